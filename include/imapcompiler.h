@@ -2,10 +2,118 @@
 
 #include "imodule.h"
 #include "inode.h"
+#include "math/AABB.h"
+#include "math/Plane3.h"
+#include <vector>
+#include <algorithm>
+#include <boost/function.hpp>
 
 namespace map
 {
 
+/**
+ * The areas of a map and the visportals connecting them, as determined by
+ * the compiler. The nodes use the layout of the .proc file's nodes section:
+ * positive child numbers refer to other nodes, negative ones are areas
+ * (-1-child), a child number of 0 is opaque, solid space.
+ */
+struct AreaPortalGraph
+{
+	struct Node
+	{
+		Plane3 plane;
+		int children[2]; // [0] = front side of the plane
+	};
+	std::vector<Node> nodes;
+
+	struct Portal
+	{
+		std::size_t areas[2]; // positive and negative side area
+		std::vector<Vector3> winding;
+	};
+	std::vector<Portal> portals;
+
+	std::size_t numAreas;
+
+	AreaPortalGraph() :
+		numAreas(0)
+	{}
+
+	// Returns the area the given point is located in, -1 for solid space
+	int getAreaForPoint(const Vector3& point) const
+	{
+		if (nodes.empty()) return numAreas > 0 ? 0 : -1;
+
+		int nodeNum = 0;
+
+		while (true)
+		{
+			const Node& node = nodes[nodeNum];
+			int child = node.children[node.plane.distanceToPoint(point) > 0 ? 0 : 1];
+
+			if (child <= 0)
+			{
+				return child == 0 ? -1 : -1 - child;
+			}
+
+			nodeNum = child;
+		}
+	}
+
+	/**
+	 * Adds the areas touched by the given bounds to the given list (if not
+	 * present yet). Boxes lying within <epsilon> of a node plane are sorted
+	 * into both of its children.
+	 */
+	void getAreasForBounds(const AABB& aabb, std::vector<int>& areas, double epsilon = 0) const
+	{
+		if (nodes.empty())
+		{
+			if (numAreas > 0 && areas.empty()) areas.push_back(0);
+			return;
+		}
+
+		getAreasForBoundsRecursively(0, aabb, areas, epsilon);
+	}
+
+private:
+	void getAreasForBoundsRecursively(int nodeNum, const AABB& aabb,
+		std::vector<int>& areas, double epsilon) const
+	{
+		const Node& node = nodes[nodeNum];
+
+		double dist = node.plane.distanceToPoint(aabb.origin);
+		double radius = fabs(node.plane.normal().x() * aabb.extents.x()) +
+			fabs(node.plane.normal().y() * aabb.extents.y()) +
+			fabs(node.plane.normal().z() * aabb.extents.z()) + epsilon;
+
+		for (int i = 0; i < 2; ++i)
+		{
+			// Skip the side the box is not reaching into
+			if (i == 0 ? dist <= -radius : dist >= radius) continue;
+
+			int child = node.children[i];
+
+			if (child > 0)
+			{
+				getAreasForBoundsRecursively(child, aabb, areas, epsilon);
+			}
+			else if (child < 0 && std::find(areas.begin(), areas.end(), -1 - child) == areas.end())
+			{
+				areas.push_back(-1 - child);
+			}
+		}
+	}
+};
+typedef boost::shared_ptr<AreaPortalGraph> AreaPortalGraphPtr;
+
+/**
+ * Builds a prepared area/portal graph, see IMapCompiler::prepareAreaPortalGraph().
+ * The task doesn't access the scene and can be run on any thread, but it
+ * should be released on the main thread, as it holds on to the materials.
+ */
+typedef boost::function<AreaPortalGraphPtr()> AreaPortalGraphTask;
+
 /**
  * Map Compiler interface for creating D3-compatible .proc files.
  */
@@ -17,6 +125,22 @@ public:
 
 	// Use the given map file to generate the .proc file containing the pre-processed map models
 	virtual void generateProc(const scene::INodePtr& root) = 0;
+
+	/**
+	 * Runs dmap on the given map file, the .proc file is written next to it.
+	 * Returns false if the map couldn't be compiled, e.g. when it is leaking
+	 * (the leak file is written in that case).
+	 */
+	virtual bool runDmap(const std::string& mapFile) = 0;
+
+	/**
+	 * Prepares building the area/portal graph of the given map the way dmap
+	 * does it, without processing any surfaces or lights. This reads the
+	 * brushes from the scene and needs to be called on the main thread. The
+	 * returned task builds the graph, which is an empty pointer if the map
+	 * doesn't have any visportals or is leaking.
+	 */
+	virtual AreaPortalGraphTask prepareAreaPortalGraph(const scene::INodePtr& root) = 0;
 };
 typedef boost::shared_ptr<IMapCompiler> IMapCompilerPtr;
 
@@ -26,6 +26,7 @@ Foundation, Inc., 51 Franklin St, Fifth Floor, Boston, MA  02110-1301  USA
 #include "irender.h"
 #include "inode.h"
 #include "imodule.h"
+#include "itextstream.h"
 
 /* Forward decls */
 class AABB;
@@ -128,6 +129,38 @@ public:
 };
 typedef boost::shared_ptr<ModelNode> ModelNodePtr;
 
+// A log message written while loading a model on a worker thread
+struct LoadMessage
+{
+	// Goes to rError() if true, to rMessage() otherwise
+	bool error;
+
+	// Including the line break
+	std::string text;
+
+	LoadMessage(bool error_, const std::string& text_) :
+		error(error_),
+		text(text_)
+	{}
+};
+typedef std::vector<LoadMessage> LoadMessages;
+
+// Writes the collected messages to the log, main thread only
+inline void writeLoadMessages(const LoadMessages& messages)
+{
+	for (LoadMessages::const_iterator i = messages.begin(); i != messages.end(); ++i)
+	{
+		if (i->error)
+		{
+			rError() << i->text;
+		}
+		else
+		{
+			rMessage() << i->text;
+		}
+	}
+}
+
 } // namespace model
 
 // Utility methods
@@ -163,6 +196,20 @@ public:
 	 *           NULL if the model loader could not load the file.
 	 */
 	virtual model::IModelPtr loadModelFromPath(const std::string& path) = 0;
+
+	/**
+	 * Variant of loadModelFromPath() for worker threads, which must not write
+	 * to the log: the messages are appended to the given list instead, the
+	 * caller logs them on the main thread.
+	 *
+	 * The default implementation is only suitable for loaders which don't
+	 * log anything.
+	 */
+	virtual model::IModelPtr loadModelFromPath(const std::string& path,
+											   model::LoadMessages& messages)
+	{
+		return loadModelFromPath(path);
+	}
 };
 typedef boost::shared_ptr<ModelLoader> ModelLoaderPtr;
 
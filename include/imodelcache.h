@@ -43,6 +43,17 @@ public:
 
 	// Clears the modelcache
 	virtual void clear() = 0;
+
+	/**
+	 * Starts a batch of background loads. Until the matching call to
+	 * endBackgroundLoads(), getModelNode() doesn't block on static models
+	 * which are not in the cache yet. These are parsed by worker threads,
+	 * in the meantime a placeholder box is returned. As soon as a model is
+	 * available, the entity its placeholder is attached to refreshes its
+	 * model. Batches may be nested.
+	 */
+	virtual void beginBackgroundLoads() = 0;
+	virtual void endBackgroundLoads() = 0;
 };
 
 } // namespace model
@@ -62,4 +73,26 @@ inline INLINE_VISIBILITY model::IModelCache& GlobalModelCache() {
 	return _modelCache;
 }
 
+namespace model {
+
+/**
+ * Loads the models requested during the lifetime of this object in the
+ * background, see IModelCache::beginBackgroundLoads().
+ */
+class ScopedBackgroundLoads
+{
+public:
+	ScopedBackgroundLoads()
+	{
+		GlobalModelCache().beginBackgroundLoads();
+	}
+
+	~ScopedBackgroundLoads()
+	{
+		GlobalModelCache().endBackgroundLoads();
+	}
+};
+
+} // namespace model
+
 #endif /* IMODELCACHE_H_ */
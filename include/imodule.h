@@ -30,6 +30,8 @@ namespace
 // for things like ASSERT_MESSAGE and ERROR_MESSAGE
 typedef boost::function<void (const std::string&, const std::string&)> ErrorHandlingFunction;
 
+namespace trace { class TraceRecorder; }
+
 /**
  * Provider for various information that may be required by modules during
  * initialisation.
@@ -96,6 +98,11 @@ public:
 	 * Retrieve a function pointer which can handle assertions and runtime errors
 	 */
 	virtual const ErrorHandlingFunction& getErrorHandlingFunction() const = 0;
+
+	/**
+	 * Retrieve the application's trace recorder, see itrace.h.
+	 */
+	virtual trace::TraceRecorder& getTraceRecorder() const = 0;
 };
 
 /**
@@ -157,6 +164,34 @@ public:
 	 */
 	virtual void initialiseModule(const ApplicationContext& ctx) = 0;
 
+	/**
+	 * Optional first part of the initialisation, called on the main (GTK)
+	 * thread right before initialiseModule(), with the same guarantees about
+	 * the dependencies. Modules with a thread-safe initialiseModule() do their
+	 * main-thread work here: registering commands and observers, reading the
+	 * XMLRegistry and connecting signals.
+	 */
+	virtual void preInitialiseModule(const ApplicationContext& ctx)
+	{
+		// Empty default implementation
+	}
+
+	/**
+	 * Whether initialiseModule() may be called on a worker thread, concurrently
+	 * with the initialisation of other modules. By default modules are
+	 * initialised on the main (GTK) thread. preInitialiseModule() is always
+	 * called on the main thread.
+	 *
+	 * Only return true if initialiseModule() does nothing but reading from its
+	 * dependencies (e.g. parsing files from the VFS) and writing to the log.
+	 * Registering commands, accessing the XMLRegistry or GTK or emitting
+	 * signals must happen in preInitialiseModule().
+	 */
+	virtual bool isInitialisationThreadSafe() const
+	{
+		return false;
+	}
+
 	/**
 	 * Optional shutdown routine. Allows the module to de-register itself,
 	 * shutdown windows, save stuff into the Registry and so on.
@@ -220,6 +255,10 @@ public:
 	 * registerModule() in the order required by their dependencies. This method
 	 * is invoked once, at application startup, with any subsequent attempts
 	 * to invoke this method throwing a logic_error.
+	 *
+	 * Modules declaring their initialisation thread-safe may be initialised
+	 * on worker threads as soon as their dependencies are ready, see
+	 * RegisterableModule::isInitialisationThreadSafe().
 	 */
 	virtual void initialiseModules() = 0;
 
@@ -28,6 +28,8 @@ Foundation, Inc., 51 Franklin St, Fifth Floor, Boston, MA  02110-1301  USA
 
 #include "ShaderLayer.h"
 
+namespace string { class InternedString; }
+
 /**
  * \file
  * Interfaces for the back-end renderer.
@@ -529,6 +531,12 @@ public:
 
 	virtual ShaderPtr capture(const std::string& name) = 0;
 
+	/**
+	 * Overload for names which are interned already, like the materials of
+	 * faces and patches. The lookup uses the hash stored in the string pool.
+	 */
+	virtual ShaderPtr capture(const string::InternedString& name) = 0;
+
     /**
      * \brief
      * Main render method.
@@ -19,6 +19,7 @@
 const std::string MODULE_SCENEGRAPH("SceneGraph");
 
 class VolumeTest;
+class Ray;
 
 namespace scene
 {
@@ -52,6 +53,10 @@ public:
 
 		// Gets called when <node> is removed from the scenegraph
 		virtual void onSceneNodeErase(const INodePtr& node) {}
+
+		// Gets called when the bounds of <node> have been re-evaluated after
+		// a change to the node or one of its children, see nodeBoundsChanged()
+		virtual void onSceneNodeBoundsChanged(const INodePtr& node) {}
 	};
 
 	// Returns the root-node of the graph.
@@ -81,9 +86,46 @@ public:
 	/// \todo Move to a separate class.
 	virtual void boundsChanged() = 0;
 
-	// A specific node has changed its bounds
+	/**
+	 * A specific node has changed its bounds. The node is not moved within
+	 * the space partition right away, the changed nodes are collected and
+	 * processed at once by processBoundsChanges().
+	 */
 	virtual void nodeBoundsChanged(const scene::INodePtr& node) = 0;
 
+	/**
+	 * Evaluates the pending bounds changes and brings the space partition up
+	 * to date. This is done before each volume or ray traversal, and at the
+	 * end of each undoable operation.
+	 */
+	virtual void processBoundsChanges() = 0;
+
+	// Counters about the bounds changes and the space partition updates
+	struct BoundsChangeStatistics
+	{
+		// Changes reported through nodeBoundsChanged()
+		std::size_t changes;
+
+		// Changes of nodes which were already waiting to be processed
+		std::size_t coalesced;
+
+		// Nodes which had to be moved to a different space partition node
+		std::size_t relinked;
+
+		// Nodes which were still fitting into their space partition node
+		std::size_t kept;
+
+		BoundsChangeStatistics() :
+			changes(0),
+			coalesced(0),
+			relinked(0),
+			kept(0)
+		{}
+	};
+
+	// The counters accumulated since the scenegraph has been created
+	virtual const BoundsChangeStatistics& getBoundsChangeStatistics() const = 0;
+
 	// A walker class to be used in "foreachNodeInVolume"
 	class Walker
 	{
@@ -112,6 +154,11 @@ public:
 	// Same as above, but culls any hidden nodes
 	virtual void foreachVisibleNodeInVolume(const VolumeTest& volume, const INode::VisitorFunc& functor) = 0;
 
+	// Call the functor on each visible scene node whose bounds are intersected by the given ray.
+	// Only the space partition nodes hit by the ray are descended, so this is a lot cheaper
+	// than walking the entire graph. Use ITraceable on the visited nodes for exact hit points.
+	virtual void foreachVisibleNodeAlongRay(const Ray& ray, const INode::VisitorFunc& functor) = 0;
+
 	// Returns the associated spacepartition
 	virtual ISpacePartitionSystemPtr getSpacePartition() = 0;
 };
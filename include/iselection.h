@@ -199,6 +199,15 @@ public:
     virtual void endMove() = 0;
     virtual void cancelMove() = 0;
 
+	/**
+	 * While a manipulator is dragged, the geometry of the selected nodes
+	 * might not be updated in each step. In this case the returned matrix
+	 * holds the transform the selected nodes (and their children) need to be
+	 * rendered with to appear at their pending position. Returns NULL if the
+	 * selection can be rendered as it is.
+	 */
+	virtual const Matrix4* getTransformPreview() const = 0;
+
 	/**
 	 * Returns the current "work zone", which is defined by the
 	 * currently selected elements. Each time a scene node is selected,
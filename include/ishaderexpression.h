@@ -1,5 +1,6 @@
 #pragma once
 
+#include <vector>
 #include <boost/shared_ptr.hpp>
 
 class IRenderEntity;
@@ -35,6 +35,8 @@ Foundation, Inc., 51 Franklin St, Fifth Floor, Boston, MA  02110-1301  USA
 
 class Image;
 
+namespace string { class InternedString; }
+
 // Forward declaration
 namespace shaders {
 
@@ -418,6 +420,9 @@ public:
 	 */
 	virtual MaterialPtr getMaterialForName(const std::string& name) = 0;
 
+	// Overload for interned names, which doesn't need to hash the name again
+	virtual MaterialPtr getMaterialForName(const string::InternedString& name) = 0;
+
 	/**
 	 * greebo: Returns true if the named material is existing, false otherwise.
 	 * In the latter case getMaterialForName() would return a default "shader not found".
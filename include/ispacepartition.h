@@ -88,6 +88,11 @@ public:
 	// (node had been linked before)
 	virtual bool unlink(const scene::INodePtr& sceneNode) = 0;
 
+	// Moves a linked node to the ISPNode fitting its current bounds. Nodes which
+	// are still at the right place are not touched. Returns true if the node
+	// had to be relinked, false if it stayed or hasn't been linked at all.
+	virtual bool update(const scene::INodePtr& sceneNode) = 0;
+
 	// Returns the root node of this SP tree (the largest one, encompassing everything)
 	virtual ISPNodePtr getRoot() const = 0;
 };
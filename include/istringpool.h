@@ -0,0 +1,112 @@
+#pragma once
+
+#include <string>
+#include "imodule.h"
+
+namespace string
+{
+
+/**
+ * An entry of the string pool. Each distinct string is stored
+ * exactly once, along with the hash of its lowercase form. All strings
+ * differing in case only refer to the same folded entry, which allows
+ * case-insensitive comparisons to be done by comparing pointers.
+ *
+ * Entries are never released while the pool is alive.
+ */
+struct PooledString
+{
+	// The string itself
+	std::string value;
+
+	// Hash of the lowercase string, equal for all case variants
+	std::size_t foldedHash;
+
+	// The entry of the lowercase variant (points to itself if value is lowercase)
+	const PooledString* folded;
+};
+
+/**
+ * The case folding of the pool: only ASCII letters are folded, like the
+ * case-insensitive comparisons used throughout the application. The result
+ * doesn't depend on the current locale.
+ */
+inline unsigned char foldAscii(unsigned char c)
+{
+	return (c >= 'A' && c <= 'Z') ? c + ('a' - 'A') : c;
+}
+
+// Returns the folded variant of the given string, see foldAscii()
+inline std::string getFoldedString(const std::string& str)
+{
+	std::string folded(str);
+
+	for (std::string::iterator i = folded.begin(); i != folded.end(); ++i)
+	{
+		*i = static_cast<char>(foldAscii(static_cast<unsigned char>(*i)));
+	}
+
+	return folded;
+}
+
+/**
+ * Case-folding FNV-1a hash, as stored in PooledString::foldedHash.
+ * Equal for all strings with the same getFoldedString().
+ */
+inline std::size_t getFoldedHash(const std::string& str)
+{
+	std::size_t hash = 2166136261U;
+
+	for (std::string::const_iterator i = str.begin(); i != str.end(); ++i)
+	{
+		hash ^= foldAscii(static_cast<unsigned char>(*i));
+		hash *= 16777619U;
+	}
+
+	return hash;
+}
+
+/**
+ * The entry of the empty string. It doesn't live in the pool, so that empty
+ * InternedStrings can be constructed before the pool module is available.
+ * The pool returns this entry when asked to intern an empty string.
+ */
+inline const PooledString& getEmptyPooledString()
+{
+	static const PooledString _empty = { std::string(), getFoldedHash(std::string()), &_empty };
+	return _empty;
+}
+
+} // namespace
+
+const std::string MODULE_STRINGPOOL("StringPool");
+
+/**
+ * The global table of interned strings used for identifiers like material
+ * names, entity class names and spawnarg keys, which are repeated many times
+ * throughout a map. Use the string::InternedString class (see
+ * libs/string/InternedString.h) instead of calling intern() directly.
+ *
+ * The pool can be accessed from any thread.
+ */
+class IStringPool :
+	public RegisterableModule
+{
+public:
+	// Returns the unique pool entry for the given string
+	virtual const string::PooledString& intern(const std::string& str) = 0;
+
+	// The number of distinct strings in the pool
+	virtual std::size_t size() const = 0;
+};
+
+inline IStringPool& GlobalStringPool()
+{
+	// Cache the reference locally
+	static IStringPool& _stringPool(
+		*boost::static_pointer_cast<IStringPool>(
+			module::GlobalModuleRegistry().getModule(MODULE_STRINGPOOL)
+		)
+	);
+	return _stringPool;
+}
@@ -1,6 +1,6 @@
 #pragma once
 
-#include <glibmm.h>
+#include <vector>
 #include <boost/function.hpp>
 #include <boost/shared_ptr.hpp>
 
@@ -14,7 +14,18 @@
 class ThreadManager
 {
 public:
+    typedef std::vector< boost::function<void()> > Jobs;
 
     /// Execute the given function in a separate thread
     virtual void execute(boost::function<void()> func) const = 0;
+
+    /**
+     * \brief
+     * Execute the given functions in parallel and block until all of them
+     * have returned. The calling thread runs jobs itself, including all jobs
+     * no pool thread has picked up, so this may be called from within jobs
+     * running in the pool. If jobs throw, the first exception is rethrown
+     * once all jobs have returned.
+     */
+    virtual void executeAndWait(const Jobs& jobs) const = 0;
 };
@@ -0,0 +1,119 @@
+#pragma once
+
+#include "imodule.h"
+#include <string>
+
+/**
+ * \namespace trace
+ * Lightweight instrumentation of the application, used to find out where
+ * startup and heavy operations spend their time. Code sections are marked
+ * by ScopedZone instances; while the recording is active, each zone is
+ * stored with its thread and its begin and end time. The recording can be
+ * exported in the Chrome trace-event format, to be viewed in about:tracing
+ * or Perfetto.
+ *
+ * Recording is started by the --trace command line switch or the StartTrace
+ * command, StopTrace writes the file.
+ */
+namespace trace
+{
+
+// Microseconds, relative to an arbitrary point in time
+typedef long long Timestamp;
+
+class TraceRecorder
+{
+protected:
+	// Checked inline by the zones to keep them cheap while not recording
+	volatile bool _recording;
+
+	TraceRecorder() :
+		_recording(false)
+	{}
+
+public:
+	virtual ~TraceRecorder() {}
+
+	bool isRecording() const
+	{
+		return _recording;
+	}
+
+	// The current time of the recorder's clock
+	virtual Timestamp getTimestamp() const = 0;
+
+	/**
+	 * Adds a completed zone on the calling thread. Category and name need
+	 * to be string literals, the detail is an optional argument shown with
+	 * the zone, like a filename.
+	 */
+	virtual void addZone(const char* category, const char* name, const std::string& detail,
+						 Timestamp start, Timestamp end) = 0;
+};
+
+} // namespace
+
+// The accessor for the recorder owned by the application
+inline trace::TraceRecorder& GlobalTraceRecorder()
+{
+	// Cache the reference locally
+	static trace::TraceRecorder& _recorder(
+		module::GlobalModuleRegistry().getApplicationContext().getTraceRecorder()
+	);
+	return _recorder;
+}
+
+namespace trace
+{
+
+/**
+ * Marks the scope it lives in as zone, recorded when the scope is left.
+ * The overhead is a single flag check while the recording is stopped.
+ */
+class ScopedZone
+{
+	TraceRecorder& _recorder;
+
+	const char* _category;
+	const char* _name;
+
+	// Not copied, only read when the zone is recorded
+	const std::string* _detail;
+
+	// Negative if the recording was stopped at construction
+	Timestamp _start;
+
+public:
+	ScopedZone(const char* category, const char* name) :
+		_recorder(GlobalTraceRecorder()),
+		_category(category),
+		_name(name),
+		_detail(NULL),
+		_start(_recorder.isRecording() ? _recorder.getTimestamp() : -1)
+	{}
+
+	/**
+	 * The detail string is referenced, it needs to outlive the zone. Pass
+	 * an existing string like a filename: a detail assembled for the zone
+	 * would be formatted even while nothing is recorded, such code needs to
+	 * check GlobalTraceRecorder().isRecording() first.
+	 */
+	ScopedZone(const char* category, const char* name, const std::string& detail) :
+		_recorder(GlobalTraceRecorder()),
+		_category(category),
+		_name(name),
+		_detail(&detail),
+		_start(_recorder.isRecording() ? _recorder.getTimestamp() : -1)
+	{}
+
+	~ScopedZone()
+	{
+		if (_start >= 0 && _recorder.isRecording())
+		{
+			_recorder.addZone(_category, _name, _detail != NULL ? *_detail : std::string(),
+							  _start, _recorder.getTimestamp());
+		}
+	}
+};
+
+} // namespace
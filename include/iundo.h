@@ -16,6 +16,10 @@ class IUndoMemento
 {
 public:
     virtual ~IUndoMemento() {}
+
+	// Returns the (approximate) number of bytes occupied by this memento,
+	// data stored in the UndoSystem's memento arena is not included.
+	virtual std::size_t getMemoryUsage() const = 0;
 };
 typedef std::shared_ptr<IUndoMemento> IUndoMementoPtr;
 
@@ -65,6 +69,27 @@ public:
 	virtual void redo() = 0;
 };
 
+/**
+ * Pooled storage for the payload of compact undo mementos, owned by the
+ * UndoSystem. Blocks are carved out of larger chunks, which avoids one heap
+ * allocation per memento and lets the UndoSystem keep track of the memory
+ * occupied by the undo history.
+ */
+class IUndoMementoArena
+{
+public:
+	virtual ~IUndoMementoArena() {}
+
+	// Returns a block of at least the given size, aligned to 8 bytes
+	virtual unsigned char* allocate(std::size_t size) = 0;
+
+	// Hands the block back to the arena, size must match the one passed to allocate()
+	virtual void release(unsigned char* block, std::size_t size) = 0;
+
+	// Returns the number of bytes occupied by the blocks currently in use
+	virtual std::size_t getMemoryUsage() const = 0;
+};
+
 const std::string MODULE_UNDOSYSTEM("UndoSystem");
 
 class UndoSystem :
@@ -102,6 +127,12 @@ public:
 
 	virtual void attachTracker(IUndoTracker& tracker) = 0;
 	virtual void detachTracker(IUndoTracker& tracker) = 0;
+
+	// The arena used by mementos to store their (compressed) data
+	virtual IUndoMementoArena& getMementoArena() = 0;
+
+	// Returns the number of bytes used by the undo and redo history
+	virtual std::size_t getMemoryUsage() const = 0;
 };
 
 // The accessor function
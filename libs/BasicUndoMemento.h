@@ -1,21 +1,48 @@
 #pragma once
 
 #include "iundo.h"
+#include <list>
+#include <vector>
 
 namespace undo
 {
 
+namespace detail
+{
+
+// Estimates the heap memory held by a copyable object, the default is to assume none
+template<typename Copyable>
+inline std::size_t getHeapMemoryUsage(const Copyable& data)
+{
+	return 0;
+}
+
+template<typename T>
+inline std::size_t getHeapMemoryUsage(const std::vector<T>& data)
+{
+	return data.capacity() * sizeof(T);
+}
+
+template<typename T>
+inline std::size_t getHeapMemoryUsage(const std::list<T>& data)
+{
+	// Each list node carries two pointers in addition to the value
+	return data.size() * (sizeof(T) + 2 * sizeof(void*));
+}
+
+} // namespace
+
 /**
  * An UndoMemento implementation capable of holding a single
  * copyable object, which is stored by value.
  */
 template<typename Copyable>
-class BasicUndoMemento : 
+class BasicUndoMemento :
 	public IUndoMemento
 {
 	Copyable _data;
 public:
-	BasicUndoMemento(const Copyable& data) : 
+	BasicUndoMemento(const Copyable& data) :
 		_data(data)
 	{}
 
@@ -23,6 +50,11 @@ public:
 	{
 		return _data;
 	}
+
+	std::size_t getMemoryUsage() const
+	{
+		return sizeof(*this) + detail::getHeapMemoryUsage(_data);
+	}
 };
 
 } // namespace
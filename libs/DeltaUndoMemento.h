@@ -0,0 +1,305 @@
+#pragma once
+
+#include "iundo.h"
+#include <vector>
+#include <string>
+#include <cstring>
+#include <boost/cstdint.hpp>
+#include <boost/noncopyable.hpp>
+
+namespace undo
+{
+
+typedef std::vector<unsigned char> ByteBuffer;
+
+/**
+ * Appends values to a ByteBuffer. Only trivially copyable
+ * types (no pointers, no virtual functions) may be written.
+ */
+class ByteWriter
+{
+	ByteBuffer& _buffer;
+public:
+	ByteWriter(ByteBuffer& buffer) :
+		_buffer(buffer)
+	{}
+
+	template<typename T>
+	void write(const T& value)
+	{
+		writeArray(&value, 1);
+	}
+
+	template<typename T>
+	void writeArray(const T* values, std::size_t count)
+	{
+		const unsigned char* bytes = reinterpret_cast<const unsigned char*>(values);
+		_buffer.insert(_buffer.end(), bytes, bytes + sizeof(T) * count);
+	}
+
+	void writeString(const std::string& str)
+	{
+		write<boost::uint32_t>(static_cast<boost::uint32_t>(str.size()));
+		_buffer.insert(_buffer.end(), str.begin(), str.end());
+	}
+};
+
+/**
+ * Reads back the values stored by a ByteWriter, in the same order.
+ */
+class ByteReader
+{
+	const ByteBuffer& _buffer;
+	std::size_t _pos;
+public:
+	ByteReader(const ByteBuffer& buffer) :
+		_buffer(buffer),
+		_pos(0)
+	{}
+
+	template<typename T>
+	void read(T& value)
+	{
+		readArray(&value, 1);
+	}
+
+	template<typename T>
+	T read()
+	{
+		T value;
+		read(value);
+		return value;
+	}
+
+	template<typename T>
+	void readArray(T* values, std::size_t count)
+	{
+		std::size_t size = sizeof(T) * count;
+
+		if (size == 0) return;
+
+		std::memcpy(values, &_buffer[_pos], size);
+		_pos += size;
+	}
+
+	std::string readString()
+	{
+		boost::uint32_t length = read<boost::uint32_t>();
+
+		std::string str(_buffer.begin() + _pos, _buffer.begin() + _pos + length);
+		_pos += length;
+
+		return str;
+	}
+};
+
+class DeltaUndoMemento;
+typedef std::shared_ptr<DeltaUndoMemento> DeltaUndoMementoPtr;
+
+/**
+ * An UndoMemento storing the serialised state of an Undoable in the
+ * UndoSystem's memento arena.
+ *
+ * A freshly created memento holds the full data (a keyframe). As soon as the
+ * Undoable is saved again, the previous memento is re-encoded as a list of
+ * changed byte ranges relative to the newer one, which it keeps alive as its
+ * base. Undoables that change only a few of their values per operation (a
+ * single face plane, a few patch vertices) thus occupy a fraction of the
+ * memory of a full copy.
+ */
+class DeltaUndoMemento :
+	public IUndoMemento,
+	public boost::noncopyable
+{
+	// Two equal ranges closer than this are merged into one, as each run
+	// carries an offset and a length.
+	static const std::size_t RUN_HEADER_SIZE = 2 * sizeof(boost::uint32_t);
+
+	IUndoMementoArena& _arena;
+
+	// The newer memento this one is stored relative to, empty for keyframes
+	DeltaUndoMementoPtr _base;
+
+	// The size of the decoded data
+	std::size_t _dataSize;
+
+	// Keyframes: the data itself, deltas: the runs [offset][length][bytes]
+	unsigned char* _block;
+	std::size_t _blockSize;
+
+public:
+	DeltaUndoMemento(const ByteBuffer& data) :
+		_arena(GlobalUndoSystem().getMementoArena()),
+		_dataSize(data.size()),
+		_block(NULL),
+		_blockSize(0)
+	{
+		store(data);
+	}
+
+	~DeltaUndoMemento()
+	{
+		releaseBlock();
+	}
+
+	bool isKeyframe() const
+	{
+		return !_base;
+	}
+
+	// The payload is accounted for by the arena
+	std::size_t getMemoryUsage() const
+	{
+		return sizeof(*this);
+	}
+
+	// Decodes the stored state into the given buffer
+	void getData(ByteBuffer& data) const
+	{
+		if (!_base)
+		{
+			data.assign(_block, _block + _blockSize);
+			return;
+		}
+
+		_base->getData(data);
+		data.resize(_dataSize);
+
+		const unsigned char* pos = _block;
+		const unsigned char* end = _block + _blockSize;
+
+		while (pos < end)
+		{
+			boost::uint32_t offset;
+			boost::uint32_t length;
+
+			std::memcpy(&offset, pos, sizeof(offset));
+			std::memcpy(&length, pos + sizeof(offset), sizeof(length));
+			pos += RUN_HEADER_SIZE;
+
+			std::memcpy(&data[offset], pos, length);
+			pos += length;
+		}
+	}
+
+	/**
+	 * Re-encodes this keyframe as difference to the given newer memento,
+	 * whose decoded data is passed in newerData. The memento is left
+	 * untouched if the difference is not smaller than the full data.
+	 */
+	void encodeAgainst(const DeltaUndoMementoPtr& newer, const ByteBuffer& newerData)
+	{
+		if (_base || newer.get() == this) return;
+
+		ByteBuffer runs;
+		ByteWriter writer(runs);
+
+		std::size_t i = 0;
+
+		while (i < _dataSize && runs.size() < _blockSize)
+		{
+			if (differs(newerData, i))
+			{
+				// Extend the run until there are enough equal bytes to justify a new run header
+				std::size_t start = i;
+				std::size_t end = i + 1;
+
+				for (std::size_t j = end; j < _dataSize && j - end < RUN_HEADER_SIZE; ++j)
+				{
+					if (differs(newerData, j))
+					{
+						end = j + 1;
+					}
+				}
+
+				writer.write<boost::uint32_t>(static_cast<boost::uint32_t>(start));
+				writer.write<boost::uint32_t>(static_cast<boost::uint32_t>(end - start));
+				writer.writeArray(_block + start, end - start);
+
+				i = end;
+				continue;
+			}
+
+			++i;
+		}
+
+		if (runs.size() >= _blockSize) return; // not worth it
+
+		releaseBlock();
+		store(runs);
+
+		_base = newer;
+	}
+
+private:
+	bool differs(const ByteBuffer& other, std::size_t offset) const
+	{
+		return offset >= other.size() || _block[offset] != other[offset];
+	}
+
+	void store(const ByteBuffer& data)
+	{
+		if (data.empty()) return;
+
+		_blockSize = data.size();
+		_block = _arena.allocate(_blockSize);
+
+		std::memcpy(_block, &data[0], _blockSize);
+	}
+
+	void releaseBlock()
+	{
+		if (_block != NULL)
+		{
+			_arena.release(_block, _blockSize);
+			_block = NULL;
+			_blockSize = 0;
+		}
+	}
+};
+
+/**
+ * Creates the DeltaUndoMementos of a single Undoable. Each new memento
+ * becomes the base of the previous one, which is then re-encoded as delta.
+ * Every KEYFRAME_INTERVAL-th memento is kept as it is, this limits the number
+ * of mementos that need to be decoded to restore a state.
+ */
+class DeltaMementoChain
+{
+	static const std::size_t KEYFRAME_INTERVAL = 16;
+
+	std::weak_ptr<DeltaUndoMemento> _last;
+	std::size_t _count;
+
+public:
+	DeltaMementoChain() :
+		_count(0)
+	{}
+
+	// Chains are bound to one Undoable, copies start from scratch
+	DeltaMementoChain(const DeltaMementoChain& other) :
+		_count(0)
+	{}
+
+	DeltaMementoChain& operator=(const DeltaMementoChain& other)
+	{
+		return *this;
+	}
+
+	DeltaUndoMementoPtr createMemento(const ByteBuffer& data)
+	{
+		DeltaUndoMementoPtr memento(new DeltaUndoMemento(data));
+		DeltaUndoMementoPtr previous = _last.lock();
+
+		if (previous && ++_count % KEYFRAME_INTERVAL != 0)
+		{
+			previous->encodeAgainst(memento, data);
+		}
+
+		_last = memento;
+
+		return memento;
+	}
+};
+
+} // namespace
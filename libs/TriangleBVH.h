@@ -0,0 +1,367 @@
+#pragma once
+
+#include <vector>
+#include <algorithm>
+#include <cfloat>
+#include <boost/shared_ptr.hpp>
+
+#include "iselectiontest.h"
+#include "ivolumetest.h"
+#include "math/AABB.h"
+#include "math/Ray.h"
+#include "math/Matrix4.h"
+
+/**
+ * A bounding volume hierarchy built over an indexed triangle list.
+ *
+ * The tree is used to accelerate selection tests and ray traces against
+ * meshes with many triangles: instead of testing every triangle, only the
+ * leaves whose bounds pass the volume (or ray) test are handed over to
+ * the SelectionTest.
+ *
+ * The BVH doesn't store any vertex data itself, it only keeps a re-ordered
+ * copy of the triangle indices. The same vertex array that has been used
+ * for construction must be passed to the query methods, which makes it
+ * possible to share one BVH between all model instances referencing the
+ * same geometry.
+ */
+class TriangleBVH
+{
+public:
+	typedef IndexPointer::index_type Index;
+
+	// Nodes with less or equal this amount of triangles are not split further
+	static const std::size_t MAX_LEAF_TRIANGLES = 8;
+
+private:
+	struct Node
+	{
+		// The bounds of all triangles below this node
+		AABB bounds;
+
+		// Leaf nodes: index of the first triangle and the number of triangles
+		// Inner nodes have numTriangles == 0, the first child is the next
+		// node in the array, the second child is located at secondChild.
+		std::size_t firstTriangle;
+		std::size_t numTriangles;
+		std::size_t secondChild;
+
+		bool isLeaf() const
+		{
+			return numTriangles > 0;
+		}
+	};
+
+	// The nodes in depth-first order, the root is at index 0
+	std::vector<Node> _nodes;
+
+	// The triangle indices, re-ordered such that each leaf references a contiguous range
+	std::vector<Index> _indices;
+
+	// Temporary per-triangle data, only used during construction
+	struct BuildTriangle
+	{
+		AABB bounds;
+		Vector3 centroid;
+		std::size_t triangle;
+	};
+	typedef std::vector<BuildTriangle> BuildTriangles;
+
+	// Sorts triangles along one axis by their centroid
+	class CentroidLess
+	{
+		std::size_t _axis;
+	public:
+		CentroidLess(std::size_t axis) :
+			_axis(axis)
+		{}
+
+		bool operator()(const BuildTriangle& a, const BuildTriangle& b) const
+		{
+			return a.centroid[_axis] < b.centroid[_axis];
+		}
+	};
+
+public:
+	/**
+	 * Construct the hierarchy from the given triangle list,
+	 * indices are interpreted as three consecutive indices per triangle.
+	 */
+	TriangleBVH(const VertexPointer& vertices, const IndexPointer& indices)
+	{
+		BuildTriangles triangles;
+
+		for (IndexPointer::iterator i = indices.begin(); i != indices.end(); i += 3)
+		{
+			const Vector3& a = vertices[*i];
+			const Vector3& b = vertices[*(i+1)];
+			const Vector3& c = vertices[*(i+2)];
+
+			BuildTriangle tri;
+			tri.bounds.includePoint(a);
+			tri.bounds.includePoint(b);
+			tri.bounds.includePoint(c);
+			tri.centroid = (a + b + c) / 3;
+			tri.triangle = triangles.size();
+
+			triangles.push_back(tri);
+
+			_indices.push_back(*i);
+			_indices.push_back(*(i+1));
+			_indices.push_back(*(i+2));
+		}
+
+		if (triangles.empty()) return;
+
+		_nodes.reserve(2 * triangles.size() / MAX_LEAF_TRIANGLES + 1);
+
+		buildRecursively(triangles, 0, triangles.size());
+
+		// Re-order the index array to match the triangle order of the leaves
+		std::vector<Index> sortedIndices(_indices.size());
+
+		for (std::size_t i = 0; i < triangles.size(); ++i)
+		{
+			std::size_t source = triangles[i].triangle * 3;
+
+			sortedIndices[i*3] = _indices[source];
+			sortedIndices[i*3 + 1] = _indices[source + 1];
+			sortedIndices[i*3 + 2] = _indices[source + 2];
+		}
+
+		_indices.swap(sortedIndices);
+	}
+
+	bool isEmpty() const
+	{
+		return _nodes.empty();
+	}
+
+	std::size_t getNumTriangles() const
+	{
+		return _indices.size() / 3;
+	}
+
+	std::size_t getNumNodes() const
+	{
+		return _nodes.size();
+	}
+
+	/**
+	 * Runs the given selection test against all triangles in leaves
+	 * intersecting the test volume. The SelectionTest is expected to be set
+	 * up already through BeginMesh(), using the same localToWorld matrix.
+	 */
+	void testSelect(SelectionTest& test, const VertexPointer& vertices,
+					const Matrix4& localToWorld, SelectionIntersection& best) const
+	{
+		if (_nodes.empty()) return;
+
+		const VolumeTest& volume = test.getVolume();
+
+		// Median splits guarantee a depth below the bit width of size_t
+		std::size_t stack[64];
+		std::size_t stackSize = 0;
+
+		stack[stackSize++] = 0;
+
+		while (stackSize > 0)
+		{
+			const Node& node = _nodes[stack[--stackSize]];
+
+			if (volume.TestAABB(node.bounds, localToWorld) == VOLUME_OUTSIDE)
+			{
+				continue;
+			}
+
+			if (node.isLeaf())
+			{
+				test.TestTriangles(vertices,
+					IndexPointer(&_indices[node.firstTriangle * 3], node.numTriangles * 3),
+					best);
+				continue;
+			}
+
+			stack[stackSize++] = node.secondChild;
+			stack[stackSize++] = &node - &_nodes[0] + 1;
+		}
+	}
+
+	/**
+	 * Traces the given ray against the triangles, the ray is expected to be
+	 * in the same (local) space as the vertices. Returns true if a hit was
+	 * found, the closest intersection point is stored in the given Vector3.
+	 * The ray direction doesn't need to be normalised.
+	 */
+	bool getIntersection(const Ray& ray, const VertexPointer& vertices, Vector3& intersection) const
+	{
+		if (_nodes.empty()) return false;
+
+		Vector3 invDir(
+			ray.direction.x() != 0 ? 1.0 / ray.direction.x() : FLT_MAX,
+			ray.direction.y() != 0 ? 1.0 / ray.direction.y() : FLT_MAX,
+			ray.direction.z() != 0 ? 1.0 / ray.direction.z() : FLT_MAX
+		);
+
+		// Distances are measured in multiples of the ray direction
+		double dirLengthSquared = ray.direction.getLengthSquared();
+
+		double bestDist = FLT_MAX;
+		bool found = false;
+
+		std::size_t stack[64];
+		std::size_t stackSize = 0;
+
+		stack[stackSize++] = 0;
+
+		while (stackSize > 0)
+		{
+			std::size_t nodeIndex = stack[--stackSize];
+			const Node& node = _nodes[nodeIndex];
+
+			double nodeDist;
+
+			if (!intersectBounds(ray, invDir, node.bounds, nodeDist) || nodeDist > bestDist)
+			{
+				continue;
+			}
+
+			if (node.isLeaf())
+			{
+				std::size_t first = node.firstTriangle * 3;
+				std::size_t last = first + node.numTriangles * 3;
+
+				for (std::size_t i = first; i < last; i += 3)
+				{
+					Vector3 triIntersection;
+
+					if (ray.intersectTriangle(vertices[_indices[i]], vertices[_indices[i+1]],
+						vertices[_indices[i+2]], triIntersection) != Ray::POINT)
+					{
+						continue;
+					}
+
+					double dist = (triIntersection - ray.origin).dot(ray.direction) / dirLengthSquared;
+
+					if (dist < bestDist)
+					{
+						bestDist = dist;
+						intersection = triIntersection;
+						found = true;
+					}
+				}
+
+				continue;
+			}
+
+			// Push the farther child first, such that the nearer one is visited first
+			std::size_t first = nodeIndex + 1;
+			std::size_t second = node.secondChild;
+
+			double firstDist = 0, secondDist = 0;
+			intersectBounds(ray, invDir, _nodes[first].bounds, firstDist);
+			intersectBounds(ray, invDir, _nodes[second].bounds, secondDist);
+
+			if (firstDist <= secondDist)
+			{
+				stack[stackSize++] = second;
+				stack[stackSize++] = first;
+			}
+			else
+			{
+				stack[stackSize++] = first;
+				stack[stackSize++] = second;
+			}
+		}
+
+		return found;
+	}
+
+private:
+	// Returns the index of the created node
+	std::size_t buildRecursively(BuildTriangles& triangles, std::size_t first, std::size_t count)
+	{
+		std::size_t nodeIndex = _nodes.size();
+		_nodes.push_back(Node());
+
+		AABB bounds;
+		AABB centroidBounds;
+
+		for (std::size_t i = first; i < first + count; ++i)
+		{
+			bounds.includeAABB(triangles[i].bounds);
+			centroidBounds.includePoint(triangles[i].centroid);
+		}
+
+		// Split along the longest axis of the centroid bounds
+		std::size_t axis = 0;
+		const Vector3& extents = centroidBounds.getExtents();
+
+		if (extents[1] > extents[axis]) axis = 1;
+		if (extents[2] > extents[axis]) axis = 2;
+
+		if (count <= MAX_LEAF_TRIANGLES || extents[axis] <= 0)
+		{
+			Node& leaf = _nodes[nodeIndex];
+
+			leaf.bounds = bounds;
+			leaf.firstTriangle = first;
+			leaf.numTriangles = count;
+			leaf.secondChild = 0;
+
+			return nodeIndex;
+		}
+
+		std::size_t half = count / 2;
+
+		std::nth_element(triangles.begin() + first, triangles.begin() + first + half,
+			triangles.begin() + first + count, CentroidLess(axis));
+
+		buildRecursively(triangles, first, half);
+		std::size_t secondChild = buildRecursively(triangles, first + half, count - half);
+
+		// Don't hold a reference across the recursion, the vector might have grown
+		Node& inner = _nodes[nodeIndex];
+
+		inner.bounds = bounds;
+		inner.firstTriangle = first;
+		inner.numTriangles = 0;
+		inner.secondChild = secondChild;
+
+		return nodeIndex;
+	}
+
+	// Slab test, returns the ray parameter at which the box is entered (0 if the origin is inside)
+	static bool intersectBounds(const Ray& ray, const Vector3& invDir, const AABB& aabb, double& dist)
+	{
+		double tMin = 0;
+		double tMax = FLT_MAX;
+
+		for (std::size_t i = 0; i < 3; ++i)
+		{
+			double lower = aabb.origin[i] - aabb.extents[i];
+			double upper = aabb.origin[i] + aabb.extents[i];
+
+			if (ray.direction[i] == 0)
+			{
+				// Parallel to the slab, origin must be within
+				if (ray.origin[i] < lower || ray.origin[i] > upper) return false;
+				continue;
+			}
+
+			double t1 = (lower - ray.origin[i]) * invDir[i];
+			double t2 = (upper - ray.origin[i]) * invDir[i];
+
+			if (t1 > t2) std::swap(t1, t2);
+
+			tMin = std::max(tMin, t1);
+			tMax = std::min(tMax, t2);
+
+			if (tMin > tMax) return false;
+		}
+
+		dist = tMin;
+		return true;
+	}
+};
+typedef boost::shared_ptr<TriangleBVH> TriangleBVHPtr;
@@ -0,0 +1,198 @@
+#pragma once
+
+#include "ifilesystem.h"
+#include "iarchive.h"
+#include "idatastream.h"
+#include "os/fs.h"
+
+#include <cstdio>
+#include <fstream>
+#include <sstream>
+#include <stdexcept>
+#include <boost/cstdint.hpp>
+#include <boost/noncopyable.hpp>
+
+#if defined(WIN32)
+#include <process.h>
+#else
+#include <unistd.h>
+#endif
+
+/**
+ * \file
+ * Helpers for the disk caches in the user's settings folder, which store
+ * information derived from VFS files between sessions.
+ */
+namespace cache
+{
+
+const boost::uint64_t FNV_OFFSET = 14695981039346656037ULL;
+const boost::uint64_t FNV_PRIME = 1099511628211ULL;
+
+// Continues the FNV-1a hash of a byte sequence, start with FNV_OFFSET
+inline boost::uint64_t hashBytes(boost::uint64_t hash, const char* data, std::size_t size)
+{
+	for (std::size_t i = 0; i < size; ++i)
+	{
+		hash ^= static_cast<unsigned char>(data[i]);
+		hash *= FNV_PRIME;
+	}
+
+	return hash;
+}
+
+/**
+ * Identifies a version of a VFS file: its size and modification time, or a
+ * checksum of its contents for files inside PK4 archives, which don't
+ * provide a timestamp. A cache entry is valid as long as both values match.
+ */
+struct SourceInfo
+{
+	boost::uint64_t size;
+	boost::uint64_t stamp;
+
+	SourceInfo() :
+		size(0),
+		stamp(0)
+	{}
+
+	bool operator==(const SourceInfo& other) const
+	{
+		return size == other.size && stamp == other.stamp;
+	}
+
+	bool operator!=(const SourceInfo& other) const
+	{
+		return !operator==(other);
+	}
+};
+
+/**
+ * Determines the source info of the given VFS file, returns false if the
+ * file doesn't exist. Archived files are read completely, which is still
+ * much faster than parsing them. This can be called from any thread.
+ */
+inline bool getSourceInfo(const std::string& vfsPath, SourceInfo& info)
+{
+	ArchiveFilePtr file = GlobalFileSystem().openFile(vfsPath);
+
+	if (!file) return false;
+
+	info.size = file->size();
+
+	// Loose files can be checked by their modification time
+	std::string root = GlobalFileSystem().findFile(vfsPath);
+
+	if (!root.empty())
+	{
+		try
+		{
+			info.stamp = static_cast<boost::uint64_t>(fs::last_write_time(fs::path(root + vfsPath)));
+			return true;
+		}
+		catch (fs::filesystem_error&)
+		{}
+	}
+
+	InputStream& stream = file->getInputStream();
+
+	char buffer[16384];
+	info.stamp = FNV_OFFSET;
+
+	for (std::size_t read = stream.read(reinterpret_cast<InputStream::byte_type*>(buffer), sizeof(buffer));
+		 read > 0;
+		 read = stream.read(reinterpret_cast<InputStream::byte_type*>(buffer), sizeof(buffer)))
+	{
+		info.stamp = hashBytes(info.stamp, buffer, read);
+	}
+
+	return true;
+}
+
+/**
+ * Writes a cache file through a temporary file next to it, which replaces
+ * the cache file on commit(). A reader never picks up a half-written file,
+ * the temporary file is removed if commit() isn't reached. Several processes
+ * (like batch workers) and threads can write the same cache file at once,
+ * the last commit wins.
+ */
+class AtomicFileWriter :
+	public boost::noncopyable
+{
+	std::string _filename;
+	std::string _tempFilename;
+
+	std::ofstream _stream;
+
+	bool _committed;
+
+public:
+	AtomicFileWriter(const std::string& filename,
+					 std::ios::openmode mode = std::ios::out) :
+		_filename(filename),
+		_tempFilename(getTempFilename(filename)),
+		_stream(_tempFilename.c_str(), mode | std::ios::out),
+		_committed(false)
+	{}
+
+	~AtomicFileWriter()
+	{
+		if (!_committed)
+		{
+			_stream.close();
+			std::remove(_tempFilename.c_str());
+		}
+	}
+
+	std::ostream& getStream()
+	{
+		return _stream;
+	}
+
+	// Replaces the target file with the written data. Throws a
+	// std::runtime_error if the data or the file couldn't be written.
+	void commit()
+	{
+		_stream.close();
+
+		if (!_stream)
+		{
+			throw std::runtime_error("Could not write " + _tempFilename);
+		}
+
+#if defined(BOOST_FILESYSTEM_VERSION) && BOOST_FILESYSTEM_VERSION >= 3
+		// Replaces the target in one step: rename() on POSIX, MoveFileEx
+		// with MOVEFILE_REPLACE_EXISTING on Windows
+		fs::rename(_tempFilename, _filename);
+#else
+		// Filesystem V2 refuses to overwrite an existing file
+		if (fs::exists(_filename))
+		{
+			fs::remove(_filename);
+		}
+
+		fs::rename(_tempFilename, _filename);
+#endif
+
+		_committed = true;
+	}
+
+private:
+	// Unique among the writers of all processes: the process ID plus the
+	// address of this writer, which no other living writer can share
+	std::string getTempFilename(const std::string& filename) const
+	{
+		std::ostringstream name;
+
+#if defined(WIN32)
+		name << filename << "." << _getpid();
+#else
+		name << filename << "." << getpid();
+#endif
+		name << "." << std::hex << reinterpret_cast<std::size_t>(this) << ".tmp";
+
+		return name.str();
+	}
+};
+
+} // namespace
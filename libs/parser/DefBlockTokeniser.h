@@ -25,9 +25,18 @@ public:
 		// The block contents (excluding braces)
 		std::string contents;
 
+		// The number of characters preceding the contents in the input,
+		// the contents can be read from there again later on
+		std::size_t contentsOffset;
+
+		Block() :
+			contentsOffset(0)
+		{}
+
 		void clear() {
 			name.clear();
 			contents.clear();
+			contentsOffset = 0;
 		}
 	};
 
@@ -79,6 +88,16 @@ class DefBlockTokeniserFunc {
 	const char _blockStartChar;	// "{"
 	const char _blockEndChar;		// "}"
 
+	// The number of characters consumed so far
+	std::size_t _position;
+
+	// Moves to the next character, keeping track of the position
+	template<typename InputIterator>
+	void advance(InputIterator& next) {
+		++next;
+		++_position;
+	}
+
 	// Test if a character is a delimiter
     bool isDelim(char c) {
         const char* curDelim = _delims;
@@ -97,7 +116,8 @@ public:
 		_state(SEARCHING_NAME),
 		_delims(delims),
 		_blockStartChar(blockStartChar),
-		_blockEndChar(blockEndChar)
+		_blockEndChar(blockEndChar),
+		_position(0)
     {}
 
     /* REQUIRED. Operator() is called by the boost::tokenizer. This function
@@ -125,7 +145,7 @@ public:
                 case SEARCHING_NAME:
 					// Ignore delimiters
 					if (isDelim(ch)) {
-						++next;
+						advance(next);
 						continue;
 					}
 
@@ -145,33 +165,34 @@ public:
                         // Found a slash, possibly start of comment
                         case '/':
                             _state = FORWARDSLASH;
-                            ++next;
+                            advance(next);
                             continue; // skip slash, will need to add it back if this is not a comment
 
                         // General case. Token lasts until next delimiter.
                         default:
                             tok.name += ch;
-                            ++next;
+                            advance(next);
                             continue;
                     }
 					break;
 
 				case SEARCHING_BLOCK:
 					if (isDelim(ch)) {
-						++next; // keep on searching
+						advance(next); // keep on searching
 						continue;
 					}
 					else if (ch == _blockStartChar) {
 						// Found an opening brace
 						_state = BLOCK_CONTENT;
 						blockLevel++;
-						++next;
+						advance(next);
+						tok.contentsOffset = _position;
 						continue;
 					}
 					else if (ch == '/') {
 						// Forward slash, possible comment start
 						_state = FORWARDSLASH;
-						++next;
+						advance(next);
 						continue;
 					}
 					else {
@@ -182,7 +203,7 @@ public:
 
 						// Switch back to name
 						_state = TOKEN_STARTED;
-						++next;
+						advance(next);
 						continue;
 					}
 
@@ -194,13 +215,13 @@ public:
 						if (blockLevel == 0) {
 							// End of block content, we're done here,
 							// don't add this last character either
-							++next;
+							advance(next);
 							return true;
 						}
 						else {
 							// Still within a block, add to contents
 							tok.contents += ch;
-							++next;
+							advance(next);
 							continue;
 						}
 					}
@@ -208,12 +229,12 @@ public:
 						// another block within this block, ignore this
 						blockLevel++;
 						tok.contents += ch;
-						++next;
+						advance(next);
 						continue;
 					}
 					else {
 						tok.contents += ch;
-						++next;
+						advance(next);
 						continue;
 					}
 
@@ -226,12 +247,12 @@ public:
                     switch (ch) {
                         case '*':
                             _state = COMMENT_DELIM;
-                            ++next;
+                            advance(next);
                             continue;
 
                         case '/':
                             _state = COMMENT_EOL;
-                            ++next;
+                            advance(next);
                             continue;
 
                         default: // false alarm, add the slash and carry on
@@ -246,11 +267,11 @@ public:
                     // the "*/" sequence.
                     if (ch == '*') {
                         _state = STAR;
-                        ++next;
+                        advance(next);
                         continue;
                     }
                     else {
-                        ++next;
+                        advance(next);
                         continue; // ignore and carry on
                     }
 
@@ -259,11 +280,11 @@ public:
                     if (ch == '\r' || ch == '\n') {
 						// An EOL comment with non-empty name means searching for block
 						_state = (tok.name.empty()) ? SEARCHING_NAME : SEARCHING_BLOCK;
-                        ++next;
+                        advance(next);
                         continue;
                     }
                     else {
-                        ++next;
+                        advance(next);
                         continue; // do nothing
                     }
 
@@ -274,20 +295,20 @@ public:
                     if (ch == '/') {
                     	// End of comment
                         _state = (tok.name.empty()) ? SEARCHING_NAME : SEARCHING_BLOCK;
-                        ++next;
+                        advance(next);
                         continue;
                     }
                     else if (ch == '*') {
                     	// Another star, remain in the STAR state in case we
                     	// have a "**/" end of comment.
                     	_state = STAR;
-                    	++next;
+                    	advance(next);
                     	continue;
                     }
                     else {
                     	// No end of comment
                     	_state = COMMENT_DELIM;
-                    	++next;
+                    	advance(next);
                         continue;
                     }
 				}
@@ -303,6 +324,7 @@ public:
     // REQUIRED. Reset function to clear internal state
     void reset() {
         _state = SEARCHING_NAME;
+        _position = 0;
     }
 };
 
@@ -19,13 +19,14 @@ This accumulates a count of the number of bytes read.  Callers can set
 it at the beginning of a sequence of reads and then retrieve it to get
 the number of bytes actually read.  If one of the I/O functions fails,
 flen is set to an error code, after which the I/O functions ignore
-read requests until flen is reset.
+read requests until flen is reset.  It is kept per thread, since
+several objects may be read at once.
 ====================================================================== */
 
 #define INT_MIN     (-2147483647 - 1) /* minimum (signed) int value */
 #define FLEN_ERROR INT_MIN
 
-static int flen;
+static PICO_THREAD_LOCAL int flen;
 
 void set_flen( int i ) { flen = i; }
 
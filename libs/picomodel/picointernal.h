@@ -64,6 +64,14 @@ extern "C"
 	#define _pico_strnicmp strncasecmp
 #endif
 
+/* storage class for state private to the loading thread, models
+   may be loaded by several threads at once */
+#ifdef _MSC_VER
+	#define PICO_THREAD_LOCAL __declspec( thread )
+#else
+	#define PICO_THREAD_LOCAL __thread
+#endif
+
 
 /* constants */
 #define	PICO_PI	3.14159265358979323846
@@ -1,6 +1,8 @@
 #pragma once
 
 #include <GL/glew.h>
+#include <vector>
+#include <stdexcept>
 
 #include "VBO.h"
 #include "VertexTraits.h"
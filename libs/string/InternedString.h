@@ -0,0 +1,79 @@
+#pragma once
+
+#include "istringpool.h"
+
+namespace string
+{
+
+/**
+ * A handle to a string stored in the global string pool. Copying and
+ * comparing InternedStrings is as cheap as copying and comparing pointers,
+ * all instances of the same string share a single copy of the characters.
+ *
+ * operator== compares case-sensitively, use equalsIgnoreCase() and the
+ * IgnoreCase functors below for case-insensitive comparisons and lookups.
+ */
+class InternedString
+{
+	const PooledString* _entry;
+
+public:
+	// An empty string, this doesn't need the pool module
+	InternedString() :
+		_entry(&getEmptyPooledString())
+	{}
+
+	explicit InternedString(const std::string& str) :
+		_entry(&GlobalStringPool().intern(str))
+	{}
+
+	const std::string& getString() const
+	{
+		return _entry->value;
+	}
+
+	bool empty() const
+	{
+		return _entry->value.empty();
+	}
+
+	std::size_t getFoldedHash() const
+	{
+		return _entry->foldedHash;
+	}
+
+	bool operator==(const InternedString& other) const
+	{
+		return _entry == other._entry;
+	}
+
+	bool operator!=(const InternedString& other) const
+	{
+		return _entry != other._entry;
+	}
+
+	bool equalsIgnoreCase(const InternedString& other) const
+	{
+		return _entry->folded == other._entry->folded;
+	}
+
+	// Hash functor for case-insensitive hash maps
+	struct HashIgnoreCase
+	{
+		std::size_t operator()(const InternedString& str) const
+		{
+			return str.getFoldedHash();
+		}
+	};
+
+	// Equality functor for case-insensitive hash maps
+	struct EqualIgnoreCase
+	{
+		bool operator()(const InternedString& a, const InternedString& b) const
+		{
+			return a.equalsIgnoreCase(b);
+		}
+	};
+};
+
+} // namespace
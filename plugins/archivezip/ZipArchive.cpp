@@ -37,9 +37,18 @@ ArchiveFilePtr ZipArchive::openFile(const std::string& name) {
 	if (i != m_filesystem.end() && !i->second.is_directory()) {
 		ZipRecord* file = i->second.file();
 
-		m_istream.seek(file->m_position);
+		// Read the local header through a stream of our own, the archive
+		// may be accessed by several threads at once
+		FileInputStream stream(m_name);
+
+		if (stream.failed()) {
+			rError() << "error opening zip file " << m_name.c_str();
+			return ArchiveFilePtr();
+		}
+
+		stream.seek(file->m_position);
 		zip_file_header file_header;
-		istream_read_zip_file_header(m_istream, file_header);
+		istream_read_zip_file_header(stream, file_header);
 
 		if (file_header.z_magic != zip_file_header_magic) {
 			rError() << "error reading zip file " << m_name.c_str();
@@ -48,9 +57,9 @@ ArchiveFilePtr ZipArchive::openFile(const std::string& name) {
 
 		switch (file->m_mode) {
 			case ZipRecord::eStored:
-				return ArchiveFilePtr(new StoredArchiveFile(name, m_name, m_istream.tell(), file->m_stream_size, file->m_file_size));
+				return ArchiveFilePtr(new StoredArchiveFile(name, m_name, stream.tell(), file->m_stream_size, file->m_file_size));
 			case ZipRecord::eDeflated:
-				return ArchiveFilePtr(new DeflatedArchiveFile(name, m_name, m_istream.tell(), file->m_stream_size, file->m_file_size));
+				return ArchiveFilePtr(new DeflatedArchiveFile(name, m_name, stream.tell(), file->m_stream_size, file->m_file_size));
 		}
 	}
 	return ArchiveFilePtr();
@@ -61,9 +70,18 @@ ArchiveTextFilePtr ZipArchive::openTextFile(const std::string& name) {
 	if (i != m_filesystem.end() && !i->second.is_directory()) {
 		ZipRecord* file = i->second.file();
 
-		m_istream.seek(file->m_position);
+		// Read the local header through a stream of our own, the archive
+		// may be accessed by several threads at once
+		FileInputStream stream(m_name);
+
+		if (stream.failed()) {
+			rError() << "error opening zip file " << m_name.c_str();
+			return ArchiveTextFilePtr();
+		}
+
+		stream.seek(file->m_position);
 		zip_file_header file_header;
-		istream_read_zip_file_header(m_istream, file_header);
+		istream_read_zip_file_header(stream, file_header);
 
 		if (file_header.z_magic != zip_file_header_magic) {
 			rError() << "error reading zip file " << m_name.c_str();
@@ -75,13 +93,13 @@ ArchiveTextFilePtr ZipArchive::openTextFile(const std::string& name) {
 				return ArchiveTextFilePtr(new StoredArchiveTextFile(name,
 					m_name,
 					m_name,
-					m_istream.tell(),
+					stream.tell(),
 					file->m_stream_size));
 			case ZipRecord::eDeflated:
 				return ArchiveTextFilePtr(new DeflatedArchiveTextFile(name,
 					m_name,
 					m_name,
-					m_istream.tell(),
+					stream.tell(),
 					file->m_stream_size));
 		}
 	}
@@ -2,6 +2,7 @@
 #define _READABLE_RELOADER_H_
 
 #include "gui/GuiManager.h"
+#include "XDataIndex.h"
 #include "gtkutil/VFSTreePopulator.h"
 #include "gtkutil/ModalProgressDialog.h"
 #include "EventRateLimiter.h"
@@ -56,6 +57,7 @@ public:
 		try
 		{
 			gui::GuiManager::Instance().findGuis();
+			XData::XDataIndex::Instance().invalidate();
 
 			ReadableReloader reloader;
 			gui::GuiManager::Instance().foreachGui(reloader);
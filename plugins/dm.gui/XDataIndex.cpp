@@ -0,0 +1,531 @@
+#include "XDataIndex.h"
+
+#include "XDataLoader.h"
+
+#include "imodule.h"
+#include "iarchive.h"
+#include "ifilesystem.h"
+#include "iradiant.h"
+#include "ithread.h"
+#include "itextstream.h"
+
+#include <set>
+#include <fstream>
+#include <sstream>
+#include <iterator>
+#include <cctype>
+#include <glibmm/timer.h>
+#include <boost/bind.hpp>
+
+namespace XData
+{
+
+namespace
+{
+	const char* const INDEX_FILENAME = "xdata.index";
+
+	// Increase this whenever the file format changes
+	const std::string INDEX_HEADER("XDataIndex 1");
+
+	// Collects the .xd files found in the VFS
+	class XdPathCollector :
+		public VirtualFileSystem::Visitor
+	{
+		StringList& _paths;
+
+	public:
+		XdPathCollector(StringList& paths) :
+			_paths(paths)
+		{}
+
+		void visit(const std::string& filename)
+		{
+			_paths.push_back(XDATA_DIR + filename);
+		}
+	};
+
+	// What the index knew about a file when the update started
+	struct KnownSource
+	{
+		cache::SourceInfo source;
+		bool verified;
+	};
+	typedef std::map<std::string, KnownSource> KnownSources;
+}
+
+XDataIndex::XDataIndex() :
+	_generation(0),
+	_loaded(false),
+	_filename(module::GlobalModuleRegistry().getApplicationContext().getSettingsPath() + INDEX_FILENAME),
+	_updating(false)
+{}
+
+void XDataIndex::updateInBackground()
+{
+	{
+		Glib::Mutex::Lock lock(_mutex);
+
+		if (_updating) return;
+
+		_updating = true;
+	}
+
+	GlobalRadiant().getThreadManager().execute(
+		boost::bind(&XDataIndex::backgroundUpdate, this)
+	);
+}
+
+void XDataIndex::wait()
+{
+	{
+		Glib::Mutex::Lock lock(_mutex);
+
+		while (_updating)
+		{
+			_updateFinished.wait(_mutex);
+		}
+	}
+
+	flushPendingLog();
+}
+
+void XDataIndex::backgroundUpdate()
+{
+	LogLines log;
+
+	try
+	{
+		update(log);
+	}
+	catch (std::exception& ex)
+	{
+		log.push_back(LogLine(LOG_ERROR,
+			std::string("[XDataIndex] Updating the index failed: ") + ex.what() + "\n"));
+	}
+	catch (...)
+	{
+		log.push_back(LogLine(LOG_ERROR, "[XDataIndex] Updating the index failed.\n"));
+	}
+
+	Glib::Mutex::Lock lock(_mutex);
+
+	_pendingLog.insert(_pendingLog.end(), log.begin(), log.end());
+
+	// Always release the threads in wait(), even if the update failed
+	_updating = false;
+	_updateFinished.broadcast();
+}
+
+void XDataIndex::getFiles(FileList& files)
+{
+	// Don't scan the files twice at the same time
+	wait();
+
+	LogLines log;
+	update(log);
+
+	{
+		Glib::Mutex::Lock lock(_mutex);
+
+		files.clear();
+		files.reserve(_paths.size());
+
+		for (StringList::const_iterator i = _paths.begin(); i != _paths.end(); ++i)
+		{
+			EntryMap::const_iterator found = _entries.find(*i);
+
+			if (found != _entries.end())
+			{
+				files.push_back(found->second.info);
+			}
+		}
+	}
+
+	writeLog(log);
+}
+
+bool XDataIndex::lookup(const std::string& path, const std::string& definitionName, std::size_t& offset)
+{
+	flushPendingLog();
+
+	Glib::Mutex::Lock lock(_mutex);
+
+	EntryMap::const_iterator found = _entries.find(path);
+
+	if (found == _entries.end()) return false;
+
+	const Definitions& definitions = found->second.info.definitions;
+
+	for (Definitions::const_iterator i = definitions.begin(); i != definitions.end(); ++i)
+	{
+		if (i->name == definitionName)
+		{
+			offset = i->offset;
+			return true;
+		}
+	}
+
+	return false;
+}
+
+void XDataIndex::invalidate()
+{
+	Glib::Mutex::Lock lock(_mutex);
+
+	for (EntryMap::iterator i = _entries.begin(); i != _entries.end(); ++i)
+	{
+		i->second.verified = false;
+	}
+
+	++_generation;
+}
+
+void XDataIndex::update(LogLines& log)
+{
+	Glib::Timer timer;
+
+	KnownSources known;
+	std::size_t generation;
+
+	{
+		Glib::Mutex::Lock lock(_mutex);
+
+		if (!_loaded)
+		{
+			load();
+			_loaded = true;
+		}
+
+		for (EntryMap::const_iterator i = _entries.begin(); i != _entries.end(); ++i)
+		{
+			KnownSource& source = known[i->first];
+			source.source = i->second.info.source;
+			source.verified = i->second.verified;
+		}
+
+		generation = _generation;
+	}
+
+	// The files are checksummed and scanned without holding the lock
+	StringList paths;
+
+	XdPathCollector collector(paths);
+	GlobalFileSystem().forEachFile(XDATA_DIR, XDATA_EXT, collector, 99);
+
+	StringList unchanged;
+	FileList scanned;
+
+	for (StringList::const_iterator path = paths.begin(); path != paths.end(); ++path)
+	{
+		KnownSources::const_iterator existing = known.find(*path);
+
+		// Files inside PK4s don't change while DarkRadiant is running
+		bool isLoose = !GlobalFileSystem().findFile(*path).empty();
+
+		if (existing != known.end() && existing->second.verified && !isLoose)
+		{
+			continue;
+		}
+
+		cache::SourceInfo source;
+
+		if (!cache::getSourceInfo(*path, source))
+		{
+			log.push_back(LogLine(LOG_ERROR, "[XDataIndex] Unable to open " + *path + "\n"));
+			continue;
+		}
+
+		if (existing != known.end() && existing->second.source == source)
+		{
+			unchanged.push_back(*path);
+			continue;
+		}
+
+		ArchiveTextFilePtr file = GlobalFileSystem().openTextFile(*path);
+
+		if (!file)
+		{
+			log.push_back(LogLine(LOG_ERROR, "[XDataIndex] Unable to open " + *path + "\n"));
+			continue;
+		}
+
+		scanned.push_back(FileInfo());
+
+		FileInfo& info = scanned.back();
+		info.path = *path;
+		info.modName = file->getModName();
+		info.source = source;
+
+		std::istream is(&(file->getInputStream()));
+		findDefinitions(is, info.definitions);
+	}
+
+	// Merge the results
+	Glib::Mutex::Lock lock(_mutex);
+
+	// Files checked before an invalidate() need to be checked again
+	bool verified = generation == _generation;
+	bool changed = !scanned.empty();
+
+	for (StringList::const_iterator i = unchanged.begin(); i != unchanged.end(); ++i)
+	{
+		EntryMap::iterator found = _entries.find(*i);
+
+		if (found != _entries.end())
+		{
+			found->second.verified = verified;
+		}
+	}
+
+	for (FileList::const_iterator i = scanned.begin(); i != scanned.end(); ++i)
+	{
+		Entry& entry = _entries[i->path];
+
+		entry.info = *i;
+		entry.verified = verified;
+	}
+
+	_paths.swap(paths);
+
+	// Drop the entries of files which have been removed
+	std::set<std::string> present(_paths.begin(), _paths.end());
+
+	for (EntryMap::iterator i = _entries.begin(); i != _entries.end(); )
+	{
+		if (present.find(i->first) == present.end())
+		{
+			_entries.erase(i++);
+			changed = true;
+		}
+		else
+		{
+			++i;
+		}
+	}
+
+	if (changed)
+	{
+		save(log);
+	}
+
+	std::ostringstream summary;
+	summary << "[XDataIndex] Indexed " << _paths.size() << " files ("
+		<< scanned.size() << " parsed) in " << timer.elapsed() << " seconds.\n";
+
+	log.push_back(LogLine(LOG_MESSAGE, summary.str()));
+}
+
+void XDataIndex::writeLog(const LogLines& log)
+{
+	for (LogLines::const_iterator i = log.begin(); i != log.end(); ++i)
+	{
+		switch (i->level)
+		{
+		case LOG_MESSAGE:
+			rMessage() << i->text;
+			break;
+		case LOG_WARNING:
+			rWarning() << i->text;
+			break;
+		case LOG_ERROR:
+			rError() << i->text;
+			break;
+		};
+	}
+}
+
+void XDataIndex::flushPendingLog()
+{
+	LogLines log;
+
+	{
+		Glib::Mutex::Lock lock(_mutex);
+		log.swap(_pendingLog);
+	}
+
+	writeLog(log);
+}
+
+void XDataIndex::findDefinitions(std::istream& stream, Definitions& definitions)
+{
+	std::istreambuf_iterator<char> it(stream);
+	std::istreambuf_iterator<char> end;
+
+	std::size_t offset = 0;
+	std::size_t depth = 0;
+
+	// The last top-level token, which is a definition name if followed by {
+	Definition candidate;
+	bool haveCandidate = false;
+
+	while (it != end)
+	{
+		char c = *it++;
+		++offset;
+
+		if (c == '/' && it != end && (*it == '/' || *it == '*'))
+		{
+			char kind = *it++;
+			++offset;
+
+			char prev = 0;
+
+			while (it != end)
+			{
+				if (kind == '/' && *it == '\n') break;
+
+				char d = *it++;
+				++offset;
+
+				if (kind == '*' && prev == '*' && d == '/') break;
+
+				prev = d;
+			}
+		}
+		else if (c == '"')
+		{
+			haveCandidate = false;
+
+			while (it != end)
+			{
+				char d = *it++;
+				++offset;
+
+				if (d == '"') break;
+
+				if (d == '\\' && it != end)
+				{
+					++it;
+					++offset;
+				}
+			}
+		}
+		else if (c == '{')
+		{
+			if (depth == 0 && haveCandidate)
+			{
+				definitions.push_back(candidate);
+			}
+
+			haveCandidate = false;
+			++depth;
+		}
+		else if (c == '}')
+		{
+			haveCandidate = false;
+
+			if (depth > 0) --depth;
+		}
+		else if (c == '(' || c == ')')
+		{
+			haveCandidate = false;
+		}
+		else if (depth == 0 && !std::isspace(static_cast<unsigned char>(c)))
+		{
+			candidate.name = c;
+			candidate.offset = offset - 1;
+
+			while (it != end && !isTokenEnd(*it))
+			{
+				candidate.name += *it++;
+				++offset;
+			}
+
+			haveCandidate = true;
+		}
+	}
+}
+
+bool XDataIndex::isTokenEnd(char c)
+{
+	return std::isspace(static_cast<unsigned char>(c)) ||
+		   c == '{' || c == '}' || c == '(' || c == ')' || c == '"';
+}
+
+void XDataIndex::load()
+{
+	_entries.clear();
+
+	std::ifstream file(_filename.c_str());
+
+	std::string line;
+
+	if (!std::getline(file, line) || line != INDEX_HEADER)
+	{
+		return;
+	}
+
+	// Each file is a line with size, stamp, number of definitions, mod name
+	// and path, followed by one line per definition with offset and name
+	while (std::getline(file, line))
+	{
+		std::istringstream fileLine(line);
+
+		Entry entry;
+		std::size_t numDefinitions;
+
+		if (!(fileLine >> entry.info.source.size >> entry.info.source.stamp >> numDefinitions) ||
+			fileLine.get() != '\t' ||
+			!std::getline(fileLine, entry.info.modName, '\t') ||
+			!std::getline(fileLine, entry.info.path) || entry.info.path.empty())
+		{
+			break;
+		}
+
+		entry.verified = false;
+
+		for (std::size_t i = 0; i < numDefinitions && std::getline(file, line); ++i)
+		{
+			std::istringstream defLine(line);
+
+			Definition def;
+
+			if (defLine >> def.offset && defLine.get() == ' ' && std::getline(defLine, def.name))
+			{
+				entry.info.definitions.push_back(def);
+			}
+		}
+
+		_entries[entry.info.path] = entry;
+	}
+}
+
+void XDataIndex::save(LogLines& log) const
+{
+	try
+	{
+		cache::AtomicFileWriter writer(_filename);
+		std::ostream& file = writer.getStream();
+
+		file << INDEX_HEADER << "\n";
+
+		for (EntryMap::const_iterator i = _entries.begin(); i != _entries.end(); ++i)
+		{
+			const FileInfo& info = i->second.info;
+
+			file << info.source.size << " " << info.source.stamp << " "
+				 << info.definitions.size() << "\t"
+				 << info.modName << "\t" << info.path << "\n";
+
+			for (Definitions::const_iterator d = info.definitions.begin(); d != info.definitions.end(); ++d)
+			{
+				file << d->offset << " " << d->name << "\n";
+			}
+		}
+
+		writer.commit();
+	}
+	catch (std::runtime_error& ex)
+	{
+		log.push_back(LogLine(LOG_WARNING,
+			"[XDataIndex] Could not write " + _filename + ": " + ex.what() + "\n"));
+	}
+}
+
+XDataIndex& XDataIndex::Instance()
+{
+	static XDataIndex _instance;
+	return _instance;
+}
+
+} // namespace XData
@@ -0,0 +1,147 @@
+#ifndef XDATAINDEX_H
+#define XDATAINDEX_H
+
+#include "XData.h"
+#include "cachelib.h"
+
+#include <map>
+#include <glibmm/thread.h>
+
+namespace XData
+{
+
+/**
+ * Index of the XData definitions in the VFS, mapping each .xd file to the
+ * names and byte offsets of the definitions it contains. The index is kept
+ * in the user's settings folder and updated file by file: loose files are
+ * re-scanned when their size or timestamp changes, files inside PK4s are
+ * checked once per session by their checksum.
+ *
+ * The update runs without holding the lock, only its results are merged
+ * under the lock, so lookup() doesn't block while files are checksummed.
+ * Except for the worker started by updateInBackground(), the methods are
+ * called on the main thread, which writes the log output of the updates.
+ */
+class XDataIndex
+{
+public:
+	struct Definition
+	{
+		std::string name;
+		std::size_t offset;	// of the name, in the text stream of the file
+	};
+	typedef std::vector<Definition> Definitions;
+
+	struct FileInfo
+	{
+		std::string path;		// VFS path, including XDATA_DIR
+		std::string modName;
+		cache::SourceInfo source;
+		Definitions definitions;
+	};
+	typedef std::vector<FileInfo> FileList;
+
+private:
+	struct Entry
+	{
+		FileInfo info;
+
+		// True if the source info has been compared against the VFS
+		// during this session
+		bool verified;
+	};
+
+	typedef std::map<std::string, Entry> EntryMap;
+	EntryMap _entries;
+
+	// Incremented by invalidate(), updates which started before don't
+	// mark their files as verified
+	std::size_t _generation;
+
+	// The .xd files in VFS order, as found by the last update
+	StringList _paths;
+
+	bool _loaded;
+
+	std::string _filename;
+
+	Glib::Mutex _mutex;
+
+	// True while a background update is queued or running
+	bool _updating;
+	Glib::Cond _updateFinished;
+
+	enum LogLevel
+	{
+		LOG_MESSAGE,
+		LOG_WARNING,
+		LOG_ERROR,
+	};
+
+	// Log output produced by an update, including the line break
+	struct LogLine
+	{
+		LogLevel level;
+		std::string text;
+
+		LogLine(LogLevel level_, const std::string& text_) :
+			level(level_),
+			text(text_)
+		{}
+	};
+	typedef std::vector<LogLine> LogLines;
+
+	// Output of the background update, waiting for the main thread
+	LogLines _pendingLog;
+
+public:
+	XDataIndex();
+
+	// Brings the index up to date in a worker thread
+	void updateInBackground();
+
+	// Blocks until a queued or running background update has finished
+	void wait();
+
+	// Updates the index and copies the entries of all .xd files, in VFS
+	// order. Waits for a running background update first.
+	void getFiles(FileList& files);
+
+	// Returns true and sets the offset if the given file contains the
+	// definition according to the index. Doesn't update the index.
+	bool lookup(const std::string& path, const std::string& definitionName, std::size_t& offset);
+
+	// Causes all files to be checked again by the next update
+	void invalidate();
+
+	// Scans the given stream for top-level definitions
+	static void findDefinitions(std::istream& stream, Definitions& definitions);
+
+	// Returns true if the character terminates a definition name
+	static bool isTokenEnd(char c);
+
+	// Accessor to the index shared by all XDataLoaders
+	static XDataIndex& Instance();
+
+private:
+	// Updates the index and queues the log output, run by the worker thread
+	void backgroundUpdate();
+
+	// Performs the update, the mutex must not be locked. The log output is
+	// appended to the given lines.
+	void update(LogLines& log);
+
+	// The mutex must be locked for these
+	void load();
+	void save(LogLines& log) const;
+
+	// Writes the given lines to the log, main thread only
+	static void writeLog(const LogLines& log);
+
+	// Writes the output of finished background updates, main thread only
+	void flushPendingLog();
+};
+
+} // namespace XData
+
+#endif /* XDATAINDEX_H */
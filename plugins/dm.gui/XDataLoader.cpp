@@ -1,7 +1,10 @@
 #include "XDataLoader.h"
 
+#include "XDataIndex.h"
 #include "iarchive.h"
 #include "boost/lexical_cast.hpp"
+#include <iterator>
+#include <glibmm/timer.h>
 
 namespace XData
 {
@@ -13,6 +16,7 @@ const bool XDataLoader::importDef( const std::string& definitionName, XDataMap&
 	_newXData.reset();
 	target.clear();
 	StringList files;
+	Glib::Timer timer;
 
 	if (filename != "")
 	{
@@ -42,10 +46,11 @@ const bool XDataLoader::importDef( const std::string& definitionName, XDataMap&
 
 		if (file == NULL)
 			return reportError("[XDataLoader::importDef] Error: Failed to open file " + files[n] + "\n");
-		std::istream is(&(file->getInputStream()));
-		parser::BasicDefTokeniser<std::istream> tok(is);
+		std::string text = readDefinitionText(*file, files[n], definitionName);
+		parser::BasicDefTokeniser<std::string> tok(text);
 
 		// Parse the desired definition:
+		_newXData.reset();
 		while (tok.hasMoreTokens() && !parseXDataDef(tok,definitionName)) {}
 		if (_newXData)
 			target.insert(XDataMap::value_type(file->getModName() + "/" + file->getName(),_newXData));
@@ -53,6 +58,9 @@ const bool XDataLoader::importDef( const std::string& definitionName, XDataMap&
 			reportError("[XDataLoader::importDef] Error: Failed to load " + definitionName + " from file " + files[n] + ".\n");
 	}
 
+	rMessage() << "[XDataLoader] Looked up " << definitionName << " in "
+		<< timer.elapsed() * 1000 << " ms." << std::endl;
+
 	//Summarizing report:
 	if (target.size() == 0)
 	{
@@ -499,8 +507,8 @@ const bool XDataLoader::recursiveImport( const std::string& sourceDef, const Str
 				);
 
 		//Find the Source-Definition in the File:
-		std::istream is(&(file->getInputStream()));
-		parser::BasicDefTokeniser<std::istream> ImpTok(is);
+		std::string text = readDefinitionText(*file, it->second[k], sourceDef);
+		parser::BasicDefTokeniser<std::string> ImpTok(text);
 		while (true)
 		{
 			while ( ImpTok.nextToken() != sourceDef) {}
@@ -726,55 +734,54 @@ void XDataLoader::jumpOutOfBrackets(parser::DefTokeniser& tok, std::size_t curre
 
 
 
+std::string XDataLoader::readDefinitionText(ArchiveTextFile& file, const std::string& filename, const std::string& definitionName) const
+{
+	std::istream is(&(file.getInputStream()));
+	std::string text((std::istreambuf_iterator<char>(is)), std::istreambuf_iterator<char>());
+
+	// Start at the definition if the index knows it, unless the file has been
+	// changed in the meantime. The name must not just be the prefix of another one.
+	std::size_t offset;
+
+	if (XDataIndex::Instance().lookup(filename, definitionName, offset) &&
+		offset < text.size() && text.compare(offset, definitionName.size(), definitionName) == 0 &&
+		(offset + definitionName.size() == text.size() ||
+		 XDataIndex::isTokenEnd(text[offset + definitionName.size()])))
+	{
+		return text.substr(offset);
+	}
+
+	return text;
+}
+
 void XDataLoader::retrieveXdInfo()
 {
 	_defMap.clear();
 	_fileSet.clear();
 	_duplicatedDefs.clear();
-	//ScopedDebugTimer timer("XData definitions parsed: ");
-	GlobalFileSystem().forEachFile(XDATA_DIR, XDATA_EXT, *this, 99);
-}
 
-void XDataLoader::visit(const std::string& filename)
-{
-	// Attempt to open the file in text mode
-	ArchiveTextFilePtr file =
-		GlobalFileSystem().openTextFile(XDATA_DIR + filename);
+	XDataIndex::FileList files;
+	XDataIndex::Instance().getFiles(files);
+
+	for (XDataIndex::FileList::const_iterator file = files.begin(); file != files.end(); ++file)
+	{
+		_fileSet.insert(file->modName + "/" + file->path);
 
-	if (file != NULL) {
-		// File is open, so add the file to the _fileSet-set and parse the tokens
-		_fileSet.insert(file->getModName() + "/" + file->getName());
-		try
+		const XDataIndex::Definitions& defs = file->definitions;
+
+		for (XDataIndex::Definitions::const_iterator def = defs.begin(); def != defs.end(); ++def)
 		{
-			std::istream is(&(file->getInputStream()));
-			parser::BasicDefTokeniser<std::istream> tok(is);
-			//grab all names from stream:
-			while (tok.hasMoreTokens())
+			std::pair<StringVectorMap::iterator,bool> ret = _defMap.insert( StringVectorMap::value_type(def->name, StringList(1, file->path) ) );
+			if (!ret.second)	//Definition already exists.
 			{
-				std::string tempstring = tok.nextToken();
-				tok.assertNextToken("{");
-				std::pair<StringVectorMap::iterator,bool> ret = _defMap.insert( StringVectorMap::value_type(tempstring, StringList(1, XDATA_DIR + filename) ) );
-				if (!ret.second)	//Definition already exists.
-				{
-					ret.first->second.push_back(XDATA_DIR + filename);
-					std::cerr << "[XDataLoader] The definition " << tempstring << " of the file " << filename << " already exists. It was defined at least once. First in " << ret.first->second[0] << ".\n";
-					//Create an entry in the _duplicatedDefs map with the original file. If entry already exists, insert will fail.
-					std::pair<StringVectorMap::iterator,bool> duplRet = _duplicatedDefs.insert( StringVectorMap::value_type(tempstring, StringList(1,ret.first->second[0]) ) );
-					//The new file is appended to the vector.
-					duplRet.first->second.push_back(XDATA_DIR + filename);
-				}
-				jumpOutOfBrackets(tok);
+				ret.first->second.push_back(file->path);
+				std::cerr << "[XDataLoader] The definition " << def->name << " of the file " << file->path << " already exists. It was defined at least once. First in " << ret.first->second[0] << ".\n";
+				//Create an entry in the _duplicatedDefs map with the original file. If entry already exists, insert will fail.
+				std::pair<StringVectorMap::iterator,bool> duplRet = _duplicatedDefs.insert( StringVectorMap::value_type(def->name, StringList(1,ret.first->second[0]) ) );
+				//The new file is appended to the vector.
+				duplRet.first->second.push_back(file->path);
 			}
 		}
-		catch (parser::ParseException& e)
-		{
-			std::cerr << "[XDataLoader] Failed to parse " << filename
-				<< ": " << e.what() << std::endl;
-		}
-	}
-	else
-	{
-		std::cerr << "[XDataLoader] Unable to open " << filename << std::endl;
 	}
 }
 
@@ -6,6 +6,7 @@
 #include "parser/DefTokeniser.h"
 #include <map>
 #include "ifilesystem.h"
+#include "iarchive.h"
 
 namespace XData
 {
@@ -27,8 +28,7 @@ typedef std::vector<std::pair<std::string, std::string> > StringPairList;
 ///////////////////////////// XDataSelector:
 // Class for importing XData from files and retrieving fileinfos: duplicated definitions,
 // List of all definitions with their corresponding filename.
-class XDataLoader :
-	public VirtualFileSystem::Visitor
+class XDataLoader
 {
 	// Notes:
 	//	-Importer cannot cope with multiple definitions in a single file currently.
@@ -92,13 +92,10 @@ public:
 		return _defMap;
 	}
 
-	// Retrieves all XData-related information found in the VFS.
+	// Retrieves all XData-related information found in the VFS. The definitions are taken
+	// from the XDataIndex, which only re-scans files that have changed.
 	void retrieveXdInfo();
 
-//FileVisitor-related:
-	// Functor operator: Adds all definitions found in the target file to the _defMap.
-	void visit(const std::string& filename);
-
 private:
 	// Issues the ErrorMessage to the cerr console and appends it to the _errorList. Returns always false, so that it can be used after a return statement.
 	const bool reportError(const std::string& ErrorMessage)
@@ -140,6 +137,10 @@ private:
 	// Used to jump out of a definition. Can lead to undefined behavior on Syntax-errors.
 	void jumpOutOfBrackets(parser::DefTokeniser& tok, std::size_t currentDepth = 1) const;
 
+	// Returns the contents of the file (filename being its VFS path), starting at the given
+	// definition if its offset is known to the XDataIndex, so that it can be parsed right away.
+	std::string readDefinitionText(ArchiveTextFile& file, const std::string& filename, const std::string& definitionName) const;
+
 //General Member variables:
 	StringList			_errorList;
 	StringVectorMap		_defMap;
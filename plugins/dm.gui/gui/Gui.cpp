@@ -1,6 +1,8 @@
 #include "Gui.h"
 #include "itextstream.h"
 
+#include <boost/algorithm/string/predicate.hpp>
+
 namespace gui
 {
 
@@ -26,7 +28,8 @@ GuiPtr Gui::createFromTokens(parser::DefTokeniser& tokeniser)
 	{
 		std::string token = tokeniser.nextToken();
 
-		if (token == "windowDef")
+		// Keywords are case-insensitive, like in the child windowDefs
+		if (boost::algorithm::iequals(token, "windowDef"))
 		{
 			if (gui->getDesktop() == NULL)
 			{
@@ -3,26 +3,80 @@
 #include "iarchive.h"
 #include "ifilesystem.h"
 #include "itextstream.h"
+#include "iradiant.h"
+#include "ithread.h"
 #include "parser/CodeTokeniser.h"
 
 #include "Gui.h"
+#include "GuiTypeCache.h"
+
+#include <glibmm/thread.h>
+#include <algorithm>
+#include <boost/bind.hpp>
+#include <boost/algorithm/string/predicate.hpp>
 
 namespace gui
 {
 
+namespace
+{
+	// The number of jobs the classification is split into
+	const std::size_t NUM_CLASSIFICATION_JOBS = 4;
+
+	// Collects the GUI paths found in the VFS
+	class GuiPathCollector :
+		public VirtualFileSystem::Visitor
+	{
+		GuiManager::StringList& _paths;
+
+	public:
+		GuiPathCollector(GuiManager::StringList& paths) :
+			_paths(paths)
+		{}
+
+		void visit(const std::string& guiPath)
+		{
+			_paths.push_back(GUI_DIR + guiPath);
+		}
+	};
+}
+
+struct GuiManager::ScanJob
+{
+	Glib::Mutex mutex;
+	Glib::Cond finished;
+	bool done;
+
+	// The GUIs found, in VFS order, and what has been found out about them
+	StringList paths;
+	std::vector<GuiType> types;
+	std::vector<GuiTypeCache::SourceInfo> sources;
+	StringList errors;
+
+	GuiTypeCache cache;
+
+	ScanJob() :
+		done(false)
+	{}
+};
+
 void GuiManager::visit(const std::string& guiPath)
 {
 	// Just store the path in the map, for later reference
 	_guis.insert(GuiInfoMap::value_type(GUI_DIR + guiPath, GuiInfo()));
 }
 
-std::size_t GuiManager::getNumGuis() const
+std::size_t GuiManager::getNumGuis()
 {
+	finishBackgroundScan();
+
 	return _guis.size();
 }
 
 void GuiManager::foreachGui(Visitor& visitor)
 {
+	finishBackgroundScan();
+
 	for (GuiInfoMap::iterator i = _guis.begin(); i != _guis.end(); ++i)
 	{
 		visitor.visit(i->first, i->second.type);
@@ -31,25 +85,55 @@ void GuiManager::foreachGui(Visitor& visitor)
 
 void GuiManager::reloadGui(const std::string& guiPath)
 {
+	finishBackgroundScan();
+
+	GuiInfoMap::iterator found = _guis.find(guiPath);
+
+	if (found != _guis.end() && !found->second.loaded)
+	{
+		// Never parsed, it's enough to classify it again when asked
+		found->second.type = NOT_LOADED_YET;
+		return;
+	}
+
 	GuiPtr gui = loadGui(guiPath);
 	determineGuiType(gui);
 }
 
 GuiType GuiManager::getGuiType(const std::string& guiPath)
 {
-	// Get the GUI (will load the file if necessary)
-	GuiPtr gui = getGui(guiPath);
+	finishBackgroundScan();
 
 	GuiInfoMap::iterator found = _guis.find(guiPath);
 
 	if (found == _guis.end())
 	{
-		return FILE_NOT_FOUND;
+		// Not found by the VFS scan, try to load the GUI afresh
+		getGui(guiPath);
+
+		found = _guis.find(guiPath);
+
+		if (found == _guis.end())
+		{
+			return FILE_NOT_FOUND;
+		}
 	}
 
-	// Gui Info found, determine readable type if necessary
-	if (found->second.type == UNDETERMINED)
+	if (found->second.type == NOT_LOADED_YET)
+	{
+		// Not classified by the background scan, the GUI doesn't need to be parsed for this
+		std::string error;
+		found->second.type = classifyGui(guiPath, error);
+
+		if (!error.empty())
+		{
+			_errorList.push_back(error);
+			rError() << error;
+		}
+	}
+	else if (found->second.type == UNDETERMINED)
 	{
+		// Gui Info found, determine readable type
 		found->second.type = determineGuiType(found->second.gui);
 	}
 
@@ -78,8 +162,80 @@ GuiType GuiManager::determineGuiType(const GuiPtr& gui)
 	return NO_READABLE;
 }
 
+GuiType GuiManager::classifyGui(const std::string& guiPath, std::string& error)
+{
+	ArchiveTextFilePtr file = GlobalFileSystem().openTextFile(guiPath);
+
+	if (file == NULL)
+	{
+		error = "Could not open file: " + guiPath + "\n";
+		return FILE_NOT_FOUND;
+	}
+
+	try
+	{
+		std::string whiteSpace = std::string(parser::WHITESPACE) + ",";
+		parser::CodeTokeniser tokeniser(file, whiteSpace.c_str(), "{}(),;");
+
+		// Same rules as determineGuiType(): the named windowDefs need to be
+		// children of the first top-level windowDef, which is the desktop.
+		// The windowDef keyword is case-insensitive on all levels, like in
+		// Gui::createFromTokens() and GuiWindowDef::constructFromTokens().
+		std::size_t depth = 0;
+		bool inDesktop = false;
+		bool desktopFound = false;
+		bool twoSided = false;
+
+		while (tokeniser.hasMoreTokens())
+		{
+			std::string token = tokeniser.nextToken();
+
+			if (token == "{")
+			{
+				++depth;
+			}
+			else if (token == "}")
+			{
+				if (depth > 0 && --depth == 0)
+				{
+					inDesktop = false;
+				}
+			}
+			else if (depth == 0 && boost::algorithm::iequals(token, "windowDef"))
+			{
+				tokeniser.skipTokens(1); // the desktop's name
+
+				inDesktop = !desktopFound;
+				desktopFound = true;
+			}
+			else if (inDesktop && boost::algorithm::iequals(token, "windowDef"))
+			{
+				std::string name = tokeniser.nextToken();
+
+				if (name == "body")
+				{
+					return ONE_SIDED_READABLE;
+				}
+				else if (name == "leftBody")
+				{
+					twoSided = true;
+				}
+			}
+		}
+
+		return twoSided ? TWO_SIDED_READABLE : NO_READABLE;
+	}
+	catch (parser::ParseException& p)
+	{
+		error = "Error while parsing " + guiPath + ": " + p.what() + "\n";
+		return IMPORT_FAILURE;
+	}
+}
+
 void GuiManager::findGuis()
 {
+	finishBackgroundScan();
+
 	_errorList.clear();
 
 	// Traverse the file system, using this class as callback
@@ -89,21 +245,174 @@ void GuiManager::findGuis()
 		<< " guis." << std::endl;
 }
 
+void GuiManager::findGuisInBackground()
+{
+	if (_scanJob) return; // already running
+
+	_scanJob.reset(new ScanJob);
+
+	GlobalRadiant().getThreadManager().execute(
+		boost::bind(&GuiManager::runScan, _scanJob)
+	);
+}
+
+void GuiManager::runScan(const ScanJobPtr& job)
+{
+	try
+	{
+		scanGuis(job);
+	}
+	catch (std::exception& ex)
+	{
+		failScan(job, std::string("[GuiManager]: Scanning the GUI files failed: ") + ex.what() + "\n");
+	}
+	catch (...)
+	{
+		failScan(job, "[GuiManager]: Scanning the GUI files failed.\n");
+	}
+
+	// Always wake up finishBackgroundScan(), even if the scan failed
+	Glib::Mutex::Lock lock(job->mutex);
+
+	job->done = true;
+	job->finished.signal();
+}
+
+void GuiManager::failScan(const ScanJobPtr& job, const std::string& error)
+{
+	Glib::Mutex::Lock lock(job->mutex);
+
+	// The types are determined when the GUIs are requested
+	job->paths.clear();
+	job->types.clear();
+
+	// Logged by finishBackgroundScan() on the main thread
+	job->errors.push_back(error);
+}
+
+void GuiManager::scanGuis(const ScanJobPtr& job)
+{
+	GuiPathCollector collector(job->paths);
+	GlobalFileSystem().forEachFile(GUI_DIR, GUI_EXT, collector, 99);
+
+	job->types.resize(job->paths.size(), NOT_LOADED_YET);
+	job->sources.resize(job->paths.size());
+
+	job->cache.load();
+
+	// Each job classifies a contiguous range, writing to its own slots
+	ThreadManager::Jobs jobs;
+	std::size_t rangeSize = job->paths.size() / NUM_CLASSIFICATION_JOBS + 1;
+
+	for (std::size_t begin = 0; begin < job->paths.size(); begin += rangeSize)
+	{
+		std::size_t end = std::min(begin + rangeSize, job->paths.size());
+		jobs.push_back(boost::bind(&GuiManager::classifyRange, job, begin, end));
+	}
+
+	GlobalRadiant().getThreadManager().executeAndWait(jobs);
+
+	for (std::size_t i = 0; i < job->paths.size(); ++i)
+	{
+		job->cache.store(job->paths[i], job->sources[i], job->types[i]);
+	}
+
+	std::string error;
+	job->cache.save(error);
+
+	if (!error.empty())
+	{
+		Glib::Mutex::Lock lock(job->mutex);
+		job->errors.push_back(error);
+	}
+}
+
+void GuiManager::classifyRange(const ScanJobPtr& job, std::size_t begin, std::size_t end)
+{
+	StringList errors;
+
+	for (std::size_t i = begin; i < end; ++i)
+	{
+		const std::string& guiPath = job->paths[i];
+
+		if (!cache::getSourceInfo(guiPath, job->sources[i]))
+		{
+			job->types[i] = FILE_NOT_FOUND;
+			continue;
+		}
+
+		if (!job->cache.lookup(guiPath, job->sources[i], job->types[i]))
+		{
+			std::string error;
+			job->types[i] = classifyGui(guiPath, error);
+
+			if (!error.empty())
+			{
+				errors.push_back(error);
+			}
+		}
+	}
+
+	Glib::Mutex::Lock lock(job->mutex);
+	job->errors.insert(job->errors.end(), errors.begin(), errors.end());
+}
+
+void GuiManager::finishBackgroundScan()
+{
+	if (!_scanJob) return;
+
+	ScanJobPtr job = _scanJob;
+	_scanJob.reset();
+
+	{
+		Glib::Mutex::Lock lock(job->mutex);
+
+		while (!job->done)
+		{
+			job->finished.wait(job->mutex);
+		}
+	}
+
+	for (std::size_t i = 0; i < job->paths.size(); ++i)
+	{
+		GuiInfo& info = _guis[job->paths[i]];
+
+		// GUIs which have been parsed in the meantime know better
+		if (!info.loaded)
+		{
+			info.type = job->types[i];
+		}
+	}
+
+	for (StringList::const_iterator i = job->errors.begin(); i != job->errors.end(); ++i)
+	{
+		_errorList.push_back(*i);
+		rError() << *i;
+	}
+
+	rMessage() << "[GuiManager]: Found " << job->paths.size()
+		<< " guis." << std::endl;
+}
+
 void GuiManager::clear()
 {
+	finishBackgroundScan();
+
 	_guis.clear();
 	_errorList.clear();
 }
 
 GuiPtr GuiManager::getGui(const std::string& guiPath)
 {
+	finishBackgroundScan();
+
 	GuiInfoMap::iterator i = _guis.find(guiPath);
 
 	// Path existent?
 	if (i != _guis.end())
 	{
 		// Found in the map, load if not yet attempted
-		if (i->second.type == NOT_LOADED_YET)
+		if (!i->second.loaded)
 		{
 			loadGui(guiPath);
 		}
@@ -124,6 +433,7 @@ GuiPtr GuiManager::loadGui(const std::string& guiPath)
 	);
 
 	GuiInfo& info = result.first->second;
+	info.loaded = true;
 
 	ArchiveTextFilePtr file = GlobalFileSystem().openTextFile(guiPath);
 
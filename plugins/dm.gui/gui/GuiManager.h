@@ -54,19 +54,26 @@ public:
 private:
 	struct GuiInfo
 	{
-		// The type of this Gui (NOT_LOADED_YET by default)
+		// The type of this Gui (NOT_LOADED_YET by default). The readable
+		// types might be known from the classification without the GUI
+		// having been parsed.
 		GuiType type;
 
 		// the cached GUI pointer, can be NULL if load failed
 		GuiPtr gui;
 
+		// Whether the file has been parsed
+		bool loaded;
+
 		GuiInfo() :
-			type(NOT_LOADED_YET)
+			type(NOT_LOADED_YET),
+			loaded(false)
 		{}
 
 		GuiInfo(const GuiPtr& gui_, GuiType type_) :
 			type(type_),
-			gui(gui_)
+			gui(gui_),
+			loaded(true)
 		{}
 	};
 
@@ -77,6 +84,12 @@ private:
 	// A List of all the errors occuring lastly.
 	StringList _errorList;
 
+	// State of a background scan, shared with the worker threads
+	struct ScanJob;
+	typedef boost::shared_ptr<ScanJob> ScanJobPtr;
+
+	ScanJobPtr _scanJob;
+
 public:
 	// Gets a GUI from the given VFS path, parsing it on demand
 	// Returns NULL if the GUI couldn't be found or loaded.
@@ -86,7 +99,7 @@ public:
 	void visit(const std::string& guiPath);
 
 	// Returns the number of known GUIs (or GUI paths)
-	std::size_t getNumGuis() const;
+	std::size_t getNumGuis();
 
 	// Traverse all known GUIs using the given Visitor
 	void foreachGui(Visitor& visitor);
@@ -106,12 +119,35 @@ public:
 	// Searches the VFS for all available GUI definitions
 	void findGuis();
 
+	/**
+	 * Searches the VFS for GUI definitions and determines their readable
+	 * types in worker threads, without parsing the GUIs. The types are
+	 * taken from the on-disk cache where possible. The results are picked
+	 * up by the first method needing them, waiting for the scan if it is
+	 * still running.
+	 */
+	void findGuisInBackground();
+
 	// Clears all internal objects
 	void clear();
 
 private:
 	GuiType determineGuiType(const GuiPtr& gui);
 
+	// Tells the readable type of the given file from the names of its
+	// windowDefs, without parsing the whole GUI. Safe to call from any thread,
+	// problems are described in the error string.
+	static GuiType classifyGui(const std::string& guiPath, std::string& error);
+
+	// Worker thread functions of findGuisInBackground()
+	static void runScan(const ScanJobPtr& job);
+	static void scanGuis(const ScanJobPtr& job);
+	static void failScan(const ScanJobPtr& job, const std::string& error);
+	static void classifyRange(const ScanJobPtr& job, std::size_t begin, std::size_t end);
+
+	// Waits for the background scan, if any, and merges its results
+	void finishBackgroundScan();
+
 	GuiPtr loadGui(const std::string& guiPath);
 };
 
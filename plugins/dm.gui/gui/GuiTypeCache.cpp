@@ -0,0 +1,118 @@
+#include "GuiTypeCache.h"
+
+#include "imodule.h"
+
+#include <fstream>
+
+namespace gui
+{
+
+namespace
+{
+	const char* const CACHE_FILENAME = "guitypes.cache";
+
+	// Increase this whenever the file format or the GuiType values change
+	const std::string CACHE_HEADER("GuiTypeCache 1");
+
+	// Failures are not stored, their error messages are reported on each scan
+	inline bool isCacheable(GuiType type)
+	{
+		return type == ONE_SIDED_READABLE || type == TWO_SIDED_READABLE ||
+			   type == NO_READABLE;
+	}
+}
+
+GuiTypeCache::GuiTypeCache() :
+	_filename(module::GlobalModuleRegistry().getApplicationContext().getSettingsPath() + CACHE_FILENAME)
+{}
+
+void GuiTypeCache::load()
+{
+	_entries.clear();
+
+	std::ifstream file(_filename.c_str());
+
+	std::string header;
+
+	if (!std::getline(file, header) || header != CACHE_HEADER)
+	{
+		return;
+	}
+
+	// Each line holds type, size and stamp, followed by the VFS path
+	int type;
+	Entry entry;
+
+	while (file >> type >> entry.source.size >> entry.source.stamp)
+	{
+		std::string guiPath;
+
+		file.ignore(1); // the space before the path
+
+		if (!std::getline(file, guiPath) || guiPath.empty())
+		{
+			break;
+		}
+
+		entry.type = static_cast<GuiType>(type);
+
+		if (isCacheable(entry.type))
+		{
+			_entries[guiPath] = entry;
+		}
+	}
+}
+
+void GuiTypeCache::save(std::string& error) const
+{
+	try
+	{
+		cache::AtomicFileWriter writer(_filename);
+		std::ostream& file = writer.getStream();
+
+		file << CACHE_HEADER << "\n";
+
+		for (EntryMap::const_iterator i = _entries.begin(); i != _entries.end(); ++i)
+		{
+			file << static_cast<int>(i->second.type) << " "
+				 << i->second.source.size << " "
+				 << i->second.source.stamp << " "
+				 << i->first << "\n";
+		}
+
+		writer.commit();
+	}
+	catch (std::runtime_error& ex)
+	{
+		error = "[GuiManager]: Could not write " + _filename + ": " + ex.what() + "\n";
+	}
+}
+
+bool GuiTypeCache::lookup(const std::string& guiPath, const SourceInfo& source, GuiType& type) const
+{
+	EntryMap::const_iterator found = _entries.find(guiPath);
+
+	if (found == _entries.end() || found->second.source != source)
+	{
+		return false;
+	}
+
+	type = found->second.type;
+	return true;
+}
+
+void GuiTypeCache::store(const std::string& guiPath, const SourceInfo& source, GuiType type)
+{
+	if (!isCacheable(type))
+	{
+		_entries.erase(guiPath);
+		return;
+	}
+
+	Entry& entry = _entries[guiPath];
+
+	entry.source = source;
+	entry.type = type;
+}
+
+} // namespace
@@ -0,0 +1,56 @@
+#ifndef GuiTypeCache_h__
+#define GuiTypeCache_h__
+
+#include "GuiManager.h"
+#include "cachelib.h"
+
+#include <map>
+#include <string>
+
+namespace gui
+{
+
+/**
+ * The readable types of the GUI files as determined during earlier
+ * sessions, stored as text file in the user's settings folder. Each entry
+ * remembers the size and timestamp of its source file, entries of
+ * changed files are not used.
+ */
+class GuiTypeCache
+{
+public:
+	// Size and modification time of a GUI file. For files inside PK4
+	// archives the stamp is a checksum of the contents.
+	typedef cache::SourceInfo SourceInfo;
+
+private:
+	struct Entry
+	{
+		SourceInfo source;
+		GuiType type;
+	};
+
+	typedef std::map<std::string, Entry> EntryMap;
+	EntryMap _entries;
+
+	std::string _filename;
+
+public:
+	GuiTypeCache();
+
+	// Reads the cache file, missing or outdated files result in an empty cache
+	void load();
+
+	// Writes all entries back to the cache file, problems are described
+	// in the error string. Safe to call from any thread.
+	void save(std::string& error) const;
+
+	// Returns true and sets the type if the given GUI is unchanged
+	bool lookup(const std::string& guiPath, const SourceInfo& source, GuiType& type) const;
+
+	void store(const std::string& guiPath, const SourceInfo& source, GuiType type);
+};
+
+} // namespace
+
+#endif // GuiTypeCache_h__
@@ -2,6 +2,7 @@
 #include "ReadableEditorDialog.h"
 #include "ReadableReloader.h"
 #include "gui/GuiManager.h"
+#include "XDataIndex.h"
 
 // General
 #include "debugging/debugging.h"
@@ -77,9 +78,6 @@ public:
             sigc::mem_fun(this, &GuiModule::onRadiantStartup)
         );
 
-		// Search the VFS for GUIs
-		gui::GuiManager::Instance().findGuis();
-
 		// Create the Readable Editor Preferences
 		constructPreferences();
 	}
@@ -102,6 +100,12 @@ public:
 			"book.png", // icon
 			"ReloadReadables"
 		);
+
+		// Search the VFS for GUIs and sort out the readables while the user is busy
+		gui::GuiManager::Instance().findGuisInBackground();
+
+		// Same for the XData definitions
+		XData::XDataIndex::Instance().updateInBackground();
 	}
 
 	// Adds the preference settings to the prefdialog
@@ -124,6 +128,9 @@ public:
 	void shutdownModule()
 	{
 		gui::GuiManager::Instance().clear();
+
+		// The worker thread must not touch the VFS after shutdown
+		XData::XDataIndex::Instance().wait();
 	}
 };
 typedef boost::shared_ptr<GuiModule> GuiModulePtr;
@@ -0,0 +1,169 @@
+#pragma once
+
+#include "ieclass.h"
+#include "istringpool.h"
+#include "string/string.h"
+
+#include <deque>
+#include <vector>
+
+namespace eclass
+{
+
+/**
+ * A flat table of EntityClassAttributes with a case-insensitive hash index
+ * on the attribute names. Attributes are kept in insertion order, references
+ * to them stay valid until the table is cleared.
+ */
+class AttributeTable
+{
+	std::deque<EntityClassAttribute> _attributes;
+
+	// The folded name hash of each attribute, same order as _attributes
+	std::vector<std::size_t> _hashes;
+
+	// Linear probing, each slot holds the position in _attributes plus one,
+	// 0 marks an empty slot. The size is always a power of two.
+	std::vector<std::size_t> _slots;
+
+	static const std::size_t MIN_SLOTS = 8;
+
+public:
+	typedef std::deque<EntityClassAttribute>::iterator iterator;
+	typedef std::deque<EntityClassAttribute>::const_iterator const_iterator;
+
+	// Returns the named attribute or NULL, hash is string::getFoldedHash(name)
+	EntityClassAttribute* find(const std::string& name, std::size_t hash)
+	{
+		if (_attributes.empty()) return NULL;
+
+		std::size_t mask = _slots.size() - 1;
+
+		for (std::size_t slot = hash & mask; _slots[slot] != 0; slot = (slot + 1) & mask)
+		{
+			std::size_t position = _slots[slot] - 1;
+
+			if (_hashes[position] == hash &&
+				string_equal_nocase(_attributes[position].getName().c_str(), name.c_str()))
+			{
+				return &_attributes[position];
+			}
+		}
+
+		return NULL;
+	}
+
+	const EntityClassAttribute* find(const std::string& name, std::size_t hash) const
+	{
+		return const_cast<AttributeTable*>(this)->find(name, hash);
+	}
+
+	/**
+	 * Adds the given attribute, unless an attribute with the same name exists.
+	 * Returns the attribute in the table and whether it has been inserted.
+	 */
+	std::pair<EntityClassAttribute*, bool> insert(const EntityClassAttribute& attribute)
+	{
+		std::size_t hash = string::getFoldedHash(attribute.getName());
+
+		EntityClassAttribute* existing = find(attribute.getName(), hash);
+
+		if (existing != NULL)
+		{
+			return std::make_pair(existing, false);
+		}
+
+		_attributes.push_back(attribute);
+		_hashes.push_back(hash);
+
+		// Keep the load factor at or below 0.5
+		if (_attributes.size() * 2 > _slots.size())
+		{
+			rebuild();
+		}
+		else
+		{
+			insertSlot(_attributes.size() - 1);
+		}
+
+		return std::make_pair(&_attributes.back(), true);
+	}
+
+	void clear()
+	{
+		_attributes.clear();
+		_hashes.clear();
+		_slots.clear();
+	}
+
+	bool empty() const
+	{
+		return _attributes.empty();
+	}
+
+	std::size_t size() const
+	{
+		return _attributes.size();
+	}
+
+	iterator begin()
+	{
+		return _attributes.begin();
+	}
+
+	iterator end()
+	{
+		return _attributes.end();
+	}
+
+	const_iterator begin() const
+	{
+		return _attributes.begin();
+	}
+
+	const_iterator end() const
+	{
+		return _attributes.end();
+	}
+
+	// The memory occupied by the table, not including the (shared) strings
+	std::size_t getMemoryUsage() const
+	{
+		return _attributes.size() * sizeof(EntityClassAttribute) +
+			_hashes.capacity() * sizeof(std::size_t) +
+			_slots.capacity() * sizeof(std::size_t);
+	}
+
+private:
+	void rebuild()
+	{
+		std::size_t numSlots = MIN_SLOTS;
+
+		while (numSlots < _attributes.size() * 2)
+		{
+			numSlots <<= 1;
+		}
+
+		_slots.assign(numSlots, 0);
+
+		for (std::size_t i = 0; i < _attributes.size(); ++i)
+		{
+			insertSlot(i);
+		}
+	}
+
+	void insertSlot(std::size_t position)
+	{
+		std::size_t mask = _slots.size() - 1;
+		std::size_t slot = _hashes[position] & mask;
+
+		while (_slots[slot] != 0)
+		{
+			slot = (slot + 1) & mask;
+		}
+
+		_slots[slot] = position + 1;
+	}
+};
+
+} // namespace
@@ -5,10 +5,10 @@
 #include "os/path.h"
 #include "string/convert.h"
 
+#include <algorithm>
 #include <boost/algorithm/string/case_conv.hpp>
 #include <boost/algorithm/string/predicate.hpp>
 #include <boost/algorithm/string/erase.hpp>
-#include <boost/bind.hpp>
 #include <boost/foreach.hpp>
 #include <boost/make_shared.hpp>
 
@@ -45,6 +45,26 @@ boost::optional<std::string> suffixedKey(const std::string& key,
     }
 }
 
+// The names of the keys with cached lookups, in the order of Doom3EntityClass::CachedKey
+const char* const CACHED_KEY_NAMES[] = { "inherit", "model", "editor_color" };
+
+const std::size_t CACHED_KEY_HASHES[] = {
+    string::getFoldedHash(CACHED_KEY_NAMES[0]),
+    string::getFoldedHash(CACHED_KEY_NAMES[1]),
+    string::getFoldedHash(CACHED_KEY_NAMES[2])
+};
+
+// Orders attributes by name, ignoring case
+bool attributeNameLess(const EntityClassAttribute& a, const EntityClassAttribute& b)
+{
+    return string_compare_nocase(a.getName().c_str(), b.getName().c_str()) < 0;
+}
+
+bool attributeNameEqual(const EntityClassAttribute& a, const EntityClassAttribute& b)
+{
+    return string_equal_nocase(a.getName().c_str(), b.getName().c_str());
+}
+
 } // namespace
 
 // Attachment helper object
@@ -220,14 +240,17 @@ Doom3EntityClass::Doom3EntityClass(const std::string& name,
   _emptyAttribute("", "", ""),
   _attachments(new Attachments(name)),
   _parseStamp(0)
-{}
+{
+    std::fill(_cachedAttributes, _cachedAttributes + NUM_CACHED_KEYS,
+              static_cast<const EntityClassAttribute*>(NULL));
+}
 
 Doom3EntityClass::~Doom3EntityClass()
 {}
 
 std::string Doom3EntityClass::getName() const
 {
-    return _name;
+    return _name.getString();
 }
 
 const IEntityClass* Doom3EntityClass::getParent() const
@@ -319,37 +342,43 @@ const std::string& Doom3EntityClass::getFillShader() const
 
 /* ATTRIBUTES */
 
-/**
- * Insert an EntityClassAttribute, without overwriting previous values.
- */
-void Doom3EntityClass::addAttribute(const EntityClassAttribute& attribute)
+namespace
 {
-    // Try to insert the class attribute
-    std::pair<EntityAttributeMap::iterator, bool> result = _attributes.insert(
-        EntityAttributeMap::value_type(attribute.getNameRef(), attribute)
-    );
-
-    if (!result.second)
+    // Adds the descriptive properties of other to the existing attribute
+    void mergeAttributeProperties(EntityClassAttribute& existing,
+                                  const EntityClassAttribute& other)
     {
-        EntityClassAttribute& existing = result.first->second;
-
-        // greebo: Attribute already existed, check if we have some
-        // descriptive properties to be added to the existing one.
-        if (!attribute.getDescription().empty() && existing.getDescription().empty())
+        if (!other.getDescription().empty() && existing.getDescription().empty())
         {
             // Use the shared string reference to save memory
-            existing.setDescription(attribute.getDescriptionRef());
+            existing.setDescription(other.getDescriptionRef());
         }
 
         // Check if we have a more descriptive type than "text"
-        if (attribute.getType() != "text" && existing.getType() == "text")
+        if (other.getType() != "text" && existing.getType() == "text")
         {
             // Use the shared string reference to save memory
-            existing.setType(attribute.getTypeRef());
+            existing.setType(other.getTypeRef());
         }
     }
 }
 
+/**
+ * Insert an EntityClassAttribute, without overwriting previous values.
+ */
+void Doom3EntityClass::addAttribute(const EntityClassAttribute& attribute)
+{
+    // Try to insert the class attribute
+    std::pair<EntityClassAttribute*, bool> result = _attributes.insert(attribute);
+
+    if (!result.second)
+    {
+        // Attribute already existed, check if we have some
+        // descriptive properties to be added to the existing one.
+        mergeAttributeProperties(*result.first, attribute);
+    }
+}
+
 // Static function to create an EntityClass (named constructor idiom)
 Doom3EntityClassPtr Doom3EntityClass::create(const std::string& name,
                                              bool brushes)
@@ -373,25 +402,36 @@ void Doom3EntityClass::forEachClassAttribute(
     boost::function<void(const EntityClassAttribute&)> visitor,
     bool editorKeys) const
 {
-    for (EntityAttributeMap::const_iterator i = _attributes.begin();
-         i != _attributes.end();
-         ++i)
+    // Collect the attributes of the whole inheritance chain, the ones of
+    // the parent classes as inherited copies
+    std::vector<EntityClassAttribute> attributes;
+
+    for (const Doom3EntityClass* currentClass = this;
+         currentClass != NULL;
+         currentClass = currentClass->_parent)
     {
-        // Visit if it is a non-editor key or we are visiting all keys
-        if (editorKeys || !boost::algorithm::istarts_with(*i->first, "editor_"))
+        for (AttributeTable::const_iterator i = currentClass->_attributes.begin();
+             i != currentClass->_attributes.end();
+             ++i)
         {
-            visitor(i->second);
+            // Visit if it is a non-editor key or we are visiting all keys
+            if (editorKeys || !boost::algorithm::istarts_with(i->getName(), "editor_"))
+            {
+                attributes.push_back(EntityClassAttribute(*i, currentClass != this));
+            }
         }
     }
-}
 
-namespace
-{
-    void copyInheritedAttribute(Doom3EntityClass* target,
-                                const EntityClassAttribute& attr)
-    {
-        target->addAttribute(EntityClassAttribute(attr, true));
-    }
+    // Sort by name, the stable sort keeps the attribute defined closest to
+    // this class in front of the overridden ones
+    std::stable_sort(attributes.begin(), attributes.end(), attributeNameLess);
+
+    attributes.erase(
+        std::unique(attributes.begin(), attributes.end(), attributeNameEqual),
+        attributes.end()
+    );
+
+    std::for_each(attributes.begin(), attributes.end(), visitor);
 }
 
 // Resolve inheritance for this class
@@ -405,7 +445,7 @@ void Doom3EntityClass::resolveInheritance(EntityClasses& classmap)
     // parent name is the same as our own classname, to avoid infinite
     // recursion.
     std::string parName = getAttribute("inherit").getValue();
-    if (parName.empty() || parName == _name)
+    if (parName.empty() || parName == _name.getString())
         return;
 
     // Find the parent entity class
@@ -415,18 +455,15 @@ void Doom3EntityClass::resolveInheritance(EntityClasses& classmap)
         // Recursively resolve inheritance of parent
         pIter->second->resolveInheritance(classmap);
 
-        // Copy attributes from the parent to the child, including editor keys
-        pIter->second->forEachClassAttribute(
-            boost::bind(&copyInheritedAttribute, this, _1), true
-        );
-
-        // Set our parent pointer
+        // Set our parent pointer and take over the descriptions of its attributes
         _parent = pIter->second.get();
+
+        inheritAttributes();
     }
     else
     {
         rWarning() << "[eclassmgr] Entity class "
-                              << _name << " specifies unknown parent class "
+                              << _name.getString() << " specifies unknown parent class "
                               << parName;
     }
 
@@ -467,11 +504,12 @@ void Doom3EntityClass::resolveInheritance(EntityClasses& classmap)
 
 bool Doom3EntityClass::isOfType(const std::string& className)
 {
-	for (const IEntityClass* currentClass = this;
+	// Walk the parents directly, getName() would return a copy of each name
+	for (const Doom3EntityClass* currentClass = this;
          currentClass != NULL;
-         currentClass = currentClass->getParent())
+         currentClass = currentClass->_parent)
     {
-        if (currentClass->getName() == className)
+        if (currentClass->_name.getString() == className)
 		{
 			return true;
 		}
@@ -480,24 +518,99 @@ bool Doom3EntityClass::isOfType(const std::string& className)
 	return false;
 }
 
+const EntityClassAttribute* Doom3EntityClass::findAttribute(const std::string& name) const
+{
+    std::size_t hash = string::getFoldedHash(name);
+
+    // A class without parent has nothing to walk, its lookups aren't cached
+    if (_parent != NULL)
+    {
+        for (std::size_t i = 0; i < NUM_CACHED_KEYS; ++i)
+        {
+            if (CACHED_KEY_HASHES[i] == hash &&
+                string_equal_nocase(CACHED_KEY_NAMES[i], name.c_str()))
+            {
+                return _cachedAttributes[i];
+            }
+        }
+    }
+
+    return findDefinedAttribute(name, hash);
+}
+
+const EntityClassAttribute* Doom3EntityClass::findDefinedAttribute(const std::string& name,
+                                                                   std::size_t hash) const
+{
+    for (const Doom3EntityClass* currentClass = this;
+         currentClass != NULL;
+         currentClass = currentClass->_parent)
+    {
+        const EntityClassAttribute* attribute = currentClass->_attributes.find(name, hash);
+
+        if (attribute != NULL)
+        {
+            return attribute;
+        }
+    }
+
+    return NULL;
+}
+
+void Doom3EntityClass::inheritAttributes()
+{
+    // Our own attributes take the descriptive properties of the
+    // parent attributes they override
+    for (AttributeTable::iterator i = _attributes.begin(); i != _attributes.end(); ++i)
+    {
+        const EntityClassAttribute* parentAttr =
+            _parent->findDefinedAttribute(i->getName(), string::getFoldedHash(i->getName()));
+
+        if (parentAttr != NULL)
+        {
+            mergeAttributeProperties(*i, *parentAttr);
+        }
+    }
+
+    // Look up the cached keys, the ones defined by a parent are copied
+    // to flag them as inherited. The reserved size keeps the pointers valid.
+    _inheritedCopies.clear();
+    _inheritedCopies.reserve(NUM_CACHED_KEYS);
+
+    for (std::size_t i = 0; i < NUM_CACHED_KEYS; ++i)
+    {
+        const EntityClassAttribute* attribute = _attributes.find(CACHED_KEY_NAMES[i], CACHED_KEY_HASHES[i]);
+
+        if (attribute == NULL)
+        {
+            attribute = _parent->findDefinedAttribute(CACHED_KEY_NAMES[i], CACHED_KEY_HASHES[i]);
+
+            if (attribute != NULL)
+            {
+                _inheritedCopies.push_back(EntityClassAttribute(*attribute, true));
+                attribute = &_inheritedCopies.back();
+            }
+        }
+
+        _cachedAttributes[i] = attribute;
+    }
+}
+
 // Find a single attribute
 EntityClassAttribute& Doom3EntityClass::getAttribute(const std::string& name)
 {
-    StringPtr ref(new std::string(name));
-
-    EntityAttributeMap::iterator f = _attributes.find(ref);
+    // The attribute may be one of a parent class, it is only modified while
+    // parsing, before the parent is known
+    const EntityClassAttribute* attribute = findAttribute(name);
 
-    return (f != _attributes.end()) ? f->second : _emptyAttribute;
+    return attribute != NULL ? const_cast<EntityClassAttribute&>(*attribute) : _emptyAttribute;
 }
 
 // Find a single attribute
 const EntityClassAttribute& Doom3EntityClass::getAttribute(const std::string& name) const
 {
-    StringPtr ref(new std::string(name));
-
-    EntityAttributeMap::const_iterator f = _attributes.find(ref);
+    const EntityClassAttribute* attribute = findAttribute(name);
 
-    return (f != _attributes.end()) ? f->second : _emptyAttribute;
+    return attribute != NULL ? *attribute : _emptyAttribute;
 }
 
 void Doom3EntityClass::clear()
@@ -511,7 +624,12 @@ void Doom3EntityClass::clear()
 
     _fixedSize = false;
 
+    // The parent is looked up again when resolving inheritance
+    _parent = NULL;
+
     _attributes.clear();
+    _inheritedCopies.clear();
+
     _model.clear();
     _skin.clear();
     _inheritanceResolved = false;
@@ -613,7 +731,7 @@ void Doom3EntityClass::parseFromTokens(parser::DefTokeniser& tokeniser)
         {
             // Both type and value are not empty, emit a warning
             rWarning() << "[eclassmgr] attribute " << key
-                << " already set on entityclass " << _name << std::endl;
+                << " already set on entityclass " << _name.getString() << std::endl;
         }
     } // while true
 
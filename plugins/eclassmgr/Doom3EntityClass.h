@@ -6,8 +6,10 @@
 #include "math/Vector3.h"
 #include "math/AABB.h"
 #include "string/string.h"
+#include "string/InternedString.h"
 
 #include "parser/DefTokeniser.h"
+#include "AttributeTable.h"
 
 #include <vector>
 #include <map>
@@ -31,23 +33,12 @@ typedef boost::shared_ptr<Doom3EntityClass> Doom3EntityClassPtr;
 class Doom3EntityClass
 : public IEntityClass
 {
-    typedef boost::shared_ptr<std::string> StringPtr;
-
-    class StringCompareFunctor
-    {
-    public:
-        bool operator()(const StringPtr& lhs, const StringPtr& rhs) const
-        {
-            //return boost::algorithm::ilexicographical_compare(lhs, rhs); // this is slow!
-            return string_compare_nocase(lhs->c_str(), rhs->c_str()) < 0;
-        }
-    };
-
-    // The name of this entity class
-    std::string _name;
+    // The name of this entity class, interned as it is shared with the
+    // classname spawnargs of the entities
+    string::InternedString _name;
 
     // Parent class pointer (or NULL)
-    IEntityClass* _parent;
+    Doom3EntityClass* _parent;
 
     // Should this entity type be treated as a light?
     bool _isLight;
@@ -64,28 +55,36 @@ class Doom3EntityClass
     // Does this entity have a fixed size?
     bool _fixedSize;
 
-    // Map of named EntityAttribute structures. EntityAttributes are picked
-    // up from the DEF file during parsing. Ignores key case.
+    // The attributes defined in this class's own DEF block, ignoring key case.
+    // Attributes of the parent classes are not copied, getAttribute() walks
+    // up the inheritance chain instead.
+    AttributeTable _attributes;
+
+    // The keys read for every class when resolving inheritance and creating
+    // entities, their lookup results are stored once the parent is known
+    enum CachedKey
+    {
+        CACHED_INHERIT,
+        CACHED_MODEL,
+        CACHED_EDITOR_COLOR,
+        NUM_CACHED_KEYS
+    };
 
-    // greebo: I've changed the EntityAttributeMap key type to StringPtr, to save
-    // more than 130 MB of string data used for just the keys. A default TDM installation
-    // has about 780k entity class attributes after resolving inheritance.
-    // However, the memory saving comes with a performance cost since we need 
-    // to convert the incoming std::string queries to StringRefs before passing
-    // them to std::map::find(). During a regular DarkRadiant startup 
-    // there are about 64k find() operations, a single idLight
-    // creation costs about 30-40 find() operations, which is ok I guess.
+    // The result for each cached key, NULL if it is not defined. Only valid
+    // while _parent is set.
+    const EntityClassAttribute* _cachedAttributes[NUM_CACHED_KEYS];
 
-    typedef std::map<StringPtr, EntityClassAttribute, StringCompareFunctor> EntityAttributeMap;
-    EntityAttributeMap _attributes;
+    // Copies of the cached attributes defined by a parent class, flagged as
+    // inherited. Never holds more than NUM_CACHED_KEYS elements.
+    std::vector<EntityClassAttribute> _inheritedCopies;
 
     // The model and skin for this entity class (if it has one)
     std::string _model;
     std::string _skin;
 
     // Flag to indicate inheritance resolved. An EntityClass resolves its
-    // inheritance by copying all values from the parent onto the child,
-    // after recursively instructing the parent to resolve its own inheritance.
+    // inheritance by looking up its parent, after recursively instructing
+    // the parent to resolve its own inheritance.
     bool _inheritanceResolved;
 
     // Name of the mod owning this class
@@ -110,6 +109,19 @@ private:
     void parseEditorSpawnarg(const std::string& key, const std::string& value);
     void setIsLight(bool val);
 
+    // Looks up the named attribute in this class and its parents, returns
+    // NULL if not found
+    const EntityClassAttribute* findAttribute(const std::string& name) const;
+
+    // Walks up the inheritance chain without consulting the cached lookups,
+    // hash is string::getFoldedHash(name)
+    const EntityClassAttribute* findDefinedAttribute(const std::string& name,
+                                                     std::size_t hash) const;
+
+    // Takes over the descriptive properties of the parent attributes and
+    // fills in the cached lookups, the parent is set already
+    void inheritAttributes();
+
 public:
 
     /**
@@ -202,6 +214,25 @@ public:
     // Initialises this class from the given tokens
     void parseFromTokens(parser::DefTokeniser& tokeniser);
 
+    // The number of attributes defined in this class's own DEF block
+    std::size_t getNumDefinedAttributes() const
+    {
+        return _attributes.size();
+    }
+
+    // The number of inherited attributes copied into this class
+    std::size_t getNumInheritedAttributes() const
+    {
+        return _inheritedCopies.size();
+    }
+
+    // The memory occupied by the attribute tables, not including the strings
+    std::size_t getAttributeMemoryUsage() const
+    {
+        return _attributes.getMemoryUsage() +
+            _inheritedCopies.capacity() * sizeof(EntityClassAttribute);
+    }
+
     void setParseStamp(std::size_t parseStamp)
     {
         _parseStamp = parseStamp;
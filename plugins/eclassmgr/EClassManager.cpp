@@ -8,12 +8,15 @@
 #include "imainframe.h"
 #include "iuimanager.h"
 #include "ifilesystem.h"
+#include "itrace.h"
+#include "istringpool.h"
 #include "archivelib.h"
 #include "parser/DefTokeniser.h"
 
 #include "Doom3EntityClass.h"
 #include "Doom3ModelDef.h"
 
+#include <glibmm/timer.h>
 #include <boost/algorithm/string/case_conv.hpp>
 #include <boost/bind.hpp>
 
@@ -125,6 +128,8 @@ void EClassManager::resolveModelInheritance(const std::string& name, const Doom3
 
 void EClassManager::parseDefFiles()
 {
+	trace::ScopedZone zone("decls", "parseDefFiles");
+
 	rMessage() << "searching vfs directory 'def' for *.def\n";
 
 	// Increase the parse stamp for this run
@@ -191,8 +196,33 @@ void EClassManager::realise()
 
 	_realised = true;
 
+	Glib::Timer timer;
+
 	parseDefFiles();
 	resolveInheritance();
+
+	rMessage() << "[eclassmgr] Realised in " << timer.elapsed() << " seconds" << std::endl;
+
+	printAttributeStatistics();
+}
+
+void EClassManager::printAttributeStatistics() const
+{
+	std::size_t numDefined = 0;
+	std::size_t numInherited = 0;
+	std::size_t memoryUsage = 0;
+
+	for (EntityClasses::const_iterator i = _entityClasses.begin();
+		i != _entityClasses.end(); ++i)
+	{
+		numDefined += i->second->getNumDefinedAttributes();
+		numInherited += i->second->getNumInheritedAttributes();
+		memoryUsage += i->second->getAttributeMemoryUsage();
+	}
+
+	rMessage() << "[eclassmgr] " << _entityClasses.size() << " entity classes with "
+		<< numDefined << " attributes and " << numInherited << " inherited attribute copies, "
+		<< (memoryUsage / 1024) << " kB" << std::endl;
 }
 
 // Find an entity class
@@ -275,20 +305,31 @@ const StringSet& EClassManager::getDependencies() const {
 		_dependencies.insert(MODULE_UIMANAGER);
 		_dependencies.insert(MODULE_EVENTMANAGER);
 		_dependencies.insert(MODULE_COMMANDSYSTEM);
+		_dependencies.insert(MODULE_STRINGPOOL);
 	}
 
 	return _dependencies;
 }
 
+void EClassManager::preInitialiseModule(const ApplicationContext& ctx)
+{
+	GlobalFileSystem().addObserver(*this);
+
+	GlobalCommandSystem().addCommand("ReloadDefs", boost::bind(&EClassManager::reloadDefsCmd, this, _1));
+	GlobalEventManager().addCommand("ReloadDefs", "ReloadDefs");
+}
+
 void EClassManager::initialiseModule(const ApplicationContext& ctx)
 {
 	rMessage() << "EntityClassDoom3::initialiseModule called." << std::endl;
 
-	GlobalFileSystem().addObserver(*this);
+	// Parsing the defs only reads from the VFS and the colour schemes
 	realise();
+}
 
-	GlobalCommandSystem().addCommand("ReloadDefs", boost::bind(&EClassManager::reloadDefsCmd, this, _1));
-	GlobalEventManager().addCommand("ReloadDefs", "ReloadDefs");
+bool EClassManager::isInitialisationThreadSafe() const
+{
+	return true;
 }
 
 void EClassManager::shutdownModule()
@@ -419,6 +460,8 @@ void EClassManager::visit(const std::string& filename)
 {
 	const std::string fullname = "def/" + filename;
 
+	trace::ScopedZone zone("decls", "parseDefFile", fullname);
+
 	ArchiveTextFilePtr file = GlobalFileSystem().openTextFile(fullname);
 
 	if (file == NULL) return;
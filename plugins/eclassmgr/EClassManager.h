@@ -78,7 +78,9 @@ public:
     // RegisterableModule implementation
 	virtual const std::string& getName() const;
 	virtual const StringSet& getDependencies() const;
+	virtual void preInitialiseModule(const ApplicationContext& ctx);
 	virtual void initialiseModule(const ApplicationContext& ctx);
+	virtual bool isInitialisationThreadSafe() const;
 	virtual void shutdownModule();
 
 	// Method loading the DEF files (gets called by GlobalFilesystem().foreach()).
@@ -99,6 +101,9 @@ private:
 	void parseDefFiles();
 	void resolveInheritance();
 
+	// Writes the number and memory usage of the class attributes to the log
+	void printAttributeStatistics() const;
+
 	void reloadDefsCmd(const cmd::ArgumentList& args);
 };
 typedef boost::shared_ptr<EClassManager> EClassManagerPtr;
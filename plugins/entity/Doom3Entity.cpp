@@ -7,11 +7,13 @@
 #include <boost/algorithm/string/case_conv.hpp>
 #include <boost/algorithm/string/predicate.hpp>
 #include <boost/bind.hpp>
+#include <boost/make_shared.hpp>
 
 namespace entity {
 
 Doom3Entity::Doom3Entity(const IEntityClassPtr& eclass) :
 	_eclass(eclass),
+	_index(_keyValues),
 	_undo(_keyValues, boost::bind(&Doom3Entity::importState, this, _1)),
 	_instanced(false),
 	_observerMutex(false),
@@ -21,6 +23,7 @@ Doom3Entity::Doom3Entity(const IEntityClassPtr& eclass) :
 Doom3Entity::Doom3Entity(const Doom3Entity& other) :
 	Entity(other),
 	_eclass(other.getEntityClass()),
+	_index(_keyValues),
 	_undo(_keyValues, boost::bind(&Doom3Entity::importState, this, _1)),
 	_instanced(false),
 	_observerMutex(false),
@@ -30,7 +33,7 @@ Doom3Entity::Doom3Entity(const Doom3Entity& other) :
 		 i != other._keyValues.end();
 		 ++i)
 	{
-		insert(i->first, i->second->get());
+		insert(i->first.getString(), i->second->get());
 	}
 }
 
@@ -50,6 +53,9 @@ bool Doom3Entity::isOfType(const std::string& className)
 
 void Doom3Entity::importState(const KeyValues& keyValues)
 {
+	// All keys are replaced, re-index them once on the next lookup
+	_index.invalidate();
+
 	// Remove the entity key values, one by one
 	while (_keyValues.size() > 0)
 	{
@@ -77,7 +83,7 @@ void Doom3Entity::attachObserver(Observer* observer)
 	// Now notify the observer about all the existing keys
 	for(KeyValues::const_iterator i = _keyValues.begin(); i != _keyValues.end(); ++i)
     {
-		observer->onKeyInsert(i->first, *i->second);
+		observer->onKeyInsert(i->first.getString(), *i->second);
 	}
 }
 
@@ -100,7 +106,7 @@ void Doom3Entity::detachObserver(Observer* observer)
 	// Call onKeyErase() for every spawnarg, so that the observer gets cleanly shut down
 	for(KeyValues::const_iterator i = _keyValues.begin(); i != _keyValues.end(); ++i)
     {
-		observer->onKeyErase(i->first, *i->second);
+		observer->onKeyErase(i->first.getString(), *i->second);
 	}
 }
 
@@ -149,7 +155,7 @@ void Doom3Entity::forEachKeyValue(Visitor& visitor) const
 {
 	for(KeyValues::const_iterator i = _keyValues.begin(); i != _keyValues.end(); ++i)
 	{
-		visitor.visit(i->first, i->second->get());
+		visitor.visit(i->first.getString(), i->second->get());
 	}
 }
 
@@ -157,7 +163,7 @@ void Doom3Entity::forEachKeyValue(KeyValueVisitor& visitor)
 {
 	for(KeyValues::iterator i = _keyValues.begin(); i != _keyValues.end(); ++i)
 	{
-		visitor.visit(i->first, *i->second);
+		visitor.visit(i->first.getString(), *i->second);
 	}
 }
 
@@ -212,10 +218,10 @@ Entity::KeyValuePairs Doom3Entity::getKeyValuePairs(const std::string& prefix) c
 	for (KeyValues::const_iterator i = _keyValues.begin(); i != _keyValues.end(); ++i)
 	{
 		// If the prefix matches, add to list
-		if (boost::algorithm::istarts_with(i->first, prefix))
+		if (boost::algorithm::istarts_with(i->first.getString(), prefix))
 		{
 			list.push_back(
-				std::pair<std::string, std::string>(i->first, i->second->get())
+				std::pair<std::string, std::string>(i->first.getString(), i->second->get())
 			);
 		}
 	}
@@ -281,20 +287,18 @@ void Doom3Entity::notifyErase(const std::string& key, KeyValue& value)
 	_observerMutex = false;
 }
 
-void Doom3Entity::insert(const std::string& key, const KeyValuePtr& keyValue)
+void Doom3Entity::insert(const KeyName& key, const KeyValuePtr& keyValue)
 {
 	// Insert the new key at the end of the list
-	KeyValues::iterator i = _keyValues.insert(
-		_keyValues.end(),
-		KeyValuePair(key, keyValue)
-	);
+	_keyValues.push_back(KeyValuePair(key, keyValue));
+	_index.onAppend();
 
-	// Dereference the iterator to get a KeyValue& reference and notify the observers
-	notifyInsert(key, *i->second);
+	// Notify the observers, keyValue stays valid even if an observer modifies the list
+	notifyInsert(key.getString(), *keyValue);
 
 	if (_instanced)
 	{
-		i->second->instanceAttach(_undo.map());
+		keyValue->instanceAttach(_undo.map());
 	}
 }
 
@@ -310,17 +314,17 @@ void Doom3Entity::insert(const std::string& key, const std::string& value)
 
         // Notify observers of key change, using the found key as argument
 		// as the case of the incoming "key" might be different
-        notifyChange(i->first, value);
+        notifyChange(i->first.getString(), value);
 	}
 	else
 	{
 		// No key with that name found, create a new one
 		_undo.save();
 
-		// Allocate a new KeyValue object and insert it into the map
+		// Allocate a new KeyValue object (along with its reference count) and insert it into the map
 		insert(
-			key,
-			KeyValuePtr(new KeyValue(value, _eclass->getAttribute(key).getValue()))
+			KeyName(key),
+			boost::make_shared<KeyValue>(value, _eclass->getAttribute(key).getValue())
 		);
 	}
 }
@@ -333,14 +337,15 @@ void Doom3Entity::erase(const KeyValues::iterator& i)
 	}
 
 	// Retrieve the key and value from the vector before deletion
-	std::string key(i->first);
+	KeyName key(i->first);
 	KeyValuePtr value(i->second);
 
-	// Actually delete the object from the list
+	// Actually delete the object from the list, this shifts the positions of all following keys
+	_index.onErase(i - _keyValues.begin());
 	_keyValues.erase(i);
 
 	// Notify about the deletion
-	notifyErase(key, *value);
+	notifyErase(key.getString(), *value);
 
 	// Scope ends here, the KeyValue object will be deleted automatically
 	// as the boost::shared_ptr useCount will reach zero.
@@ -360,34 +365,16 @@ void Doom3Entity::erase(const std::string& key)
 
 Doom3Entity::KeyValues::const_iterator Doom3Entity::find(const std::string& key) const
 {
-	for (KeyValues::const_iterator i = _keyValues.begin();
-		 i != _keyValues.end();
-		 ++i)
-	{
-		if (boost::iequals(i->first, key))
-		{
-			return i;
-		}
-	}
+	std::size_t position = _index.find(key);
 
-	// Not found
-	return _keyValues.end();
+	return position != std::string::npos ? _keyValues.begin() + position : _keyValues.end();
 }
 
 Doom3Entity::KeyValues::iterator Doom3Entity::find(const std::string& key)
 {
-	for (KeyValues::iterator i = _keyValues.begin();
-		 i != _keyValues.end();
-		 ++i)
-	{
-		if (boost::iequals(i->first, key))
-		{
-			return i;
-		}
-	}
+	std::size_t position = _index.find(key);
 
-	// Not found
-	return _keyValues.end();
+	return position != std::string::npos ? _keyValues.begin() + position : _keyValues.end();
 }
 
 } // namespace entity
@@ -3,6 +3,7 @@
 
 #include <vector>
 #include "KeyValue.h"
+#include "KeyValueIndex.h"
 #include <boost/shared_ptr.hpp>
 
 /** greebo: This is the implementation of the class Entity.
@@ -21,6 +22,7 @@ namespace entity {
 /// - Notifies observers when a pair is inserted or removed.
 /// - Provides undo support through the global undo system.
 /// - New keys are appended to the end of the list.
+/// - Keys are interned and looked up through a hash index.
 class Doom3Entity :
 	public Entity
 {
@@ -29,12 +31,15 @@ class Doom3Entity :
 	typedef boost::shared_ptr<KeyValue> KeyValuePtr;
 
 	// A key value pair using a dynamically allocated value
-	typedef std::pair<std::string, KeyValuePtr> KeyValuePair;
+	typedef std::pair<KeyName, KeyValuePtr> KeyValuePair;
 
-	// The unsorted list of KeyValue pairs
+	// The unsorted list of KeyValue pairs, in insertion order
 	typedef std::vector<KeyValuePair> KeyValues;
 	KeyValues _keyValues;
 
+	// Maps keys to their position in _keyValues
+	KeyValueIndex<KeyValues> _index;
+
 	typedef std::set<Observer*> Observers;
 	Observers _observers;
 
@@ -101,7 +106,7 @@ private:
     void notifyChange(const std::string& k, const std::string& v);
 	void notifyErase(const std::string& key, KeyValue& value);
 
-	void insert(const std::string& key, const KeyValuePtr& keyValue);
+	void insert(const KeyName& key, const KeyValuePtr& keyValue);
 	void insert(const std::string& key, const std::string& value);
 
 	void erase(const KeyValues::iterator& i);
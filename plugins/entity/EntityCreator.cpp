@@ -9,6 +9,7 @@
 #include "inamespace.h"
 #include "ifilter.h"
 #include "ipreferencesystem.h"
+#include "istringpool.h"
 
 #include "entitylib.h"
 #include "gamelib.h"
@@ -159,6 +160,7 @@ const StringSet& Doom3EntityCreator::getDependencies() const {
 		_dependencies.insert(MODULE_SCENEGRAPH);
 		_dependencies.insert(MODULE_RENDERSYSTEM);
 		_dependencies.insert(MODULE_UNDOSYSTEM);
+		_dependencies.insert(MODULE_STRINGPOOL);
 	}
 
 	return _dependencies;
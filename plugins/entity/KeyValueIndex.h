@@ -0,0 +1,180 @@
+#pragma once
+
+#include <string>
+#include <vector>
+#include <boost/algorithm/string/predicate.hpp>
+#include "string/InternedString.h"
+
+namespace entity
+{
+
+/**
+ * A spawnarg key name, interned in the global string pool. All entities
+ * using the same key share a single copy of the string, which carries the
+ * hash of its lowercase form (keys are compared case-insensitively).
+ */
+typedef string::InternedString KeyName;
+
+/**
+ * An open-addressing hash index over a vector of key/value pairs, whose
+ * first member is a KeyName. The vector keeps the pairs in insertion order,
+ * the index maps case-insensitive key lookups to positions in that vector.
+ *
+ * The index is bound to the vector passed to the constructor. Appending a
+ * pair has to be announced through onAppend(), erasing one through onErase()
+ * before it is removed from the vector. All other modifications require a
+ * call to invalidate(), an invalidated index is rebuilt by the next lookup,
+ * so replacing all pairs costs a single rebuild. Like the entities using it,
+ * the index is not meant to be accessed from several threads.
+ */
+template<typename KeyValues>
+class KeyValueIndex
+{
+	const KeyValues& _keyValues;
+
+	// Linear probing, each slot holds the position in _keyValues plus one,
+	// 0 marks an empty slot. The size is always a power of two.
+	mutable std::vector<std::size_t> _slots;
+
+	// True if the slots don't match the vector anymore
+	mutable bool _dirty;
+
+	static const std::size_t MIN_SLOTS = 16;
+
+public:
+	KeyValueIndex(const KeyValues& keyValues) :
+		_keyValues(keyValues),
+		_dirty(false)
+	{
+		rebuild();
+	}
+
+	/**
+	 * Returns the position of the given key in the vector or
+	 * std::string::npos if the key is not present.
+	 */
+	std::size_t find(const std::string& key) const
+	{
+		if (_keyValues.empty()) return std::string::npos;
+
+		if (_dirty)
+		{
+			rebuild();
+		}
+
+		std::size_t mask = _slots.size() - 1;
+		std::size_t hash = string::getFoldedHash(key);
+
+		for (std::size_t slot = hash & mask; _slots[slot] != 0; slot = (slot + 1) & mask)
+		{
+			const KeyName& name = _keyValues[_slots[slot] - 1].first;
+
+			if (name.getFoldedHash() == hash && boost::algorithm::iequals(name.getString(), key))
+			{
+				return _slots[slot] - 1;
+			}
+		}
+
+		return std::string::npos;
+	}
+
+	// Adds the last pair of the vector to the index
+	void onAppend()
+	{
+		// The pending rebuild will pick up the new pair
+		if (_dirty) return;
+
+		// Keep the load factor at or below 0.5
+		if (_keyValues.size() * 2 > _slots.size())
+		{
+			rebuild();
+			return;
+		}
+
+		insertSlot(_keyValues.size() - 1);
+	}
+
+	// Removes the pair at the given position from the index, call this right
+	// before erasing it from the vector
+	void onErase(std::size_t position)
+	{
+		// The pending rebuild will see the vector without the pair
+		if (_dirty) return;
+
+		std::size_t mask = _slots.size() - 1;
+		std::size_t slot = _keyValues[position].first.getFoldedHash() & mask;
+
+		while (_slots[slot] != position + 1)
+		{
+			slot = (slot + 1) & mask;
+		}
+
+		// Close the gap by moving back the entries further down the probe
+		// sequence, unless they are already sitting at their home slot
+		for (std::size_t next = (slot + 1) & mask; _slots[next] != 0; next = (next + 1) & mask)
+		{
+			std::size_t home = _keyValues[_slots[next] - 1].first.getFoldedHash() & mask;
+
+			bool movable = slot <= next ? (home <= slot || home > next) : (home <= slot && home > next);
+
+			if (movable)
+			{
+				_slots[slot] = _slots[next];
+				slot = next;
+			}
+		}
+
+		_slots[slot] = 0;
+
+		// All following pairs move up by one position
+		for (std::size_t i = 0; i < _slots.size(); ++i)
+		{
+			if (_slots[i] > position + 1)
+			{
+				--_slots[i];
+			}
+		}
+	}
+
+	// Marks the index as outdated, it is rebuilt on the next lookup
+	void invalidate()
+	{
+		_dirty = true;
+	}
+
+	// Re-indexes all pairs of the vector
+	void rebuild() const
+	{
+		std::size_t numSlots = MIN_SLOTS;
+
+		while (numSlots < _keyValues.size() * 2)
+		{
+			numSlots <<= 1;
+		}
+
+		_slots.assign(numSlots, 0);
+
+		for (std::size_t i = 0; i < _keyValues.size(); ++i)
+		{
+			insertSlot(i);
+		}
+
+		_dirty = false;
+	}
+
+private:
+	void insertSlot(std::size_t position) const
+	{
+		std::size_t mask = _slots.size() - 1;
+		std::size_t slot = _keyValues[position].first.getFoldedHash() & mask;
+
+		while (_slots[slot] != 0)
+		{
+			slot = (slot + 1) & mask;
+		}
+
+		_slots[slot] = position + 1;
+	}
+};
+
+} // namespace
@@ -29,7 +29,7 @@ void ModelKey::refreshModel()
 	// Check if we have a skinnable model and remember the skin
 	SkinnedModelPtr skinned = boost::dynamic_pointer_cast<SkinnedModel>(_modelNode);
 
-	std::string skin = skinned ? skinned->getSkin() : "";
+	std::string skin = skinned ? skinned->getSkin() : _skin;
 	
 	attachModelNode();
 	
@@ -107,6 +107,8 @@ void ModelKey::attachModelNode()
 
 void ModelKey::skinChanged(const std::string& value)
 {
+	_skin = value;
+
 	// Check if we have a skinnable model
 	SkinnedModelPtr skinned = boost::dynamic_pointer_cast<SkinnedModel>(_modelNode);
 
@@ -18,6 +18,10 @@ private:
 
 	std::string _modelPath;
 
+	// The last value of the "skin" spawnarg, remembered for models which
+	// don't support skins, like the placeholders of background loads
+	std::string _skin;
+
 	// To deactivate model handling during node destruction
 	bool _active;
 
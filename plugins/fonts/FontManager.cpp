@@ -5,6 +5,7 @@
 #include "itextstream.h"
 #include "iregistry.h"
 #include "igame.h"
+#include "itrace.h"
 #include "os/path.h"
 
 #include "xmlutil/MissingXMLNodeException.h"
@@ -50,6 +51,12 @@ const StringSet& FontManager::getDependencies() const
 	return _dependencies;
 }
 
+void FontManager::preInitialiseModule(const ApplicationContext& ctx)
+{
+	// The game file is part of the registry, which is read on the main thread
+	readFontLocation();
+}
+
 void FontManager::initialiseModule(const ApplicationContext& ctx)
 {
 	rMessage() << getName() << "::initialiseModule called" << std::endl;
@@ -58,6 +65,13 @@ void FontManager::initialiseModule(const ApplicationContext& ctx)
 	reloadFonts();
 }
 
+bool FontManager::isInitialisationThreadSafe() const
+{
+	// Loading the fonts only reads from the VFS, the glyph shaders are
+	// acquired on demand
+	return true;
+}
+
 void FontManager::shutdownModule()
 {
 }
@@ -67,10 +81,8 @@ const std::string& FontManager::getCurLanguage()
 	return _curLanguage;
 }
 
-void FontManager::reloadFonts()
+void FontManager::readFontLocation()
 {
-	_fonts.clear();
-
 	xml::NodeList nlBasePath = GlobalGameManager().currentGame()->getLocalXPath("/filesystem/fonts/basepath");
 
 	if (nlBasePath.empty())
@@ -88,13 +100,19 @@ void FontManager::reloadFonts()
 	// TODO: Get the language from the registry
 	_curLanguage = "english";
 
-	// Load the DAT files from the VFS
-	std::string path = os::standardPathWithSlash(nlBasePath[0].getContent()) + _curLanguage + "/";
-	std::string extension = nlExt[0].getContent();
+	_fontPath = os::standardPathWithSlash(nlBasePath[0].getContent()) + _curLanguage + "/";
+	_fontExtension = nlExt[0].getContent();
+}
+
+void FontManager::reloadFonts()
+{
+	trace::ScopedZone zone("decls", "reloadFonts");
+
+	_fonts.clear();
 
-	// Instantiate a visitor to traverse the VFS
-	FontLoader loader(path, *this);
-	GlobalFileSystem().forEachFile(path, extension, loader, 2);
+	// Load the DAT files from the VFS, instantiate a visitor to traverse it
+	FontLoader loader(_fontPath, *this);
+	GlobalFileSystem().forEachFile(_fontPath, _fontExtension, loader, 2);
 
 	rMessage() << _fonts.size() << " fonts registered." << std::endl;
 }
@@ -22,13 +22,20 @@ private:
 
 	std::string _curLanguage;
 
+	// Folder of the current language's fonts and the extension of their
+	// files, read from the game file
+	std::string _fontPath;
+	std::string _fontExtension;
+
 public:
 	FontManager();
 
 	// RegisterableModule implementation
 	const std::string& getName() const;
 	const StringSet& getDependencies() const;
+	void preInitialiseModule(const ApplicationContext& ctx);
 	void initialiseModule(const ApplicationContext& ctx);
+	bool isInitialisationThreadSafe() const;
 	void shutdownModule();
 
 	// Returns the info structure of a specific font (current language),
@@ -43,6 +50,7 @@ public:
 	const std::string& getCurLanguage();
 
 private:
+	void readFontLocation();
 	void reloadFonts();
 };
 typedef boost::shared_ptr<FontManager> FontManagerPtr;
@@ -1,6 +1,7 @@
 #include "Doom3MapCompiler.h"
 
 #include "itextstream.h"
+#include "itrace.h"
 #include "icommandsystem.h"
 #include "ientity.h"
 #include "iregistry.h"
@@ -94,6 +95,15 @@ void Doom3MapCompiler::generateProc(const scene::INodePtr& root)
 	_procFile = compiler.generateProcFile();
 }
 
+AreaPortalGraphTask Doom3MapCompiler::prepareAreaPortalGraph(const scene::INodePtr& root)
+{
+	boost::shared_ptr<ProcCompiler> compiler(new ProcCompiler(root));
+
+	compiler->loadBrushData();
+
+	return boost::bind(&ProcCompiler::generateAreaPortalGraph, compiler);
+}
+
 void Doom3MapCompiler::runDmap(const scene::INodePtr& root)
 {
 	assert(root);
@@ -107,12 +117,14 @@ void Doom3MapCompiler::runDmap(const scene::INodePtr& root)
 	}
 }
 
-void Doom3MapCompiler::runDmap(const std::string& mapFile)
+bool Doom3MapCompiler::runDmap(const std::string& mapFile)
 {
+	trace::ScopedZone zone("dmap", "runDmap", mapFile);
+
 	if (!os::fileOrDirExists(mapFile) || file_is_directory(mapFile.c_str()))
 	{
 		rError() << "Can't dmap, file doesn't exist: " << mapFile << std::endl;
-		return;
+		return false;
 	}
 
 	TextFileInputStream file(mapFile);
@@ -132,12 +144,17 @@ void Doom3MapCompiler::runDmap(const std::string& mapFile)
 	{
 		rError() << 
 			(boost::format("Failure reading map file:\n%s\n\n%s") % mapFile % e.what()).str() << std::endl;
-		return;
+		return false;
 	}
 
 	// Start the sequence
 	runDmap(root);
 
+	if (!_procFile)
+	{
+		return false;
+	}
+
 	if (_procFile->hasLeak())
 	{
 		std::string ext = "." + os::getExtension(mapFile);
@@ -145,13 +162,15 @@ void Doom3MapCompiler::runDmap(const std::string& mapFile)
 
 		_procFile->leakFile->writeToFile(leakFileName);
 
-		return;
+		return false;
 	}
 
 	std::string ext = "." + os::getExtension(mapFile);
 	std::string procFileName = boost::algorithm::replace_last_copy(mapFile, ext, ProcFile::Extension());
 
 	_procFile->saveToFile(procFileName);
+
+	return true;
 }
 
 void Doom3MapCompiler::dmapCmd(const cmd::ArgumentList& args)
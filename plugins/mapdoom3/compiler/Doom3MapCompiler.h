@@ -19,6 +19,8 @@ private:
 
 public:
 	virtual void generateProc(const scene::INodePtr& root);
+	virtual bool runDmap(const std::string& mapFile);
+	virtual AreaPortalGraphTask prepareAreaPortalGraph(const scene::INodePtr& root);
 
 	virtual const std::string& getName() const;
 	virtual const StringSet& getDependencies() const;
@@ -31,9 +33,8 @@ private:
 
 	void setDmapRenderOption(const cmd::ArgumentList& args);
 
-	// Runs the actual dmap sequence on the given map file
+	// Runs the actual dmap sequence on the given map root
 	void runDmap(const scene::INodePtr& root);
-	void runDmap(const std::string& mapFile);
 };
 typedef boost::shared_ptr<Doom3MapCompiler> Doom3MapCompilerPtr;
 
@@ -1,6 +1,7 @@
 #include "ProcCompiler.h"
 
 #include "itextstream.h"
+#include "itrace.h"
 #include "math/Plane3.h"
 #include "string/convert.h"
 #include "ishaders.h"
@@ -71,6 +72,86 @@ ProcFilePtr ProcCompiler::generateProcFile()
     return _procFile;
 }
 
+void ProcCompiler::loadBrushData()
+{
+    _procFile.reset(new ProcFile);
+
+    generateBrushData();
+
+    // Don't keep the scene alive, the graph might be built in a worker thread
+    _root.reset();
+}
+
+AreaPortalGraphPtr ProcCompiler::generateAreaPortalGraph()
+{
+    trace::ScopedZone zone("dmap", "generateAreaPortalGraph");
+
+    // Without any visportals the whole map is a single area
+    if (_procFile->entities.empty() || _procFile->numPortals == 0)
+    {
+        return AreaPortalGraphPtr();
+    }
+
+    ProcEntity& world = **_procFile->entities.begin();
+
+    if (world.primitives.empty() || !buildAreas(world, true))
+    {
+        return AreaPortalGraphPtr();
+    }
+
+    AreaPortalGraphPtr graph(new AreaPortalGraph);
+
+    graph->numAreas = world.numAreas;
+
+    // The single-leaf case doesn't need any nodes
+    if (world.tree.head->planenum != PLANENUM_LEAF)
+    {
+        addAreaGraphNodesRecursively(*graph, world.tree.head);
+    }
+
+    for (ProcFile::InterAreaPortals::const_iterator i = _procFile->interAreaPortals.begin();
+         i != _procFile->interAreaPortals.end(); ++i)
+    {
+        graph->portals.push_back(AreaPortalGraph::Portal());
+        AreaPortalGraph::Portal& portal = graph->portals.back();
+
+        portal.areas[0] = i->area0;
+        portal.areas[1] = i->area1;
+
+        const ProcWinding& winding = i->side->winding;
+
+        for (std::size_t p = 0; p < winding.size(); ++p)
+        {
+            portal.winding.push_back(winding[p].vertex);
+        }
+    }
+
+    return graph;
+}
+
+int ProcCompiler::addAreaGraphNodesRecursively(AreaPortalGraph& graph, const BspTreeNodePtr& node)
+{
+    if (node->planenum == PLANENUM_LEAF)
+    {
+        // Opaque leafs don't have an area, which results in 0, like in the .proc file
+        return static_cast<int>(-1 - node->area);
+    }
+
+    int nodeNum = static_cast<int>(graph.nodes.size());
+
+    graph.nodes.push_back(AreaPortalGraph::Node());
+    graph.nodes[nodeNum].plane = _procFile->planes.getPlane(node->planenum);
+
+    // The node list is growing during recursion, don't hold any references
+    int front = addAreaGraphNodesRecursively(graph, node->children[0]);
+    int back = addAreaGraphNodesRecursively(graph, node->children[1]);
+
+    graph.nodes[nodeNum].children[0] = front;
+    graph.nodes[nodeNum].children[1] = back;
+
+    return nodeNum;
+}
+
 namespace
 {
 
@@ -539,6 +620,8 @@ private:
 
 void ProcCompiler::generateBrushData()
 {
+    trace::ScopedZone zone("dmap", "generateBrushData");
+
     ToolDataGenerator generator(_procFile);
     _root->traverseChildren(generator);
 
@@ -560,6 +643,8 @@ void ProcCompiler::generateBrushData()
 
 bool ProcCompiler::processModels()
 {
+    trace::ScopedZone zone("dmap", "processModels");
+
     for (std::size_t i = 0; i < _procFile->entities.size(); ++i)
     {
         ProcEntity& entity = *_procFile->entities[i];
@@ -851,6 +936,8 @@ void ProcCompiler::buildFaceTreeRecursively(const BspTreeNodePtr& node, BspFaces
 
 void ProcCompiler::faceBsp(ProcEntity& entity)
 {
+    trace::ScopedZone zone("dmap", "faceBsp");
+
     rMessage() << "--- FaceBSP: " << _bspFaces.size() << " faces ---" << std::endl;
 
     entity.tree.bounds = AABB();
@@ -1713,9 +1800,9 @@ bool ProcCompiler::floodEntities(BspTree& tree)
 
     for (std::size_t i = 1; i < _procFile->entities.size(); ++i)
     {
-        Entity& mapEnt = _procFile->entities[i]->mapEntity->getEntity();
+        const ProcEntity& procEntity = *_procFile->entities[i];
         
-        std::string originStr = mapEnt.getKeyValue("origin");
+        std::string originStr = procEntity.getSpawnarg("origin");
 
         if (originStr.empty())
         {
@@ -1725,25 +1812,25 @@ bool ProcCompiler::floodEntities(BspTree& tree)
         Vector3 origin = string::convert<Vector3>(originStr);
 
         // any entity can have "noFlood" set to skip it
-        if (!mapEnt.getKeyValue("noFlood").empty())
+        if (!procEntity.getSpawnarg("noFlood").empty())
         {
             continue;
         }
 
-        std::string className = mapEnt.getKeyValue("classname");
+        std::string className = procEntity.getSpawnarg("classname");
         
         if (className == "light")
         {
             // don't place lights that have a light_start field, because they can still
             // be valid if their origin is outside the world
-            if (!mapEnt.getKeyValue("light_start").empty())
+            if (!procEntity.getSpawnarg("light_start").empty())
             {
                 continue;
             }
 
             // don't place fog lights, because they often
             // have origins outside the light
-            std::string texture = mapEnt.getKeyValue("texture");
+            std::string texture = procEntity.getSpawnarg("texture");
 
             if (!texture.empty())
             {
@@ -1765,10 +1852,10 @@ bool ProcCompiler::floodEntities(BspTree& tree)
         {
             errorShown = true;
             rError() << "Leak on entity #" << i << std::endl;
-            rError() << "Entity classname was " << mapEnt.getKeyValue("classname") << std::endl;
-            rError() << "Entity name was " << mapEnt.getKeyValue("name") << std::endl;
+            rError() << "Entity classname was " << procEntity.getSpawnarg("classname") << std::endl;
+            rError() << "Entity name was " << procEntity.getSpawnarg("name") << std::endl;
             rError() << "Entity origin is " 
-                                << string::convert<Vector3>(mapEnt.getKeyValue("origin"))
+                                << string::convert<Vector3>(procEntity.getSpawnarg("origin"))
                                 << std::endl;
         }
     }
@@ -1874,6 +1961,8 @@ void ProcCompiler::clipSideByTreeRecursively(ProcWinding& winding, ProcFace& sid
 
 void ProcCompiler::clipSidesByTree(ProcEntity& entity)
 {
+    trace::ScopedZone zone("dmap", "clipSidesByTree");
+
     rMessage() << "----- ClipSidesByTree -----" << std::endl;
 
     for (ProcEntity::Primitives::const_iterator prim = entity.primitives.begin(); prim != entity.primitives.end(); ++prim)
@@ -2172,6 +2261,8 @@ void ProcCompiler::findInterAreaPortalsRecursively(const BspTreeNodePtr& node)
 
 void ProcCompiler::floodAreas(ProcEntity& entity)
 {
+    trace::ScopedZone zone("dmap", "floodAreas");
+
     rMessage() << "--- FloodAreas ---" << std::endl;
 
     // set all areas to -1
@@ -2702,6 +2793,8 @@ void ProcCompiler::addMapTrisToAreas(const ProcTris& tris, ProcEntity& entity)
 
 void ProcCompiler::putPrimitivesInAreas(ProcEntity& entity)
 {
+    trace::ScopedZone zone("dmap", "putPrimitivesInAreas");
+
     rMessage() << "----- PutPrimitivesInAreas -----" << std::endl;
 
     // allocate space for surface chains for each area
@@ -4929,6 +5022,8 @@ void ProcCompiler::buildLightShadows(ProcEntity& entity, ProcLight& light)
 
 void ProcCompiler::preLight(ProcEntity& entity)
 {
+    trace::ScopedZone zone("dmap", "preLight");
+
     // don't prelight anything but the world entity
     if (&entity != _procFile->entities[0].get())
     {
@@ -4982,6 +5077,8 @@ void ProcCompiler::preLight(ProcEntity& entity)
 
 void ProcCompiler::optimizeEntity(ProcEntity& entity)
 {
+    trace::ScopedZone zone("dmap", "optimizeEntity");
+
     rMessage() << "----- OptimizeEntity -----" << std::endl;
 
     for (std::size_t i = 0; i < entity.areas.size(); ++i)
@@ -5163,7 +5260,7 @@ std::size_t ProcCompiler::pruneNodesRecursively(const BspTreeNodePtr& node)
     return a1;
 }
 
-bool ProcCompiler::processModel(ProcEntity& entity, bool floodFill)
+bool ProcCompiler::buildAreas(ProcEntity& entity, bool floodFill)
 {
     _bspFaces.clear();
 
@@ -5205,9 +5302,6 @@ bool ProcCompiler::processModel(ProcEntity& entity, bool floodFill)
             // Generate a new leakfile
             _procFile->leakFile.reset(new LeakFile(entity.tree));
 
-            // bail out here.  If someone really wants to
-            // process a map that leaks, they should use
-            // -noFlood
             return false;
         }
     }
@@ -5221,6 +5315,21 @@ bool ProcCompiler::processModel(ProcEntity& entity, bool floodFill)
     // tree, so tris will never cross area boundaries
     floodAreas(entity);
 
+    return true;
+}
+
+bool ProcCompiler::processModel(ProcEntity& entity, bool floodFill)
+{
+    trace::ScopedZone zone("dmap", "processModel");
+
+    if (!buildAreas(entity, floodFill))
+    {
+        // bail out here.  If someone really wants to
+        // process a map that leaks, they should use
+        // -noFlood
+        return false;
+    }
+
     /*rMessage() << "--- Planelist before PutPrimitivesInAreas --- " << std::endl;
 
     for (std::size_t i = 0; i < _procFile->planes.size(); ++i)
@@ -2,6 +2,7 @@
 
 #include "inode.h"
 #include "ientity.h"
+#include "imapcompiler.h"
 #include "ProcFile.h"
 #include "BspTree.h"
 #include "math/Vector3.h"
@@ -116,12 +117,27 @@ public:
 	// Generate the .proc file
 	ProcFilePtr generateProcFile();
 
+	// Reads the brushes and entities of the map, without processing them.
+	// The scene isn't accessed anymore afterwards.
+	void loadBrushData();
+
+	// Generate the areas and visportals of the worldspawn only, from the
+	// data read by loadBrushData()
+	AreaPortalGraphPtr generateAreaPortalGraph();
+
 private:
 	void generateBrushData();
 
 	bool processModels();
 	bool processModel(ProcEntity& entity, bool floodFill);
 
+	// Builds the BSP tree of the given entity and flood fills its areas,
+	// returns false if the entity is leaking
+	bool buildAreas(ProcEntity& entity, bool floodFill);
+
+	// Copies the given subtree into the graph, returns the child number to refer to it
+	int addAreaGraphNodesRecursively(AreaPortalGraph& graph, const BspTreeNodePtr& node);
+
 	// Create a list of all faces that are relevant for faceBSP()
 	void makeStructuralProcFaceList(const ProcEntity::Primitives& primitives);
 
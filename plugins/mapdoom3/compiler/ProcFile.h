@@ -1,9 +1,12 @@
 #pragma once
 
 #include <boost/shared_ptr.hpp>
+#include <boost/algorithm/string/case_conv.hpp>
 #include <vector>
 #include <list>
+#include <map>
 #include "ibrush.h"
+#include "ientity.h"
 #include "ipatch.h"
 #include "ishaders.h"
 
@@ -180,6 +183,11 @@ struct ProcEntity
 	// The reference into the scenegraph
 	IEntityNodePtr	mapEntity;
 
+	// A copy of the entity's spawnargs with lowercase keys, used by the
+	// stages which might run in a worker thread, away from the scenegraph
+	typedef std::map<std::string, std::string> Spawnargs;
+	Spawnargs		spawnargs;
+
 	std::size_t		entityNum;
 
 	Vector3			origin;
@@ -199,7 +207,22 @@ struct ProcEntity
 		mapEntity(entityNode),
 		entityNum(entityNum_),
 		numAreas(0)
-	{}
+	{
+		Entity::KeyValuePairs pairs = entityNode->getEntity().getKeyValuePairs("");
+
+		for (Entity::KeyValuePairs::const_iterator i = pairs.begin(); i != pairs.end(); ++i)
+		{
+			spawnargs[boost::algorithm::to_lower_copy(i->first)] = i->second;
+		}
+	}
+
+	// Returns the value of the given spawnarg, or an empty string
+	std::string getSpawnarg(const std::string& key) const
+	{
+		Spawnargs::const_iterator found = spawnargs.find(boost::algorithm::to_lower_copy(key));
+
+		return found != spawnargs.end() ? found->second : std::string();
+	}
 };
 
 struct ProcInterAreaPortal
@@ -3,6 +3,8 @@
 #include "itextstream.h"
 #include "string/convert.h"
 
+#include <algorithm>
+
 namespace md5
 {
 
@@ -133,13 +135,13 @@ void MD5Anim::parseFrame(std::size_t frame, parser::DefTokeniser& tok)
 	tok.assertNextToken("}");
 }
 
-void MD5Anim::parseFromStream(std::istream& stream)
+bool MD5Anim::parseFromStream(std::istream& stream)
 {
 	parser::BasicDefTokeniser<std::istream> tokeniser(stream);
-	parseFromTokens(tokeniser);
+	return parseFromTokens(tokeniser);
 }
 
-void MD5Anim::parseFromTokens(parser::DefTokeniser& tok)
+bool MD5Anim::parseFromTokens(parser::DefTokeniser& tok)
 {
 	try
 	{
@@ -192,6 +194,103 @@ void MD5Anim::parseFromTokens(parser::DefTokeniser& tok)
 	catch (parser::ParseException& ex)
 	{
 		rError() << "Error parsing MD5 Animation: " << ex.what() << std::endl;
+		return false;
+	}
+
+	return true;
+}
+
+void MD5Anim::writeToCache(BinaryCacheWriter& writer) const
+{
+	writer.writeString(_commandLine);
+	writer.write(static_cast<boost::int32_t>(_frameRate));
+	writer.write(static_cast<boost::int32_t>(_numAnimatedComponents));
+
+	writer.write(static_cast<boost::uint32_t>(_joints.size()));
+
+	for (std::vector<Joint>::const_iterator i = _joints.begin(); i != _joints.end(); ++i)
+	{
+		// The child lists are rebuilt from the parent IDs
+		writer.writeString(i->name);
+		writer.write(static_cast<boost::int32_t>(i->parentId));
+		writer.write(static_cast<boost::uint32_t>(i->animComponents));
+		writer.write(static_cast<boost::uint32_t>(i->firstKey));
+	}
+
+	writer.writeArray(_bounds);
+	writer.writeArray(_baseFrame);
+
+	writer.write(static_cast<boost::uint32_t>(_frames.size()));
+
+	for (std::vector<FrameKeys>::const_iterator i = _frames.begin(); i != _frames.end(); ++i)
+	{
+		writer.writeArray(*i);
+	}
+}
+
+void MD5Anim::readFromCache(BinaryCacheReader& reader)
+{
+	_commandLine = reader.readString();
+	_frameRate = reader.read<boost::int32_t>();
+	_numAnimatedComponents = reader.read<boost::int32_t>();
+
+	_joints.clear();
+	_joints.resize(reader.read<boost::uint32_t>());
+
+	for (std::size_t i = 0; i < _joints.size(); ++i)
+	{
+		_joints[i].id = static_cast<int>(i);
+		_joints[i].name = reader.readString();
+		_joints[i].parentId = reader.read<boost::int32_t>();
+		_joints[i].animComponents = reader.read<boost::uint32_t>();
+		_joints[i].firstKey = reader.read<boost::uint32_t>();
+
+		int parentId = _joints[i].parentId;
+
+		if (parentId >= static_cast<int>(_joints.size()))
+		{
+			throw BinaryCacheException("Invalid joint parent");
+		}
+
+		// Each animated component takes one key, starting at firstKey
+		std::size_t numKeys = 0;
+
+		for (std::size_t bits = _joints[i].animComponents & (Joint::INVALID_COMPONENT - 1); bits != 0; bits >>= 1)
+		{
+			numKeys += bits & 1;
+		}
+
+		std::size_t numComponents = static_cast<std::size_t>(std::max(_numAnimatedComponents, 0));
+
+		if (numKeys > numComponents || _joints[i].firstKey > numComponents - numKeys)
+		{
+			throw BinaryCacheException("Invalid joint keys");
+		}
+
+		if (parentId >= 0)
+		{
+			_joints[parentId].children.push_back(_joints[i].id);
+		}
+	}
+
+	reader.readArray(_bounds);
+	reader.readArray(_baseFrame);
+
+	if (_baseFrame.size() != _joints.size())
+	{
+		throw BinaryCacheException("Invalid base frame");
+	}
+
+	_frames.resize(reader.read<boost::uint32_t>());
+
+	for (std::size_t i = 0; i < _frames.size(); ++i)
+	{
+		reader.readArray(_frames[i]);
+
+		if (_frames[i].size() != static_cast<std::size_t>(_numAnimatedComponents))
+		{
+			throw BinaryCacheException("Invalid frame keys");
+		}
 	}
 }
 
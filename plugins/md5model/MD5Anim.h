@@ -6,6 +6,7 @@
 #include "math/AABB.h"
 #include "math/Vector3.h"
 #include "math/Quaternion.h"
+#include "MD5BinaryCache.h"
 
 namespace md5
 {
@@ -72,10 +73,15 @@ public:
 		return _frames[index];
 	}
 
-	void parseFromStream(std::istream& stream);
+	// Returns false if the stream could not be parsed
+	bool parseFromStream(std::istream& stream);
+
+	// Binary cache serialisation, see MD5BinaryCache
+	void writeToCache(BinaryCacheWriter& writer) const;
+	void readFromCache(BinaryCacheReader& reader);
 
 private:
-	void parseFromTokens(parser::DefTokeniser& tok);
+	bool parseFromTokens(parser::DefTokeniser& tok);
 	void parseJointHierarchy(parser::DefTokeniser& tok);
 	void parseFrameBounds(parser::DefTokeniser& tok);
 	void parseBaseFrame(parser::DefTokeniser& tok);
@@ -18,6 +18,18 @@ IMD5AnimPtr MD5AnimationCache::getAnim(const std::string& vfsPath)
 		return found->second;
 	}
 
+	// Try the binary cache before parsing the text file
+	MD5BinaryCache& cache = MD5BinaryCache::Instance();
+
+	MD5AnimPtr anim(new MD5Anim);
+	MD5BinaryCache::SourceInfo source;
+
+	if (cache.load(vfsPath, source, *anim))
+	{
+		_animations.insert(AnimationMap::value_type(vfsPath, anim));
+		return anim;
+	}
+
 	// Not found, construct new animation with the given path
 	ArchiveTextFilePtr file = GlobalFileSystem().openTextFile(vfsPath);
 
@@ -30,8 +42,12 @@ IMD5AnimPtr MD5AnimationCache::getAnim(const std::string& vfsPath)
 	std::istream inputStream(&file->getInputStream());
 	
 	// Create the anim from scratch
-	MD5AnimPtr anim(new MD5Anim);
-	anim->parseFromStream(inputStream);
+	anim.reset(new MD5Anim);
+
+	if (anim->parseFromStream(inputStream))
+	{
+		cache.save(vfsPath, source, *anim);
+	}
 
 	// Store the anim in our cache
 	_animations.insert(AnimationMap::value_type(vfsPath, anim));
@@ -0,0 +1,208 @@
+#include "MD5BinaryCache.h"
+
+#include "imodule.h"
+#include "itextstream.h"
+
+#include <fstream>
+#include <sstream>
+#include <iomanip>
+
+#include "MD5Model.h"
+#include "MD5Anim.h"
+
+namespace md5
+{
+
+namespace
+{
+	const char* const CACHE_FOLDER = "md5cache/";
+	const char* const CACHE_EXTENSION = ".bin";
+
+	const boost::uint32_t CACHE_MAGIC = 0x4335444d; // "MD5C"
+
+	// Increase this whenever the serialised data changes
+	const boost::uint32_t CACHE_VERSION = 1;
+
+	const boost::uint32_t TYPE_MESH = 0;
+	const boost::uint32_t TYPE_ANIM = 1;
+
+	// The sizes of the structures which are written as a block, a cache file
+	// written by a build with a different layout must not be used
+	std::vector<boost::uint32_t> getLayout()
+	{
+		std::vector<boost::uint32_t> layout;
+
+		layout.push_back(sizeof(MD5Joint));
+		layout.push_back(sizeof(MD5Vert));
+		layout.push_back(sizeof(MD5Tri));
+		layout.push_back(sizeof(MD5Weight));
+		layout.push_back(sizeof(IMD5Anim::Key));
+		layout.push_back(sizeof(AABB));
+
+		return layout;
+	}
+
+	void writeHeader(BinaryCacheWriter& writer, const std::string& vfsPath, boost::uint32_t type,
+					 boost::uint64_t sourceSize, boost::uint64_t sourceStamp)
+	{
+		writer.write(CACHE_MAGIC);
+		writer.write(CACHE_VERSION);
+		writer.write(type);
+		writer.writeArray(getLayout());
+		writer.writeString(vfsPath);
+		writer.write(sourceSize);
+		writer.write(sourceStamp);
+	}
+
+	// Returns true if the header belongs to the given, unchanged source file
+	bool readHeader(BinaryCacheReader& reader, const std::string& vfsPath, boost::uint32_t type,
+					boost::uint64_t sourceSize, boost::uint64_t sourceStamp)
+	{
+		if (reader.read<boost::uint32_t>() != CACHE_MAGIC ||
+			reader.read<boost::uint32_t>() != CACHE_VERSION ||
+			reader.read<boost::uint32_t>() != type)
+		{
+			return false;
+		}
+
+		std::vector<boost::uint32_t> layout;
+		reader.readArray(layout);
+
+		if (layout != getLayout() || reader.readString() != vfsPath)
+		{
+			return false;
+		}
+
+		return reader.read<boost::uint64_t>() == sourceSize &&
+			   reader.read<boost::uint64_t>() == sourceStamp;
+	}
+}
+
+MD5BinaryCache::MD5BinaryCache() :
+	_cachePath(module::GlobalModuleRegistry().getApplicationContext().getSettingsPath() + CACHE_FOLDER),
+	_hits(0),
+	_misses(0),
+	_writes(0)
+{}
+
+bool MD5BinaryCache::load(const std::string& vfsPath, SourceInfo& source, MD5Model& model)
+{
+	return loadEntry(vfsPath, TYPE_MESH, source, model);
+}
+
+bool MD5BinaryCache::load(const std::string& vfsPath, SourceInfo& source, MD5Anim& anim)
+{
+	return loadEntry(vfsPath, TYPE_ANIM, source, anim);
+}
+
+void MD5BinaryCache::save(const std::string& vfsPath, const SourceInfo& source, const MD5Model& model)
+{
+	saveEntry(vfsPath, TYPE_MESH, source, model);
+}
+
+void MD5BinaryCache::save(const std::string& vfsPath, const SourceInfo& source, const MD5Anim& anim)
+{
+	saveEntry(vfsPath, TYPE_ANIM, source, anim);
+}
+
+void MD5BinaryCache::printStatistics() const
+{
+	rMessage() << "[md5model] Binary cache: " << _hits << " hits, "
+		<< _misses << " misses, " << _writes << " entries written." << std::endl;
+}
+
+MD5BinaryCache& MD5BinaryCache::Instance()
+{
+	static MD5BinaryCache _instance;
+	return _instance;
+}
+
+std::string MD5BinaryCache::getCacheFilename(const std::string& vfsPath) const
+{
+	std::ostringstream filename;
+
+	filename << _cachePath << std::hex << std::setw(16) << std::setfill('0')
+		<< cache::hashBytes(cache::FNV_OFFSET, vfsPath.data(), vfsPath.size()) << CACHE_EXTENSION;
+
+	return filename.str();
+}
+
+template<typename T>
+bool MD5BinaryCache::loadEntry(const std::string& vfsPath, boost::uint32_t type,
+							   SourceInfo& source, T& object)
+{
+	if (!cache::getSourceInfo(vfsPath, source))
+	{
+		return false; // no source, let the caller deal with that
+	}
+
+	std::ifstream file(getCacheFilename(vfsPath).c_str(), std::ios::binary);
+
+	if (file)
+	{
+		// Load the whole entry at once, the arrays are copied as blocks from there
+		file.seekg(0, std::ios::end);
+		std::size_t size = static_cast<std::size_t>(file.tellg());
+		file.seekg(0, std::ios::beg);
+
+		std::vector<char> buffer(size);
+
+		if (size > 0 && file.read(&buffer[0], size))
+		{
+			try
+			{
+				BinaryCacheReader reader(&buffer[0], size);
+
+				if (readHeader(reader, vfsPath, type, source.size, source.stamp))
+				{
+					object.readFromCache(reader);
+
+					++_hits;
+					return true;
+				}
+			}
+			catch (BinaryCacheException& ex)
+			{
+				rWarning() << "[md5model] Ignoring damaged cache entry for " << vfsPath
+					<< ": " << ex.what() << std::endl;
+			}
+		}
+	}
+
+	++_misses;
+	return false;
+}
+
+template<typename T>
+void MD5BinaryCache::saveEntry(const std::string& vfsPath, boost::uint32_t type,
+							   const SourceInfo& source, const T& object)
+{
+	BinaryCacheWriter writer;
+
+	writeHeader(writer, vfsPath, type, source.size, source.stamp);
+	object.writeToCache(writer);
+
+	std::string filename = getCacheFilename(vfsPath);
+
+	try
+	{
+		fs::create_directories(_cachePath);
+
+		// A half-written entry must never be picked up
+		cache::AtomicFileWriter file(filename, std::ios::binary);
+
+		const std::vector<char>& buffer = writer.getBuffer();
+		file.getStream().write(&buffer[0], buffer.size());
+
+		file.commit();
+
+		++_writes;
+	}
+	catch (std::runtime_error& ex)
+	{
+		rWarning() << "[md5model] Could not write cache file " << filename
+			<< ": " << ex.what() << std::endl;
+	}
+}
+
+} // namespace
@@ -0,0 +1,203 @@
+#pragma once
+
+#include "cachelib.h"
+
+#include <string>
+#include <vector>
+#include <cstring>
+#include <stdexcept>
+#include <boost/cstdint.hpp>
+#include <boost/noncopyable.hpp>
+
+namespace md5
+{
+
+class MD5Model;
+class MD5Anim;
+
+/**
+ * Thrown by the BinaryCacheReader if a cache entry is truncated or otherwise
+ * doesn't match the expected structure.
+ */
+class BinaryCacheException :
+	public std::runtime_error
+{
+public:
+	BinaryCacheException(const std::string& what) :
+		std::runtime_error(what)
+	{}
+};
+
+/**
+ * Serialises values and arrays into a memory buffer. Arrays of plain
+ * structures are written as a single block in their in-memory layout.
+ */
+class BinaryCacheWriter
+{
+	std::vector<char> _buffer;
+
+public:
+	template<typename T>
+	void write(const T& value)
+	{
+		writeData(&value, sizeof(T));
+	}
+
+	void writeString(const std::string& str)
+	{
+		write(static_cast<boost::uint32_t>(str.size()));
+		writeData(str.data(), str.size());
+	}
+
+	template<typename T>
+	void writeArray(const std::vector<T>& array)
+	{
+		write(static_cast<boost::uint32_t>(array.size()));
+
+		if (!array.empty())
+		{
+			writeData(&array[0], array.size() * sizeof(T));
+		}
+	}
+
+	const std::vector<char>& getBuffer() const
+	{
+		return _buffer;
+	}
+
+private:
+	void writeData(const void* data, std::size_t size)
+	{
+		const char* bytes = static_cast<const char*>(data);
+		_buffer.insert(_buffer.end(), bytes, bytes + size);
+	}
+};
+
+/**
+ * Reads back what a BinaryCacheWriter has produced. Throws a
+ * BinaryCacheException when reading beyond the end of the data.
+ */
+class BinaryCacheReader
+{
+	const char* _cur;
+	const char* _end;
+
+public:
+	BinaryCacheReader(const char* data, std::size_t size) :
+		_cur(data),
+		_end(data + size)
+	{}
+
+	template<typename T>
+	T read()
+	{
+		T value;
+		std::memcpy(&value, readData(sizeof(T)), sizeof(T));
+		return value;
+	}
+
+	std::string readString()
+	{
+		std::size_t size = read<boost::uint32_t>();
+		const char* data = readData(size);
+
+		return std::string(data, size);
+	}
+
+	template<typename T>
+	void readArray(std::vector<T>& array)
+	{
+		std::size_t count = read<boost::uint32_t>();
+
+		// Check the size before allocating anything
+		const char* data = readData(count * sizeof(T));
+
+		array.resize(count);
+
+		if (count > 0)
+		{
+			std::memcpy(&array[0], data, count * sizeof(T));
+		}
+	}
+
+	bool atEnd() const
+	{
+		return _cur == _end;
+	}
+
+private:
+	const char* readData(std::size_t size)
+	{
+		if (static_cast<std::size_t>(_end - _cur) < size)
+		{
+			throw BinaryCacheException("Unexpected end of cache data");
+		}
+
+		const char* data = _cur;
+		_cur += size;
+
+		return data;
+	}
+};
+
+/**
+ * A disk cache of parsed .md5mesh and .md5anim files, stored in the user's
+ * settings folder. Each entry is keyed by the VFS path of the source file
+ * and remembers its size and modification time (or a checksum of its
+ * contents for files inside PK4 archives), so changed sources are parsed
+ * again. Entries written by a different cache version or a build with a
+ * different structure layout are ignored.
+ */
+class MD5BinaryCache :
+	public boost::noncopyable
+{
+	// The folder holding the cache files
+	std::string _cachePath;
+
+	std::size_t _hits;
+	std::size_t _misses;
+	std::size_t _writes;
+
+public:
+	// Information about the source file, as stored in the entry header
+	typedef cache::SourceInfo SourceInfo;
+
+	MD5BinaryCache();
+
+	// Fills the given object from the cache, returns false on a cache miss.
+	// The source info is determined in either case, pass it to save() after
+	// parsing the file, files inside PK4s are checksummed only once that way.
+	bool load(const std::string& vfsPath, SourceInfo& source, MD5Model& model);
+	bool load(const std::string& vfsPath, SourceInfo& source, MD5Anim& anim);
+
+	// Stores the given (freshly parsed) object in the cache
+	void save(const std::string& vfsPath, const SourceInfo& source, const MD5Model& model);
+	void save(const std::string& vfsPath, const SourceInfo& source, const MD5Anim& anim);
+
+	std::size_t getNumHits() const
+	{
+		return _hits;
+	}
+
+	std::size_t getNumMisses() const
+	{
+		return _misses;
+	}
+
+	// Writes the number of hits, misses and writes to the log
+	void printStatistics() const;
+
+	static MD5BinaryCache& Instance();
+
+private:
+	std::string getCacheFilename(const std::string& vfsPath) const;
+
+	template<typename T>
+	bool loadEntry(const std::string& vfsPath, boost::uint32_t type, SourceInfo& source, T& object);
+
+	template<typename T>
+	void saveEntry(const std::string& vfsPath, boost::uint32_t type, const SourceInfo& source,
+				   const T& object);
+};
+
+} // namespace
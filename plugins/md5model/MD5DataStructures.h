@@ -3,6 +3,7 @@
 #include <vector>
 #include "math/Vector3.h"
 #include "math/Quaternion.h"
+#include "TriangleBVH.h"
 
 /** greebo: Some data structures used in MD5 model code
  */
@@ -85,6 +86,16 @@ struct MD5Mesh
 	MD5Verts	vertices;
 	MD5Tris		triangles;
 	MD5Weights	weights;
+
+	// The weights in single precision for skinning (see MD5Skinning.h): the
+	// position relative to the joint and the bias, packed in 4 floats per
+	// weight, and the joint index of each weight.
+	std::vector<float> skinWeights;
+	std::vector<unsigned int> skinJoints;
+
+	// Selection hierarchy for the default pose, built on first use.
+	// It is shared by all surfaces referencing this mesh.
+	TriangleBVHPtr defaultPoseBVH;
 };
 typedef boost::shared_ptr<MD5Mesh> MD5MeshPtr;
 
@@ -1,5 +1,7 @@
 #include "MD5Model.h"
 
+#include "iradiant.h"
+#include "ithread.h"
 #include "ivolumetest.h"
 #include "ishaders.h"
 #include "texturelib.h"
@@ -8,9 +10,38 @@
 #include "math/Quaternion.h"
 #include "math/Ray.h"
 #include "MD5DataStructures.h"
+#include "MD5SkinnedMeshCache.h"
+
+#include <boost/bind.hpp>
 
 namespace md5 {
 
+namespace
+{
+	// Below this number of vertices it's not worth waking up other threads
+	const std::size_t MIN_PARALLEL_SKINNING_VERTICES = 4096;
+
+	void createSurfacePose(const MD5Surface& surface, const JointMatrices& matrices,
+						   MD5SkinnedMeshPtr& pose)
+	{
+		pose = surface.createPose(matrices);
+	}
+
+	// Returns true and sets the frame index if the given time falls exactly
+	// onto a frame of the animation
+	bool getFrameAtTime(const IMD5AnimPtr& anim, std::size_t time, std::size_t& frame)
+	{
+		if (anim->getFrameRate() <= 0 || anim->getNumFrames() == 0) return false;
+
+		std::size_t scaledTime = time * anim->getFrameRate();
+
+		if (scaledTime % 1000 != 0) return false;
+
+		frame = (scaledTime / 1000) % anim->getNumFrames();
+		return true;
+	}
+}
+
 MD5Model::MD5Model() :
 	_polyCount(0),
 	_vertexCount(0),
@@ -35,9 +66,9 @@ MD5Model::MD5Model(const MD5Model& other) :
 
 		// Build the index array - this has to happen at least once
 		_surfaces[i].surface->buildIndexArray();
-		_surfaces[i].surface->updateToDefaultPose(_joints);
 	}
 
+	updateToDefaultPose();
 	updateMaterialList();
 }
 
@@ -260,9 +291,6 @@ void MD5Model::setRenderSystem(const RenderSystemPtr& renderSystem)
 
 void MD5Model::parseFromTokens(parser::DefTokeniser& tok)
 {
-	_vertexCount = 0;
-	_polyCount = 0;
-
 	// Check the version number
 	tok.assertNextToken("MD5Version");
 	tok.assertNextToken("10");
@@ -329,21 +357,65 @@ void MD5Model::parseFromTokens(parser::DefTokeniser& tok)
 		MD5Surface& surface = createNewSurface();
 
 		surface.parseFromTokens(tok);
+	}
+
+	initialiseSurfaces();
+}
+
+void MD5Model::writeToCache(BinaryCacheWriter& writer) const
+{
+	writer.writeArray(_joints);
+	writer.write(static_cast<boost::uint32_t>(_surfaces.size()));
+
+	for (SurfaceList::const_iterator i = _surfaces.begin(); i != _surfaces.end(); ++i)
+	{
+		i->surface->writeToCache(writer);
+	}
+}
+
+void MD5Model::readFromCache(BinaryCacheReader& reader)
+{
+	reader.readArray(_joints);
+
+	for (MD5Joints::const_iterator i = _joints.begin(); i != _joints.end(); ++i)
+	{
+		if (i->parent >= static_cast<int>(_joints.size()))
+		{
+			throw BinaryCacheException("Invalid joint parent");
+		}
+	}
+
+	std::size_t numMeshes = reader.read<boost::uint32_t>();
+
+	for (std::size_t i = 0; i < numMeshes; ++i)
+	{
+		createNewSurface().readFromCache(reader, _joints.size());
+	}
+
+	initialiseSurfaces();
+}
+
+void MD5Model::initialiseSurfaces()
+{
+	_vertexCount = 0;
+	_polyCount = 0;
+
+	for (SurfaceList::iterator i = _surfaces.begin(); i != _surfaces.end(); ++i)
+	{
+		MD5Surface& surface = *i->surface;
 
 		// Build the index array - this has to happen at least once
 		surface.buildIndexArray();
 
-		// Build the default vertex array
-		surface.updateToDefaultPose(joints);
-
 		// Update the vertexcount
-		_vertexCount += surface.getNumVertices();
+		_vertexCount += surface.getMesh()->vertices.size();
 
 		// Update the polycount
 		_polyCount += surface.getNumTriangles();
 	}
 
-	updateAABB();
+	// Build the default vertex arrays, this updates the AABB too
+	updateToDefaultPose();
 	updateMaterialList();
 }
 
@@ -365,10 +437,7 @@ void MD5Model::setAnim(const IMD5AnimPtr& anim)
 
 	if (!_anim)
 	{
-		for (SurfaceList::iterator i = _surfaces.begin(); i != _surfaces.end(); ++i)
-		{
-			i->surface->updateToDefaultPose(_joints);
-		}
+		updateToDefaultPose();
 	}
 }
 
@@ -384,10 +453,80 @@ void MD5Model::updateAnim(std::size_t time)
 	// Update our joint hierarchy first
 	_skeleton.update(_anim, time);
 
-	for (SurfaceList::iterator i = _surfaces.begin(); i != _surfaces.end(); ++i)
+	updatePose(_anim, time, _skeleton.getJointMatrices());
+}
+
+void MD5Model::updateToDefaultPose()
+{
+	JointMatrices matrices;
+
+	for (std::size_t i = 0; i < _joints.size(); ++i)
 	{
-		i->surface->updateToSkeleton(_skeleton);
+		setJointMatrix(matrices, i, _joints[i].rotation, _joints[i].position);
 	}
+
+	updatePose(IMD5AnimPtr(), 0, matrices);
+}
+
+void MD5Model::updatePose(const IMD5AnimPtr& anim, std::size_t time, const JointMatrices& matrices)
+{
+	MD5SkinnedMeshCache& cache = MD5SkinnedMeshCache::Instance();
+
+	// Poses between two frames are interpolated from the exact time, caching
+	// those would only push out the entries which are actually shared
+	std::size_t frame = 0;
+	bool cacheable = !anim || getFrameAtTime(anim, time, frame);
+
+	std::vector<MD5SkinnedMeshPtr> poses(_surfaces.size());
+	std::vector<bool> created(_surfaces.size(), false);
+
+	ThreadManager::Jobs jobs;
+	std::size_t numVertices = 0;
+
+	// Skin the surfaces which are not in the cache yet
+	for (std::size_t i = 0; i < _surfaces.size(); ++i)
+	{
+		const MD5Surface& surface = *_surfaces[i].surface;
+
+		if (cacheable)
+		{
+			poses[i] = cache.find(surface.getMesh(), anim, frame);
+		}
+
+		if (!poses[i])
+		{
+			created[i] = true;
+			numVertices += surface.getMesh()->vertices.size();
+
+			jobs.push_back(boost::bind(&createSurfacePose,
+				boost::cref(surface), boost::cref(matrices), boost::ref(poses[i])));
+		}
+	}
+
+	if (jobs.size() > 1 && numVertices >= MIN_PARALLEL_SKINNING_VERTICES)
+	{
+		GlobalRadiant().getThreadManager().executeAndWait(jobs);
+	}
+	else
+	{
+		for (ThreadManager::Jobs::const_iterator i = jobs.begin(); i != jobs.end(); ++i)
+		{
+			(*i)();
+		}
+	}
+
+	// The GL calls and the cache are only touched by the main thread
+	for (std::size_t i = 0; i < _surfaces.size(); ++i)
+	{
+		if (created[i] && cacheable)
+		{
+			cache.insert(_surfaces[i].surface->getMesh(), anim, frame, poses[i]);
+		}
+
+		_surfaces[i].surface->setPose(poses[i], !anim);
+	}
+
+	updateAABB();
 }
 
 } // namespace
@@ -7,6 +7,7 @@
 #include "parser/DefTokeniser.h"
 
 #include "MD5Surface.h"
+#include "MD5BinaryCache.h"
 #include "RenderableMD5Skeleton.h"
 
 namespace md5
@@ -92,6 +93,10 @@ public:
 	 */
 	void parseFromTokens(parser::DefTokeniser& tok);
 
+	// Binary cache serialisation, see MD5BinaryCache
+	void writeToCache(BinaryCacheWriter& writer) const;
+	void readFromCache(BinaryCacheReader& reader);
+
 	RenderableMD5Skeleton& getRenderableSkeleton()
 	{
 		return _renderableSkeleton;
@@ -163,6 +168,17 @@ private:
 	void updateMaterialList();
 
 	void captureShaders();
+
+	// Builds the index arrays and the default pose of freshly loaded surfaces
+	void initialiseSurfaces();
+
+	// Moves all surfaces to the pose defined by the joints in the .md5mesh file
+	void updateToDefaultPose();
+
+	// Moves all surfaces to the pose given by the joint matrices, re-using the
+	// geometry of other models in the same pose (anim and time) if possible.
+	// Pass an empty anim for the default pose.
+	void updatePose(const IMD5AnimPtr& anim, std::size_t time, const JointMatrices& matrices);
 };
 typedef boost::shared_ptr<MD5Model> MD5ModelPtr;
 
@@ -1,6 +1,7 @@
 #include "MD5ModelLoader.h"
 
 #include "imodule.h"
+#include "iradiant.h"
 #include "ishaders.h"
 #include "imodelcache.h"
 #include "ifilesystem.h"
@@ -9,6 +10,7 @@
 #include "os/path.h"
 
 #include "MD5ModelNode.h"
+#include "MD5BinaryCache.h"
 
 namespace md5
  {
@@ -71,6 +73,20 @@ model::IModelPtr MD5ModelLoader::loadModelFromPath(const std::string& name)
 		// Set the filename this model was loaded from
 		model->setFilename(os::getFilename(file->getName()));
 
+		MD5BinaryCache& cache = MD5BinaryCache::Instance();
+		MD5BinaryCache::SourceInfo source;
+
+		if (cache.load(name, source, *model))
+		{
+			return model;
+		}
+
+		// Not cached, start over with a clean model (the cache entry might
+		// have been loaded partially)
+		model.reset(new MD5Model);
+		model->setModelPath(name);
+		model->setFilename(os::getFilename(file->getName()));
+
 		// greebo: Get the Inputstream from the given file
 		BinaryToTextInputStream<InputStream> inputStream(file->getInputStream());
 
@@ -91,6 +107,8 @@ model::IModelPtr MD5ModelLoader::loadModelFromPath(const std::string& name)
 			return model::IModelPtr();
 		}
 
+		cache.save(name, source, *model);
+
 		// Load was successful, return the model
 		return model;
 	}
@@ -116,11 +134,17 @@ const StringSet& MD5ModelLoader::getDependencies() const
 		_dependencies.insert(MODULE_VIRTUALFILESYSTEM);
 		_dependencies.insert(MODULE_FILETYPES);
 		_dependencies.insert(MODULE_RENDERSYSTEM);
+		_dependencies.insert(MODULE_RADIANT);
 	}
 
 	return _dependencies;
 }
 
+void MD5ModelLoader::shutdownModule()
+{
+	MD5BinaryCache::Instance().printStatistics();
+}
+
 void MD5ModelLoader::initialiseModule(const ApplicationContext& ctx)
 {
 	rMessage() << "MD5Model::initialiseModule called." << std::endl;
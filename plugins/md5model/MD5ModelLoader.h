@@ -23,6 +23,7 @@ public:
 	virtual const std::string& getName() const;
 	virtual const StringSet& getDependencies() const;
 	virtual void initialiseModule(const ApplicationContext& ctx);
+	virtual void shutdownModule();
 };
 typedef boost::shared_ptr<MD5ModelLoader> MD5ModelLoaderPtr;
 
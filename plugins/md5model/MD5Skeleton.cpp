@@ -68,6 +68,7 @@ namespace
 void MD5Skeleton::update(const IMD5AnimPtr& anim, std::size_t time)
 {
 	_anim = anim;
+	_time = time;
 
 	// Update the joint positions, recursively, starting from the first
 	// Only root nodes need to be processed, the children are reached through them
@@ -178,6 +179,13 @@ void MD5Skeleton::update(const IMD5AnimPtr& anim, std::size_t time)
 			updateJointRecursively(i);
 		}
 	}
+
+	_matrices.resize(numJoints * JOINT_MATRIX_SIZE);
+
+	for (std::size_t i = 0; i < numJoints; ++i)
+	{
+		setJointMatrix(_matrices, i, _skeleton[i].orientation, _skeleton[i].origin);
+	}
 }
 
 void MD5Skeleton::updateJointRecursively(std::size_t jointId)
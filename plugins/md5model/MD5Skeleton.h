@@ -2,6 +2,7 @@
 
 #include <vector>
 #include "imd5anim.h"
+#include "MD5Skinning.h"
 
 namespace md5
 {
@@ -20,7 +21,17 @@ protected:
 	// The current animation, needed to get joint information etc.
 	IMD5AnimPtr _anim;
 
+	// The time passed to the last update() call
+	std::size_t _time;
+
+	// The joint transforms of the current pose, as needed for skinning
+	JointMatrices _matrices;
+
 public:
+	MD5Skeleton() :
+		_time(0)
+	{}
+
 	// Update the skeleton to match the given animation at the given time
 	void update(const IMD5AnimPtr& anim, std::size_t time);
 
@@ -39,6 +50,21 @@ public:
 		return _anim->getJoint(index);
 	}
 
+	const IMD5AnimPtr& getAnim() const
+	{
+		return _anim;
+	}
+
+	std::size_t getTime() const
+	{
+		return _time;
+	}
+
+	const JointMatrices& getJointMatrices() const
+	{
+		return _matrices;
+	}
+
 private:
 	void updateJointRecursively(std::size_t jointId);
 };
@@ -0,0 +1,72 @@
+#include "MD5SkinnedMeshCache.h"
+
+namespace md5
+{
+
+namespace
+{
+	// Enough for a few dozen distinct poses of detailed AI meshes
+	const std::size_t MAX_MEMORY_USAGE = 64 * 1024 * 1024;
+}
+
+MD5SkinnedMeshCache::MD5SkinnedMeshCache() :
+	_memoryUsage(0)
+{}
+
+MD5SkinnedMeshPtr MD5SkinnedMeshCache::find(const MD5MeshPtr& mesh,
+	const IMD5AnimPtr& anim, std::size_t frame) const
+{
+	Key key;
+	key.mesh = mesh;
+	key.anim = anim;
+	key.frame = frame;
+
+	Entries::const_iterator found = _entries.find(key);
+
+	return found != _entries.end() ? found->second : MD5SkinnedMeshPtr();
+}
+
+void MD5SkinnedMeshCache::insert(const MD5MeshPtr& mesh, const IMD5AnimPtr& anim,
+	std::size_t frame, const MD5SkinnedMeshPtr& skinned)
+{
+	Key key;
+	key.mesh = mesh;
+	key.anim = anim;
+	key.frame = frame;
+
+	std::pair<Entries::iterator, bool> result = _entries.insert(Entries::value_type(key, skinned));
+
+	if (!result.second) return; // already cached
+
+	_order.push_back(result.first);
+	_memoryUsage += getMemoryUsage(*skinned);
+
+	// Drop the oldest entries, but keep the one just inserted
+	while (_memoryUsage > MAX_MEMORY_USAGE && _order.size() > 1)
+	{
+		_memoryUsage -= getMemoryUsage(*_order.front()->second);
+
+		_entries.erase(_order.front());
+		_order.pop_front();
+	}
+}
+
+void MD5SkinnedMeshCache::clear()
+{
+	_order.clear();
+	_entries.clear();
+	_memoryUsage = 0;
+}
+
+MD5SkinnedMeshCache& MD5SkinnedMeshCache::Instance()
+{
+	static MD5SkinnedMeshCache _instance;
+	return _instance;
+}
+
+std::size_t MD5SkinnedMeshCache::getMemoryUsage(const MD5SkinnedMesh& skinned)
+{
+	return sizeof(MD5SkinnedMesh) + skinned.vertices.capacity() * sizeof(ArbitraryMeshVertex);
+}
+
+} // namespace
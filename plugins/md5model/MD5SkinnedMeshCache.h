@@ -0,0 +1,82 @@
+#pragma once
+
+#include <map>
+#include <deque>
+#include <boost/noncopyable.hpp>
+
+#include "imd5anim.h"
+#include "render.h"
+#include "math/AABB.h"
+#include "MD5DataStructures.h"
+
+namespace md5
+{
+
+/**
+ * The geometry of an MD5 mesh in a given pose, including normals and
+ * tangents. Once created, it is shared by all surfaces in the same pose
+ * and must not be modified anymore.
+ */
+struct MD5SkinnedMesh
+{
+	std::vector<ArbitraryMeshVertex> vertices;
+	AABB bounds;
+};
+typedef boost::shared_ptr<MD5SkinnedMesh> MD5SkinnedMeshPtr;
+
+/**
+ * Keeps the most recently created skinned meshes, indexed by the mesh, the
+ * animation and the frame. Entities showing the same frame of the same
+ * animation share a single copy of the deformed vertices, and don't need
+ * to skin them again. The default pose of a mesh is stored with an empty
+ * animation and frame 0. Poses interpolated between two frames are not
+ * cached, they are rarely seen twice.
+ *
+ * Older entries are dropped once the cache exceeds its memory budget. The
+ * cache is only accessed from the main thread.
+ */
+class MD5SkinnedMeshCache :
+	public boost::noncopyable
+{
+	struct Key
+	{
+		// Keep mesh and anim alive, their addresses must not be reused
+		MD5MeshPtr mesh;
+		IMD5AnimPtr anim;
+		std::size_t frame;
+
+		bool operator<(const Key& other) const
+		{
+			if (mesh != other.mesh) return mesh < other.mesh;
+			if (anim != other.anim) return anim < other.anim;
+			return frame < other.frame;
+		}
+	};
+
+	typedef std::map<Key, MD5SkinnedMeshPtr> Entries;
+	Entries _entries;
+
+	// Entries in insertion order, the oldest ones are dropped first
+	std::deque<Entries::iterator> _order;
+
+	// The approximate size of all cached meshes in bytes
+	std::size_t _memoryUsage;
+
+public:
+	MD5SkinnedMeshCache();
+
+	// Returns the cached pose or an empty pointer
+	MD5SkinnedMeshPtr find(const MD5MeshPtr& mesh, const IMD5AnimPtr& anim, std::size_t frame) const;
+
+	void insert(const MD5MeshPtr& mesh, const IMD5AnimPtr& anim, std::size_t frame,
+				const MD5SkinnedMeshPtr& skinned);
+
+	void clear();
+
+	static MD5SkinnedMeshCache& Instance();
+
+private:
+	static std::size_t getMemoryUsage(const MD5SkinnedMesh& skinned);
+};
+
+} // namespace
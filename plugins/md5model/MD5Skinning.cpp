@@ -0,0 +1,126 @@
+#include "MD5Skinning.h"
+
+#if defined(__SSE__) || defined(_M_X64) || (defined(_M_IX86_FP) && _M_IX86_FP >= 1)
+	#define MD5_SKINNING_SSE
+	#include <xmmintrin.h>
+#endif
+
+namespace md5
+{
+
+void setJointMatrix(JointMatrices& matrices, std::size_t joint,
+					const Quaternion& orientation, const Vector3& origin)
+{
+	if (matrices.size() < (joint + 1) * JOINT_MATRIX_SIZE)
+	{
+		matrices.resize((joint + 1) * JOINT_MATRIX_SIZE);
+	}
+
+	float* m = &matrices[joint * JOINT_MATRIX_SIZE];
+
+	// The rotation is linear, its columns are the rotated unit vectors
+	Vector3 axes[4] = {
+		orientation.transformPoint(Vector3(1, 0, 0)),
+		orientation.transformPoint(Vector3(0, 1, 0)),
+		orientation.transformPoint(Vector3(0, 0, 1)),
+		origin
+	};
+
+	for (std::size_t i = 0; i < 4; ++i)
+	{
+		m[i*4 + 0] = static_cast<float>(axes[i].x());
+		m[i*4 + 1] = static_cast<float>(axes[i].y());
+		m[i*4 + 2] = static_cast<float>(axes[i].z());
+		m[i*4 + 3] = 0;
+	}
+}
+
+void prepareSkinWeights(MD5Mesh& mesh)
+{
+	mesh.skinWeights.resize(mesh.weights.size() * 4);
+	mesh.skinJoints.resize(mesh.weights.size());
+
+	for (std::size_t i = 0; i < mesh.weights.size(); ++i)
+	{
+		const MD5Weight& weight = mesh.weights[i];
+
+		mesh.skinWeights[i*4 + 0] = static_cast<float>(weight.v.x());
+		mesh.skinWeights[i*4 + 1] = static_cast<float>(weight.v.y());
+		mesh.skinWeights[i*4 + 2] = static_cast<float>(weight.v.z());
+		mesh.skinWeights[i*4 + 3] = weight.t;
+
+		mesh.skinJoints[i] = static_cast<unsigned int>(weight.joint);
+	}
+}
+
+void skinVertices(const MD5Mesh& mesh, const JointMatrices& matrices,
+				  std::vector<ArbitraryMeshVertex>& vertices)
+{
+	vertices.resize(mesh.vertices.size());
+
+	if (mesh.skinWeights.empty() || matrices.empty()) return;
+
+	// Weights referring to joints the skeleton doesn't have are ignored
+	std::size_t numJoints = matrices.size() / JOINT_MATRIX_SIZE;
+
+	const float* weights = &mesh.skinWeights[0];
+	const unsigned int* joints = &mesh.skinJoints[0];
+	const float* jointMatrices = &matrices[0];
+
+	for (std::size_t j = 0; j < mesh.vertices.size(); ++j)
+	{
+		const MD5Vert& vert = mesh.vertices[j];
+
+		std::size_t first = vert.weight_index;
+		std::size_t last = vert.weight_index + vert.weight_count;
+
+		// Sum up (rotation * v + origin) * t over all weights of this vertex
+		float skinned[4];
+
+#ifdef MD5_SKINNING_SSE
+		__m128 sum = _mm_setzero_ps();
+
+		for (std::size_t k = first; k < last; ++k)
+		{
+			if (joints[k] >= numJoints) continue;
+
+			const float* w = weights + k*4;
+			const float* m = jointMatrices + joints[k] * JOINT_MATRIX_SIZE;
+
+			__m128 point = _mm_add_ps(
+				_mm_add_ps(_mm_mul_ps(_mm_loadu_ps(m), _mm_set1_ps(w[0])),
+						   _mm_mul_ps(_mm_loadu_ps(m + 4), _mm_set1_ps(w[1]))),
+				_mm_add_ps(_mm_mul_ps(_mm_loadu_ps(m + 8), _mm_set1_ps(w[2])),
+						   _mm_loadu_ps(m + 12))
+			);
+
+			sum = _mm_add_ps(sum, _mm_mul_ps(point, _mm_set1_ps(w[3])));
+		}
+
+		_mm_storeu_ps(skinned, sum);
+#else
+		skinned[0] = skinned[1] = skinned[2] = 0;
+
+		for (std::size_t k = first; k < last; ++k)
+		{
+			if (joints[k] >= numJoints) continue;
+
+			const float* w = weights + k*4;
+			const float* m = jointMatrices + joints[k] * JOINT_MATRIX_SIZE;
+
+			for (std::size_t c = 0; c < 3; ++c)
+			{
+				skinned[c] += (m[c] * w[0] + m[4 + c] * w[1] + m[8 + c] * w[2] + m[12 + c]) * w[3];
+			}
+		}
+#endif
+
+		ArbitraryMeshVertex& vertex = vertices[j];
+
+		vertex.vertex = Vertex3f(skinned[0], skinned[1], skinned[2]);
+		vertex.texcoord = TexCoord2f(vert.u, vert.v);
+		vertex.normal = Normal3f(0, 0, 0);
+	}
+}
+
+} // namespace
@@ -0,0 +1,39 @@
+#pragma once
+
+#include <vector>
+#include "render.h"
+#include "MD5DataStructures.h"
+
+namespace md5
+{
+
+/**
+ * The transforms of a joint hierarchy in single precision, as used by the
+ * skinning routines. Each joint occupies 16 floats, holding the rotated
+ * x, y and z axes followed by the translation (4 floats each, the last
+ * component is unused).
+ */
+typedef std::vector<float> JointMatrices;
+
+// Number of floats per joint in a JointMatrices array
+const std::size_t JOINT_MATRIX_SIZE = 16;
+
+// Stores the transform given by the orientation and origin at the given joint index
+void setJointMatrix(JointMatrices& matrices, std::size_t joint,
+					const Quaternion& orientation, const Vector3& origin);
+
+/**
+ * Rearranges the weights of the given mesh into MD5Mesh::skinWeights and
+ * MD5Mesh::skinJoints. Needs to be called once after the mesh is loaded.
+ */
+void prepareSkinWeights(MD5Mesh& mesh);
+
+/**
+ * Calculates the vertex positions and texture coordinates of the mesh deformed
+ * by the given joints. The vertex array is resized to the number of mesh
+ * vertices, normals are reset to zero. Uses SSE if available.
+ */
+void skinVertices(const MD5Mesh& mesh, const JointMatrices& matrices,
+				  std::vector<ArbitraryMeshVertex>& vertices);
+
+} // namespace
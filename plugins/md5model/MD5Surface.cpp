@@ -18,16 +18,19 @@ inline VertexPointer vertexpointer_arbitrarymeshvertex(const ArbitraryMeshVertex
 MD5Surface::MD5Surface() : 
 	_originalShaderName(""),
 	_mesh(new MD5Mesh),
+	_pose(new MD5SkinnedMesh),
 	_normalList(0),
-	_lightingList(0)
+	_lightingList(0),
+	_inDefaultPose(false)
 {}
 
 MD5Surface::MD5Surface(const MD5Surface& other) :
-	_aabb_local(other._aabb_local),
 	_originalShaderName(other._originalShaderName),
 	_mesh(other._mesh),
+	_pose(other._pose),
 	_normalList(0),
-	_lightingList(0)
+	_lightingList(0),
+	_inDefaultPose(false)
 {}
 
 // Destructor
@@ -38,37 +41,60 @@ MD5Surface::~MD5Surface()
 	glDeleteLists(_lightingList, 1);
 }
 
-// Update geometry
-void MD5Surface::updateGeometry()
+const MD5MeshPtr& MD5Surface::getMesh() const
 {
-	_aabb_local = AABB();
+	return _mesh;
+}
+
+MD5SkinnedMeshPtr MD5Surface::createPose(const JointMatrices& matrices) const
+{
+	MD5SkinnedMeshPtr pose(new MD5SkinnedMesh);
+
+	skinVertices(*_mesh, matrices, pose->vertices);
 
-	for (Vertices::const_iterator i = _vertices.begin(); i != _vertices.end(); ++i)
+	buildVertexNormals(pose->vertices);
+	buildTangents(pose->vertices);
+
+	for (Vertices::const_iterator i = pose->vertices.begin(); i != pose->vertices.end(); ++i)
 	{
-		_aabb_local.includePoint(i->vertex);
+		pose->bounds.includePoint(i->vertex);
 	}
 
-	for (Indices::iterator i = _indices.begin();
+	return pose;
+}
+
+void MD5Surface::setPose(const MD5SkinnedMeshPtr& pose, bool defaultPose)
+{
+	_pose = pose;
+	_inDefaultPose = defaultPose;
+
+	// Vertices have changed, the hierarchy needs to be rebuilt (or re-acquired)
+	_bvh.reset();
+
+	// Build the display lists
+	createDisplayLists();
+}
+
+void MD5Surface::buildTangents(Vertices& vertices) const
+{
+	for (Indices::const_iterator i = _indices.begin();
 		 i != _indices.end();
 		 i += 3)
 	{
-		ArbitraryMeshVertex& a = _vertices[*(i + 0)];
-		ArbitraryMeshVertex& b = _vertices[*(i + 1)];
-		ArbitraryMeshVertex& c = _vertices[*(i + 2)];
+		ArbitraryMeshVertex& a = vertices[*(i + 0)];
+		ArbitraryMeshVertex& b = vertices[*(i + 1)];
+		ArbitraryMeshVertex& c = vertices[*(i + 2)];
 
 		ArbitraryMeshTriangle_sumTangents(a, b, c);
 	}
 
-	for (Vertices::iterator i = _vertices.begin();
-		 i != _vertices.end();
+	for (Vertices::iterator i = vertices.begin();
+		 i != vertices.end();
 		 ++i)
 	{
 		i->tangent.normalise();
 		i->bitangent.normalise();
 	}
-
-	// Build the display lists
-	createDisplayLists();
 }
 
 // Back-end render
@@ -87,6 +113,19 @@ void MD5Surface::render(const RenderInfo& info) const
 // Construct the display lists
 void MD5Surface::createDisplayLists()
 {
+	// Release the lists of the previous pose
+	if (_lightingList != 0)
+	{
+		glDeleteLists(_lightingList, 1);
+	}
+
+	if (_normalList != 0)
+	{
+		glDeleteLists(_normalList, 1);
+	}
+
+	const Vertices& vertices = _pose->vertices;
+
 	// Create the list for lighting mode
 	_lightingList = glGenLists(1);
 	assert(_lightingList != 0);
@@ -98,7 +137,7 @@ void MD5Surface::createDisplayLists()
 		 ++i)
 	{
 		// Get the vertex for this index
-		ArbitraryMeshVertex& v = _vertices[*i];
+		const ArbitraryMeshVertex& v = vertices[*i];
 
 		// Submit the vertex attributes and coordinate
 		if (GLEW_ARB_vertex_program) {
@@ -125,7 +164,7 @@ void MD5Surface::createDisplayLists()
 		 ++i)
 	{
 		// Get the vertex for this index
-		ArbitraryMeshVertex& v = _vertices[*i];
+		const ArbitraryMeshVertex& v = vertices[*i];
 
 		// Submit attributes
 		glNormal3dv(v.normal);
@@ -137,18 +176,45 @@ void MD5Surface::createDisplayLists()
 	glEndList();
 }
 
+const TriangleBVH& MD5Surface::getBVH()
+{
+	if (!_bvh)
+	{
+		if (_inDefaultPose && _mesh->defaultPoseBVH)
+		{
+			_bvh = _mesh->defaultPoseBVH;
+		}
+		else
+		{
+			_bvh.reset(new TriangleBVH(
+				vertexpointer_arbitrarymeshvertex(_pose->vertices.data()),
+				IndexPointer(_indices.data(), IndexPointer::index_type(_indices.size()))
+			));
+
+			if (_inDefaultPose)
+			{
+				_mesh->defaultPoseBVH = _bvh;
+			}
+		}
+	}
+
+	return *_bvh;
+}
+
 // Selection test
 void MD5Surface::testSelect(Selector& selector,
 							SelectionTest& test,
 							const Matrix4& localToWorld)
 {
+	if (_pose->vertices.empty() || _indices.empty()) return;
+
 	test.BeginMesh(localToWorld);
 
 	SelectionIntersection best;
-	test.TestTriangles(
-	  vertexpointer_arbitrarymeshvertex(_vertices.data()),
-	  IndexPointer(_indices.data(), IndexPointer::index_type(_indices.size())),
-	  best
+	getBVH().testSelect(test,
+		vertexpointer_arbitrarymeshvertex(_pose->vertices.data()),
+		localToWorld,
+		best
 	);
 
 	if(best.valid()) {
@@ -158,43 +224,22 @@ void MD5Surface::testSelect(Selector& selector,
 
 bool MD5Surface::getIntersection(const Ray& ray, Vector3& intersection, const Matrix4& localToWorld)
 {
-	Vector3 bestIntersection = ray.origin;
-	Vector3 triIntersection;
+	if (_pose->vertices.empty() || _indices.empty()) return false;
 
-	for (Indices::const_iterator i = _indices.begin();
-		 i != _indices.end();
-		 i += 3)
-	{
-		// Get the vertices for this triangle
-		const ArbitraryMeshVertex& p1 = _vertices[*(i)];
-		const ArbitraryMeshVertex& p2 = _vertices[*(i+1)];
-		const ArbitraryMeshVertex& p3 = _vertices[*(i+2)];
+	// Trace in object space using the triangle hierarchy
+	Ray localRay(ray);
+	localRay.transform(localToWorld.getFullInverse());
 
-		if (ray.intersectTriangle(localToWorld.transformPoint(p1.vertex), 
-			localToWorld.transformPoint(p2.vertex), localToWorld.transformPoint(p3.vertex), triIntersection))
-		{
-			intersection = triIntersection;
-			
-			// Test if this surface intersection is better than what we currently have
-			float oldDistSquared = (bestIntersection - ray.origin).getLengthSquared();
-			float newDistSquared = (triIntersection - ray.origin).getLengthSquared();
+	Vector3 localIntersection;
 
-			if ((oldDistSquared == 0 && newDistSquared > 0) || newDistSquared < oldDistSquared)
-			{
-				bestIntersection = triIntersection;
-			}
-		}
-	}
-
-	if ((bestIntersection - ray.origin).getLengthSquared() > 0)
+	if (getBVH().getIntersection(localRay,
+		vertexpointer_arbitrarymeshvertex(_pose->vertices.data()), localIntersection))
 	{
-		intersection = bestIntersection;
+		intersection = localToWorld.transformPoint(localIntersection);
 		return true;
 	}
-	else
-	{
-		return false;
-	}
+
+	return false;
 }
 
 void MD5Surface::setDefaultMaterial(const std::string& name)
@@ -203,7 +248,7 @@ void MD5Surface::setDefaultMaterial(const std::string& name)
 }
 
 const AABB& MD5Surface::localAABB() const {
-	return _aabb_local;
+	return _pose->bounds;
 }
 
 void MD5Surface::render(RenderableCollector& collector, const Matrix4& localToWorld, 
@@ -217,7 +262,7 @@ void MD5Surface::render(RenderableCollector& collector, const Matrix4& localToWo
 
 int MD5Surface::getNumVertices() const
 {
-	return static_cast<int>(_vertices.size());
+	return static_cast<int>(_pose->vertices.size());
 }
 
 int MD5Surface::getNumTriangles() const
@@ -227,8 +272,8 @@ int MD5Surface::getNumTriangles() const
 
 const ArbitraryMeshVertex& MD5Surface::getVertex(int vertexIndex) const
 {
-	assert(vertexIndex >= 0 && vertexIndex < static_cast<int>(_vertices.size()));
-	return _vertices[vertexIndex];
+	assert(vertexIndex >= 0 && vertexIndex < static_cast<int>(_pose->vertices.size()));
+	return _pose->vertices[vertexIndex];
 }
 
 model::ModelPolygon MD5Surface::getPolygon(int polygonIndex) const
@@ -237,9 +282,11 @@ model::ModelPolygon MD5Surface::getPolygon(int polygonIndex) const
 
 	model::ModelPolygon poly;
 
-	poly.a = _vertices[_indices[polygonIndex*3]];
-	poly.b = _vertices[_indices[polygonIndex*3 + 1]];
-	poly.c = _vertices[_indices[polygonIndex*3 + 2]];
+	const Vertices& vertices = _pose->vertices;
+
+	poly.a = vertices[_indices[polygonIndex*3]];
+	poly.b = vertices[_indices[polygonIndex*3 + 1]];
+	poly.c = vertices[_indices[polygonIndex*3 + 2]];
 
 	return poly;
 }
@@ -249,92 +296,13 @@ const std::string& MD5Surface::getDefaultMaterial() const
 	return _originalShaderName;
 }
 
-void MD5Surface::updateToDefaultPose(const MD5Joints& joints)
-{
-	if (_vertices.size() != _mesh->vertices.size())
-	{
-		_vertices.resize(_mesh->vertices.size());
-	}
-
-	for (std::size_t j = 0; j < _mesh->vertices.size(); ++j)
-	{
-		MD5Vert& vert = _mesh->vertices[j];
-
-		Vector3 skinned(0, 0, 0);
-
-		for (std::size_t k = 0; k != vert.weight_count; ++k)
-		{
-			MD5Weight& weight = _mesh->weights[vert.weight_index + k];
-			const MD5Joint& joint = joints[weight.joint];
-
-			Vector3 rotatedPoint = joint.rotation.transformPoint(weight.v);
-			skinned += (rotatedPoint + joint.position) * weight.t;
-		}
-
-		_vertices[j].vertex = skinned;
-		_vertices[j].texcoord = TexCoord2f(vert.u, vert.v);
-		_vertices[j].normal = Normal3f(0,0,0);
-	}
-
-	// Ensure the index array is ok
-	if (_indices.empty())
-	{
-		buildIndexArray();
-	}
-
-	buildVertexNormals();
-
-	updateGeometry();
-}
-
-void MD5Surface::updateToSkeleton(const MD5Skeleton& skeleton)
+void MD5Surface::buildVertexNormals(Vertices& vertices) const
 {
-	// Ensure we have all vertices allocated
-	if (_vertices.size() != _mesh->vertices.size())
+	for (Indices::const_iterator j = _indices.begin(); j != _indices.end(); j += 3)
 	{
-		_vertices.resize(_mesh->vertices.size());
-	}
-
-	// Deform vertices to fit the skeleton
-	for (std::size_t j = 0; j < _mesh->vertices.size(); ++j)
-	{
-		MD5Vert& vert = _mesh->vertices[j];
-
-		Vector3 skinned(0, 0, 0);
-
-		for (std::size_t k = 0; k != vert.weight_count; ++k)
-		{
-			MD5Weight& weight = _mesh->weights[vert.weight_index + k];
-			const IMD5Anim::Key& key = skeleton.getKey(weight.joint);
-			//const Joint& joint = skeleton.getJoint(weight.joint);
-
-			Vector3 rotatedPoint = key.orientation.transformPoint(weight.v);
-			skinned += (rotatedPoint + key.origin) * weight.t;
-		}
-
-		_vertices[j].vertex = skinned;
-		_vertices[j].texcoord = TexCoord2f(vert.u, vert.v);
-		_vertices[j].normal = Normal3f(0,0,0);
-	}
-
-	// Ensure the index array is ok
-	if (_indices.empty())
-	{
-		buildIndexArray();
-	}
-
-	buildVertexNormals();
-
-	updateGeometry();
-}
-
-void MD5Surface::buildVertexNormals()
-{
-	for (Indices::iterator j = _indices.begin(); j != _indices.end(); j += 3)
-	{
-		ArbitraryMeshVertex& a = _vertices[*(j + 0)];
-		ArbitraryMeshVertex& b = _vertices[*(j + 1)];
-		ArbitraryMeshVertex& c = _vertices[*(j + 2)];
+		ArbitraryMeshVertex& a = vertices[*(j + 0)];
+		ArbitraryMeshVertex& b = vertices[*(j + 1)];
+		ArbitraryMeshVertex& c = vertices[*(j + 2)];
 
 		Vector3 weightedNormal((c.vertex - a.vertex).crossProduct(b.vertex - a.vertex));
 
@@ -344,7 +312,7 @@ void MD5Surface::buildVertexNormals()
 	}
 
 	// Normalise all normal vectors
-	for (Vertices::iterator j = _vertices.begin(); j != _vertices.end(); ++j)
+	for (Vertices::iterator j = vertices.begin(); j != vertices.end(); ++j)
 	{
 		j->normal = Normal3f(j->normal.getNormalised());
 	}
@@ -459,6 +427,57 @@ void MD5Surface::parseFromTokens(parser::DefTokeniser& tok)
 	// ----- END OF MESH DECL -----
 
 	tok.assertNextToken("}");
+
+	// Arrange the weights for skinning
+	prepareSkinWeights(mesh);
+}
+
+void MD5Surface::writeToCache(BinaryCacheWriter& writer) const
+{
+	writer.writeString(_originalShaderName);
+
+	writer.writeArray(_mesh->vertices);
+	writer.writeArray(_mesh->triangles);
+	writer.writeArray(_mesh->weights);
+}
+
+void MD5Surface::readFromCache(BinaryCacheReader& reader, std::size_t numJoints)
+{
+	setDefaultMaterial(reader.readString());
+
+	reader.readArray(_mesh->vertices);
+	reader.readArray(_mesh->triangles);
+	reader.readArray(_mesh->weights);
+
+	// The indices are used without further checks, a damaged cache
+	// must not send them out of bounds
+	for (MD5Verts::const_iterator v = _mesh->vertices.begin(); v != _mesh->vertices.end(); ++v)
+	{
+		if (v->weight_index > _mesh->weights.size() ||
+			v->weight_count > _mesh->weights.size() - v->weight_index)
+		{
+			throw BinaryCacheException("Invalid vertex weights");
+		}
+	}
+
+	for (MD5Tris::const_iterator t = _mesh->triangles.begin(); t != _mesh->triangles.end(); ++t)
+	{
+		if (t->a >= _mesh->vertices.size() || t->b >= _mesh->vertices.size() ||
+			t->c >= _mesh->vertices.size())
+		{
+			throw BinaryCacheException("Invalid triangle vertex");
+		}
+	}
+
+	for (MD5Weights::const_iterator w = _mesh->weights.begin(); w != _mesh->weights.end(); ++w)
+	{
+		if (w->joint >= numJoints)
+		{
+			throw BinaryCacheException("Invalid weight joint");
+		}
+	}
+
+	prepareSkinWeights(*_mesh);
 }
 
 } // namespace md5
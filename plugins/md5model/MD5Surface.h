@@ -10,6 +10,9 @@
 #include "imodelsurface.h"
 
 #include "MD5DataStructures.h"
+#include "MD5Skinning.h"
+#include "MD5SkinnedMeshCache.h"
+#include "MD5BinaryCache.h"
 #include "parser/DefTokeniser.h"
 
 class Ray;
@@ -17,8 +20,6 @@ class Ray;
 namespace md5
 {
 
-class MD5Skeleton;
-
 class MD5Surface :
 	public model::IModelSurface,
 	public OpenGLRenderable
@@ -28,8 +29,6 @@ public:
 	typedef IndexBuffer Indices;
 
 private:
-	AABB _aabb_local;
-
 	// Shader name
 	std::string _originalShaderName;
 
@@ -37,21 +36,32 @@ private:
 	// Several MD5Surfaces can share the same mesh
 	MD5MeshPtr _mesh;
 
-	// Our render data
-	Vertices _vertices;
+	// Our render data, the vertices are shared with all surfaces in the same pose
+	MD5SkinnedMeshPtr _pose;
 	Indices _indices;
 
 	// The GL display lists for this surface's geometry
 	GLuint _normalList;
 	GLuint _lightingList;
 
+	// Whether the vertices are matching the mesh's default pose
+	bool _inDefaultPose;
+
+	// Triangle hierarchy used for selection tests, built on demand
+	TriangleBVHPtr _bvh;
+
 private:
 
 	// Create the display lists
 	void createDisplayLists();
 
-	// Re-calculate the normal vectors
-	void buildVertexNormals();
+	// Calculate the normal and tangent vectors of the given skinned vertices
+	void buildVertexNormals(Vertices& vertices) const;
+	void buildTangents(Vertices& vertices) const;
+
+	// Returns the triangle hierarchy matching the current vertices. Surfaces
+	// in their default pose share the one stored in the MD5Mesh.
+	const TriangleBVH& getBVH();
 
 public:
 
@@ -73,17 +83,20 @@ public:
 	// Set/get the shader name
 	void setDefaultMaterial(const std::string& name);
 	
+	const MD5MeshPtr& getMesh() const;
+
 	/**
-	 * Calculate the AABB and build the display lists for rendering.
+	 * Deforms the mesh by the given joints and returns the resulting geometry
+	 * including normals, tangents and bounds. Doesn't change this surface and
+	 * may be called from any thread, as long as the index array is built.
 	 */
-	void updateGeometry();
-
-	// Updates the mesh to the pose defined in the .md5mesh file - usually a T-Pose
-	// It needs the joints defined in that file as reference
-	void updateToDefaultPose(const MD5Joints& joints);
+	MD5SkinnedMeshPtr createPose(const JointMatrices& matrices) const;
 
-	// Updates this mesh to the state of the given skeleton
-	void updateToSkeleton(const MD5Skeleton& skeleton);
+	/**
+	 * Switches this surface to the given geometry and rebuilds the display lists.
+	 * The default pose is the one defined in the .md5mesh file, usually a T-Pose.
+	 */
+	void setPose(const MD5SkinnedMeshPtr& pose, bool defaultPose);
 
 	// Applies the given Skin to this surface.
 	void applySkin(const ModelSkin& skin);
@@ -116,6 +129,11 @@ public:
 
 	void parseFromTokens(parser::DefTokeniser& tok);
 
+	// Binary cache serialisation of the mesh data, see MD5BinaryCache. The
+	// weights read from the cache have to refer to one of the model's joints.
+	void writeToCache(BinaryCacheWriter& writer) const;
+	void readFromCache(BinaryCacheReader& reader, std::size_t numJoints);
+
 	// Rebuild the render index array - usually needs to be called only once
 	void buildIndexArray();
 };
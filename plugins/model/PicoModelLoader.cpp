@@ -13,6 +13,7 @@
 
 #include "idatastream.h"
 #include <boost/algorithm/string/case_conv.hpp>
+#include <glibmm/thread.h>
 
 namespace model {
 
@@ -27,6 +28,27 @@ namespace {
 	size_t picoInputStreamReam(void* inputStream, unsigned char* buffer, size_t length) {
 		return reinterpret_cast<InputStream*>(inputStream)->read(buffer, length);
 	}
+
+	// The list belongs to the caller of loadModelFromPath(), nothing to free
+	void keepMessages(void*)
+	{}
+
+	Glib::StaticPrivate<LoadMessages> currentMessages = GLIBMM_STATIC_PRIVATE_INIT;
+
+	// Sets the message list of the calling thread for the lifetime of this object
+	class CurrentMessagesSetter
+	{
+	public:
+		CurrentMessagesSetter(LoadMessages& messages)
+		{
+			currentMessages.set(&messages, keepMessages);
+		}
+
+		~CurrentMessagesSetter()
+		{
+			currentMessages.set(NULL, keepMessages);
+		}
+	};
 } // namespace
 
 PicoModelLoader::PicoModelLoader(const picoModule_t* module, const std::string& extension) :
@@ -71,13 +93,23 @@ scene::INodePtr PicoModelLoader::loadModel(const std::string& modelName) {
 
 // Load the given model from the VFS path
 IModelPtr PicoModelLoader::loadModelFromPath(const std::string& name)
+{
+	LoadMessages messages;
+	IModelPtr model = loadModelFromPath(name, messages);
+
+	writeLoadMessages(messages);
+
+	return model;
+}
+
+IModelPtr PicoModelLoader::loadModelFromPath(const std::string& name, LoadMessages& messages)
 {
 	// Open an ArchiveFile to load
 	ArchiveFilePtr file = GlobalFileSystem().openFile(name);
 
 	if (file == NULL)
 	{
-		rError() << "Failed to load model " << name << std::endl;
+		messages.push_back(LoadMessage(true, "Failed to load model " + name + "\n"));
 		return IModelPtr();
 	}
 
@@ -86,13 +118,20 @@ IModelPtr PicoModelLoader::loadModelFromPath(const std::string& name)
 	boost::algorithm::to_lower(fName);
 	std::string fExt = fName.substr(fName.size() - 3, 3);
 
-	picoModel_t* model = PicoModuleLoadModelStream(
-		_module,
-		&file->getInputStream(),
-		picoInputStreamReam,
-		file->size(),
-		0
-	);
+	picoModel_t* model = NULL;
+
+	{
+		// Route the picomodel output into the message list
+		CurrentMessagesSetter setter(messages);
+
+		model = PicoModuleLoadModelStream(
+			_module,
+			&file->getInputStream(),
+			picoInputStreamReam,
+			file->size(),
+			0
+		);
+	}
 
 	// greebo: Check if the model load was successful
 	if (model == NULL || model->numSurfaces == 0) {
@@ -111,6 +150,11 @@ IModelPtr PicoModelLoader::loadModelFromPath(const std::string& name)
 	return modelObj;
 }
 
+LoadMessages* PicoModelLoader::getCurrentMessages()
+{
+	return currentMessages.get();
+}
+
 // RegisterableModule implementation
 const std::string& PicoModelLoader::getName() const
 {
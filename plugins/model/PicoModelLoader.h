@@ -25,6 +25,14 @@ public:
 
   	// Load the given model from the VFS path
 	IModelPtr loadModelFromPath(const std::string& name);
+	IModelPtr loadModelFromPath(const std::string& name, LoadMessages& messages);
+
+	/**
+	 * The message list of the model the calling thread is loading, NULL if
+	 * the messages go to the log right away. Used by the picomodel print
+	 * function, which has no other way to find its caller.
+	 */
+	static LoadMessages* getCurrentMessages();
 
 	// RegisterableModule implementation
   	virtual const std::string& getName() const;
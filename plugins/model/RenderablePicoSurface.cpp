@@ -81,8 +81,7 @@ RenderablePicoSurface::RenderablePicoSurface(picoSurface_t* surf,
 	// Calculate the tangent and bitangent vectors
 	calculateTangents();
 
-	// Construct the DLs
-	createDisplayLists();
+	// The DLs are constructed by the first render() call, in the GL thread
 }
 
 std::string RenderablePicoSurface::cleanupShaderName(const std::string& inName)
@@ -130,9 +129,12 @@ std::string RenderablePicoSurface::cleanupShaderName(const std::string& inName)
 // Destructor. Release the GL display lists.
 RenderablePicoSurface::~RenderablePicoSurface()
 {
-	glDeleteLists(_dlRegular, 1);
-	glDeleteLists(_dlProgramNoVCol, 1);
-	glDeleteLists(_dlProgramVcol, 1);
+	if (_dlRegular != 0)
+	{
+		glDeleteLists(_dlRegular, 1);
+		glDeleteLists(_dlProgramNoVCol, 1);
+		glDeleteLists(_dlProgramVcol, 1);
+	}
 }
 
 // Convert byte pointers to colour vector
@@ -186,6 +188,11 @@ void RenderablePicoSurface::submitRenderables(RenderableCollector& rend,
 // Back-end render function
 void RenderablePicoSurface::render(const RenderInfo& info) const
 {
+	if (_dlRegular == 0)
+	{
+		createDisplayLists();
+	}
+
 	// Invoke appropriate display list
 	if (info.checkFlag(RENDER_PROGRAM))
     {
@@ -205,7 +212,7 @@ void RenderablePicoSurface::render(const RenderInfo& info) const
 }
 
 // Construct a list for GLProgram mode, either with or without vertex colour
-GLuint RenderablePicoSurface::compileProgramList(bool includeColour)
+GLuint RenderablePicoSurface::compileProgramList(bool includeColour) const
 {
     GLuint list = glGenLists(1);
 	assert(list != 0); // check if we run out of display lists
@@ -217,7 +224,7 @@ GLuint RenderablePicoSurface::compileProgramList(bool includeColour)
 		 ++i)
 	{
 		// Get the vertex for this index
-		ArbitraryMeshVertex& v = _vertices[*i];
+		const ArbitraryMeshVertex& v = _vertices[*i];
 
 		// Submit the vertex attributes and coordinate
 		if (GLEW_ARB_vertex_program)
@@ -245,7 +252,7 @@ GLuint RenderablePicoSurface::compileProgramList(bool includeColour)
 }
 
 // Construct the two display lists
-void RenderablePicoSurface::createDisplayLists()
+void RenderablePicoSurface::createDisplayLists() const
 {
 	// Generate the lists for lighting mode
     _dlProgramNoVCol = compileProgramList(false);
@@ -262,7 +269,7 @@ void RenderablePicoSurface::createDisplayLists()
 		 ++i)
 	{
 		// Get the vertex for this index
-		ArbitraryMeshVertex& v = _vertices[*i];
+		const ArbitraryMeshVertex& v = _vertices[*i];
 
 		// Submit attributes
 		glNormal3dv(v.normal);
@@ -274,6 +281,19 @@ void RenderablePicoSurface::createDisplayLists()
 	glEndList();
 }
 
+const TriangleBVH& RenderablePicoSurface::getBVH() const
+{
+	if (!_bvh)
+	{
+		_bvh.reset(new TriangleBVH(
+			VertexPointer(&_vertices[0].vertex, sizeof(ArbitraryMeshVertex)),
+			IndexPointer(&_indices[0], IndexPointer::index_type(_indices.size()))
+		));
+	}
+
+	return *_bvh;
+}
+
 // Perform selection test for this surface
 void RenderablePicoSurface::testSelect(Selector& selector,
 									   SelectionTest& test,
@@ -285,10 +305,10 @@ void RenderablePicoSurface::testSelect(Selector& selector,
 		test.BeginMesh(localToWorld);
 		SelectionIntersection result;
 
-		test.TestTriangles(
+		// Only the triangles in BVH leaves touching the test volume are checked
+		getBVH().testSelect(test,
 			VertexPointer(&_vertices[0].vertex, sizeof(ArbitraryMeshVertex)),
-      		IndexPointer(&_indices[0],
-      					 IndexPointer::index_type(_indices.size())),
+			localToWorld,
 			result
 		);
 
@@ -340,43 +360,22 @@ void RenderablePicoSurface::setDefaultMaterial(const std::string& defaultMateria
 
 bool RenderablePicoSurface::getIntersection(const Ray& ray, Vector3& intersection, const Matrix4& localToWorld)
 {
-	Vector3 bestIntersection = ray.origin;
-	Vector3 triIntersection;
+	if (_vertices.empty() || _indices.empty()) return false;
 
-	for (Indices::const_iterator i = _indices.begin();
-		 i != _indices.end();
-		 i += 3)
-	{
-		// Get the vertices for this triangle
-		const ArbitraryMeshVertex& p1 = _vertices[*(i)];
-		const ArbitraryMeshVertex& p2 = _vertices[*(i+1)];
-		const ArbitraryMeshVertex& p3 = _vertices[*(i+2)];
+	// Trace in object space, this way the BVH can be shared by all instances
+	Ray localRay(ray);
+	localRay.transform(localToWorld.getFullInverse());
 
-		if (ray.intersectTriangle(localToWorld.transformPoint(p1.vertex), 
-			localToWorld.transformPoint(p2.vertex), localToWorld.transformPoint(p3.vertex), triIntersection))
-		{
-			intersection = triIntersection;
-			
-			// Test if this surface intersection is better than what we currently have
-			float oldDistSquared = (bestIntersection - ray.origin).getLengthSquared();
-			float newDistSquared = (triIntersection - ray.origin).getLengthSquared();
-
-			if ((oldDistSquared == 0 && newDistSquared > 0) || newDistSquared < oldDistSquared)
-			{
-				bestIntersection = triIntersection;
-			}
-		}
-	}
+	Vector3 localIntersection;
 
-	if ((bestIntersection - ray.origin).getLengthSquared() > 0)
+	if (getBVH().getIntersection(localRay,
+		VertexPointer(&_vertices[0].vertex, sizeof(ArbitraryMeshVertex)), localIntersection))
 	{
-		intersection = bestIntersection;
+		intersection = localToWorld.transformPoint(localIntersection);
 		return true;
 	}
-	else
-	{
-		return false;
-	}
+
+	return false;
 }
 
 } // namespace model
@@ -4,6 +4,7 @@
 #include "picomodel.h"
 #include "render.h"
 #include "math/AABB.h"
+#include "TriangleBVH.h"
 
 #include "ishaders.h"
 #include "imodelsurface.h"
@@ -48,10 +49,15 @@ class RenderablePicoSurface :
 	// The AABB containing this surface, in local object space.
 	AABB _localAABB;
 
-	// The GL display lists for this surface's geometry
-	GLuint _dlRegular;
-	GLuint _dlProgramVcol;
-    GLuint _dlProgramNoVCol;
+	// Triangle hierarchy for selection tests and traces, built on first use.
+	// Surfaces are shared between all instances of a cached model, so is this.
+	mutable TriangleBVHPtr _bvh;
+
+	// The GL display lists for this surface's geometry, created on first use.
+	// Surfaces may be constructed by a worker thread without a GL context.
+	mutable GLuint _dlRegular;
+	mutable GLuint _dlProgramVcol;
+	mutable GLuint _dlProgramNoVCol;
 
 private:
 
@@ -62,11 +68,14 @@ private:
 	void calculateTangents();
 
 	// Create the display lists
-    GLuint compileProgramList(bool includeColour);
-	void createDisplayLists();
+    GLuint compileProgramList(bool includeColour) const;
+	void createDisplayLists() const;
 
 	std::string cleanupShaderName(const std::string& mapName);
 
+	// Returns the triangle hierarchy, constructing it if necessary
+	const TriangleBVH& getBVH() const;
+
 public:
 	/**
 	 * Constructor. Accepts a picoSurface_t struct and the file extension to determine
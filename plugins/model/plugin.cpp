@@ -26,9 +26,32 @@ Foundation, Inc., 51 Franklin St, Fifth Floor, Boston, MA  02110-1301  USA
 #include <stdio.h>
 #include "picomodel.h"
 #include "debugging/debugging.h"
+#include "PicoModelLoader.h"
 typedef unsigned char byte;
 #include <boost/algorithm/string/case_conv.hpp>
 
+namespace
+{
+	// Logs the message, or adds it to the messages of the model the calling thread is loading
+	void writePicoMessage(bool error, const std::string& text)
+	{
+		model::LoadMessages* messages = model::PicoModelLoader::getCurrentMessages();
+
+		if (messages != NULL)
+		{
+			messages->push_back(model::LoadMessage(error, text));
+		}
+		else if (error)
+		{
+			rError() << text;
+		}
+		else
+		{
+			rMessage() << text;
+		}
+	}
+}
+
 void PicoPrintFunc( int level, const char *str )
 {
 	if( str == 0 )
@@ -36,7 +59,7 @@ void PicoPrintFunc( int level, const char *str )
 	switch( level )
 	{
 		case PICO_NORMAL:
-			rMessage() << str << "\n";
+			writePicoMessage(false, std::string(str) + "\n");
 			break;
 
 		case PICO_VERBOSE:
@@ -44,15 +67,15 @@ void PicoPrintFunc( int level, const char *str )
 			break;
 
 		case PICO_WARNING:
-			rError() << "PICO_WARNING: " << str << "\n";
+			writePicoMessage(true, "PICO_WARNING: " + std::string(str) + "\n");
 			break;
 
 		case PICO_ERROR:
-			rError() << "PICO_ERROR: " << str << "\n";
+			writePicoMessage(true, "PICO_ERROR: " + std::string(str) + "\n");
 			break;
 
 		case PICO_FATAL:
-			rError() << "PICO_FATAL: " << str << "\n";
+			writePicoMessage(true, "PICO_FATAL: " + std::string(str) + "\n");
 			break;
 	}
 }
@@ -75,8 +98,6 @@ void pico_initialise()
 	PicoSetFreeFileFunc( PicoFreeFileFunc );
 }
 
-#include "PicoModelLoader.h"
-
 // DarkRadiant module entry point
 extern "C" void DARKRADIANT_DLLEXPORT RegisterModule(IModuleRegistry& registry) {
 
@@ -11,6 +11,7 @@
 #include "ifilesystem.h"
 #include "igame.h"
 #include "i18n.h"
+#include "itrace.h"
 
 #include "parser/DefTokeniser.h"
 #include "math/Vector4.h"
@@ -202,25 +203,39 @@ const StringSet& ParticlesManager::getDependencies() const
 	return _dependencies;
 }
 
+void ParticlesManager::preInitialiseModule(const ApplicationContext& ctx)
+{
+	// Register the "ReloadParticles" commands
+	GlobalCommandSystem().addCommand("ReloadParticles", boost::bind(&ParticlesManager::reloadParticleDefs, this));
+	GlobalEventManager().addCommand("ReloadParticles", "ReloadParticles");
+}
+
 void ParticlesManager::initialiseModule(const ApplicationContext& ctx)
 {
 	rMessage() << "ParticlesManager::initialiseModule called" << std::endl;
 
-	// Load the .prt files
-	reloadParticleDefs();
+	// Load the .prt files, nobody is connected to the reloaded signal yet
+	loadParticleDefs();
+}
 
-	// Register the "ReloadParticles" commands
-	GlobalCommandSystem().addCommand("ReloadParticles", boost::bind(&ParticlesManager::reloadParticleDefs, this));
-	GlobalEventManager().addCommand("ReloadParticles", "ReloadParticles");
+bool ParticlesManager::isInitialisationThreadSafe() const
+{
+	return true;
 }
 
-void ParticlesManager::reloadParticleDefs()
+void ParticlesManager::loadParticleDefs()
 {
 	// Use a ParticleFileLoader to load each file
 	ParticleFileLoader loader(*this);
 
 	ScopedDebugTimer timer("Particle definitions parsed: ");
+	trace::ScopedZone zone("decls", "loadParticleDefs");
 	GlobalFileSystem().forEachFile(PARTICLES_DIR, PARTICLES_EXT, loader, 1);
+}
+
+void ParticlesManager::reloadParticleDefs()
+{
+	loadParticleDefs();
 
 	// Notify observers about this event
     _particlesReloadedSignal.emit();
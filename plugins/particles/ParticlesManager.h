@@ -27,6 +27,10 @@ class ParticlesManager :
     // Reloaded signal
     sigc::signal<void> _particlesReloadedSignal;
 
+private:
+	// Parses the particle files without notifying anyone
+	void loadParticleDefs();
+
 public:
 
 	// IParticlesManager implementation
@@ -42,6 +46,8 @@ public:
 	void removeParticleDef(const std::string& name);
 
 	IRenderableParticlePtr getRenderableParticle(const std::string& name);
+
+	// Parses the particle files and emits the reloaded signal
 	void reloadParticleDefs();
 
 	/**
@@ -70,7 +76,9 @@ public:
 	// RegisterableModule implementation
 	const std::string& getName() const;
 	const StringSet& getDependencies() const;
+	void preInitialiseModule(const ApplicationContext& ctx);
 	void initialiseModule(const ApplicationContext& ctx);
+	bool isInitialisationThreadSafe() const;
 
 	static ParticlesManager& Instance()
 	{
@@ -120,6 +120,29 @@ bool Octree::unlink(const scene::INodePtr& sceneNode)
 	return false;
 }
 
+bool Octree::update(const scene::INodePtr& sceneNode)
+{
+	NodeMapping::iterator found = _nodeMapping.find(sceneNode);
+
+	if (found == _nodeMapping.end())
+	{
+		return false; // not linked
+	}
+
+	OctreeNode* node = found->second;
+
+	// Most moves are small enough to keep the node in its octant
+	if (node->isBestFitFor(sceneNode->worldAABB()))
+	{
+		return false;
+	}
+
+	node->unlink(sceneNode);
+	link(sceneNode);
+
+	return true;
+}
+
 // Returns the root node of this SP tree
 ISPNodePtr Octree::getRoot() const
 {
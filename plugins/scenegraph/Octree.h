@@ -60,6 +60,9 @@ public:
 	// Unlink this node from the SP tree, returns true if found
 	bool unlink(const scene::INodePtr& sceneNode);
 
+	// Relinks this node if its bounds don't fit into its octree node anymore
+	bool update(const scene::INodePtr& sceneNode);
+
 	// Returns the root node of this SP tree
 	ISPNodePtr getRoot() const;
 
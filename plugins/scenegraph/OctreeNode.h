@@ -264,6 +264,32 @@ public:
 		return this;
 	}
 
+	// Returns true if linkRecursively() would link an object with the given
+	// bounds to this node, such that a member with these bounds can stay here
+	bool isBestFitFor(const AABB& bounds) const
+	{
+		// Objects without valid bounds are linked to the root node
+		if (!bounds.isValid())
+		{
+			return _parent.expired();
+		}
+
+		if (!_bounds.contains(bounds))
+		{
+			return false;
+		}
+
+		for (std::size_t i = 0, size = _children.size(); i < size; ++i)
+		{
+			if (_children[i]->getBounds().contains(bounds))
+			{
+				return false; // belongs into this child
+			}
+		}
+
+		return true;
+	}
+
 	void unlink(const scene::INodePtr& sceneNode)
 	{
 		// Lookup the node in the members list (rather slow lookup)
@@ -2,11 +2,13 @@
 
 #include "ivolumetest.h"
 #include "itextstream.h"
+#include "itrace.h"
 
 #include "scene/InstanceWalkers.h"
 #include "debugging/debugging.h"
 
 #include "math/AABB.h"
+#include "math/Ray.h"
 #include "Octree.h"
 #include "SceneGraphFactory.h"
 
@@ -77,6 +79,7 @@ void SceneGraph::setRoot(const INodePtr& newRoot)
 
 	// Refresh the space partition class
 	_spacePartition = ISpacePartitionSystemPtr(new Octree);
+	_boundsChangedNodes.clear();
 
 	if (_root != NULL)
 	{
@@ -116,6 +119,7 @@ void SceneGraph::insert(const INodePtr& node)
 void SceneGraph::erase(const INodePtr& node)
 {
 	_spacePartition->unlink(node);
+	_boundsChangedNodes.erase(node);
 
 	// Fire the onRemove event on the Node
 	node->onRemoveFromScene();
@@ -130,15 +134,64 @@ void SceneGraph::erase(const INodePtr& node)
 
 void SceneGraph::nodeBoundsChanged(const scene::INodePtr& node)
 {
-	//assert(_visitedSPNodes == 0); // Disallow this during traversal
+	++_boundsChangeStatistics.changes;
 
-	if (_spacePartition->unlink(node))
+	// Bulk operations report the same nodes over and over, relink them only once
+	if (!_boundsChangedNodes.insert(node).second)
 	{
-		// unlink returned true, so the given node was linked before => re-link it
-		_spacePartition->link(node);
+		++_boundsChangeStatistics.coalesced;
+	}
+
+	for (ObserverList::iterator i = _sceneObservers.begin(); i != _sceneObservers.end(); ++i)
+	{
+		(*i)->onSceneNodeBoundsChanged(node);
 	}
 }
 
+void SceneGraph::processBoundsChanges()
+{
+	// Acquire the worldAABB() of the scenegraph root - if any node got changed in the graph
+	// the scenegraph's root bounds are marked as "dirty" and the bounds will be re-calculated,
+	// which reports the changed nodes to nodeBoundsChanged().
+	if (_root != NULL) _root->worldAABB();
+
+	if (_boundsChangedNodes.empty())
+	{
+		return;
+	}
+
+	trace::ScopedZone zone("scenegraph", "processBoundsChanges");
+
+	// Linking might evaluate the bounds of further nodes, process until none are left
+	while (!_boundsChangedNodes.empty())
+	{
+		NodeSet nodes;
+		nodes.swap(_boundsChangedNodes);
+
+		for (NodeSet::const_iterator i = nodes.begin(); i != nodes.end(); ++i)
+		{
+			if (!(*i)->inScene())
+			{
+				continue; // not linked, will be when inserted
+			}
+
+			if (_spacePartition->update(*i))
+			{
+				++_boundsChangeStatistics.relinked;
+			}
+			else
+			{
+				++_boundsChangeStatistics.kept;
+			}
+		}
+	}
+}
+
+const Graph::BoundsChangeStatistics& SceneGraph::getBoundsChangeStatistics() const
+{
+	return _boundsChangeStatistics;
+}
+
 void SceneGraph::foreachNode(const INode::VisitorFunc& functor)
 {
 	if (!_root) return;
@@ -180,11 +233,9 @@ void SceneGraph::foreachVisibleNodeInVolume(const VolumeTest& volume, const INod
 
 void SceneGraph::foreachNodeInVolume(const VolumeTest& volume, const INode::VisitorFunc& functor, bool visitHidden)
 {
-	// Acquire the worldAABB() of the scenegraph root - if any node got changed in the graph
-	// the scenegraph's root bounds are marked as "dirty" and the bounds will be re-calculated
-	// which in turn might trigger a re-link in the Octree. We want to avoid that the Octree
-	// changes during traversal so let's call this now. If nothing got changed, this call is very cheap.
-	if (_root != NULL) _root->worldAABB();
+	// Bring the Octree up to date, we want to avoid that it changes during traversal.
+	// If nothing got changed, this call is very cheap.
+	processBoundsChanges();
 
 	// Descend the SpacePartition tree and call the walker for each (partially) visible member
 	ISPNodePtr root = _spacePartition->getRoot();
@@ -260,6 +311,53 @@ bool SceneGraph::foreachNodeInVolume_r(const ISPNode& node, const VolumeTest& vo
 	return true; // continue traversal
 }
 
+void SceneGraph::foreachVisibleNodeAlongRay(const Ray& ray, const INode::VisitorFunc& functor)
+{
+	// Make sure the Octree is up to date before traversal, see foreachNodeInVolume
+	processBoundsChanges();
+
+	foreachNodeAlongRay_r(*_spacePartition->getRoot(), ray, functor);
+}
+
+bool SceneGraph::foreachNodeAlongRay_r(const ISPNode& node, const Ray& ray, const INode::VisitorFunc& functor)
+{
+	Vector3 intersection;
+
+	const ISPNode::MemberList& members = node.getMembers();
+
+	for (ISPNode::MemberList::const_iterator m = members.begin(); m != members.end(); /* in-loop increment */)
+	{
+		const INodePtr& member = *m++;
+
+		if (!member->visible() || !ray.intersectAABB(member->worldAABB(), intersection))
+		{
+			continue;
+		}
+
+		if (!functor(member))
+		{
+			return false;
+		}
+	}
+
+	const ISPNode::NodeList& children = node.getChildNodes();
+
+	for (ISPNode::NodeList::const_iterator i = children.begin(); i != children.end(); ++i)
+	{
+		if (!ray.intersectAABB((*i)->getBounds(), intersection))
+		{
+			continue;
+		}
+
+		if (!foreachNodeAlongRay_r(**i, ray, functor))
+		{
+			return false;
+		}
+	}
+
+	return true;
+}
+
 ISpacePartitionSystemPtr SceneGraph::getSpacePartition()
 {
 	return _spacePartition;
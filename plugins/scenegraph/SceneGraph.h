@@ -2,7 +2,9 @@
 
 #include <map>
 #include <list>
+#include <unordered_set>
 #include <sigc++/signal.h>
+#include <boost/functional/hash.hpp>
 
 #include "iscenegraph.h"
 #include "imodule.h"
@@ -37,6 +39,12 @@ private:
 	std::size_t _visitedSPNodes;
 	std::size_t _skippedSPNodes;
 
+	// The nodes which changed their bounds since the space partition has been updated
+	typedef std::unordered_set<INodePtr, boost::hash<INodePtr> > NodeSet;
+	NodeSet _boundsChangedNodes;
+
+	BoundsChangeStatistics _boundsChangeStatistics;
+
 public:
 	SceneGraph();
 
@@ -66,6 +74,8 @@ public:
 	void erase(const INodePtr& node);
 
 	void nodeBoundsChanged(const scene::INodePtr& node);
+	void processBoundsChanges();
+	const BoundsChangeStatistics& getBoundsChangeStatistics() const;
 
 	// Walker variants
 	void foreachNodeInVolume(const VolumeTest& volume, Walker& walker);
@@ -77,6 +87,9 @@ public:
 	void foreachNodeInVolume(const VolumeTest& volume, const INode::VisitorFunc& functor);
 	void foreachVisibleNodeInVolume(const VolumeTest& volume, const INode::VisitorFunc& functor);
 
+	// Ray query
+	void foreachVisibleNodeAlongRay(const Ray& ray, const INode::VisitorFunc& functor);
+
 	ISpacePartitionSystemPtr getSpacePartition();
 private:
 	void foreachNodeInVolume(const VolumeTest& volume, const INode::VisitorFunc& functor, bool visitHidden);
@@ -84,6 +97,9 @@ private:
 	// Recursive method used to descend the SpacePartition tree, returns FALSE if the walker signaled stop
 	bool foreachNodeInVolume_r(const ISPNode& node, const VolumeTest& volume, 
 							   const INode::VisitorFunc& functor, bool visitHidden);
+
+	// Recursive method descending all SpacePartition nodes hit by the ray, returns FALSE if the functor signaled stop
+	bool foreachNodeAlongRay_r(const ISPNode& node, const Ray& ray, const INode::VisitorFunc& functor);
 };
 typedef boost::shared_ptr<SceneGraph> SceneGraphPtr;
 
@@ -153,9 +153,7 @@ Colour4 Doom3ShaderLayer::getColour() const
 void Doom3ShaderLayer::setColourExpression(ColourComponentSelector comp, const IShaderExpressionPtr& expr)
 {
 	// Store the expression and link it to our registers
-	_expressions.push_back(expr);
-
-	std::size_t index = expr->linkToRegister(_registers);
+	std::size_t index = linkExpression(expr);
 
 	// Now assign the index to our colour components
 	switch (comp)
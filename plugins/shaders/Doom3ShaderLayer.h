@@ -5,6 +5,7 @@
 
 #include "math/Vector4.h"
 #include "NamedBindable.h"
+#include "ShaderExpressionProgram.h"
 
 namespace shaders
 {
@@ -39,10 +40,13 @@ private:
     // The registers keeping the results of expression evaluations
     Registers _registers;
 
-    // The expressions used in this stage
-    typedef std::vector<IShaderExpressionPtr> Expressions;
+    // The expressions used in this stage and the registers they're linked to
+    typedef std::vector<std::pair<IShaderExpressionPtr, std::size_t> > Expressions;
     Expressions _expressions;
 
+    // The expressions compiled into a single program, built on first evaluation
+    ShaderExpressionProgram _program;
+
     static const IShaderExpressionPtr NULL_EXPRESSION;
 
     // The condition register for this stage. Points to a register to be interpreted as bool.
@@ -133,27 +137,20 @@ public:
 
     void setCondition(const IShaderExpressionPtr& conditionExpr)
     {
-        // Store the expression in our list
-        _expressions.push_back(conditionExpr);
-
-        // Link the result to our local registers
-        _condition = conditionExpr->linkToRegister(_registers);
+        _condition = linkExpression(conditionExpr);
     }
 
+    // Time-only results are calculated once per time value and shared by all entities
     void evaluateExpressions(std::size_t time) 
     {
-        for (Expressions::iterator i = _expressions.begin(); i != _expressions.end(); ++i)
-        {
-            (*i)->evaluate(time);
-        }
+        compileExpressions();
+        _program.execute(time, NULL, _registers);
     }
 
     void evaluateExpressions(std::size_t time, const IRenderEntity& entity)
     {
-        for (Expressions::iterator i = _expressions.begin(); i != _expressions.end(); ++i)
-        {
-            (*i)->evaluate(time, entity);
-        }
+        compileExpressions();
+        _program.execute(time, &entity, _registers);
     }
 
     /**
@@ -296,11 +293,8 @@ public:
      */
     void setScale(const IShaderExpressionPtr& xExpr, const IShaderExpressionPtr& yExpr)
     {
-        _expressions.push_back(xExpr);
-        _expressions.push_back(yExpr);
-
-        _scale[0] = xExpr->linkToRegister(_registers);
-        _scale[1] = yExpr->linkToRegister(_registers);
+        _scale[0] = linkExpression(xExpr);
+        _scale[1] = linkExpression(yExpr);
     }
 
     Vector2 getTranslation() 
@@ -313,11 +307,8 @@ public:
      */
     void setTranslation(const IShaderExpressionPtr& xExpr, const IShaderExpressionPtr& yExpr)
     {
-        _expressions.push_back(xExpr);
-        _expressions.push_back(yExpr);
-
-        _translation[0] = xExpr->linkToRegister(_registers);
-        _translation[1] = yExpr->linkToRegister(_registers);
+        _translation[0] = linkExpression(xExpr);
+        _translation[1] = linkExpression(yExpr);
     }
 
     float getRotation() 
@@ -330,9 +321,7 @@ public:
      */
     void setRotation(const IShaderExpressionPtr& expr)
     {
-        _expressions.push_back(expr);
-
-        _rotation = expr->linkToRegister(_registers);
+        _rotation = linkExpression(expr);
     }
 
     Vector2 getShear() 
@@ -345,11 +334,8 @@ public:
      */
     void setShear(const IShaderExpressionPtr& xExpr, const IShaderExpressionPtr& yExpr)
     {
-        _expressions.push_back(xExpr);
-        _expressions.push_back(yExpr);
-
-        _shear[0] = xExpr->linkToRegister(_registers);
-        _shear[1] = yExpr->linkToRegister(_registers);
+        _shear[0] = linkExpression(xExpr);
+        _shear[1] = linkExpression(yExpr);
     }
 
     /**
@@ -367,8 +353,7 @@ public:
      */
     void setAlphaTest(const IShaderExpressionPtr& expr)
     {
-        _expressions.push_back(expr);
-        _alphaTest = expr->linkToRegister(_registers);
+        _alphaTest = linkExpression(expr);
     }
 
     // Returns the value of the given register
@@ -382,6 +367,9 @@ public:
     {
         assert(index < _registers.size());
         _registers[index] = value;
+
+        // Let the expressions overwrite the value again on the next evaluation
+        _program.clear();
     }
 
     // Allocates a new register, initialised with the given value
@@ -422,25 +410,21 @@ public:
     {
         assert(parm0);
 
-        _expressions.push_back(parm0);
-        std::size_t parm0Reg = parm0->linkToRegister(_registers);
+        std::size_t parm0Reg = linkExpression(parm0);
 
         _vertexParms.push_back(parm0Reg);
 
         if (parm1)
         {
-            _expressions.push_back(parm1);
-            _vertexParms.push_back(parm1->linkToRegister(_registers));
+            _vertexParms.push_back(linkExpression(parm1));
 
             if (parm2)
             {
-                _expressions.push_back(parm2);
-                _vertexParms.push_back(parm2->linkToRegister(_registers));
+                _vertexParms.push_back(linkExpression(parm2));
 
                 if (parm3)
                 {
-                    _expressions.push_back(parm3);
-                    _vertexParms.push_back(parm3->linkToRegister(_registers));
+                    _vertexParms.push_back(linkExpression(parm3));
                 }
                 else
                 {
@@ -504,6 +488,30 @@ public:
     {
         _privatePolygonOffset = value;
     }
+
+private:
+    // Stores the expression and links it to a new register, returning the register index
+    std::size_t linkExpression(const IShaderExpressionPtr& expr)
+    {
+        std::size_t index = expr->linkToRegister(_registers);
+
+        _expressions.push_back(std::make_pair(expr, index));
+        _program.clear();
+
+        return index;
+    }
+
+    void compileExpressions()
+    {
+        if (_program.isCompiled()) return;
+
+        for (Expressions::const_iterator i = _expressions.begin(); i != _expressions.end(); ++i)
+        {
+            _program.addOutput(i->first, i->second, _registers);
+        }
+
+        _program.setCompiled();
+    }
 };
 
 /**
@@ -8,6 +8,7 @@
 #include "imainframe.h"
 #include "ieventmanager.h"
 #include "igame.h"
+#include "itrace.h"
 
 #include "xmlutil/Node.h"
 #include "xmlutil/MissingXMLNodeException.h"
@@ -68,7 +69,7 @@ void Doom3ShaderSystem::destroy() {
 	// the CShader destructors.
 }
 
-void Doom3ShaderSystem::loadMaterialFiles()
+void Doom3ShaderSystem::readMaterialFileLocation()
 {
 	// Get the shaders path and extension from the XML game file
 	xml::NodeList nlShaderPath =
@@ -81,18 +82,21 @@ void Doom3ShaderSystem::loadMaterialFiles()
 	if (nlShaderExt.empty())
 		throw xml::MissingXMLNodeException(MISSING_EXTENSION_NODE);
 
-	// Load the shader files from the VFS
-	std::string sPath = nlShaderPath[0].getContent();
-	if (!boost::algorithm::ends_with(sPath, "/"))
-		sPath += "/";
+	_materialPath = nlShaderPath[0].getContent();
+	if (!boost::algorithm::ends_with(_materialPath, "/"))
+		_materialPath += "/";
 
-	std::string extension = nlShaderExt[0].getContent();
+	_materialExtension = nlShaderExt[0].getContent();
+}
 
+void Doom3ShaderSystem::loadMaterialFiles()
+{
 	// Load each file from the global filesystem
-	ShaderFileLoader loader(sPath);
+	ShaderFileLoader loader(_materialPath);
 	{
 		ScopedDebugTimer timer("ShaderFiles parsed: ");
-		GlobalFileSystem().forEachFile(sPath, extension, loader, 0);
+		trace::ScopedZone zone("decls", "loadMaterialFiles");
+		GlobalFileSystem().forEachFile(_materialPath, _materialExtension, loader, 0);
 	}
 
 	rMessage() << _library->getNumShaders() << " shaders found." << std::endl;
@@ -110,6 +114,9 @@ void Doom3ShaderSystem::unrealise()
 {
 	if (_realised)
 	{
+		rMessage() << _library->getNumRealisedShaders() << " of " << _library->getNumShaders()
+			<< " shader definitions have been realised." << std::endl;
+
 		_tables.clear();
 		_observers.unrealise();
 		freeShaders();
@@ -128,6 +135,7 @@ void Doom3ShaderSystem::onFileSystemShutdown() {
 void Doom3ShaderSystem::freeShaders() {
 	_library->clear();
 	_textureManager->checkBindings();
+	MapExpression::clearImageCache();
 	activeShadersChangedNotify();
 }
 
@@ -143,6 +151,12 @@ bool Doom3ShaderSystem::isRealised() {
 
 // Return a shader by name
 MaterialPtr Doom3ShaderSystem::getMaterialForName(const std::string& name)
+{
+	CShaderPtr shader = _library->findShader(string::InternedString(name));
+	return shader;
+}
+
+MaterialPtr Doom3ShaderSystem::getMaterialForName(const string::InternedString& name)
 {
 	CShaderPtr shader = _library->findShader(name);
 	return shader;
@@ -314,19 +328,29 @@ const StringSet& Doom3ShaderSystem::getDependencies() const {
 		_dependencies.insert(MODULE_XMLREGISTRY);
 		_dependencies.insert(MODULE_GAMEMANAGER);
 		_dependencies.insert(MODULE_PREFERENCESYSTEM);
+		_dependencies.insert(MODULE_STRINGPOOL);
 	}
 
 	return _dependencies;
 }
 
-void Doom3ShaderSystem::initialiseModule(const ApplicationContext& ctx)
+void Doom3ShaderSystem::preInitialiseModule(const ApplicationContext& ctx)
 {
-	rMessage() << getName() << "::initialiseModule called" << std::endl;
-
 	GlobalCommandSystem().addCommand("RefreshShaders", boost::bind(&Doom3ShaderSystem::refreshShadersCmd, this, _1));
 	GlobalEventManager().addCommand("RefreshShaders", "RefreshShaders");
 
+	// The game can't change during a session, the location is read once
+	readMaterialFileLocation();
+
 	construct();
+}
+
+void Doom3ShaderSystem::initialiseModule(const ApplicationContext& ctx)
+{
+	rMessage() << getName() << "::initialiseModule called" << std::endl;
+
+	// Nothing is attached to the module observers yet, the dependent
+	// modules are initialised after this one
 	realise();
 
 #ifdef _DEBUG
@@ -334,6 +358,11 @@ void Doom3ShaderSystem::initialiseModule(const ApplicationContext& ctx)
 #endif
 }
 
+bool Doom3ShaderSystem::isInitialisationThreadSafe() const
+{
+	return true;
+}
+
 // Horrible evil macro to avoid assertion failures if expr is NULL
 #define GET_EXPR_OR_RETURN expr = createShaderExpressionFromString(exprStr);\
                                   if (!expr) return;
@@ -47,6 +47,10 @@ class Doom3ShaderSystem
 	// notified upon realisation of this class.
 	ModuleObservers _observers;
 
+	// Folder and extension of the material files, read from the game file
+	std::string _materialPath;
+	std::string _materialExtension;
+
 public:
 
 	// Constructor, allocates the library
@@ -77,6 +81,7 @@ public:
 
 	// Return a shader by name
 	MaterialPtr getMaterialForName(const std::string& name);
+	MaterialPtr getMaterialForName(const string::InternedString& name);
 
 	bool materialExists(const std::string& name);
 
@@ -126,6 +131,9 @@ public:
 
 public:
 
+	// Reads the material folder and extension from the game file
+	void readMaterialFileLocation();
+
 	/** Load the shader definitions from the MTR files
 	 * (doesn't load any textures yet).	*/
 	void loadMaterialFiles();
@@ -139,7 +147,9 @@ public:
 	// RegisterableModule implementation
 	virtual const std::string& getName() const;
 	virtual const StringSet& getDependencies() const;
+	virtual void preInitialiseModule(const ApplicationContext& ctx);
 	virtual void initialiseModule(const ApplicationContext& ctx);
+	virtual bool isInitialisationThreadSafe() const;
 	virtual void shutdownModule();
 
 private:
@@ -4,7 +4,10 @@
 #include "ifilesystem.h"
 
 #include <boost/algorithm/string/case_conv.hpp>
+#include <boost/weak_ptr.hpp>
 #include <iostream>
+#include <map>
+#include <deque>
 
 #include "os/path.h"
 #include "string/convert.h"
@@ -34,6 +37,113 @@ namespace {
 	const std::string IMAGE_SCRATCH = "_scratch.bmp";
 	const std::string IMAGE_SPOTLIGHT = "_spotlight.bmp";
 	const std::string IMAGE_WHITE = "_white.bmp";
+
+	// The amount of recently created images kept alive for sharing
+	const std::size_t MAX_RECENT_IMAGE_MEMORY = 64 * 1024 * 1024;
+
+	/**
+	 * Images created by map expressions, indexed by the expression identifier.
+	 * Images are available as long as anyone else holds a reference, the most
+	 * recently created ones are kept alive by the cache itself.
+	 */
+	class ImageCache
+	{
+		typedef std::map<std::string, boost::weak_ptr<Image> > Images;
+		Images _images;
+
+		// Number of entries at which expired ones are removed
+		std::size_t _sweepSize;
+
+		typedef std::deque<std::pair<ImagePtr, std::size_t> > RecentImages;
+		RecentImages _recent;
+		std::size_t _recentMemory;
+
+	public:
+		ImageCache() :
+			_sweepSize(256),
+			_recentMemory(0)
+		{}
+
+		ImagePtr find(const std::string& identifier)
+		{
+			Images::iterator found = _images.find(identifier);
+
+			return found != _images.end() ? found->second.lock() : ImagePtr();
+		}
+
+		void insert(const std::string& identifier, const ImagePtr& image)
+		{
+			_images[identifier] = image;
+
+			if (_images.size() >= _sweepSize)
+			{
+				removeExpired();
+			}
+
+			std::size_t size = image->getWidth(0) * image->getHeight(0) * 4;
+
+			_recent.push_back(RecentImages::value_type(image, size));
+			_recentMemory += size;
+
+			while (_recentMemory > MAX_RECENT_IMAGE_MEMORY && _recent.size() > 1)
+			{
+				_recentMemory -= _recent.front().second;
+				_recent.pop_front();
+			}
+		}
+
+		void clear()
+		{
+			_images.clear();
+			_recent.clear();
+			_recentMemory = 0;
+		}
+
+		static ImageCache& Instance()
+		{
+			static ImageCache _instance;
+			return _instance;
+		}
+
+	private:
+		void removeExpired()
+		{
+			for (Images::iterator i = _images.begin(); i != _images.end(); /* in-loop increment */)
+			{
+				if (i->second.expired())
+				{
+					_images.erase(i++);
+				}
+				else
+				{
+					++i;
+				}
+			}
+
+			_sweepSize = std::max(_images.size() * 2, static_cast<std::size_t>(256));
+		}
+	};
+
+	// The average of two channel values, rounded like float_to_integer() does
+	// (to even on ties), but without leaving integer arithmetics
+	inline byte averageRounded(unsigned int a, unsigned int b)
+	{
+		unsigned int sum = a + b;
+		unsigned int half = sum >> 1;
+
+		return static_cast<byte>(half + (sum & half & 1));
+	}
+
+	inline byte scaleClamped(byte value, float scale)
+	{
+		int scaled = float_to_integer(static_cast<float>(value) * scale);
+		return static_cast<byte>(scaled > 255 ? 255 : scaled);
+	}
+
+	inline void warnPrecompressed()
+	{
+		rWarning() << "Cannot evaluate map expression with precompressed texture." << std::endl;
+	}
 }
 
 namespace shaders {
@@ -82,6 +192,32 @@ MapExpressionPtr MapExpression::createForString(std::string str) {
 	return createForToken(token);
 }
 
+ImagePtr MapExpression::getImage() const
+{
+	std::string identifier = getIdentifier();
+
+	ImageCache& cache = ImageCache::Instance();
+
+	ImagePtr image = cache.find(identifier);
+
+	if (!image)
+	{
+		image = createImage();
+
+		if (image)
+		{
+			cache.insert(identifier, image);
+		}
+	}
+
+	return image;
+}
+
+void MapExpression::clearImageCache()
+{
+	ImageCache::Instance().clear();
+}
+
 ImagePtr MapExpression::getResampled(const ImagePtr& input, std::size_t width, std::size_t height)
 {
 	// Don't process precompressed images
@@ -110,6 +246,118 @@ ImagePtr MapExpression::getResampled(const ImagePtr& input, std::size_t width, s
 	}
 }
 
+/* PixelExpression */
+
+PixelExpression::PixelExpression() :
+	_numRows(0)
+{}
+
+std::size_t PixelExpression::compile(const PixelExpression& expression) const
+{
+	Instruction instruction;
+	instruction.expression = &expression;
+
+	for (std::size_t i = 0; i < expression.getNumArguments(); ++i)
+	{
+		const MapExpressionPtr& argument = expression.getArgument(i);
+
+		const PixelExpression* pixelArgument = dynamic_cast<const PixelExpression*>(argument.get());
+
+		if (pixelArgument != NULL)
+		{
+			instruction.arguments.push_back(compile(*pixelArgument));
+		}
+		else
+		{
+			// Anything else is evaluated on its own and read from its image
+			_inputs.push_back(argument);
+			_inputRows.push_back(_numRows++);
+
+			instruction.arguments.push_back(_inputRows.back());
+		}
+	}
+
+	instruction.output = _numRows++;
+	_instructions.push_back(instruction);
+
+	return instruction.output;
+}
+
+ImagePtr PixelExpression::createImage() const
+{
+	if (_instructions.empty())
+	{
+		compile(*this);
+	}
+
+	// Fetch the input images, the first one determines the dimensions
+	std::vector<ImagePtr> images(_inputs.size());
+
+	for (std::size_t i = 0; i < _inputs.size(); ++i)
+	{
+		images[i] = _inputs[i]->getImage();
+
+		if (!images[i]) return ImagePtr();
+
+		// Don't process precompressed images
+		if (images[i]->isPrecompressed())
+		{
+			warnPrecompressed();
+			return images.front();
+		}
+	}
+
+	std::size_t width = images.front()->getWidth(0);
+	std::size_t height = images.front()->getHeight(0);
+
+	for (std::size_t i = 1; i < images.size(); ++i)
+	{
+		images[i] = getResampled(images[i], width, height);
+	}
+
+	ImagePtr result(new RGBAImage(width, height));
+
+	if (width == 0 || height == 0) return result;
+
+	// Intermediate results only need a single row, which stays in the CPU cache
+	std::size_t rowSize = width * 4;
+	std::vector<byte> intermediate(rowSize * _numRows);
+
+	std::vector<byte*> rows(_numRows);
+	std::vector<const byte*> arguments;
+
+	for (std::size_t y = 0; y < height; ++y)
+	{
+		for (std::size_t i = 0; i < _numRows; ++i)
+		{
+			rows[i] = &intermediate[i * rowSize];
+		}
+
+		for (std::size_t i = 0; i < images.size(); ++i)
+		{
+			rows[_inputRows[i]] = images[i]->getMipMapPixels(0) + y * rowSize;
+		}
+
+		// The last instruction is this expression, it writes to the result
+		rows[_instructions.back().output] = result->getMipMapPixels(0) + y * rowSize;
+
+		for (std::vector<Instruction>::const_iterator i = _instructions.begin();
+			 i != _instructions.end(); ++i)
+		{
+			arguments.clear();
+
+			for (std::size_t a = 0; a < i->arguments.size(); ++a)
+			{
+				arguments.push_back(rows[i->arguments[a]]);
+			}
+
+			i->expression->evaluatePixels(&arguments.front(), rows[i->output], width);
+		}
+	}
+
+	return result;
+}
+
 HeightMapExpression::HeightMapExpression (DefTokeniser& token) {
 	token.assertNextToken("(");
 	heightMapExp = createForToken(token);
@@ -118,7 +366,7 @@ HeightMapExpression::HeightMapExpression (DefTokeniser& token) {
 	token.assertNextToken(")");
 }
 
-ImagePtr HeightMapExpression::getImage() const {
+ImagePtr HeightMapExpression::createImage() const {
 	// Get the heightmap from the contained expression
 	ImagePtr heightMap = heightMapExp->getImage();
 
@@ -126,7 +374,7 @@ ImagePtr HeightMapExpression::getImage() const {
 
 	// Don't process precompressed images
 	if (heightMap->isPrecompressed()) {
-		rWarning() << "Cannot evaluate map expression with precompressed texture." << std::endl;
+		warnPrecompressed();
 		return heightMap;
 	}
 
@@ -136,9 +384,7 @@ ImagePtr HeightMapExpression::getImage() const {
 }
 
 std::string HeightMapExpression::getIdentifier() const {
-	std::string identifier = "_heightmap_";
-	identifier.append(heightMapExp->getIdentifier() + string::to_string(scale));
-	return identifier;
+	return "heightmap(" + heightMapExp->getIdentifier() + ", " + string::to_string(scale) + ")";
 }
 
 AddNormalsExpression::AddNormalsExpression (DefTokeniser& token) {
@@ -149,70 +395,32 @@ AddNormalsExpression::AddNormalsExpression (DefTokeniser& token) {
 	token.assertNextToken(")");
 }
 
-ImagePtr AddNormalsExpression::getImage() const {
-    ImagePtr imgOne = mapExpOne->getImage();
-
-    if (imgOne == NULL) return ImagePtr();
-
-    std::size_t width = imgOne->getWidth(0);
-    std::size_t height = imgOne->getHeight(0);
-
-    ImagePtr imgTwo = mapExpTwo->getImage();
-
-    if (imgTwo == NULL) return ImagePtr();
-
-	// Don't process precompressed images
-	if (imgOne->isPrecompressed() || imgTwo->isPrecompressed()) {
-		rWarning() << "Cannot evaluate map expression with precompressed texture." << std::endl;
-		return imgOne;
-	}
-
-	// The image must match the dimensions of the first
-	imgTwo = getResampled(imgTwo, width, height);
+std::size_t AddNormalsExpression::getNumArguments() const {
+	return 2;
+}
 
-    ImagePtr result (new RGBAImage(width, height));
+const MapExpressionPtr& AddNormalsExpression::getArgument(std::size_t index) const {
+	return index == 0 ? mapExpOne : mapExpTwo;
+}
 
-    byte* pixOne = imgOne->getMipMapPixels(0);
-    byte* pixTwo = imgTwo->getMipMapPixels(0);
-    byte* pixOut = result->getMipMapPixels(0);
+void AddNormalsExpression::evaluatePixels(const byte* const* arguments, byte* output,
+										  std::size_t numPixels) const
+{
+	const byte* pixOne = arguments[0];
+	const byte* pixTwo = arguments[1];
 
-    // iterate through the pixels
-    for( std::size_t y = 0; y < height; y++ )
+	for (std::size_t i = 0; i < numPixels * 4; i += 4)
 	{
-		for( std::size_t x = 0; x < width; x++ )
-		{
-			// create the two vectors
-			Vector3 vectorOne(
-    			static_cast<double>(pixOne[0]),
-    			static_cast<double>(pixOne[1]),
-    			static_cast<double>(pixOne[2])
-			);
-			Vector3 vectorTwo(
-    			static_cast<double>(pixTwo[0]),
-    			static_cast<double>(pixTwo[1]),
-    			static_cast<double>(pixTwo[2])
-			);
-			// Take the mean value of the two vectors
-			Vector3 vectorOut = (vectorOne + vectorTwo) * 0.5;
-
-			pixOut[0] = float_to_integer(vectorOut.x());
-			pixOut[1] = float_to_integer(vectorOut.y());
-			pixOut[2] = float_to_integer(vectorOut.z());
-			pixOut[3] = 255;
-
-			// advance the pixel pointer
-			pixOne += 4;
-			pixTwo += 4;
-			pixOut += 4;
-		}
-    }
-    return result;
+		// Take the mean value of the two vectors
+		output[i + 0] = averageRounded(pixOne[i + 0], pixTwo[i + 0]);
+		output[i + 1] = averageRounded(pixOne[i + 1], pixTwo[i + 1]);
+		output[i + 2] = averageRounded(pixOne[i + 2], pixTwo[i + 2]);
+		output[i + 3] = 255;
+	}
 }
 
 std::string AddNormalsExpression::getIdentifier() const {
-	std::string identifier = "_addnormals_";
-	identifier.append(mapExpOne->getIdentifier() + mapExpTwo->getIdentifier());
-	return identifier;
+	return "addnormals(" + mapExpOne->getIdentifier() + ", " + mapExpTwo->getIdentifier() + ")";
 }
 
 SmoothNormalsExpression::SmoothNormalsExpression (DefTokeniser& token) {
@@ -221,7 +429,7 @@ SmoothNormalsExpression::SmoothNormalsExpression (DefTokeniser& token) {
 	token.assertNextToken(")");
 }
 
-ImagePtr SmoothNormalsExpression::getImage() const {
+ImagePtr SmoothNormalsExpression::createImage() const {
 
 	ImagePtr normalMap = mapExp->getImage();
 
@@ -229,7 +437,7 @@ ImagePtr SmoothNormalsExpression::getImage() const {
 
 	// Don't process precompressed images
 	if (normalMap->isPrecompressed()) {
-		rWarning() << "Cannot evaluate map expression with precompressed texture." << std::endl;
+		warnPrecompressed();
 		return normalMap;
 	}
 
@@ -292,9 +500,7 @@ ImagePtr SmoothNormalsExpression::getImage() const {
 }
 
 std::string SmoothNormalsExpression::getIdentifier() const {
-	std::string identifier = "_smoothnormals_";
-	identifier.append(mapExp->getIdentifier());
-	return identifier;
+	return "smoothnormals(" + mapExp->getIdentifier() + ")";
 }
 
 AddExpression::AddExpression (DefTokeniser& token) {
@@ -305,57 +511,29 @@ AddExpression::AddExpression (DefTokeniser& token) {
 	token.assertNextToken(")");
 }
 
-ImagePtr AddExpression::getImage() const {
-    ImagePtr imgOne = mapExpOne->getImage();
-
-    if (imgOne == NULL) return ImagePtr();
-
-    std::size_t width = imgOne->getWidth(0);
-    std::size_t height = imgOne->getHeight(0);
-
-	ImagePtr imgTwo = mapExpTwo->getImage();
-
-	if (imgTwo == NULL) return ImagePtr();
-
-	// Don't process precompressed images
-	if (imgOne->isPrecompressed() || imgTwo->isPrecompressed()) {
-		rWarning() << "Cannot evaluate map expression with precompressed texture." << std::endl;
-		return imgOne;
-	}
-
-	// Resize the image to match the dimensions of the first
-    imgTwo = getResampled(imgTwo, width, height);
+std::size_t AddExpression::getNumArguments() const {
+	return 2;
+}
 
-    ImagePtr result (new RGBAImage(width, height));
+const MapExpressionPtr& AddExpression::getArgument(std::size_t index) const {
+	return index == 0 ? mapExpOne : mapExpTwo;
+}
 
-    byte* pixOne = imgOne->getMipMapPixels(0);
-    byte* pixTwo = imgTwo->getMipMapPixels(0);
-    byte* pixOut = result->getMipMapPixels(0);
+void AddExpression::evaluatePixels(const byte* const* arguments, byte* output,
+								   std::size_t numPixels) const
+{
+	const byte* pixOne = arguments[0];
+	const byte* pixTwo = arguments[1];
 
-    // iterate through the pixels
-    for( std::size_t y = 0; y < height; y++)
+	// add the colors
+	for (std::size_t i = 0; i < numPixels * 4; ++i)
 	{
-		for( std::size_t x = 0; x < width; x++)
-		{
-			// add the colors
-			pixOut[0] = float_to_integer((static_cast<float>(pixOne[0]) + pixTwo[0]) * 0.5f);
-			pixOut[1] = float_to_integer((static_cast<float>(pixOne[1]) + pixTwo[1]) * 0.5f);
-			pixOut[2] = float_to_integer((static_cast<float>(pixOne[2]) + pixTwo[2]) * 0.5f);
-			pixOut[3] = float_to_integer((static_cast<float>(pixOne[3]) + pixTwo[3]) * 0.5f);
-
-			//advance the pixel pointer
-			pixOne += 4;
-			pixTwo += 4;
-			pixOut += 4;
-		}
-    }
-	return result;
+		output[i] = averageRounded(pixOne[i], pixTwo[i]);
+	}
 }
 
 std::string AddExpression::getIdentifier() const {
-	std::string identifier = "_add_";
-	identifier.append(mapExpOne->getIdentifier() + mapExpTwo->getIdentifier());
-	return identifier;
+	return "add(" + mapExpOne->getIdentifier() + ", " + mapExpTwo->getIdentifier() + ")";
 }
 
 ScaleExpression::ScaleExpression (DefTokeniser& token) : scaleGreen(0),scaleBlue(0),scaleAlpha(0) {
@@ -363,75 +541,58 @@ ScaleExpression::ScaleExpression (DefTokeniser& token) : scaleGreen(0),scaleBlue
 	mapExp = createForToken(token);
 	token.assertNextToken(",");
 	scaleRed = string::convert<float>(token.nextToken());
-	if (token.nextToken() == ")") {
-		return;
-	}
-	scaleGreen = string::convert<float>(token.nextToken());
-	if (token.nextToken() == ")") {
-		return;
-	}
-	scaleBlue = string::convert<float>(token.nextToken());
-	if (token.nextToken() == ")") {
-		return;
-	}
-	scaleAlpha = string::convert<float>(token.nextToken());
-	token.assertNextToken(")");
-}
 
-ImagePtr ScaleExpression::getImage() const {
-    ImagePtr img = mapExp->getImage();
+	// Green, blue and alpha are optional
+	float* optionalScales[] = { &scaleGreen, &scaleBlue, &scaleAlpha };
 
-    if (img == NULL) return ImagePtr();
+	std::size_t numOptional = 0;
 
-	// Don't process precompressed images
-	if (img->isPrecompressed()) {
-		rWarning() << "Cannot evaluate map expression with precompressed texture." << std::endl;
-		return img;
+	while (numOptional < 3 && token.nextToken() != ")") {
+		*optionalScales[numOptional++] = string::convert<float>(token.nextToken());
 	}
 
-    std::size_t width = img->getWidth(0);
-    std::size_t height = img->getHeight(0);
-
-    if (scaleRed < 0 || scaleGreen < 0 || scaleBlue < 0 || scaleAlpha < 0) {
-		std::cout << "[shaders] ScaleExpression: Invalid scale values found.\n";
-		return img;
+	if (numOptional == 3) {
+		token.assertNextToken(")");
 	}
 
-    ImagePtr result (new RGBAImage(width, height));
-
-    byte* in = img->getMipMapPixels(0);
-    byte* out = result->getMipMapPixels(0);
+	if (scaleRed < 0 || scaleGreen < 0 || scaleBlue < 0 || scaleAlpha < 0) {
+		rWarning() << "[shaders] ScaleExpression: Invalid scale values found." << std::endl;
+	}
+}
 
-    // iterate through the pixels
-    for( std::size_t y = 0; y < height; ++y)
-	{
-		for( std::size_t x = 0; x < width; ++x)
-		{
-			// prevent negative values and check for values >255
-			int red = float_to_integer(static_cast<float>(in[0]) * scaleRed);
-			out[0] = (red>255) ? 255 : red;
+std::size_t ScaleExpression::getNumArguments() const {
+	return 1;
+}
 
-			int green = float_to_integer(static_cast<float>(in[1]) * scaleGreen);
-			out[1] = (green>255) ? 255 : green;
+const MapExpressionPtr& ScaleExpression::getArgument(std::size_t index) const {
+	return mapExp;
+}
 
-			int blue = float_to_integer(static_cast<float>(in[2]) * scaleBlue);
-			out[2] = (blue>255) ? 255 : blue;
+void ScaleExpression::evaluatePixels(const byte* const* arguments, byte* output,
+									 std::size_t numPixels) const
+{
+	const byte* in = arguments[0];
 
-			int alpha = float_to_integer(static_cast<float>(in[3]) * scaleAlpha);
-			out[3] = (alpha>255) ? 255 : alpha;
+	if (scaleRed < 0 || scaleGreen < 0 || scaleBlue < 0 || scaleAlpha < 0) {
+		// Leave the image unchanged, this has been reported on construction
+		std::copy(in, in + numPixels * 4, output);
+		return;
+	}
 
-			// advance the pixel pointer
-			in += 4;
-			out += 4;
-		}
-    }
-	return result;
+	// prevent negative values and check for values >255
+	for (std::size_t i = 0; i < numPixels * 4; i += 4)
+	{
+		output[i + 0] = scaleClamped(in[i + 0], scaleRed);
+		output[i + 1] = scaleClamped(in[i + 1], scaleGreen);
+		output[i + 2] = scaleClamped(in[i + 2], scaleBlue);
+		output[i + 3] = scaleClamped(in[i + 3], scaleAlpha);
+	}
 }
 
 std::string ScaleExpression::getIdentifier() const {
-	std::string identifier = "_scale_";
-	identifier.append(mapExp->getIdentifier() + string::to_string(scaleRed) + string::to_string(scaleGreen) + string::to_string(scaleBlue) + string::to_string(scaleAlpha));
-	return identifier;
+	return "scale(" + mapExp->getIdentifier() + ", " + string::to_string(scaleRed) + ", " +
+		string::to_string(scaleGreen) + ", " + string::to_string(scaleBlue) + ", " +
+		string::to_string(scaleAlpha) + ")";
 }
 
 InvertAlphaExpression::InvertAlphaExpression (DefTokeniser& token) {
@@ -440,48 +601,30 @@ InvertAlphaExpression::InvertAlphaExpression (DefTokeniser& token) {
 	token.assertNextToken(")");
 }
 
-ImagePtr InvertAlphaExpression::getImage() const {
-	ImagePtr img = mapExp->getImage();
-
-	if (img == NULL) return ImagePtr();
-
-	// Don't process precompressed images
-	if (img->isPrecompressed()) {
-		rWarning() << "Cannot evaluate map expression with precompressed texture." << std::endl;
-		return img;
-	}
-
-	std::size_t width = img->getWidth(0);
-	std::size_t height = img->getHeight(0);
+std::size_t InvertAlphaExpression::getNumArguments() const {
+	return 1;
+}
 
-	ImagePtr result (new RGBAImage(width, height));
+const MapExpressionPtr& InvertAlphaExpression::getArgument(std::size_t index) const {
+	return mapExp;
+}
 
-	byte* in = img->getMipMapPixels(0);
-	byte* out = result->getMipMapPixels(0);
+void InvertAlphaExpression::evaluatePixels(const byte* const* arguments, byte* output,
+										   std::size_t numPixels) const
+{
+	const byte* in = arguments[0];
 
-	// iterate through the pixels
-	for( std::size_t y = 0; y < height; ++y)
+	for (std::size_t i = 0; i < numPixels * 4; i += 4)
 	{
-		for( std::size_t x = 0; x < width; ++x)
-		{
-			out[0] = in[0];
-			out[1] = in[1];
-			out[2] = in[2];
-			out[3] = 255 - in[3];
-
-			// advance the pixel pointer
-			in += 4;
-			out += 4;
-		}
+		output[i + 0] = in[i + 0];
+		output[i + 1] = in[i + 1];
+		output[i + 2] = in[i + 2];
+		output[i + 3] = 255 - in[i + 3];
 	}
-
-	return result;
 }
 
 std::string InvertAlphaExpression::getIdentifier() const {
-	std::string identifier = "_invertalpha_";
-	identifier.append(mapExp->getIdentifier());
-	return identifier;
+	return "invertalpha(" + mapExp->getIdentifier() + ")";
 }
 
 InvertColorExpression::InvertColorExpression (DefTokeniser& token) {
@@ -490,46 +633,30 @@ InvertColorExpression::InvertColorExpression (DefTokeniser& token) {
 	token.assertNextToken(")");
 }
 
-ImagePtr InvertColorExpression::getImage() const {
-	ImagePtr img = mapExp->getImage();
-
-	if (img == NULL) return ImagePtr();
-
-	// Don't process precompressed images
-	if (img->isPrecompressed()) {
-		rWarning() << "Cannot evaluate map expression with precompressed texture." << std::endl;
-		return img;
-	}
-
-	std::size_t width = img->getWidth(0);
-	std::size_t height = img->getHeight(0);
-
-	ImagePtr result (new RGBAImage(width, height));
+std::size_t InvertColorExpression::getNumArguments() const {
+	return 1;
+}
 
-	byte* in = img->getMipMapPixels(0);
-	byte* out = result->getMipMapPixels(0);
+const MapExpressionPtr& InvertColorExpression::getArgument(std::size_t index) const {
+	return mapExp;
+}
 
-	// iterate through the pixels
-	for( std::size_t y = 0; y < height; y++) {
-		for( std::size_t x = 0; x < width; x++) {
-			out[0] = 255 - in[0];
-			out[1] = 255 - in[1];
-			out[2] = 255 - in[2];
-			out[3] = in[3];
+void InvertColorExpression::evaluatePixels(const byte* const* arguments, byte* output,
+										   std::size_t numPixels) const
+{
+	const byte* in = arguments[0];
 
-			// advance the pixel pointer
-			in += 4;
-			out += 4;
-		}
+	for (std::size_t i = 0; i < numPixels * 4; i += 4)
+	{
+		output[i + 0] = 255 - in[i + 0];
+		output[i + 1] = 255 - in[i + 1];
+		output[i + 2] = 255 - in[i + 2];
+		output[i + 3] = in[i + 3];
 	}
-
-	return result;
 }
 
 std::string InvertColorExpression::getIdentifier() const {
-	std::string identifier = "_invertcolor_";
-	identifier.append(mapExp->getIdentifier());
-	return identifier;
+	return "invertcolor(" + mapExp->getIdentifier() + ")";
 }
 
 MakeIntensityExpression::MakeIntensityExpression (DefTokeniser& token) {
@@ -538,48 +665,30 @@ MakeIntensityExpression::MakeIntensityExpression (DefTokeniser& token) {
 	token.assertNextToken(")");
 }
 
-ImagePtr MakeIntensityExpression::getImage() const {
-	ImagePtr img = mapExp->getImage();
-
-	if (img == NULL) return ImagePtr();
-
-	// Don't process precompressed images
-	if (img->isPrecompressed()) {
-		rWarning() << "Cannot evaluate map expression with precompressed texture." << std::endl;
-		return img;
-	}
-
-	std::size_t width = img->getWidth(0);
-	std::size_t height = img->getHeight(0);
+std::size_t MakeIntensityExpression::getNumArguments() const {
+	return 1;
+}
 
-	ImagePtr result (new RGBAImage(width, height));
+const MapExpressionPtr& MakeIntensityExpression::getArgument(std::size_t index) const {
+	return mapExp;
+}
 
-	byte* in = img->getMipMapPixels(0);
-	byte* out = result->getMipMapPixels(0);
+void MakeIntensityExpression::evaluatePixels(const byte* const* arguments, byte* output,
+											 std::size_t numPixels) const
+{
+	const byte* in = arguments[0];
 
-	// iterate through the pixels
-	for( std::size_t y = 0; y < height; ++y)
+	for (std::size_t i = 0; i < numPixels * 4; i += 4)
 	{
-		for( std::size_t x = 0; x < width; ++x)
-		{
-			out[0] = in[0];
-			out[1] = in[0];
-			out[2] = in[0];
-			out[3] = in[0];
-
-			// advance the pixel pointer
-			in += 4;
-			out += 4;
-		}
+		output[i + 0] = in[i + 0];
+		output[i + 1] = in[i + 0];
+		output[i + 2] = in[i + 0];
+		output[i + 3] = in[i + 0];
 	}
-
-	return result;
 }
 
 std::string MakeIntensityExpression::getIdentifier() const {
-	std::string identifier = "_makeintensity_";
-	identifier.append(mapExp->getIdentifier());
-	return identifier;
+	return "makeintensity(" + mapExp->getIdentifier() + ")";
 }
 
 MakeAlphaExpression::MakeAlphaExpression (DefTokeniser& token) {
@@ -588,48 +697,30 @@ MakeAlphaExpression::MakeAlphaExpression (DefTokeniser& token) {
 	token.assertNextToken(")");
 }
 
-ImagePtr MakeAlphaExpression::getImage() const {
-	ImagePtr img = mapExp->getImage();
-
-	if (img == NULL) return ImagePtr();
-
-	// Don't process precompressed images
-	if (img->isPrecompressed()) {
-		rWarning() << "Cannot evaluate map expression with precompressed texture." << std::endl;
-		return img;
-	}
-
-	std::size_t width = img->getWidth(0);
-	std::size_t height = img->getHeight(0);
+std::size_t MakeAlphaExpression::getNumArguments() const {
+	return 1;
+}
 
-	ImagePtr result (new RGBAImage(width, height));
+const MapExpressionPtr& MakeAlphaExpression::getArgument(std::size_t index) const {
+	return mapExp;
+}
 
-	byte* in = img->getMipMapPixels(0);
-	byte* out = result->getMipMapPixels(0);
+void MakeAlphaExpression::evaluatePixels(const byte* const* arguments, byte* output,
+										 std::size_t numPixels) const
+{
+	const byte* in = arguments[0];
 
-	// iterate through the pixels
-	for( std::size_t y = 0; y < height; y++)
+	for (std::size_t i = 0; i < numPixels * 4; i += 4)
 	{
-		for( std::size_t x = 0; x < width; x++)
-		{
-			out[0] = 255;
-			out[1] = 255;
-			out[2] = 255;
-			out[3] = (in[0] + in[1] + in[2])/3;
-
-			// advance the pixel pointer
-			in += 4;
-			out += 4;
-		}
+		output[i + 0] = 255;
+		output[i + 1] = 255;
+		output[i + 2] = 255;
+		output[i + 3] = (in[i + 0] + in[i + 1] + in[i + 2]) / 3;
 	}
-
-	return result;
 }
 
 std::string MakeAlphaExpression::getIdentifier() const {
-	std::string identifier = "_makealpha_";
-	identifier.append(mapExp->getIdentifier());
-	return identifier;
+	return "makealpha(" + mapExp->getIdentifier() + ")";
 }
 
 /* ImageExpression */
@@ -642,7 +733,7 @@ ImageExpression::ImageExpression(const std::string& imgName)
 	_imgName = os::standardPath(imgName).substr(0, imgName.rfind("."));
 }
 
-ImagePtr ImageExpression::getImage() const
+ImagePtr ImageExpression::createImage() const
 {
 	// Check for some image keywords and load the correct file
 	if (_imgName == "_black") {
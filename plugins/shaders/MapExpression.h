@@ -2,6 +2,7 @@
 #define MAPEXPRESSION_H_
 
 #include <string>
+#include <vector>
 
 #include <boost/shared_ptr.hpp>
 
@@ -31,8 +32,11 @@ public: /* INTERFACE METHODS */
 	/**
      * \brief
      * Construct and return the image created from this map expression.
+     *
+     * Images are shared between all expressions with the same identifier
+     * (see getIdentifier()), callers must not modify them.
      */
-	virtual ImagePtr getImage() const = 0;
+	ImagePtr getImage() const;
 
     /**
      * \brief
@@ -67,8 +71,22 @@ public: /* STATIC CONSTRUCTION METHODS */
 	static MapExpressionPtr createForToken(DefTokeniser& token);
 	static MapExpressionPtr createForString(std::string str);
 
+	/**
+	 * \brief
+	 * Release the images kept for sharing by getImage(), needs to be called
+	 * when the image files might have changed.
+	 */
+	static void clearImageCache();
+
 protected:
 
+	/**
+	 * \brief
+	 * Create the image of this expression, called by getImage() if no image
+	 * with the same identifier is available.
+	 */
+	virtual ImagePtr createImage() const = 0;
+
 	/** greebo: Assures that the image is matching the desired dimensions.
 	 *
 	 * @input: The image to be rescaled. If it doesn't match <width x height>
@@ -82,43 +100,106 @@ protected:
 	static ImagePtr getResampled(const ImagePtr& input, std::size_t width, std::size_t height);
 };
 
+/**
+ * \brief
+ * Base class for expressions calculating each output pixel from the pixels
+ * at the same position of their input images.
+ *
+ * A tree of nested pixel expressions is evaluated in a single pass over the
+ * image, row by row, without creating an intermediate image for each node.
+ * Only the inputs of the tree (images, heightmaps etc.) are fetched as a whole,
+ * these are resampled to the dimensions of the first one.
+ */
+class PixelExpression
+: public MapExpression
+{
+	// A pixel expression of the tree with the rows holding its arguments
+	// and its output, see createImage()
+	struct Instruction
+	{
+		const PixelExpression* expression;
+		std::vector<std::size_t> arguments;
+		std::size_t output;
+	};
+
+	// The tree rooted at this expression, compiled on first use. The
+	// instructions are in evaluation order, the last one is this expression.
+	mutable std::vector<MapExpressionPtr> _inputs;
+	mutable std::vector<std::size_t> _inputRows;
+	mutable std::vector<Instruction> _instructions;
+	mutable std::size_t _numRows;
+
+public:
+
+	PixelExpression();
+
+	/// Return the number of sub-expressions
+	virtual std::size_t getNumArguments() const = 0;
+
+	/// Return the sub-expression with the given index
+	virtual const MapExpressionPtr& getArgument(std::size_t index) const = 0;
+
+	/**
+	 * \brief
+	 * Calculate numPixels RGBA pixels from the given rows of input pixels,
+	 * one row per argument.
+	 */
+	virtual void evaluatePixels(const byte* const* arguments, byte* output,
+								std::size_t numPixels) const = 0;
+
+protected:
+
+	ImagePtr createImage() const;
+
+private:
+
+	// Appends the instructions of the given tree, returns the row of its result
+	std::size_t compile(const PixelExpression& expression) const;
+};
+
 // the specific MapExpressions
 class HeightMapExpression : public MapExpression {
 	MapExpressionPtr heightMapExp;
 	float scale;
 public:
 	HeightMapExpression (DefTokeniser& token);
-	ImagePtr getImage() const;
 	std::string getIdentifier() const;
+protected:
+	ImagePtr createImage() const;
 };
 
-class AddNormalsExpression : public MapExpression {
+class AddNormalsExpression : public PixelExpression {
 	MapExpressionPtr mapExpOne;
 	MapExpressionPtr mapExpTwo;
 public:
 	AddNormalsExpression (DefTokeniser& token);
-	ImagePtr getImage() const;
 	std::string getIdentifier() const;
+	std::size_t getNumArguments() const;
+	const MapExpressionPtr& getArgument(std::size_t index) const;
+	void evaluatePixels(const byte* const* arguments, byte* output, std::size_t numPixels) const;
 };
 
 class SmoothNormalsExpression : public MapExpression {
 	MapExpressionPtr mapExp;
 public:
 	SmoothNormalsExpression (DefTokeniser& token);
-	ImagePtr getImage() const;
 	std::string getIdentifier() const;
+protected:
+	ImagePtr createImage() const;
 };
 
-class AddExpression : public MapExpression {
+class AddExpression : public PixelExpression {
 	MapExpressionPtr mapExpOne;
 	MapExpressionPtr mapExpTwo;
 public:
 	AddExpression (DefTokeniser& token);
-	ImagePtr getImage() const;
 	std::string getIdentifier() const;
+	std::size_t getNumArguments() const;
+	const MapExpressionPtr& getArgument(std::size_t index) const;
+	void evaluatePixels(const byte* const* arguments, byte* output, std::size_t numPixels) const;
 };
 
-class ScaleExpression : public MapExpression {
+class ScaleExpression : public PixelExpression {
 	MapExpressionPtr mapExp;
 	float scaleRed;
 	float scaleGreen;
@@ -126,40 +207,50 @@ class ScaleExpression : public MapExpression {
 	float scaleAlpha;
 public:
 	ScaleExpression (DefTokeniser& token);
-	ImagePtr getImage() const;
 	std::string getIdentifier() const;
+	std::size_t getNumArguments() const;
+	const MapExpressionPtr& getArgument(std::size_t index) const;
+	void evaluatePixels(const byte* const* arguments, byte* output, std::size_t numPixels) const;
 };
 
-class InvertAlphaExpression : public MapExpression {
+class InvertAlphaExpression : public PixelExpression {
 	MapExpressionPtr mapExp;
 public:
 	InvertAlphaExpression (DefTokeniser& token);
-	ImagePtr getImage() const;
 	std::string getIdentifier() const;
+	std::size_t getNumArguments() const;
+	const MapExpressionPtr& getArgument(std::size_t index) const;
+	void evaluatePixels(const byte* const* arguments, byte* output, std::size_t numPixels) const;
 };
 
-class InvertColorExpression : public MapExpression {
+class InvertColorExpression : public PixelExpression {
 	MapExpressionPtr mapExp;
 public:
 	InvertColorExpression (DefTokeniser& token);
-	ImagePtr getImage() const;
 	std::string getIdentifier() const;
+	std::size_t getNumArguments() const;
+	const MapExpressionPtr& getArgument(std::size_t index) const;
+	void evaluatePixels(const byte* const* arguments, byte* output, std::size_t numPixels) const;
 };
 
-class MakeIntensityExpression : public MapExpression {
+class MakeIntensityExpression : public PixelExpression {
 	MapExpressionPtr mapExp;
 public:
 	MakeIntensityExpression (DefTokeniser& token);
-	ImagePtr getImage() const;
 	std::string getIdentifier() const;
+	std::size_t getNumArguments() const;
+	const MapExpressionPtr& getArgument(std::size_t index) const;
+	void evaluatePixels(const byte* const* arguments, byte* output, std::size_t numPixels) const;
 };
 
-class MakeAlphaExpression : public MapExpression {
+class MakeAlphaExpression : public PixelExpression {
 	MapExpressionPtr mapExp;
 public:
 	MakeAlphaExpression (DefTokeniser& token);
-	ImagePtr getImage() const;
 	std::string getIdentifier() const;
+	std::size_t getNumArguments() const;
+	const MapExpressionPtr& getArgument(std::size_t index) const;
+	void evaluatePixels(const byte* const* arguments, byte* output, std::size_t numPixels) const;
 };
 
 /**
@@ -177,8 +268,10 @@ public:
 
     /* MapExpression interface */
 	ImageExpression(const std::string& imgName);
-	ImagePtr getImage() const;
 	std::string getIdentifier() const;
+
+protected:
+	ImagePtr createImage() const;
 };
 
 } // namespace shaders
@@ -10,23 +10,46 @@ namespace shaders
 {
 
 /**
- * Wrapper class that associates a ShaderTemplate with its filename.
+ * Wrapper class that associates a material declaration with its filename.
+ * Only the position of the declaration block within the file is stored,
+ * the ShaderLibrary reads the block and constructs the ShaderTemplate when
+ * the material is requested for the first time.
  */
 struct ShaderDefinition
 {
-	// The shader template
+	// The shader template, NULL until the definition has been realised
 	ShaderTemplatePtr shaderTemplate;
 
 	// Filename from which the shader was parsed
 	std::string filename;
 
-	/* Constructor
+	// Position of the unparsed declaration block (excluding the braces),
+	// in characters of the file's text stream
+	std::size_t blockOffset;
+	std::size_t blockLength;
+
+	/* Constructs an unrealised definition from the position of its
+	 * declaration block in the given file
+	 */
+	ShaderDefinition(const std::string& fname, std::size_t offset, std::size_t length) :
+		filename(fname),
+		blockOffset(offset),
+		blockLength(length)
+	{}
+
+	/* Constructs a definition using an existing template
 	 */
 	ShaderDefinition(const ShaderTemplatePtr& templ, const std::string& fname) :
 		shaderTemplate(templ),
-		filename(fname)
+		filename(fname),
+		blockOffset(0),
+		blockLength(0)
 	{}
 
+	bool isRealised() const
+	{
+		return shaderTemplate != NULL;
+	}
 };
 
 typedef std::map<std::string, ShaderDefinition, ShaderNameCompareFunctor> ShaderDefinitionMap;
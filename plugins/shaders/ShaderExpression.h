@@ -4,6 +4,7 @@
 #include "irender.h"
 #include "parser/DefTokeniser.h"
 #include "TableDefinition.h"
+#include "ShaderExpressionProgram.h"
 
 namespace shaders
 {
@@ -64,6 +65,12 @@ public:
 		return _index;
 	}
 
+	/**
+	 * Emits the instructions calculating this expression into the given
+	 * program, returning the operand holding the result.
+	 */
+	virtual ShaderExpressionProgram::Operand compile(ShaderExpressionProgram& program) = 0;
+
 	static IShaderExpressionPtr createFromString(const std::string& exprStr);
 
 	static IShaderExpressionPtr createFromTokens(parser::DefTokeniser& tokeniser);
@@ -97,6 +104,11 @@ public:
 	{
 		return entity.getShaderParm(_parmNum);
 	}
+
+	virtual ShaderExpressionProgram::Operand compile(ShaderExpressionProgram& program)
+	{
+		return program.shaderParm(_parmNum);
+	}
 };
 
 class GlobalShaderParmExpression :
@@ -121,6 +133,11 @@ public:
 	{
 		return getValue(time);
 	}
+
+	virtual ShaderExpressionProgram::Operand compile(ShaderExpressionProgram& program)
+	{
+		return program.constant(getValue(0));
+	}
 };
 
 // An expression returning the current (game) time as result
@@ -141,6 +158,11 @@ public:
 	{
 		return getValue(time);
 	}
+
+	virtual ShaderExpressionProgram::Operand compile(ShaderExpressionProgram& program)
+	{
+		return program.time();
+	}
 };
 
 // An expression representing a constant floating point number
@@ -165,6 +187,11 @@ public:
 	{
 		return getValue(time);
 	}
+
+	virtual ShaderExpressionProgram::Operand compile(ShaderExpressionProgram& program)
+	{
+		return program.constant(_value);
+	}
 };
 
 // An expression looking up a value in a table def
@@ -198,6 +225,11 @@ public:
 		float lookupVal = _lookupExpr->getValue(time, entity);
 		return _tableDef->getValue(lookupVal);
 	}
+
+	virtual ShaderExpressionProgram::Operand compile(ShaderExpressionProgram& program)
+	{
+		return program.tableLookup(*_tableDef, _lookupExpr);
+	}
 };
 
 // Abstract base class for an expression taking two sub-expression as arguments
@@ -271,6 +303,11 @@ public:
 	{
 		return _a->getValue(time, entity) + _b->getValue(time, entity);
 	}
+
+	virtual ShaderExpressionProgram::Operand compile(ShaderExpressionProgram& program)
+	{
+		return program.binary(ShaderExpressionProgram::OP_ADD, _a, _b);
+	}
 };
 
 // An expression subtracting the value of two expressions
@@ -292,6 +329,11 @@ public:
 	{
 		return _a->getValue(time, entity) - _b->getValue(time, entity);
 	}
+
+	virtual ShaderExpressionProgram::Operand compile(ShaderExpressionProgram& program)
+	{
+		return program.binary(ShaderExpressionProgram::OP_SUBTRACT, _a, _b);
+	}
 };
 
 // An expression multiplying the value of two expressions
@@ -313,6 +355,11 @@ public:
 	{
 		return _a->getValue(time, entity) * _b->getValue(time, entity);
 	}
+
+	virtual ShaderExpressionProgram::Operand compile(ShaderExpressionProgram& program)
+	{
+		return program.binary(ShaderExpressionProgram::OP_MULTIPLY, _a, _b);
+	}
 };
 
 // An expression dividing the value of two expressions
@@ -334,6 +381,11 @@ public:
 	{
 		return _a->getValue(time, entity) / _b->getValue(time, entity);
 	}
+
+	virtual ShaderExpressionProgram::Operand compile(ShaderExpressionProgram& program)
+	{
+		return program.binary(ShaderExpressionProgram::OP_DIVIDE, _a, _b);
+	}
 };
 
 // An expression returning modulo of A % B
@@ -355,6 +407,11 @@ public:
 	{
 		return fmod(_a->getValue(time, entity), _b->getValue(time, entity));
 	}
+
+	virtual ShaderExpressionProgram::Operand compile(ShaderExpressionProgram& program)
+	{
+		return program.binary(ShaderExpressionProgram::OP_MODULO, _a, _b);
+	}
 };
 
 // An expression returning 1 if A < B, otherwise 0
@@ -376,6 +433,11 @@ public:
 	{
 		return _a->getValue(time, entity) < _b->getValue(time, entity) ? 1.0f : 0;
 	}
+
+	virtual ShaderExpressionProgram::Operand compile(ShaderExpressionProgram& program)
+	{
+		return program.binary(ShaderExpressionProgram::OP_LESSER, _a, _b);
+	}
 };
 
 // An expression returning 1 if A <= B, otherwise 0
@@ -397,6 +459,11 @@ public:
 	{
 		return _a->getValue(time, entity) <= _b->getValue(time, entity) ? 1.0f : 0;
 	}
+
+	virtual ShaderExpressionProgram::Operand compile(ShaderExpressionProgram& program)
+	{
+		return program.binary(ShaderExpressionProgram::OP_LESSER_EQUAL, _a, _b);
+	}
 };
 
 // An expression returning 1 if A > B, otherwise 0
@@ -418,6 +485,11 @@ public:
 	{
 		return _a->getValue(time, entity) > _b->getValue(time, entity) ? 1.0f : 0;
 	}
+
+	virtual ShaderExpressionProgram::Operand compile(ShaderExpressionProgram& program)
+	{
+		return program.binary(ShaderExpressionProgram::OP_GREATER, _a, _b);
+	}
 };
 
 // An expression returning 1 if A >= B, otherwise 0
@@ -439,6 +511,11 @@ public:
 	{
 		return _a->getValue(time, entity) >= _b->getValue(time, entity) ? 1.0f : 0;
 	}
+
+	virtual ShaderExpressionProgram::Operand compile(ShaderExpressionProgram& program)
+	{
+		return program.binary(ShaderExpressionProgram::OP_GREATER_EQUAL, _a, _b);
+	}
 };
 
 // An expression returning 1 if A == B, otherwise 0
@@ -460,6 +537,11 @@ public:
 	{
 		return _a->getValue(time, entity) == _b->getValue(time, entity) ? 1.0f : 0;
 	}
+
+	virtual ShaderExpressionProgram::Operand compile(ShaderExpressionProgram& program)
+	{
+		return program.binary(ShaderExpressionProgram::OP_EQUAL, _a, _b);
+	}
 };
 
 // An expression returning 1 if A != B, otherwise 0
@@ -481,6 +563,11 @@ public:
 	{
 		return _a->getValue(time, entity) != _b->getValue(time, entity) ? 1.0f : 0;
 	}
+
+	virtual ShaderExpressionProgram::Operand compile(ShaderExpressionProgram& program)
+	{
+		return program.binary(ShaderExpressionProgram::OP_NOT_EQUAL, _a, _b);
+	}
 };
 
 // An expression returning 1 if both A and B are true (non-zero), otherwise 0
@@ -502,6 +589,11 @@ public:
 	{
 		return (_a->getValue(time, entity) != 0 && _b->getValue(time, entity) != 0) ? 1.0f : 0;
 	}
+
+	virtual ShaderExpressionProgram::Operand compile(ShaderExpressionProgram& program)
+	{
+		return program.binary(ShaderExpressionProgram::OP_AND, _a, _b);
+	}
 };
 
 // An expression returning 1 if either A or B are true (non-zero), otherwise 0
@@ -523,6 +615,11 @@ public:
 	{
 		return (_a->getValue(time, entity) != 0 || _b->getValue(time, entity) != 0) ? 1.0f : 0;
 	}
+
+	virtual ShaderExpressionProgram::Operand compile(ShaderExpressionProgram& program)
+	{
+		return program.binary(ShaderExpressionProgram::OP_OR, _a, _b);
+	}
 };
 
 } // namespace
@@ -0,0 +1,230 @@
+#include "ShaderExpressionProgram.h"
+
+#include "irender.h"
+#include "ShaderExpression.h"
+
+#include <cmath>
+#include <algorithm>
+
+namespace shaders
+{
+
+namespace
+{
+	// Applies the given binary operator, used for folding and execution alike
+	inline float applyBinary(ShaderExpressionProgram::OpCode op, float a, float b)
+	{
+		switch (op)
+		{
+		case ShaderExpressionProgram::OP_ADD:			return a + b;
+		case ShaderExpressionProgram::OP_SUBTRACT:		return a - b;
+		case ShaderExpressionProgram::OP_MULTIPLY:		return a * b;
+		case ShaderExpressionProgram::OP_DIVIDE:		return a / b;
+		case ShaderExpressionProgram::OP_MODULO:		return fmod(a, b);
+		case ShaderExpressionProgram::OP_LESSER:		return a < b ? 1.0f : 0;
+		case ShaderExpressionProgram::OP_LESSER_EQUAL:	return a <= b ? 1.0f : 0;
+		case ShaderExpressionProgram::OP_GREATER:		return a > b ? 1.0f : 0;
+		case ShaderExpressionProgram::OP_GREATER_EQUAL:	return a >= b ? 1.0f : 0;
+		case ShaderExpressionProgram::OP_EQUAL:			return a == b ? 1.0f : 0;
+		case ShaderExpressionProgram::OP_NOT_EQUAL:		return a != b ? 1.0f : 0;
+		case ShaderExpressionProgram::OP_AND:			return (a != 0 && b != 0) ? 1.0f : 0;
+		case ShaderExpressionProgram::OP_OR:			return (a != 0 || b != 0) ? 1.0f : 0;
+		default:
+			return 0;
+		};
+	}
+}
+
+ShaderExpressionProgram::ShaderExpressionProgram() :
+	_timeIndex(0),
+	_compiled(false),
+	_time(0),
+	_timeValid(false)
+{}
+
+void ShaderExpressionProgram::clear()
+{
+	_timeCode.clear();
+	_entityCode.clear();
+	_values.clear();
+	_timeIndex = 0;
+	_shaderParms.clear();
+	_compiled = false;
+	_timeValid = false;
+}
+
+void ShaderExpressionProgram::addOutput(const IShaderExpressionPtr& expr, std::size_t reg,
+										Registers& registers)
+{
+	Operand result = compile(expr);
+
+	if (result.dependency == DEPENDS_ON_NOTHING)
+	{
+		registers[reg] = _values[result.index];
+		return;
+	}
+
+	Instruction instr = Instruction();
+	instr.op = OP_STORE;
+	instr.dest = reg;
+	instr.a = result.index;
+
+	(result.dependency == DEPENDS_ON_TIME ? _timeCode : _entityCode).push_back(instr);
+}
+
+void ShaderExpressionProgram::execute(std::size_t time, const IRenderEntity* entity,
+									  Registers& registers)
+{
+	if (!_timeValid || time != _time)
+	{
+		run(_timeCode, time, entity, registers);
+
+		_time = time;
+		_timeValid = true;
+	}
+
+	run(_entityCode, time, entity, registers);
+}
+
+ShaderExpressionProgram::Operand ShaderExpressionProgram::compile(const IShaderExpressionPtr& expr)
+{
+	ShaderExpression* node = dynamic_cast<ShaderExpression*>(expr.get());
+
+	if (node != NULL)
+	{
+		return node->compile(*this);
+	}
+
+	// Some foreign implementation, evaluate it through its interface
+	Instruction instr = Instruction();
+	instr.op = OP_CALL;
+	instr.expression = expr.get();
+
+	return emit(instr, DEPENDS_ON_ENTITY);
+}
+
+ShaderExpressionProgram::Operand ShaderExpressionProgram::constant(float value)
+{
+	_values.push_back(value);
+	return Operand(_values.size() - 1, DEPENDS_ON_NOTHING);
+}
+
+ShaderExpressionProgram::Operand ShaderExpressionProgram::time()
+{
+	if (_timeCode.empty() || _timeCode.front().op != OP_TIME)
+	{
+		Instruction instr = Instruction();
+		instr.op = OP_TIME;
+
+		_values.push_back(0);
+		instr.dest = _timeIndex = _values.size() - 1;
+
+		// Keep the time at the front, everything else may depend on it
+		_timeCode.insert(_timeCode.begin(), instr);
+	}
+
+	return Operand(_timeIndex, DEPENDS_ON_TIME);
+}
+
+ShaderExpressionProgram::Operand ShaderExpressionProgram::shaderParm(int parmNum)
+{
+	std::map<int, std::size_t>::const_iterator found = _shaderParms.find(parmNum);
+
+	if (found != _shaderParms.end())
+	{
+		return Operand(found->second, DEPENDS_ON_ENTITY);
+	}
+
+	Instruction instr = Instruction();
+	instr.op = OP_SHADERPARM;
+	instr.parmNum = parmNum;
+
+	Operand result = emit(instr, DEPENDS_ON_ENTITY);
+	_shaderParms[parmNum] = result.index;
+
+	return result;
+}
+
+ShaderExpressionProgram::Operand ShaderExpressionProgram::tableLookup(
+	TableDefinition& table, const IShaderExpressionPtr& lookupExpr)
+{
+	Operand lookup = compile(lookupExpr);
+
+	if (lookup.dependency == DEPENDS_ON_NOTHING)
+	{
+		return constant(table.getValue(_values[lookup.index]));
+	}
+
+	Instruction instr = Instruction();
+	instr.op = OP_TABLE;
+	instr.a = lookup.index;
+	instr.table = &table;
+
+	return emit(instr, lookup.dependency);
+}
+
+ShaderExpressionProgram::Operand ShaderExpressionProgram::binary(
+	OpCode op, const IShaderExpressionPtr& a, const IShaderExpressionPtr& b)
+{
+	Operand first = compile(a);
+	Operand second = compile(b);
+
+	if (first.dependency == DEPENDS_ON_NOTHING && second.dependency == DEPENDS_ON_NOTHING)
+	{
+		return constant(applyBinary(op, _values[first.index], _values[second.index]));
+	}
+
+	Instruction instr = Instruction();
+	instr.op = op;
+	instr.a = first.index;
+	instr.b = second.index;
+
+	return emit(instr, std::max(first.dependency, second.dependency));
+}
+
+ShaderExpressionProgram::Operand ShaderExpressionProgram::emit(Instruction& instr,
+															   Dependency dependency)
+{
+	_values.push_back(0);
+	instr.dest = _values.size() - 1;
+
+	(dependency == DEPENDS_ON_ENTITY ? _entityCode : _timeCode).push_back(instr);
+
+	return Operand(instr.dest, dependency);
+}
+
+void ShaderExpressionProgram::run(const Instructions& code, std::size_t time,
+								  const IRenderEntity* entity, Registers& registers)
+{
+	float* values = _values.empty() ? NULL : &_values.front();
+
+	for (Instructions::const_iterator i = code.begin(); i != code.end(); ++i)
+	{
+		const Instruction& instr = *i;
+
+		switch (instr.op)
+		{
+		case OP_TIME:
+			values[instr.dest] = time / 1000.0f; // convert msecs to secs
+			break;
+		case OP_SHADERPARM:
+			values[instr.dest] = entity != NULL ? entity->getShaderParm(instr.parmNum) : 0.0f;
+			break;
+		case OP_TABLE:
+			values[instr.dest] = instr.table->getValue(values[instr.a]);
+			break;
+		case OP_CALL:
+			values[instr.dest] = entity != NULL ?
+				instr.expression->getValue(time, *entity) : instr.expression->getValue(time);
+			break;
+		case OP_STORE:
+			registers[instr.dest] = values[instr.a];
+			break;
+		default:
+			values[instr.dest] = applyBinary(instr.op, values[instr.a], values[instr.b]);
+			break;
+		};
+	}
+}
+
+} // namespace
@@ -0,0 +1,161 @@
+#pragma once
+
+#include "ishaderexpression.h"
+#include "TableDefinition.h"
+
+#include <map>
+#include <vector>
+
+namespace shaders
+{
+
+/**
+ * A flattened form of the shader expressions of a material stage. The
+ * expression trees are compiled into a list of instructions operating on
+ * a local array of temporaries, the results are copied into the stage's
+ * registers.
+ *
+ * Sub-expressions only depending on constants are folded at compile time.
+ * Instructions depending on nothing but the time are kept apart from the
+ * ones referring to entity parameters: they are executed only when the time
+ * changes, their results are shared by all entities rendered in that frame.
+ */
+class ShaderExpressionProgram
+{
+public:
+	enum OpCode
+	{
+		OP_TIME,		// dest = time in seconds
+		OP_SHADERPARM,	// dest = entity shaderparm, 0 without entity
+		OP_TABLE,		// dest = table[a]
+		OP_CALL,		// dest = value of a non-compilable expression
+		OP_ADD,			// dest = a + b
+		OP_SUBTRACT,	// dest = a - b
+		OP_MULTIPLY,	// dest = a * b
+		OP_DIVIDE,		// dest = a / b
+		OP_MODULO,		// dest = fmod(a, b)
+		OP_LESSER,		// dest = a < b
+		OP_LESSER_EQUAL,	// dest = a <= b
+		OP_GREATER,		// dest = a > b
+		OP_GREATER_EQUAL,	// dest = a >= b
+		OP_EQUAL,		// dest = a == b
+		OP_NOT_EQUAL,	// dest = a != b
+		OP_AND,			// dest = a && b
+		OP_OR,			// dest = a || b
+		OP_STORE,		// register[dest] = a
+	};
+
+	// What the value of an operand depends on, ordered by increasing variability
+	enum Dependency
+	{
+		DEPENDS_ON_NOTHING = 0,	// constant
+		DEPENDS_ON_TIME = 1,
+		DEPENDS_ON_ENTITY = 2,
+	};
+
+	// A compiled (sub-)expression: the temporary holding its value
+	struct Operand
+	{
+		std::size_t index;
+		Dependency dependency;
+
+		Operand(std::size_t index_, Dependency dependency_) :
+			index(index_),
+			dependency(dependency_)
+		{}
+	};
+
+private:
+	struct Instruction
+	{
+		OpCode op;
+		std::size_t dest;
+		std::size_t a;
+		std::size_t b;
+
+		union
+		{
+			int parmNum;
+			TableDefinition* table;
+			IShaderExpression* expression;
+		};
+	};
+	typedef std::vector<Instruction> Instructions;
+
+	// Instructions depending on the time only, and those depending on an entity
+	Instructions _timeCode;
+	Instructions _entityCode;
+
+	// The temporaries, holding the folded constants at their initial values
+	std::vector<float> _values;
+
+	// Temporaries already holding the time and the shader parms
+	std::size_t _timeIndex;
+	std::map<int, std::size_t> _shaderParms;
+
+	bool _compiled;
+
+	// The time the time-dependent instructions have been executed for
+	std::size_t _time;
+	bool _timeValid;
+
+public:
+	ShaderExpressionProgram();
+
+	// Throws away all instructions, the program needs to be compiled again
+	void clear();
+
+	// Whether the program has been compiled since the last clear()
+	bool isCompiled() const
+	{
+		return _compiled;
+	}
+
+	// Marks the program as compiled, see addOutput()
+	void setCompiled()
+	{
+		_compiled = true;
+	}
+
+	// True if the results depend on entity parameters
+	bool isEntityDependent() const
+	{
+		return !_entityCode.empty();
+	}
+
+	/**
+	 * Compiles the given expression, its value is stored into the given
+	 * register when the program is executed. Constant values are written
+	 * to the registers right away.
+	 */
+	void addOutput(const IShaderExpressionPtr& expr, std::size_t reg, Registers& registers);
+
+	/**
+	 * Runs the program and writes the results into the registers. The time
+	 * dependent part is skipped if it has already been run for this time,
+	 * unless resetTime() has been called in between. Entity may be NULL.
+	 */
+	void execute(std::size_t time, const IRenderEntity* entity, Registers& registers);
+
+	// Forces the time dependent instructions to run at the next execute()
+	void resetTime()
+	{
+		_timeValid = false;
+	}
+
+	// Emitters, called by the ShaderExpression nodes during compilation
+	Operand compile(const IShaderExpressionPtr& expr);
+	Operand constant(float value);
+	Operand time();
+	Operand shaderParm(int parmNum);
+	Operand tableLookup(TableDefinition& table, const IShaderExpressionPtr& lookupExpr);
+	Operand binary(OpCode op, const IShaderExpressionPtr& a, const IShaderExpressionPtr& b);
+
+private:
+	Operand emit(Instruction& instr, Dependency dependency);
+
+	void run(const Instructions& code, std::size_t time, const IRenderEntity* entity,
+			 Registers& registers);
+};
+
+} // namespace
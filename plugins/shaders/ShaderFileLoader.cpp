@@ -2,6 +2,7 @@
 
 #include "ifilesystem.h"
 #include "iarchive.h"
+#include "itrace.h"
 #include "parser/DefTokeniser.h"
 #include "parser/DefBlockTokeniser.h"
 #include "ShaderDefinition.h"
@@ -63,10 +64,9 @@ void ShaderFileLoader::parseShaderFile(std::istream& inStr,
 
 		boost::algorithm::replace_all(block.name, "\\", "/"); // use forward slashes
 
-		ShaderTemplatePtr shaderTemplate(new ShaderTemplate(block.name, block.contents));
-
-		// Construct the ShaderDefinition wrapper class
-		ShaderDefinition def(shaderTemplate, filename);
+		// Only remember where the block is, the ShaderTemplate is constructed
+		// and parsed when the material is requested for the first time
+		ShaderDefinition def(filename, block.contentsOffset, block.contents.size());
 
 		// Insert into the definitions map, if not already present
 		if (!GetShaderLibrary().addDefinition(block.name, def))
@@ -82,6 +82,8 @@ void ShaderFileLoader::visit(const std::string& filename)
 	// Construct the full VFS path
 	std::string fullPath = _basePath + filename;
 
+	trace::ScopedZone zone("decls", "parseShaderFile", fullPath);
+
 	// Open the file
 	ArchiveTextFilePtr file = GlobalFileSystem().openTextFile(fullPath);
 
@@ -2,7 +2,12 @@
 
 #include <iostream>
 #include <utility>
+#include <algorithm>
+#include <iterator>
 #include "itextstream.h"
+#include "itrace.h"
+#include "ifilesystem.h"
+#include "iarchive.h"
 #include "ShaderTemplate.h"
 #include "Doom3ShaderSystem.h"
 #include "textures/ImageFileLoader.h"
@@ -10,10 +15,25 @@
 
 namespace shaders {
 
+namespace
+{
+	bool compareShaderNames(const std::pair<const string::InternedString, CShaderPtr>* a,
+							const std::pair<const string::InternedString, CShaderPtr>* b)
+	{
+		return ShaderNameCompareFunctor()(a->first.getString(), b->first.getString());
+	}
+}
+
+ShaderLibrary::ShaderLibrary() :
+	_numRealisedDefinitions(0)
+{}
+
 // Insert into the definitions map, if not already present
 bool ShaderLibrary::addDefinition(const std::string& name,
 								  const ShaderDefinition& def)
 {
+	Glib::RecMutex::Lock lock(_mutex);
+
 	std::pair<ShaderDefinitionMap::iterator, bool> result = _definitions.insert(
 		ShaderDefinitionMap::value_type(name, def)
 	);
@@ -23,13 +43,28 @@ bool ShaderLibrary::addDefinition(const std::string& name,
 
 ShaderDefinition& ShaderLibrary::getDefinition(const std::string& name)
 {
+	Glib::RecMutex::Lock lock(_mutex);
+
 	// Try to lookup the named definition
 	ShaderDefinitionMap::iterator i = _definitions.find(name);
 
 	if (i != _definitions.end())
     {
-		// Return the definition
-		return i->second;
+		ShaderDefinition& def = i->second;
+
+		if (!def.isRealised())
+		{
+			// First request, construct the template using the name as it
+			// has been declared. The declaration itself is parsed on demand.
+			std::string blockContents;
+			readBlockContents(def, blockContents);
+
+			def.shaderTemplate.reset(new ShaderTemplate(i->first, blockContents));
+
+			++_numRealisedDefinitions;
+		}
+
+		return def;
 	}
 
 	// The shader definition hasn't been found, let's check if the name
@@ -71,15 +106,52 @@ ShaderDefinition& ShaderLibrary::getDefinition(const std::string& name)
 	}
 }
 
+void ShaderLibrary::readBlockContents(const ShaderDefinition& def, std::string& contents)
+{
+	if (def.filename != _cachedFilename)
+	{
+		_cachedFilename = def.filename;
+		_cachedFileText.clear();
+
+		ArchiveTextFilePtr file = GlobalFileSystem().openTextFile(def.filename);
+
+		if (file == NULL)
+		{
+			rWarning() << "[shaders] ShaderLibrary: unable to read " << def.filename << std::endl;
+			return;
+		}
+
+		// Read the characters like the tokeniser did when it determined the offsets
+		std::istream is(&(file->getInputStream()));
+		_cachedFileText.assign(std::istreambuf_iterator<char>(is), std::istreambuf_iterator<char>());
+	}
+
+	// The block is enclosed by braces, unless the file has been changed
+	if (def.blockOffset == 0 || def.blockOffset + def.blockLength >= _cachedFileText.size() ||
+		_cachedFileText[def.blockOffset - 1] != '{' ||
+		_cachedFileText[def.blockOffset + def.blockLength] != '}')
+	{
+		rWarning() << "[shaders] ShaderLibrary: " << def.filename
+			<< " has been changed since it was parsed." << std::endl;
+		return;
+	}
+
+	contents.assign(_cachedFileText, def.blockOffset, def.blockLength);
+}
+
 bool ShaderLibrary::definitionExists(const std::string& name) const
 {
+	Glib::RecMutex::Lock lock(_mutex);
+
 	ShaderDefinitionMap::const_iterator i = _definitions.find(name);
 
 	return i != _definitions.end();
 }
 
-CShaderPtr ShaderLibrary::findShader(const std::string& name)
+CShaderPtr ShaderLibrary::findShader(const string::InternedString& name)
 {
+	Glib::RecMutex::Lock lock(_mutex);
+
 	// Try to lookup the shader in the active shaders list
 	ShaderMap::iterator i = _shaders.find(name);
 
@@ -90,31 +162,49 @@ CShaderPtr ShaderLibrary::findShader(const std::string& name)
 	}
 	else
     {
+		trace::ScopedZone zone("decls", "realiseShader", name.getString());
+
         // No shader has been found, retrieve its definition (may also be a
         // dummy def)
-        ShaderDefinition& def = getDefinition(name);
+        ShaderDefinition& def = getDefinition(name.getString());
 
         // Construct a new shader object with this def and insert it into the
-        // map
-        CShaderPtr shader(new CShader(name, def));
+        // map, this parses the declaration
+        CShaderPtr shader(new CShader(name.getString(), def));
 
 		_shaders[name] = shader;
+		_sortedShaders.clear();
 
 		return shader;
 	}
 }
 
 void ShaderLibrary::clear() {
+	Glib::RecMutex::Lock lock(_mutex);
+
 	_shaders.clear();
+	_sortedShaders.clear();
 	_definitions.clear();
+	_numRealisedDefinitions = 0;
+
+	_cachedFilename.clear();
+	std::string().swap(_cachedFileText);
 }
 
 std::size_t ShaderLibrary::getNumShaders() {
+	Glib::RecMutex::Lock lock(_mutex);
 	return _definitions.size();
 }
 
+std::size_t ShaderLibrary::getNumRealisedShaders() {
+	Glib::RecMutex::Lock lock(_mutex);
+	return _numRealisedDefinitions;
+}
+
 void ShaderLibrary::foreachShaderName(const ShaderNameCallback& callback)
 {
+	Glib::RecMutex::Lock lock(_mutex);
+
 	for (ShaderDefinitionMap::const_iterator i = _definitions.begin();
 		 i != _definitions.end();
 		 ++i)
@@ -134,14 +224,42 @@ TexturePtr ShaderLibrary::loadTextureFromFile(const std::string& filename,
 
 void ShaderLibrary::foreachShader(ShaderVisitor& visitor)
 {
-	for (ShaderMap::const_iterator i = _shaders.begin(); i != _shaders.end(); ++i)
+	Glib::RecMutex::Lock lock(_mutex);
+
+	// The texture browser lays out the shaders in the order they're visited
+	if (_sortedShaders.size() != _shaders.size())
 	{
-		visitor.visit(i->second);
+		_sortedShaders.clear();
+		_sortedShaders.reserve(_shaders.size());
+
+		// Elements of the hash map stay at their address when it rehashes
+		for (ShaderMap::const_iterator i = _shaders.begin(); i != _shaders.end(); ++i)
+		{
+			_sortedShaders.push_back(&(*i));
+		}
+
+		std::sort(_sortedShaders.begin(), _sortedShaders.end(), compareShaderNames);
+	}
+
+	// Visitors might request further shaders, which empties the view
+	std::vector<CShaderPtr> shaders;
+	shaders.reserve(_sortedShaders.size());
+
+	for (SortedShaders::const_iterator i = _sortedShaders.begin(); i != _sortedShaders.end(); ++i)
+	{
+		shaders.push_back((*i)->second);
+	}
+
+	for (std::vector<CShaderPtr>::const_iterator i = shaders.begin(); i != shaders.end(); ++i)
+	{
+		visitor.visit(*i);
 	}
 }
 
 void ShaderLibrary::realiseLighting()
 {
+	Glib::RecMutex::Lock lock(_mutex);
+
 	// First unrealise the lighting of all shaders
 	for (ShaderMap::const_iterator i = _shaders.begin(); i != _shaders.end(); ++i)
 	{
@@ -151,6 +269,8 @@ void ShaderLibrary::realiseLighting()
 
 void ShaderLibrary::unrealiseLighting()
 {
+	Glib::RecMutex::Lock lock(_mutex);
+
 	for (ShaderMap::const_iterator i = _shaders.begin(); i != _shaders.end(); ++i)
 	{
 		i->second->unrealiseLighting();
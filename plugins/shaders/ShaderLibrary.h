@@ -2,7 +2,11 @@
 
 #include <string>
 #include <map>
+#include <vector>
+#include <unordered_map>
+#include <glibmm/thread.h>
 #include "CShader.h"
+#include "string/InternedString.h"
 
 namespace shaders {
 
@@ -12,11 +16,34 @@ class ShaderLibrary
 	// These are referenced by name.
 	ShaderDefinitionMap _definitions;
 
-	typedef std::map<std::string, CShaderPtr, ShaderNameCompareFunctor> ShaderMap;
+	// The shaders created so far, looked up by every face and patch
+	// during map load. Keyed by the interned names, whose case-insensitive
+	// hash and comparison come precomputed from the string pool.
+	typedef std::unordered_map<string::InternedString, CShaderPtr,
+		string::InternedString::HashIgnoreCase,
+		string::InternedString::EqualIgnoreCase> ShaderMap;
 
 	ShaderMap _shaders;
 
+	// The elements of _shaders sorted by name, as traversed by foreachShader().
+	// Built on demand, emptied whenever a shader is added or removed.
+	typedef std::vector<const ShaderMap::value_type*> SortedShaders;
+	SortedShaders _sortedShaders;
+
+	// The number of definitions whose template has been constructed
+	std::size_t _numRealisedDefinitions;
+
+	// The text of the material file read last, consecutive realisations
+	// mostly concern definitions of the same file
+	std::string _cachedFilename;
+	std::string _cachedFileText;
+
+	// Materials may be requested from worker threads (e.g. to warm them up
+	// in the background), this guards the maps above
+	mutable Glib::RecMutex _mutex;
+
 public:
+	ShaderLibrary();
 
 	/* greebo: Add a shader definition to the internal list
 	 * @returns: FALSE, if such a name already exists, TRUE otherwise
@@ -24,7 +51,8 @@ public:
 	bool addDefinition(const std::string& name, const ShaderDefinition& def);
 
 	/* greebo: Trys to lookup the named shader definition and returns
-	 * its reference. Always returns a valid reference.
+	 * its reference. Always returns a valid reference, the definition's
+	 * template is constructed if this hasn't happened yet.
 	 */
 	ShaderDefinition& getDefinition(const std::string& name);
 
@@ -40,24 +68,31 @@ public:
 	// Get the number of known shaders
 	std::size_t getNumShaders();
 
+	// Get the number of shader definitions which have been requested and parsed so far
+	std::size_t getNumRealisedShaders();
+
 	/* greebo: Retrieves the shader with the given name.
 	 *
 	 * @returns: the according CShaderPtr, this may also
 	 * be a pointer to a dummy shader (shader not found)
 	 */
-	CShaderPtr findShader(const std::string& name);
+	CShaderPtr findShader(const string::InternedString& name);
 
 	void foreachShaderName(const ShaderNameCallback& callback);
 
 	TexturePtr loadTextureFromFile(const std::string& filename,
                                      const std::string& moduleNames);
 
-	// Traverse the library using the given shadername
+	// Traverse the library's shaders, sorted by name
 	void foreachShader(ShaderVisitor& visitor);
 
 	void realiseLighting();
 	void unrealiseLighting();
 
+private:
+	// Reads the declaration block of the given definition from its file
+	void readBlockContents(const ShaderDefinition& def, std::string& contents);
+
 }; // class ShaderLibrary
 
 typedef boost::shared_ptr<ShaderLibrary> ShaderLibraryPtr;
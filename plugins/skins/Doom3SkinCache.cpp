@@ -3,6 +3,7 @@
 #include "itextstream.h"
 #include "ifilesystem.h"
 #include "iarchive.h"
+#include "itrace.h"
 
 #include <iostream>
 
@@ -62,6 +63,8 @@ void Doom3SkinCache::realise() {
 	if (_realised)
 		return;
 
+	trace::ScopedZone zone("decls", "realiseSkins");
+
 	rMessage() << "[skins] Loading skins." << std::endl;
 
 	// Use a functor to traverse the skins directory, catching any parse
@@ -193,4 +196,9 @@ void Doom3SkinCache::initialiseModule(const ApplicationContext& ctx) {
 	realise();
 }
 
+bool Doom3SkinCache::isInitialisationThreadSafe() const {
+	// Parsing the skin files only involves the VFS
+	return true;
+}
+
 } // namespace skins
@@ -3,6 +3,7 @@
 
 #include "ifilesystem.h"
 #include "archivelib.h"
+#include "itrace.h"
 
 #include "debugging/ScopedDebugTimer.h"
 
@@ -106,6 +107,8 @@ const StringSet& SoundManager::getDependencies() const {
 
 void SoundManager::loadShadersFromFilesystem() const
 {
+	trace::ScopedZone zone("decls", "loadSoundShaders");
+
 	// Pass a SoundFileLoader to the filesystem
 	SoundFileLoader loader(_shaders);
 
@@ -150,4 +153,11 @@ void SoundManager::initialiseModule(const ApplicationContext& ctx)
     }
 }
 
+bool SoundManager::isInitialisationThreadSafe() const
+{
+    // The sound shaders are parsed on first use, the SoundPlayer only sets
+    // up its (disabled) timer, which GLib allows from any thread
+    return true;
+}
+
 } // namespace sound
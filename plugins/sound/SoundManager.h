@@ -51,6 +51,7 @@ public:
 	virtual const std::string& getName() const;
 	virtual const StringSet& getDependencies() const;
 	virtual void initialiseModule(const ApplicationContext& ctx);
+	virtual bool isInitialisationThreadSafe() const;
 };
 typedef boost::shared_ptr<SoundManager> SoundManagerPtr;
 
@@ -0,0 +1,145 @@
+#pragma once
+
+#include "iundo.h"
+#include <set>
+#include <boost/noncopyable.hpp>
+
+namespace undo
+{
+
+/**
+ * The arena holding the memento data of the undo history. Blocks are
+ * carved out of chunks of CHUNK_SIZE bytes, a chunk is freed as soon as the
+ * last of its blocks has been released. Blocks larger than CHUNK_SIZE get a
+ * chunk of their own. The arena is only accessed from the main thread.
+ */
+class MementoArena :
+	public IUndoMementoArena,
+	public boost::noncopyable
+{
+	static const std::size_t CHUNK_SIZE = 256 * 1024;
+
+	// Each block is prefixed with a pointer to its chunk, padded to 8 bytes
+	static const std::size_t HEADER_SIZE = 8;
+
+	struct Chunk
+	{
+		unsigned char* data;
+		std::size_t capacity;
+		std::size_t used;
+		std::size_t numBlocks;
+	};
+
+	std::set<Chunk*> _chunks;
+
+	// The chunk new blocks are allocated from
+	Chunk* _current;
+
+	// The bytes occupied by live blocks, including their headers
+	std::size_t _usedBytes;
+
+public:
+	MementoArena() :
+		_current(NULL),
+		_usedBytes(0)
+	{}
+
+	~MementoArena()
+	{
+		while (!_chunks.empty())
+		{
+			destroyChunk(*_chunks.begin());
+		}
+	}
+
+	unsigned char* allocate(std::size_t size)
+	{
+		static_assert(sizeof(Chunk*) <= HEADER_SIZE, "Chunk pointer doesn't fit into the block header");
+
+		std::size_t required = getBlockSize(size);
+
+		if (_current == NULL || _current->capacity - _current->used < required)
+		{
+			Chunk* previous = _current;
+
+			_current = createChunk(required > CHUNK_SIZE ? required : CHUNK_SIZE);
+
+			// The previous chunk is not reachable anymore if it is empty
+			if (previous != NULL && previous->numBlocks == 0)
+			{
+				destroyChunk(previous);
+			}
+		}
+
+		unsigned char* header = _current->data + _current->used;
+		*reinterpret_cast<Chunk**>(header) = _current;
+
+		_current->used += required;
+		_current->numBlocks++;
+
+		_usedBytes += required;
+
+		return header + HEADER_SIZE;
+	}
+
+	void release(unsigned char* block, std::size_t size)
+	{
+		Chunk* chunk = *reinterpret_cast<Chunk**>(block - HEADER_SIZE);
+
+		_usedBytes -= getBlockSize(size);
+
+		if (--chunk->numBlocks > 0) return;
+
+		if (chunk == _current)
+		{
+			// Keep the current chunk around and start over
+			chunk->used = 0;
+		}
+		else
+		{
+			destroyChunk(chunk);
+		}
+	}
+
+	std::size_t getMemoryUsage() const
+	{
+		return _usedBytes;
+	}
+
+private:
+	// The space taken by a block of the given size, including header and padding
+	static std::size_t getBlockSize(std::size_t size)
+	{
+		return HEADER_SIZE + ((size + 7) & ~static_cast<std::size_t>(7));
+	}
+
+	Chunk* createChunk(std::size_t capacity)
+	{
+		Chunk* chunk = new Chunk;
+
+		// operator new[] returns memory suitably aligned for any type
+		chunk->data = new unsigned char[capacity];
+		chunk->capacity = capacity;
+		chunk->used = 0;
+		chunk->numBlocks = 0;
+
+		_chunks.insert(chunk);
+
+		return chunk;
+	}
+
+	void destroyChunk(Chunk* chunk)
+	{
+		if (chunk == _current)
+		{
+			_current = NULL;
+		}
+
+		_chunks.erase(chunk);
+
+		delete[] chunk->data;
+		delete chunk;
+	}
+};
+
+} // namespace
@@ -14,10 +14,14 @@ private:
 	// The name of the UndoOperaton
 	std::string _command;
 
+	// The memory used by the saved mementos
+	std::size_t _memoryUsage;
+
 public:
 	// Constructor
 	Operation(const std::string& command) :
-		_command(command)
+		_command(command),
+		_memoryUsage(sizeof(Operation))
 	{}
 
 	const std::string& getName() const
@@ -33,6 +37,14 @@ public:
 	void save(IUndoable& undoable)
 	{
 		_snapshot.save(undoable);
+		_memoryUsage += _snapshot.front().getMemoryUsage();
+	}
+
+	// Returns the number of bytes occupied by this operation,
+	// not including the data stored in the memento arena
+	std::size_t getMemoryUsage() const
+	{
+		return _memoryUsage;
 	}
 
 	void restoreSnapshot()
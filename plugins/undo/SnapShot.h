@@ -27,6 +27,11 @@ public:
 	{
 		_undoable.importState(_data);
 	}
+
+	std::size_t getMemoryUsage() const
+	{
+		return sizeof(*this) + _data->getMemoryUsage();
+	}
 };
 
 /** 
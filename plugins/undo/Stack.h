@@ -24,7 +24,13 @@ class UndoStack
 	// The pending undo operation (a working variable, so to say)
 	OperationPtr _pending;
 
+	// The sum of the memory used by the operations in the stack
+	std::size_t _memoryUsage;
+
 public:
+	UndoStack() :
+		_memoryUsage(0)
+	{}
 
 	bool empty() const
 	{
@@ -48,17 +54,26 @@ public:
 
 	void pop_front()
 	{
+		_memoryUsage -= _stack.front()->getMemoryUsage();
 		_stack.pop_front();
 	}
 
 	void pop_back()
 	{
+		_memoryUsage -= _stack.back()->getMemoryUsage();
 		_stack.pop_back();
 	}
 
 	void clear()
 	{
 		_stack.clear();
+		_memoryUsage = 0;
+	}
+
+	// Returns the memory used by all operations, not including the memento arena
+	std::size_t getMemoryUsage() const
+	{
+		return _memoryUsage;
 	}
 
 	// Allocate a new Operation to work with
@@ -97,11 +112,16 @@ public:
 		{
 			// Save the pending undo command
 			_stack.push_back(_pending);
+			_memoryUsage += _pending->getMemoryUsage();
 			_pending.reset();
 		}
 
 		// Save the UndoMemento of the most recently added command into the snapshot
+		std::size_t usageBefore = back()->getMemoryUsage();
+
 		back()->save(undoable);
+
+		_memoryUsage += back()->getMemoryUsage() - usageBefore;
 	}
 
 }; // class UndoStack
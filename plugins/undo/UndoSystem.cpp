@@ -8,24 +8,30 @@
 #include "ieventmanager.h"
 #include "ipreferencesystem.h"
 #include "iscenegraph.h"
+#include "iuimanager.h"
 
 #include <iostream>
 #include <map>
 #include <set>
 
 #include "registry/registry.h"
+#include "MementoArena.h"
 #include "SnapShot.h"
 #include "Operation.h"
 #include "Stack.h"
 #include "StackFiller.h"
 
 #include <boost/bind.hpp>
+#include <boost/format.hpp>
 
 namespace undo {
 
 namespace
 {
 	const std::string RKEY_UNDO_QUEUE_SIZE = "user/ui/undo/queueSize";
+	const std::string RKEY_UNDO_MEMORY_BUDGET = "user/ui/undo/memoryBudget";
+
+	const char* const STATUSBAR_UNDO_MEMORY = "UndoMemory";
 }
 
 /** 
@@ -46,6 +52,9 @@ class RadiantUndoSystem :
 
 	static const std::size_t MAX_UNDO_LEVELS = 16384;
 
+	// The storage for the memento data, needs to outlive the stacks
+	MementoArena _arena;
+
 	// The undo and redo stacks
 	UndoStack _undoStack;
 	UndoStack _redoStack;
@@ -55,13 +64,20 @@ class RadiantUndoSystem :
 
 	std::size_t _undoLevels;
 
+	// The maximum memory used by the history in bytes, 0 = unlimited
+	std::size_t _memoryBudget;
+
 	typedef std::set<IUndoTracker*> Trackers;
 	Trackers _trackers;
 
+	bool _statusBarElementAdded;
+
 public:
 	// Constructor
 	RadiantUndoSystem() :
-		_undoLevels(64)
+		_undoLevels(64),
+		_memoryBudget(0),
+		_statusBarElementAdded(false)
 	{}
 
 	virtual ~RadiantUndoSystem()
@@ -73,6 +89,10 @@ public:
 	void keyChanged()
     {
 		_undoLevels = registry::getValue<int>(RKEY_UNDO_QUEUE_SIZE);
+		_memoryBudget = static_cast<std::size_t>(registry::getValue<int>(RKEY_UNDO_MEMORY_BUDGET)) * 1024 * 1024;
+
+		enforceMemoryBudget();
+		updateStatusBar();
 	}
 
 	IUndoStateSaver* getStateSaver(IUndoable& undoable)
@@ -117,6 +137,12 @@ public:
 		if (finishUndo(command)) {
 			rMessage() << command << std::endl;
 		}
+
+		// The operation is complete, relink the nodes it has moved
+		GlobalSceneGraph().processBoundsChanges();
+
+		enforceMemoryBudget();
+		updateStatusBar();
 	}
 
 	void undo()
@@ -150,6 +176,10 @@ public:
 		});
 
 		GlobalSceneGraph().sceneChanged();
+		GlobalSceneGraph().processBoundsChanges();
+
+		enforceMemoryBudget();
+		updateStatusBar();
 	}
 
 	void redo()
@@ -183,6 +213,10 @@ public:
 		});
 
 		GlobalSceneGraph().sceneChanged();
+		GlobalSceneGraph().processBoundsChanges();
+
+		enforceMemoryBudget();
+		updateStatusBar();
 	}
 
 	void clear()
@@ -192,6 +226,8 @@ public:
 		_redoStack.clear();
 		trackersClear();
 
+		updateStatusBar();
+
 		// greebo: This is called on map shutdown, so don't clear the observers,
 		// there are some "persistent" observers like EntityInspector and ShaderClipboard
 	}
@@ -230,6 +266,16 @@ public:
 		_trackers.erase(&tracker);
 	}
 
+	IUndoMementoArena& getMementoArena()
+	{
+		return _arena;
+	}
+
+	std::size_t getMemoryUsage() const
+	{
+		return _undoStack.getMemoryUsage() + _redoStack.getMemoryUsage() + _arena.getMemoryUsage();
+	}
+
 	// RegisterableModule implementation
 	virtual const std::string& getName() const
 	{
@@ -248,6 +294,7 @@ public:
 			_dependencies.insert(MODULE_COMMANDSYSTEM);
 			_dependencies.insert(MODULE_SCENEGRAPH);
 			_dependencies.insert(MODULE_EVENTMANAGER);
+			_dependencies.insert(MODULE_UIMANAGER);
 		}
 
 		return _dependencies;
@@ -266,14 +313,33 @@ public:
 		GlobalEventManager().addCommand("Redo", "Redo");
 
 		_undoLevels = registry::getValue<int>(RKEY_UNDO_QUEUE_SIZE);
+		_memoryBudget = static_cast<std::size_t>(registry::getValue<int>(RKEY_UNDO_MEMORY_BUDGET)) * 1024 * 1024;
 
 		// Add self to the key observers to get notified on change
 		GlobalRegistry().signalForKey(RKEY_UNDO_QUEUE_SIZE).connect(
             sigc::mem_fun(this, &RadiantUndoSystem::keyChanged)
         );
+		GlobalRegistry().signalForKey(RKEY_UNDO_MEMORY_BUDGET).connect(
+            sigc::mem_fun(this, &RadiantUndoSystem::keyChanged)
+        );
 
 		// add the preference settings
 		constructPreferences();
+
+		GlobalUIManager().getStatusBarManager().addTextElement(
+			STATUSBAR_UNDO_MEMORY,
+			"",  // no icon
+			IStatusBarManager::POS_BRUSHCOUNT + 1
+		);
+		_statusBarElementAdded = true;
+
+		updateStatusBar();
+	}
+
+	virtual void shutdownModule()
+	{
+		// The status bar might be gone by the time the history is cleared
+		_statusBarElementAdded = false;
 	}
 
 	// This is connected to the CommandSystem
@@ -309,6 +375,32 @@ private:
 		return _undoLevels;
 	}
 
+	// Drops operations until the history fits into the memory budget. The redo
+	// steps furthest away from the current state go first, then the oldest undo steps.
+	void enforceMemoryBudget()
+	{
+		if (_memoryBudget == 0) return;
+
+		while (!_redoStack.empty() && getMemoryUsage() > _memoryBudget)
+		{
+			_redoStack.pop_front();
+		}
+
+		// The most recent operation is always kept
+		while (_undoStack.size() > 1 && getMemoryUsage() > _memoryBudget)
+		{
+			_undoStack.pop_front();
+		}
+	}
+
+	void updateStatusBar()
+	{
+		if (!_statusBarElementAdded) return;
+
+		GlobalUIManager().getStatusBarManager().setText(STATUSBAR_UNDO_MEMORY,
+			(boost::format(_("Undo: %.1f MB")) % (getMemoryUsage() / (1024.0 * 1024.0))).str());
+	}
+
 	void startUndo()
 	{
 		_undoStack.start("unnamedCommand");
@@ -377,6 +469,7 @@ private:
 	{
 		PreferencesPagePtr page = GlobalPreferenceSystem().getPage(_("Settings/Undo System"));
 		page->appendSpinner(_("Undo Queue Size"), RKEY_UNDO_QUEUE_SIZE, 0, 1024, 1);
+		page->appendSpinner(_("Undo Memory Budget (MB, 0 = unlimited)"), RKEY_UNDO_MEMORY_BUDGET, 0, 4096, 1);
 	}
 
 }; // class RadiantUndoSystem
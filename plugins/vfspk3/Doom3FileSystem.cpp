@@ -53,6 +53,7 @@ SOFTWARE, EVEN IF ADVISED OF THE POSSIBILITY OF SUCH DAMAGE.
 #include "ifilesystem.h"
 #include "iregistry.h"
 #include "igame.h"
+#include "itrace.h"
 
 #include "string/string.h"
 #include "os/path.h"
@@ -77,6 +78,8 @@ void Doom3FileSystem::initDirectory(const std::string& inputPath)
         return;
     }
 
+    trace::ScopedZone zone("vfs", "initDirectory", inputPath);
+
     // greebo: Normalise path: Replace backslashes and ensure trailing slash
     _directories[_numDirectories] = os::standardPathWithSlash(inputPath);
 
@@ -126,6 +129,8 @@ void Doom3FileSystem::initDirectory(const std::string& inputPath)
 
 void Doom3FileSystem::initialise()
 {
+    trace::ScopedZone zone("vfs", "initialise");
+
     rMessage() << "filesystem initialised" << std::endl;
 
     std::string extensions = GlobalGameManager().currentGame()->getKeyValue("archivetypes");
@@ -293,6 +298,8 @@ std::string Doom3FileSystem::findRoot(const std::string& name) {
 
 void Doom3FileSystem::initPakFile(ArchiveLoader& archiveModule, const std::string& filename)
 {
+    trace::ScopedZone zone("vfs", "initPakFile", filename);
+
     std::string fileExt(os::getExtension(filename));
     boost::to_lower(fileExt);
 
@@ -0,0 +1,639 @@
+#include "BatchMode.h"
+
+#include "itextstream.h"
+#include "itrace.h"
+#include "ientity.h"
+#include "ibrush.h"
+#include "ipatch.h"
+#include "iundo.h"
+#include "ieclass.h"
+#include "ishaders.h"
+#include "ifilesystem.h"
+#include "iscenegraph.h"
+#include "inamespace.h"
+#include "imodelcache.h"
+#include "imapformat.h"
+#include "imapcompiler.h"
+#include "igame.h"
+
+#include "os/path.h"
+#include "os/dir.h"
+#include "stream/textfilestream.h"
+#include "string/convert.h"
+#include "map/RootNode.h"
+#include "map/algorithm/ChildPrimitives.h"
+#include "map/algorithm/MapExporter.h"
+#include "map/algorithm/Traverse.h"
+#include "modulesystem/ModuleRegistry.h"
+
+#include <algorithm>
+#include <cstdio>
+#include <cstdlib>
+#include <fstream>
+#include <map>
+#include <sstream>
+#include <stdexcept>
+#include <boost/algorithm/string/case_conv.hpp>
+#include <boost/algorithm/string/split.hpp>
+#include <boost/algorithm/string/classification.hpp>
+#include <glibmm/timer.h>
+#include <glibmm/spawn.h>
+#include <glibmm/threadpool.h>
+#include <glibmm/miscutils.h>
+
+#if defined(WIN32)
+#include <windows.h>
+#include <psapi.h>
+#else
+#include <sys/resource.h>
+#include <sys/wait.h>
+#endif
+
+namespace batch
+{
+
+namespace
+{
+	const char* const BATCH_ARG = "--batch";
+	const char* const OUTPUT_ARG = "--batch-output";
+	const char* const FORMAT_ARG = "--batch-format";
+	const char* const REPORT_ARG = "--batch-report";
+	const char* const PROCESSES_ARG = "--batch-processes";
+	const char* const WORKER_ARG = "--batch-worker";
+
+	const char* const DEFAULT_REPORT_FILENAME = "darkradiant_batch.csv";
+
+	const char* const REPORT_HEADER = "map,job,success,seconds,peak_memory_kb,entities,brushes,patches";
+
+	const char* const JOB_NAMES[] = { "load", "stats", "materials", "save", "dmap" };
+
+	// Peak resident memory of this process in kB, 0 if unknown
+	std::size_t getPeakMemoryUsage()
+	{
+#if defined(WIN32)
+		PROCESS_MEMORY_COUNTERS counters;
+
+		if (GetProcessMemoryInfo(GetCurrentProcess(), &counters, sizeof(counters)))
+		{
+			return counters.PeakWorkingSetSize / 1024;
+		}
+
+		return 0;
+#else
+		struct rusage usage;
+
+		if (getrusage(RUSAGE_SELF, &usage) != 0)
+		{
+			return 0;
+		}
+
+	#if defined(__APPLE__)
+		return usage.ru_maxrss / 1024; // bytes
+	#else
+		return usage.ru_maxrss; // kB
+	#endif
+#endif
+	}
+
+	// Quotes the value for the CSV report if necessary
+	std::string csvValue(const std::string& value)
+	{
+		if (value.find_first_of(",\"\n") == std::string::npos)
+		{
+			return value;
+		}
+
+		std::string result("\"");
+
+		for (std::string::const_iterator i = value.begin(); i != value.end(); ++i)
+		{
+			result += *i;
+
+			if (*i == '"') result += '"';
+		}
+
+		return result + "\"";
+	}
+
+	bool exitedSuccessfully(int status)
+	{
+#if defined(WIN32)
+		return status == 0;
+#else
+		return WIFEXITED(status) && WEXITSTATUS(status) == 0;
+#endif
+	}
+
+	// Feeds the parsed nodes into the given root, like the importer used by the Map
+	class MapNodeImporter :
+		public map::IMapImportFilter
+	{
+		scene::INodePtr _root;
+
+	public:
+		MapNodeImporter(const scene::INodePtr& root) :
+			_root(root)
+		{}
+
+		bool addEntity(const scene::INodePtr& entityNode)
+		{
+			_root->addChildNode(entityNode);
+			return true;
+		}
+
+		bool addPrimitiveToEntity(const scene::INodePtr& primitive, const scene::INodePtr& entity)
+		{
+			if (Node_getEntity(entity)->isContainer())
+			{
+				entity->addChildNode(primitive);
+				return true;
+			}
+
+			return false;
+		}
+	};
+}
+
+BatchRunner::BatchRunner(const ApplicationContext& ctx) :
+	_numProcesses(1),
+	_workerIndex(-1)
+{
+	const ApplicationContext::ArgumentList& args = ctx.getCmdLineArgs();
+
+	for (std::size_t i = 0; i < args.size(); ++i)
+	{
+		const std::string& arg = args[i];
+		bool hasValue = i + 1 < args.size();
+
+		if (arg == BATCH_ARG && hasValue)
+		{
+			std::vector<std::string> jobNames;
+			boost::algorithm::split(jobNames, args[++i], boost::algorithm::is_any_of(","));
+
+			for (std::vector<std::string>::const_iterator j = jobNames.begin(); j != jobNames.end(); ++j)
+			{
+				const std::size_t numJobs = sizeof(JOB_NAMES) / sizeof(JOB_NAMES[0]);
+				std::size_t job = std::find(JOB_NAMES, JOB_NAMES + numJobs, *j) - JOB_NAMES;
+
+				if (job < numJobs)
+				{
+					_jobs.push_back(static_cast<Job>(job));
+				}
+				else
+				{
+					rError() << "Unknown batch job: " << *j << std::endl;
+				}
+			}
+
+			_workerArgs.push_back(arg);
+			_workerArgs.push_back(args[i]);
+		}
+		else if (arg == OUTPUT_ARG && hasValue)
+		{
+			_outputPath = os::standardPathWithSlash(args[++i]);
+
+			_workerArgs.push_back(arg);
+			_workerArgs.push_back(args[i]);
+		}
+		else if (arg == FORMAT_ARG && hasValue)
+		{
+			_formatName = args[++i];
+
+			_workerArgs.push_back(arg);
+			_workerArgs.push_back(args[i]);
+		}
+		else if (arg == REPORT_ARG && hasValue)
+		{
+			_reportFile = args[++i];
+		}
+		else if (arg == PROCESSES_ARG && hasValue)
+		{
+			_numProcesses = std::max(string::convert<int>(args[++i]), 1);
+		}
+		else if (arg == WORKER_ARG && hasValue)
+		{
+			_workerIndex = string::convert<int>(args[++i]);
+		}
+		else if (arg.empty() || arg[0] == '-' || arg.find('=') != std::string::npos)
+		{
+			// Other switches and game settings like fs_game=, pass them on
+			_workerArgs.push_back(arg);
+		}
+		else
+		{
+			_maps.push_back(arg);
+		}
+	}
+
+	if (_reportFile.empty())
+	{
+		_reportFile = ctx.getSettingsPath() + DEFAULT_REPORT_FILENAME;
+	}
+}
+
+bool BatchRunner::isRequested(const ApplicationContext& ctx)
+{
+	const ApplicationContext::ArgumentList& args = ctx.getCmdLineArgs();
+	return std::find(args.begin(), args.end(), BATCH_ARG) != args.end();
+}
+
+std::string BatchRunner::getLogFilename() const
+{
+	return _workerIndex >= 0 ?
+		"darkradiant_batch" + string::to_string(_workerIndex) + ".log" : "darkradiant_batch.log";
+}
+
+bool BatchRunner::usesWorkerProcesses() const
+{
+	return _numProcesses > 1 && _maps.size() > 1;
+}
+
+int BatchRunner::runWorkerProcesses(const std::string& executable)
+{
+	if (!checkJobs())
+	{
+		return EXIT_FAILURE;
+	}
+
+	std::size_t numWorkers = std::min(_numProcesses, _maps.size());
+
+	rMessage() << "Processing " << _maps.size() << " maps in " << numWorkers
+		<< " processes." << std::endl;
+
+	_workerSucceeded.assign(numWorkers, 0);
+
+	{
+		// The pool waits for all workers when going out of scope
+		Glib::ThreadPool pool(static_cast<int>(numWorkers));
+
+		for (std::size_t i = 0; i < numWorkers; ++i)
+		{
+			pool.push(sigc::bind(sigc::mem_fun(*this, &BatchRunner::runWorker), i, executable));
+		}
+	}
+
+	// Merge the reports of the workers
+	std::ofstream report(_reportFile.c_str());
+	report << REPORT_HEADER << std::endl;
+
+	bool success = true;
+
+	for (std::size_t i = 0; i < numWorkers; ++i)
+	{
+		std::string workerReport = _reportFile + "." + string::to_string(i);
+		std::ifstream input(workerReport.c_str());
+
+		std::string line;
+		std::getline(input, line); // skip the header
+
+		while (std::getline(input, line))
+		{
+			report << line << std::endl;
+		}
+
+		input.close();
+		remove(workerReport.c_str());
+
+		if (!_workerSucceeded[i])
+		{
+			rError() << "Batch process " << i << " failed, see darkradiant_batch"
+				<< i << ".log for details." << std::endl;
+			success = false;
+		}
+	}
+
+	rMessage() << "Batch report written to " << _reportFile << std::endl;
+
+	return success ? EXIT_SUCCESS : EXIT_FAILURE;
+}
+
+void BatchRunner::runWorker(std::size_t index, const std::string& executable)
+{
+	std::vector<std::string> argv;
+	argv.push_back(executable);
+	argv.insert(argv.end(), _workerArgs.begin(), _workerArgs.end());
+
+	argv.push_back(WORKER_ARG);
+	argv.push_back(string::to_string(index));
+	argv.push_back(REPORT_ARG);
+	argv.push_back(_reportFile + "." + string::to_string(index));
+
+	// Distribute the maps round-robin
+	for (std::size_t i = index; i < _maps.size(); i += _workerSucceeded.size())
+	{
+		argv.push_back(_maps[i]);
+	}
+
+	try
+	{
+		int status = -1;
+
+		Glib::spawn_sync(Glib::get_current_dir(), argv, Glib::SPAWN_SEARCH_PATH,
+						 sigc::slot<void>(), NULL, NULL, &status);
+
+		_workerSucceeded[index] = exitedSuccessfully(status);
+	}
+	catch (Glib::Error& ex)
+	{
+		rError() << "Could not start batch process: " << ex.what() << std::endl;
+	}
+}
+
+void BatchRunner::initialiseModules()
+{
+	StringSet modules;
+
+	modules.insert(MODULE_VIRTUALFILESYSTEM);
+	modules.insert(MODULE_SCENEGRAPH);
+	modules.insert(MODULE_UNDOSYSTEM);
+	modules.insert(MODULE_NAMESPACE_FACTORY);
+	modules.insert(MODULE_ECLASSMANAGER);
+	modules.insert(MODULE_ENTITYCREATOR);
+	modules.insert(MODULE_SHADERSYSTEM);
+	modules.insert(MODULE_MODELCACHE);
+	modules.insert(MODULE_MAPFORMATMANAGER);
+	modules.insert("Doom3MapLoader");
+	modules.insert("Doom3PrefabLoader");
+	modules.insert("Quake3MapLoader");
+	modules.insert("Quake4MapLoader");
+
+	if (std::find(_jobs.begin(), _jobs.end(), JOB_DMAP) != _jobs.end())
+	{
+		modules.insert(MODULE_MAPCOMPILER);
+	}
+
+	module::ModuleRegistry::Instance().initialiseModules(modules);
+}
+
+bool BatchRunner::checkJobs() const
+{
+	if (_jobs.empty())
+	{
+		rError() << "No batch jobs given, use --batch load,stats,materials,save,dmap" << std::endl;
+		return false;
+	}
+
+	if (std::find(_jobs.begin(), _jobs.end(), JOB_SAVE) == _jobs.end())
+	{
+		return true;
+	}
+
+	if (_outputPath.empty())
+	{
+		rError() << "The save job needs an output folder (" << OUTPUT_ARG << ")" << std::endl;
+		return false;
+	}
+
+	// The maps are saved by their filename, two maps with the same name
+	// would overwrite each other (case-insensitive, like some filesystems)
+	std::map<std::string, std::string> outputNames;
+	bool unique = true;
+
+	for (std::vector<std::string>::const_iterator m = _maps.begin(); m != _maps.end(); ++m)
+	{
+		std::string name = boost::algorithm::to_lower_copy(os::getFilename(*m));
+		std::pair<std::map<std::string, std::string>::iterator, bool> result =
+			outputNames.insert(std::make_pair(name, *m));
+
+		if (!result.second)
+		{
+			rError() << "The save job would write " << result.first->second << " and "
+				<< *m << " to the same file in the output folder" << std::endl;
+			unique = false;
+		}
+	}
+
+	return unique;
+}
+
+int BatchRunner::run()
+{
+	if (!checkJobs())
+	{
+		return EXIT_FAILURE;
+	}
+
+	if (!_outputPath.empty())
+	{
+		os::makeDirectory(_outputPath);
+	}
+
+	bool success = true;
+
+	for (std::vector<std::string>::const_iterator m = _maps.begin(); m != _maps.end(); ++m)
+	{
+		trace::ScopedZone zone("batch", "processMap", *m);
+
+		rMessage() << "Batch processing " << *m << std::endl;
+
+		scene::INodePtr root;
+
+		for (Jobs::const_iterator j = _jobs.begin(); j != _jobs.end(); ++j)
+		{
+			// Jobs working on the scene need the map to be loaded first
+			if (!root && (*j == JOB_STATS || *j == JOB_MATERIALS || *j == JOB_SAVE) &&
+				!runJob(JOB_LOAD, *m, root))
+			{
+				success = false;
+				break;
+			}
+
+			if (!runJob(*j, *m, root))
+			{
+				success = false;
+				break;
+			}
+		}
+	}
+
+	writeReport(_reportFile);
+
+	return success ? EXIT_SUCCESS : EXIT_FAILURE;
+}
+
+bool BatchRunner::runJob(Job job, const std::string& mapFile, scene::INodePtr& root)
+{
+	trace::ScopedZone zone("batch", JOB_NAMES[job], mapFile);
+
+	Glib::Timer timer;
+	bool success = true;
+	std::string stats(",,");
+
+	try
+	{
+		switch (job)
+		{
+		case JOB_LOAD:
+			root = loadMap(mapFile);
+			break;
+
+		case JOB_STATS:
+		{
+			std::size_t entities = 0;
+			std::size_t brushes = 0;
+			std::size_t patches = 0;
+
+			root->foreachNode([&] (const scene::INodePtr& node)->bool
+			{
+				if (Node_isEntity(node)) ++entities;
+				else if (Node_isBrush(node)) ++brushes;
+				else if (Node_isPatch(node)) ++patches;
+
+				return true;
+			});
+
+			stats = string::to_string(entities) + "," + string::to_string(brushes) + "," +
+				string::to_string(patches);
+			break;
+		}
+
+		case JOB_MATERIALS:
+			root->foreachNode([&] (const scene::INodePtr& node)->bool
+			{
+				IBrush* brush = Node_getIBrush(node);
+
+				if (brush != NULL)
+				{
+					for (std::size_t i = 0; i < brush->getNumFaces(); ++i)
+					{
+						GlobalMaterialManager().getMaterialForName(brush->getFace(i).getShader());
+					}
+				}
+				else if (Node_isPatch(node))
+				{
+					GlobalMaterialManager().getMaterialForName(Node_getIPatch(node)->getShader());
+				}
+
+				return true;
+			});
+			break;
+
+		case JOB_SAVE:
+			saveMap(mapFile, root);
+			break;
+
+		case JOB_DMAP:
+			success = GlobalMapCompiler().runDmap(mapFile);
+			break;
+		};
+	}
+	catch (std::exception& ex)
+	{
+		rError() << "Batch job " << JOB_NAMES[job] << " failed on " << mapFile
+			<< ": " << ex.what() << std::endl;
+		success = false;
+	}
+
+	addReportLine(mapFile, job, success, timer.elapsed(), stats);
+
+	return success;
+}
+
+scene::INodePtr BatchRunner::loadMap(const std::string& mapFile)
+{
+	TextFileInputStream file(mapFile);
+	std::istream stream(&file);
+
+	if (file.failed())
+	{
+		throw std::runtime_error("Could not open the map file");
+	}
+
+	// Find the format able to read this file
+	std::set<map::MapFormatPtr> formats =
+		GlobalMapFormatManager().getMapFormatList(os::getExtension(mapFile));
+
+	map::MapFormatPtr format;
+
+	for (std::set<map::MapFormatPtr>::const_iterator i = formats.begin(); i != formats.end(); ++i)
+	{
+		stream.seekg(0, std::ios_base::beg);
+
+		if ((*i)->canLoad(stream))
+		{
+			format = *i;
+			break;
+		}
+	}
+
+	if (!format)
+	{
+		throw std::runtime_error("Could not determine the map format");
+	}
+
+	stream.seekg(0, std::ios_base::beg);
+
+	scene::INodePtr root(NewMapRoot(os::getFilename(mapFile)));
+	MapNodeImporter importer(root);
+
+	format->getMapReader(importer)->readFromStream(stream);
+
+	// Child primitives are stored relative to their entity's origin
+	map::addOriginToChildPrimitives(root);
+
+	return root;
+}
+
+void BatchRunner::saveMap(const std::string& mapFile, const scene::INodePtr& root)
+{
+	std::string extension = os::getExtension(mapFile);
+
+	map::MapFormatPtr format = !_formatName.empty() ?
+		GlobalMapFormatManager().getMapFormatByName(_formatName) :
+		GlobalMapFormatManager().getMapFormatForGameType(
+			GlobalGameManager().currentGame()->getKeyValue("type"), extension);
+
+	if (!format)
+	{
+		throw std::runtime_error("Could not find the map format to save with");
+	}
+
+	std::string outputFile = _outputPath + os::getFilename(mapFile);
+	std::ofstream stream(outputFile.c_str());
+
+	if (!stream.good())
+	{
+		throw std::runtime_error("Could not write to " + outputFile);
+	}
+
+	map::IMapWriterPtr writer = format->getMapWriter();
+
+	// No node count given, so the exporter doesn't open a progress dialog.
+	// The editor-specific .darkradiant file (layers, selection sets) is not written.
+	map::MapExporter exporter(*writer, root, stream, 0);
+	exporter.exportMap(root, map::traverse);
+}
+
+void BatchRunner::addReportLine(const std::string& mapFile, Job job, bool success,
+								double seconds, const std::string& stats)
+{
+	std::ostringstream line;
+
+	line << csvValue(mapFile) << "," << JOB_NAMES[job] << "," << (success ? 1 : 0) << ","
+		<< seconds << "," << getPeakMemoryUsage() << "," << stats;
+
+	_reportLines.push_back(line.str());
+}
+
+void BatchRunner::writeReport(const std::string& filename) const
+{
+	std::ofstream report(filename.c_str());
+
+	if (!report.good())
+	{
+		rError() << "Could not write the batch report to " << filename << std::endl;
+		return;
+	}
+
+	report << REPORT_HEADER << std::endl;
+
+	for (std::vector<std::string>::const_iterator i = _reportLines.begin();
+		 i != _reportLines.end(); ++i)
+	{
+		report << *i << std::endl;
+	}
+
+	rMessage() << "Batch report written to " << filename << std::endl;
+}
+
+} // namespace
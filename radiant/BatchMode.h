@@ -0,0 +1,117 @@
+#pragma once
+
+#include "imodule.h"
+#include "inode.h"
+
+#include <vector>
+
+namespace batch
+{
+
+/**
+ * Processes a list of maps without the user interface, started by the
+ * --batch command line switch:
+ *
+ * darkradiant --batch <jobs> [options] <map files>
+ *
+ * <jobs> is a comma-separated list of the jobs to run on each map, in the
+ * given order:
+ * - load: parses the map
+ * - stats: counts the entities, brushes and patches
+ * - materials: looks up the material of every face and patch, like the
+ *              renderer does when the map is shown for the first time
+ * - save: writes the map to the output folder, optionally in another format.
+ *         The maps need to have different filenames.
+ * - dmap: compiles the map, the .proc file is written next to it
+ *
+ * Options:
+ * --batch-output <folder>: where the save job writes the maps to
+ * --batch-format <name>: map format used by the save job, e.g. "Quake 4"
+ * --batch-report <file>: the CSV report, defaults to darkradiant_batch.csv
+ *                        in the settings folder
+ * --batch-processes <n>: distributes the maps across n processes
+ *
+ * Only the modules needed for the jobs are initialised, the main window is
+ * never created. For each job the report lists the map, the job, whether it
+ * succeeded, its duration and the peak memory usage of the process so far.
+ */
+class BatchRunner
+{
+public:
+	enum Job
+	{
+		JOB_LOAD,
+		JOB_STATS,
+		JOB_MATERIALS,
+		JOB_SAVE,
+		JOB_DMAP,
+	};
+
+private:
+	typedef std::vector<Job> Jobs;
+	Jobs _jobs;
+
+	std::vector<std::string> _maps;
+
+	std::string _outputPath;
+	std::string _formatName;
+	std::string _reportFile;
+	std::size_t _numProcesses;
+
+	// Index of this process if it has been started by another batch process, -1 otherwise
+	int _workerIndex;
+
+	// The command line arguments to be passed on to the worker processes
+	std::vector<std::string> _workerArgs;
+
+	// One line per job
+	std::vector<std::string> _reportLines;
+
+	// Whether the worker processes exited successfully, one element per
+	// worker. Not a vector<bool>, the worker threads write concurrently.
+	std::vector<char> _workerSucceeded;
+
+public:
+	// Reads the batch settings from the command line
+	BatchRunner(const ApplicationContext& ctx);
+
+	// True if the --batch switch has been given
+	static bool isRequested(const ApplicationContext& ctx);
+
+	// The file to log into, unique for each process
+	std::string getLogFilename() const;
+
+	// True if the maps are to be processed by other processes
+	bool usesWorkerProcesses() const;
+
+	/**
+	 * Starts the worker processes using the given executable, each of them
+	 * processing a share of the maps, and merges their reports. Returns the
+	 * exit code.
+	 */
+	int runWorkerProcesses(const std::string& executable);
+
+	// Initialises the modules needed for the jobs, they need to be loaded already
+	void initialiseModules();
+
+	// Processes the maps and writes the report, returns the exit code
+	int run();
+
+private:
+	// Checks the jobs and the save job's output names, logs any problem
+	bool checkJobs() const;
+
+	bool runJob(Job job, const std::string& mapFile, scene::INodePtr& root);
+
+	scene::INodePtr loadMap(const std::string& mapFile);
+	void saveMap(const std::string& mapFile, const scene::INodePtr& root);
+
+	void addReportLine(const std::string& mapFile, Job job, bool success, double seconds,
+					   const std::string& stats);
+
+	void writeReport(const std::string& filename) const;
+
+	void runWorker(std::size_t index, const std::string& executable);
+};
+
+} // namespace
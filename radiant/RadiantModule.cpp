@@ -37,6 +37,7 @@
 #include "selection/algorithm/General.h"
 
 #include "log/Console.h"
+#include "log/ChromeTraceRecorder.h"
 #include "ui/lightinspector/LightInspector.h"
 #include "ui/patch/PatchInspector.h"
 #include "ui/surfaceinspector/SurfaceInspector.h"
@@ -129,6 +130,10 @@ void RadiantModule::initialiseModule(const ApplicationContext& ctx)
 
 	GlobalCommandSystem().addCommand("Exit", exitCmd);
 	GlobalEventManager().addCommand("Exit", "Exit");
+
+	GlobalCommandSystem().addCommand("StartTrace", startTraceCmd);
+	GlobalCommandSystem().addCommand("StopTrace", stopTraceCmd,
+		cmd::ARGTYPE_STRING|cmd::ARGTYPE_OPTIONAL);
 }
 
 void RadiantModule::shutdownModule()
@@ -242,6 +247,19 @@ void RadiantModule::exitCmd(const cmd::ArgumentList& args)
 	}
 }
 
+void RadiantModule::startTraceCmd(const cmd::ArgumentList& args)
+{
+	applog::ChromeTraceRecorder::Instance().start();
+}
+
+void RadiantModule::stopTraceCmd(const cmd::ArgumentList& args)
+{
+	if (!applog::ChromeTraceRecorder::Instance().stop(args.empty() ? "" : args[0].getString()))
+	{
+		rWarning() << "No trace has been written." << std::endl;
+	}
+}
+
 // Define the static Radiant module
 module::StaticModule<RadiantModule> radiantCoreModule;
 
@@ -47,6 +47,10 @@ public:
 
 	// Target method bound to the "Exit" command
 	static void exitCmd(const cmd::ArgumentList& args);
+
+	// Trace recording, StopTrace takes an optional filename
+	static void startTraceCmd(const cmd::ArgumentList& args);
+	static void stopTraceCmd(const cmd::ArgumentList& args);
 };
 typedef boost::shared_ptr<RadiantModule> RadiantModulePtr;
 
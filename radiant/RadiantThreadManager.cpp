@@ -1,5 +1,9 @@
 #include "RadiantThreadManager.h"
 
+#include <exception>
+#include <glibmm/thread.h>
+#include <boost/make_shared.hpp>
+
 namespace radiant
 {
 
@@ -9,6 +13,91 @@ namespace
     {
         func();
     }
+
+    // The jobs of an executeAndWait() call. Each participating thread takes
+    // the next job which hasn't been started yet, until none are left.
+    class JobBatch
+    {
+        ThreadManager::Jobs _jobs;
+
+        Glib::Mutex _mutex;
+        Glib::Cond _finished;
+
+        // The next job to start, and the number of jobs not finished yet
+        std::size_t _next;
+        std::size_t _pending;
+
+        // The first exception thrown by a job
+        std::exception_ptr _exception;
+
+    public:
+        JobBatch(const ThreadManager::Jobs& jobs) :
+            _jobs(jobs),
+            _next(0),
+            _pending(jobs.size())
+        {}
+
+        void runJobs()
+        {
+            while (true)
+            {
+                std::size_t index;
+
+                {
+                    Glib::Mutex::Lock lock(_mutex);
+
+                    if (_next == _jobs.size()) return;
+
+                    index = _next++;
+                }
+
+                std::exception_ptr exception;
+
+                try
+                {
+                    _jobs[index]();
+                }
+                catch (...)
+                {
+                    exception = std::current_exception();
+                }
+
+                Glib::Mutex::Lock lock(_mutex);
+
+                if (exception && !_exception)
+                {
+                    _exception = exception;
+                }
+
+                if (--_pending == 0)
+                {
+                    _finished.signal();
+                }
+            }
+        }
+
+        // Blocks until all jobs have finished, rethrows the first exception
+        void wait()
+        {
+            Glib::Mutex::Lock lock(_mutex);
+
+            while (_pending > 0)
+            {
+                _finished.wait(_mutex);
+            }
+
+            if (_exception)
+            {
+                std::rethrow_exception(_exception);
+            }
+        }
+    };
+    typedef boost::shared_ptr<JobBatch> JobBatchPtr;
+
+    void runBatchInThread(JobBatchPtr batch)
+    {
+        batch->runJobs();
+    }
 }
 
 void RadiantThreadManager::execute(boost::function<void()> func) const
@@ -18,4 +107,23 @@ void RadiantThreadManager::execute(boost::function<void()> func) const
     _pool.push(sigc::bind(sigc::ptr_fun(&runFuncInThread), func));
 }
 
+void RadiantThreadManager::executeAndWait(const Jobs& jobs) const
+{
+    if (jobs.empty()) return;
+
+    // The pool threads may get to the batch only after we're done with it,
+    // so they share its ownership
+    JobBatchPtr batch = boost::make_shared<JobBatch>(jobs);
+
+    for (std::size_t i = 1; i < jobs.size(); ++i)
+    {
+        _pool.push(sigc::bind(sigc::ptr_fun(&runBatchInThread), batch));
+    }
+
+    // Keep this thread busy too. Jobs the pool doesn't get to in time are run
+    // here, which lets jobs running in the pool call executeAndWait() as well.
+    batch->runJobs();
+    batch->wait();
+}
+
 }
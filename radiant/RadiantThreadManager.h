@@ -1,6 +1,7 @@
 #pragma once
 
 #include "ithread.h"
+#include <glibmm/threadpool.h>
 
 namespace radiant
 {
@@ -15,6 +16,7 @@ public:
 
     // ThreadManager implementation
     void execute(boost::function<void()>) const;
+    void executeAndWait(const Jobs& jobs) const;
 };
 
 }
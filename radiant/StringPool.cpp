@@ -0,0 +1,136 @@
+#include "StringPool.h"
+
+#include "itextstream.h"
+#include "modulesystem/StaticModule.h"
+
+namespace radiant
+{
+
+namespace
+{
+	const std::size_t INITIAL_SLOTS = 4096;
+
+	// FNV-1a, case-sensitive
+	std::size_t getHash(const std::string& str)
+	{
+		std::size_t hash = 2166136261U;
+
+		for (std::string::const_iterator i = str.begin(); i != str.end(); ++i)
+		{
+			hash ^= static_cast<unsigned char>(*i);
+			hash *= 16777619U;
+		}
+
+		return hash;
+	}
+}
+
+StringPool::StringPool() :
+	_slots(INITIAL_SLOTS, static_cast<Entry*>(NULL))
+{
+	g_static_mutex_init(_mutex.gobj());
+}
+
+const string::PooledString& StringPool::intern(const std::string& str)
+{
+	if (str.empty())
+	{
+		return string::getEmptyPooledString();
+	}
+
+	Glib::StaticMutex::Lock lock(_mutex);
+
+	return internLocked(str);
+}
+
+std::size_t StringPool::size() const
+{
+	Glib::StaticMutex::Lock lock(_mutex);
+
+	return _entries.size();
+}
+
+const StringPool::Entry& StringPool::internLocked(const std::string& str)
+{
+	std::size_t hash = getHash(str);
+	std::size_t mask = _slots.size() - 1;
+	std::size_t slot = hash & mask;
+
+	for (; _slots[slot] != NULL; slot = (slot + 1) & mask)
+	{
+		if (_slots[slot]->hash == hash && _slots[slot]->value == str)
+		{
+			return *_slots[slot];
+		}
+	}
+
+	// Not found, resolve the lowercase variant first, this might grow the table.
+	// It must be folded like getFoldedHash() does, independent of the locale.
+	std::string lower = string::getFoldedString(str);
+	const Entry* folded = (lower != str) ? &internLocked(lower) : NULL;
+
+	_entries.push_back(Entry());
+
+	Entry& entry = _entries.back();
+	entry.value = str;
+	entry.hash = hash;
+	entry.foldedHash = string::getFoldedHash(str);
+	entry.folded = folded != NULL ? folded : &entry;
+
+	// Keep the load factor at or below 0.5
+	if (_entries.size() * 2 > _slots.size())
+	{
+		grow();
+		return entry;
+	}
+
+	// The table might have grown while interning the lowercase string
+	mask = _slots.size() - 1;
+
+	for (slot = hash & mask; _slots[slot] != NULL; slot = (slot + 1) & mask) {}
+
+	_slots[slot] = &entry;
+
+	return entry;
+}
+
+void StringPool::grow()
+{
+	_slots.assign(_slots.size() * 2, static_cast<Entry*>(NULL));
+
+	std::size_t mask = _slots.size() - 1;
+
+	for (std::deque<Entry>::iterator i = _entries.begin(); i != _entries.end(); ++i)
+	{
+		std::size_t slot = i->hash & mask;
+
+		while (_slots[slot] != NULL)
+		{
+			slot = (slot + 1) & mask;
+		}
+
+		_slots[slot] = &(*i);
+	}
+}
+
+const std::string& StringPool::getName() const
+{
+	static std::string _name(MODULE_STRINGPOOL);
+	return _name;
+}
+
+const StringSet& StringPool::getDependencies() const
+{
+	static StringSet _dependencies; // no dependencies
+	return _dependencies;
+}
+
+void StringPool::initialiseModule(const ApplicationContext& ctx)
+{
+	rMessage() << getName() << "::initialiseModule called." << std::endl;
+}
+
+// Register the string pool module in the registry
+module::StaticModule<StringPool> stringPoolModule;
+
+} // namespace
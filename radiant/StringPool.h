@@ -0,0 +1,52 @@
+#pragma once
+
+#include "istringpool.h"
+
+#include <deque>
+#include <vector>
+#include <glibmm/thread.h>
+
+namespace radiant
+{
+
+/// IStringPool implementation, an open-addressing hash table of pooled strings
+class StringPool :
+	public IStringPool
+{
+	struct Entry :
+		public string::PooledString
+	{
+		// Case-sensitive hash of value
+		std::size_t hash;
+	};
+
+	// The entries, a deque doesn't move its elements when growing
+	std::deque<Entry> _entries;
+
+	// Linear probing, NULL marks an empty slot, the size is a power of two
+	std::vector<Entry*> _slots;
+
+	// The pool is constructed statically, before Glib threading is
+	// initialised, which a static mutex is able to cope with
+	mutable Glib::StaticMutex _mutex;
+
+public:
+	StringPool();
+
+	// IStringPool implementation
+	const string::PooledString& intern(const std::string& str);
+	std::size_t size() const;
+
+	// RegisterableModule implementation
+	const std::string& getName() const;
+	const StringSet& getDependencies() const;
+	void initialiseModule(const ApplicationContext& ctx);
+
+private:
+	// Needs to be called with the mutex locked
+	const Entry& internLocked(const std::string& str);
+
+	void grow();
+};
+
+}
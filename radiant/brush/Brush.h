@@ -168,6 +168,11 @@ public:
 
 		virtual ~BrushUndoMemento() {}
 
+		std::size_t getMemoryUsage() const
+		{
+			return sizeof(*this) + _faces.capacity() * sizeof(FacePtr);
+		}
+
 		Faces _faces;
 		DetailFlag _detailFlag;
 	};
@@ -8,6 +8,7 @@
 #include "igame.h"
 #include "ilayer.h"
 #include "ieventmanager.h"
+#include "istringpool.h"
 #include "brush/BrushNode.h"
 #include "brush/BrushClipPlane.h"
 #include "brush/BrushVisit.h"
@@ -32,6 +33,9 @@ void BrushModuleImpl::constructPreferences()
 
 	// The checkbox to enable/disable the texture lock option
 	page->appendCheckBox("", _("Enable Texture Lock (for Brushes)"), "user/ui/brush/textureLock");
+
+	// Dragging large selections only updates the primitives when the mouse comes to rest
+	page->appendCheckBox("", _("Preview Translations and Rotations while dragging"), "user/ui/transformPreview");
 }
 
 void BrushModuleImpl::construct()
@@ -91,6 +95,7 @@ const StringSet& BrushModuleImpl::getDependencies() const {
 		_dependencies.insert(MODULE_XMLREGISTRY);
 		_dependencies.insert(MODULE_PREFERENCESYSTEM);
 		_dependencies.insert(MODULE_UNDOSYSTEM);
+		_dependencies.insert(MODULE_STRINGPOOL);
 	}
 
 	return _dependencies;
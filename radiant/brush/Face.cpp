@@ -161,14 +161,59 @@ void Face::undoSave() {
 // undoable
 IUndoMementoPtr Face::exportState() const
 {
-    return IUndoMementoPtr(new SavedState(*this));
+	// Serialise plane, shader and texture projection, the memento chain
+	// takes care of storing only the differences to the previous state
+	undo::ByteBuffer data;
+	undo::ByteWriter writer(data);
+
+	writer.write(m_plane.getPlane());
+
+	// Field by field, the struct padding would show up as spurious changes
+	const ContentsFlagsValue& flags = _faceShader.m_flags;
+	writer.write(flags.m_surfaceFlags);
+	writer.write(flags.m_contentFlags);
+	writer.write(flags.m_value);
+	writer.write(flags.m_specified);
+
+	const TextureProjection& projection = m_texdef.m_projection;
+	writer.writeArray(projection.m_texdef._shift, 2);
+	writer.write(projection.m_texdef._rotate);
+	writer.writeArray(projection.m_texdef._scale, 2);
+	writer.writeArray(&projection.m_brushprimit_texdef.coords[0][0], 6);
+
+	// The variable-length name goes last, all other values keep their offsets
+	writer.writeString(_faceShader.getMaterialName());
+
+	return _undoMementos.createMemento(data);
 }
 
 void Face::importState(const IUndoMementoPtr& data)
 {
     undoSave();
 
-	std::static_pointer_cast<SavedState>(data)->exportState(*this);
+	undo::ByteBuffer buffer;
+	std::static_pointer_cast<undo::DeltaUndoMemento>(data)->getData(buffer);
+
+	undo::ByteReader reader(buffer);
+
+	m_plane.setPlane(reader.read<Plane3>());
+
+	ContentsFlagsValue flags;
+	reader.read(flags.m_surfaceFlags);
+	reader.read(flags.m_contentFlags);
+	reader.read(flags.m_value);
+	reader.read(flags.m_specified);
+
+	TextureProjection projection;
+	reader.readArray(projection.m_texdef._shift, 2);
+	reader.read(projection.m_texdef._rotate);
+	reader.readArray(projection.m_texdef._scale, 2);
+	reader.readArray(&projection.m_brushprimit_texdef.coords[0][0], 6);
+
+	_faceShader.setMaterialName(reader.readString());
+	_faceShader.setFlags(flags);
+
+	m_texdef.m_projection.assign(projection);
 
     planeChanged();
     m_observer->connectivityChanged();
@@ -12,6 +12,7 @@
 #include "FaceShader.h"
 #include "PlanePoints.h"
 #include "FacePlane.h"
+#include "DeltaUndoMemento.h"
 #include <boost/shared_ptr.hpp>
 #include <boost/noncopyable.hpp>
 #include "selection/algorithm/Shader.h"
@@ -40,29 +41,6 @@ class Face :
 	public FaceShader::Observer,
 	public boost::noncopyable
 {
-	class SavedState : 
-		public IUndoMemento
-	{
-		public:
-			FacePlane::SavedState m_planeState;
-			FaceTexdef::SavedState m_texdefState;
-			FaceShader::SavedState m_shaderState;
-
-		SavedState(const Face& face) :
-			m_planeState(face.getPlane()),
-			m_texdefState(face.getTexdef()),
-			m_shaderState(face.getFaceShader())
-		{}
-
-		virtual ~SavedState() {}
-
-		void exportState(Face& face) const {
-			m_planeState.exportState(face.getPlane());
-			m_shaderState.exportState(face.getFaceShader());
-			m_texdefState.exportState(face.getTexdef());
-		}
-	};
-
 public:
 	static QuantiseFunc m_quantise;
 
@@ -88,6 +66,9 @@ private:
 	IUndoStateSaver* _undoStateSaver;
 	MapFile* m_map;
 
+	// Creates the delta-encoded undo mementos of this face
+	mutable undo::DeltaMementoChain _undoMementos;
+
 	// Cached visibility flag, queried during front end rendering
 	bool _faceIsVisible;
 
@@ -12,21 +12,6 @@ class FacePlane
     Plane3 m_plane;
 
 public:
-    class SavedState
-    {
-    public:
-        Plane3 m_plane;
-
-        SavedState(const FacePlane& facePlane) :
-            m_plane(facePlane.m_plane)
-        {}
-
-        void exportState(FacePlane& facePlane) const
-        {
-            facePlane.m_plane = m_plane;
-        }
-    }; // class SavedState
-
     /// Initialise internal plane from the given three points
     void initialiseFromPoints(const Vector3& p0,
                               const Vector3& p1,
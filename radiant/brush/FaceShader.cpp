@@ -146,14 +146,14 @@ void FaceShader::detachObserver(Observer& observer)
 
 const std::string& FaceShader::getMaterialName() const
 {
-	return _materialName;
+	return _materialName.getString();
 }
 
 void FaceShader::setMaterialName(const std::string& name)
 {
 	releaseShader();
 
-	_materialName = name;
+	_materialName = string::InternedString(name);
 
 	captureShader();
 }
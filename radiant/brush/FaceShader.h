@@ -8,6 +8,7 @@
 #include <boost/noncopyable.hpp>
 
 #include "ContentsFlagsValue.h"
+#include "string/InternedString.h"
 
 class Face;
 
@@ -37,28 +38,11 @@ public:
 		virtual void unrealiseShader() = 0;
 	};
 
-	class SavedState
-	{
-	public:
-		std::string _materialName;
-		ContentsFlagsValue m_flags;
-
-		SavedState(const FaceShader& faceShader) {
-			_materialName = faceShader.getMaterialName();
-			m_flags = faceShader.m_flags;
-		}
-
-		void exportState(FaceShader& faceShader) const {
-			faceShader.setMaterialName(_materialName);
-			faceShader.setFlags(m_flags);
-		}
-	};
-
 	// The owning face
 	Face& _owner;
 
-    // The text name of the material
-	std::string _materialName;
+    // The text name of the material, interned as it is shared by many faces
+	string::InternedString _materialName;
 
     // The Shader used by the renderer
 	ShaderPtr _glShader;
@@ -17,20 +17,6 @@ class FaceTexdef :
 	public boost::noncopyable
 {
 public:
-	class SavedState
-	{
-	public:
-		TextureProjection m_projection;
-
-		SavedState(const FaceTexdef& faceTexdef) {
-			m_projection = faceTexdef.m_projection;
-		}
-
-		void exportState(FaceTexdef& faceTexdef) const {
-			faceTexdef.m_projection.assign(m_projection);
-		}
-	};
-
 	FaceShader& m_shader;
 	TextureProjection m_projection;
 	bool m_projectionInitialised;
@@ -0,0 +1,581 @@
+#include "AreaPortalCulling.h"
+
+#include "imap.h"
+#include "ibrush.h"
+#include "iradiant.h"
+#include "ithread.h"
+#include "itextstream.h"
+#include "itrace.h"
+
+#include "GlobalCamera.h"
+
+#include <algorithm>
+#include <boost/format.hpp>
+#include <boost/functional/hash.hpp>
+#include <boost/bind.hpp>
+#include <glibmm/main.h>
+
+namespace
+{
+	// Wait for the map to stay unchanged that long before regenerating the graph
+	const unsigned int REBUILD_DELAY_MSEC = 500;
+
+	// Walls touching an area only with their faces are still part of it
+	const double AREA_BOUNDS_EPSILON = 1.0;
+
+	// Viewers closer to a portal than that are using the frustum in front of it
+	const double PORTAL_PLANE_EPSILON = 1.0;
+
+	// The number of narrowed frusta stored per area until the view frustum is used instead
+	const std::size_t MAX_FRUSTA_PER_AREA = 8;
+
+	// The number of portal passes per frame until the culling gives up
+	const std::size_t MAX_PORTAL_PASSES = 4096;
+
+	// Worker thread function, runs the prepared build and notifies the main thread
+	void buildAreaPortalGraph(const AreaPortalCache::GraphBuildPtr& build)
+	{
+		map::AreaPortalGraphTask task;
+
+		{
+			Glib::Mutex::Lock lock(build->mutex);
+			task = build->task;
+		}
+
+		map::AreaPortalGraphPtr graph;
+
+		try
+		{
+			graph = task();
+		}
+		catch (std::exception& ex)
+		{
+			rError() << "Portal culling: could not build the area graph: " << ex.what() << std::endl;
+		}
+
+		// Release our reference while the main thread still holds the task
+		task.clear();
+
+		Glib::Mutex::Lock lock(build->mutex);
+
+		build->graph = graph;
+		build->running = false;
+		build->finished.signal();
+
+		if (build->dispatcher != NULL)
+		{
+			build->dispatcher->emit();
+		}
+	}
+
+	// Clips the given polygon, keeping the part on the positive side of the plane
+	std::vector<Vector3> clipWinding(const std::vector<Vector3>& winding, const Plane3& plane)
+	{
+		std::vector<Vector3> result;
+
+		for (std::size_t i = 0; i < winding.size(); ++i)
+		{
+			const Vector3& cur = winding[i];
+			const Vector3& next = winding[(i + 1) % winding.size()];
+
+			double curDist = plane.distanceToPoint(cur);
+			double nextDist = plane.distanceToPoint(next);
+
+			if (curDist >= 0)
+			{
+				result.push_back(cur);
+			}
+
+			if ((curDist >= 0) != (nextDist >= 0))
+			{
+				result.push_back(cur + (next - cur) * (curDist / (curDist - nextDist)));
+			}
+		}
+
+		return result;
+	}
+
+	bool boundsIntersectVolume(const AABB& aabb, const std::vector<Plane3>& planes)
+	{
+		for (std::vector<Plane3>::const_iterator p = planes.begin(); p != planes.end(); ++p)
+		{
+			const Vector3& normal = p->normal();
+
+			double radius = fabs(normal.x() * aabb.extents.x()) +
+				fabs(normal.y() * aabb.extents.y()) +
+				fabs(normal.z() * aabb.extents.z());
+
+			if (p->distanceToPoint(aabb.origin) < -radius)
+			{
+				return false;
+			}
+		}
+
+		return true;
+	}
+}
+
+AreaPortalCache::AreaPortalCache() :
+	_root(NULL),
+	_worldspawnChecksum(0),
+	_buildRoot(NULL),
+	_buildChecksum(0),
+	_enabled(false),
+	_rebuildPending(false),
+	_build(new GraphBuild)
+{}
+
+void AreaPortalCache::setEnabled(bool enabled)
+{
+	if (_enabled == enabled) return;
+
+	_enabled = enabled;
+
+	if (_enabled)
+	{
+		GlobalSceneGraph().addSceneObserver(this);
+
+		// The worker thread hands the graph over through this dispatcher
+		_buildDispatcher.reset(new Glib::Dispatcher);
+		_buildDispatcher->connect(sigc::mem_fun(*this, &AreaPortalCache::onGraphBuilt));
+
+		{
+			Glib::Mutex::Lock lock(_build->mutex);
+			_build->dispatcher = _buildDispatcher.get();
+		}
+
+		scheduleRebuild();
+	}
+	else
+	{
+		GlobalSceneGraph().removeSceneObserver(this);
+
+		_rebuildTimer.disconnect();
+
+		{
+			Glib::Mutex::Lock lock(_build->mutex);
+
+			// The task refers to the materials, which need to be released
+			// on this thread, wait for a running build to finish
+			while (_build->running)
+			{
+				_build->finished.wait(_build->mutex);
+			}
+
+			_build->dispatcher = NULL;
+			_build->task.clear();
+			_build->graph.reset();
+		}
+
+		_buildDispatcher.reset();
+
+		_rebuildPending = false;
+		_graph.reset();
+		_areaPortals.clear();
+		_nodeAreas.clear();
+		_root = NULL;
+	}
+}
+
+map::AreaPortalGraphPtr AreaPortalCache::getGraph()
+{
+	if (!_enabled) return map::AreaPortalGraphPtr();
+
+	// A different map might have been loaded without changing any bounds
+	if (GlobalSceneGraph().root().get() != _root && !_rebuildPending)
+	{
+		scheduleRebuild();
+	}
+
+	// Don't cull anything while the graph might be out of date
+	return _rebuildPending ? map::AreaPortalGraphPtr() : _graph;
+}
+
+const std::vector<std::size_t>& AreaPortalCache::getPortalsForArea(int area) const
+{
+	return _areaPortals[area];
+}
+
+const std::vector<int>& AreaPortalCache::getAreasForNode(const scene::INode& node)
+{
+	const AABB& bounds = node.worldAABB();
+
+	NodeAreaMap::iterator i = _nodeAreas.find(&node);
+
+	if (i != _nodeAreas.end() &&
+		i->second.bounds.origin == bounds.origin && i->second.bounds.extents == bounds.extents)
+	{
+		return i->second.areas;
+	}
+
+	NodeAreas& entry = _nodeAreas[&node];
+
+	entry.bounds = bounds;
+	entry.areas.clear();
+
+	if (_graph)
+	{
+		_graph->getAreasForBounds(bounds, entry.areas, AREA_BOUNDS_EPSILON);
+	}
+
+	return entry.areas;
+}
+
+void AreaPortalCache::onSceneNodeErase(const scene::INodePtr& node)
+{
+	_nodeAreas.erase(node.get());
+}
+
+void AreaPortalCache::onSceneNodeBoundsChanged(const scene::INodePtr& node)
+{
+	// The worldspawn's bounds are evaluated again whenever one of its brushes
+	// has been changed, added or removed. Changes to other entities don't
+	// affect the areas, their cached areas are checked against their bounds.
+	if (node == GlobalMapModule().getWorldspawn())
+	{
+		scheduleRebuild();
+	}
+}
+
+void AreaPortalCache::scheduleRebuild()
+{
+	_rebuildPending = true;
+
+	// Restart the timer, the graph is processed once the changes have settled
+	_rebuildTimer.disconnect();
+	_rebuildTimer = Glib::signal_timeout().connect(
+		sigc::mem_fun(*this, &AreaPortalCache::onRebuildTimer), REBUILD_DELAY_MSEC
+	);
+}
+
+bool AreaPortalCache::onRebuildTimer()
+{
+	{
+		Glib::Mutex::Lock lock(_build->mutex);
+
+		// Check again later, the running build is outdated anyway
+		if (_build->running) return true;
+	}
+
+	rebuild();
+
+	return false; // disconnect
+}
+
+void AreaPortalCache::rebuild()
+{
+	const scene::INodePtr& root = GlobalSceneGraph().root();
+	std::size_t checksum = calculateWorldspawnChecksum();
+
+	// Only changes to the worldspawn brushes are affecting the areas, the
+	// cached node areas remain valid as they are checked against the bounds
+	if (root.get() == _root && checksum == _worldspawnChecksum)
+	{
+		_rebuildPending = false;
+		return;
+	}
+
+	_buildRoot = root.get();
+	_buildChecksum = checksum;
+
+	if (!root || !module::GlobalModuleRegistry().moduleExists(MODULE_MAPCOMPILER))
+	{
+		setGraph(map::AreaPortalGraphPtr());
+		return;
+	}
+
+	map::AreaPortalGraphTask task;
+
+	{
+		trace::ScopedZone zone("render", "prepareAreaPortalGraph");
+
+		// Reading the brushes needs to happen on this thread
+		task = GlobalMapCompiler().prepareAreaPortalGraph(root);
+	}
+
+	{
+		Glib::Mutex::Lock lock(_build->mutex);
+
+		_build->task = task;
+		_build->graph.reset();
+		_build->running = true;
+	}
+
+	GlobalRadiant().getThreadManager().execute(
+		boost::bind(buildAreaPortalGraph, _build)
+	);
+}
+
+void AreaPortalCache::onGraphBuilt()
+{
+	map::AreaPortalGraphPtr graph;
+
+	{
+		Glib::Mutex::Lock lock(_build->mutex);
+
+		if (_build->running || !_build->task) return;
+
+		graph = _build->graph;
+
+		_build->graph.reset();
+		_build->task.clear();
+	}
+
+	// The worldspawn has been changed again while the graph has been built,
+	// the timer starts another build
+	if (_rebuildTimer.connected()) return;
+
+	setGraph(graph);
+}
+
+void AreaPortalCache::setGraph(const map::AreaPortalGraphPtr& graph)
+{
+	_rebuildPending = false;
+
+	_root = _buildRoot;
+	_worldspawnChecksum = _buildChecksum;
+
+	_graph = graph;
+	_areaPortals.clear();
+	_nodeAreas.clear();
+
+	if (_graph)
+	{
+		_areaPortals.resize(_graph->numAreas);
+
+		for (std::size_t i = 0; i < _graph->portals.size(); ++i)
+		{
+			const map::AreaPortalGraph::Portal& portal = _graph->portals[i];
+
+			_areaPortals[portal.areas[0]].push_back(i);
+			_areaPortals[portal.areas[1]].push_back(i);
+		}
+
+		rMessage() << "Portal culling: " << _graph->numAreas << " areas, "
+			<< _graph->portals.size() << " portals." << std::endl;
+	}
+	else if (_root != NULL && module::GlobalModuleRegistry().moduleExists(MODULE_MAPCOMPILER))
+	{
+		rMessage() << "Portal culling: the map doesn't have any visportals or is leaking." << std::endl;
+	}
+
+	// Redraw the views to apply the new graph
+	GlobalCamera().update();
+}
+
+std::size_t AreaPortalCache::calculateWorldspawnChecksum()
+{
+	std::size_t checksum = 0;
+
+	scene::INodePtr worldspawn = GlobalMapModule().getWorldspawn();
+
+	if (!worldspawn) return checksum;
+
+	worldspawn->foreachNode([&] (const scene::INodePtr& child)->bool
+	{
+		IBrush* brush = Node_getIBrush(child);
+
+		if (brush == NULL) return true;
+
+		for (std::size_t i = 0; i < brush->getNumFaces(); ++i)
+		{
+			const IFace& face = brush->getFace(i);
+			const Plane3& plane = face.getPlane3();
+
+			boost::hash_combine(checksum, plane.normal().x());
+			boost::hash_combine(checksum, plane.normal().y());
+			boost::hash_combine(checksum, plane.normal().z());
+			boost::hash_combine(checksum, plane.dist());
+			boost::hash_combine(checksum, face.getShader());
+		}
+
+		return true;
+	});
+
+	return checksum;
+}
+
+// ------------------------------------------------------------------------------------
+
+PortalCuller::PortalCuller(AreaPortalCache& cache, const Vector3& viewer, const Frustum& frustum) :
+	_cache(cache),
+	_graph(cache.getGraph()),
+	_viewer(viewer),
+	_active(false),
+	_numPortalPasses(0),
+	_numVisibleAreas(0),
+	_numTestedNodes(0),
+	_numCulledNodes(0)
+{
+	if (!_graph) return;
+
+	int viewerArea = _graph->getAreaForPoint(_viewer);
+
+	// Outside the map everything is visible
+	if (viewerArea < 0) return;
+
+	_areas.resize(_graph->numAreas);
+
+	// The frustum planes are facing inwards, with the distance negated
+	Planes planes;
+
+	planes.push_back(Plane3(frustum.left.normal(), -frustum.left.dist()));
+	planes.push_back(Plane3(frustum.right.normal(), -frustum.right.dist()));
+	planes.push_back(Plane3(frustum.top.normal(), -frustum.top.dist()));
+	planes.push_back(Plane3(frustum.bottom.normal(), -frustum.bottom.dist()));
+
+	floodRecursively(viewerArea, planes);
+
+	// The viewer's own area doesn't need to be tested against the portal frusta
+	_areas[viewerArea].unbounded = true;
+
+	_active = _numPortalPasses <= MAX_PORTAL_PASSES;
+}
+
+bool PortalCuller::isVisible(const scene::INodePtr& node)
+{
+	if (!_active) return true;
+
+	const AABB& bounds = node->worldAABB();
+
+	// Nodes without extents like the root are always visited
+	if (!bounds.isValid()) return true;
+
+	++_numTestedNodes;
+
+	const std::vector<int>& areas = _cache.getAreasForNode(*node);
+
+	for (std::vector<int>::const_iterator a = areas.begin(); a != areas.end(); ++a)
+	{
+		const AreaVisibility& area = _areas[*a];
+
+		if (!area.visible) continue;
+
+		if (area.unbounded) return true;
+
+		for (std::vector<Planes>::const_iterator f = area.frusta.begin(); f != area.frusta.end(); ++f)
+		{
+			if (boundsIntersectVolume(bounds, *f)) return true;
+		}
+	}
+
+	++_numCulledNodes;
+
+	return false;
+}
+
+std::string PortalCuller::getStats() const
+{
+	if (!_active)
+	{
+		return "Portal culling inactive";
+	}
+
+	return (boost::format("Areas: %d/%d visible | Nodes: %d/%d culled") %
+		_numVisibleAreas % _areas.size() % _numCulledNodes % _numTestedNodes).str();
+}
+
+void PortalCuller::floodRecursively(int area, const Planes& planes)
+{
+	AreaVisibility& visibility = _areas[area];
+
+	if (!visibility.visible)
+	{
+		visibility.visible = true;
+		++_numVisibleAreas;
+	}
+
+	if (!visibility.unbounded)
+	{
+		if (visibility.frusta.size() < MAX_FRUSTA_PER_AREA)
+		{
+			visibility.frusta.push_back(planes);
+		}
+		else
+		{
+			visibility.unbounded = true;
+			visibility.frusta.clear();
+		}
+	}
+
+	_areaStack.push_back(area);
+
+	const std::vector<std::size_t>& portals = _cache.getPortalsForArea(area);
+
+	for (std::vector<std::size_t>::const_iterator i = portals.begin(); i != portals.end(); ++i)
+	{
+		// Give up on pathological layouts, everything is drawn in that case
+		if (++_numPortalPasses > MAX_PORTAL_PASSES) break;
+
+		const map::AreaPortalGraph::Portal& portal = _graph->portals[*i];
+
+		int otherArea = static_cast<int>(portal.areas[0]) == area ?
+			static_cast<int>(portal.areas[1]) : static_cast<int>(portal.areas[0]);
+
+		// Don't flood back into the areas we came through
+		if (std::find(_areaStack.begin(), _areaStack.end(), otherArea) != _areaStack.end())
+		{
+			continue;
+		}
+
+		// Clip the portal to the current frustum
+		std::vector<Vector3> winding = portal.winding;
+
+		for (Planes::const_iterator p = planes.begin(); p != planes.end() && winding.size() >= 3; ++p)
+		{
+			winding = clipWinding(winding, *p);
+		}
+
+		if (winding.size() < 3) continue; // portal not visible
+
+		Vector3 centre(0, 0, 0);
+
+		for (std::size_t v = 0; v < winding.size(); ++v)
+		{
+			centre += winding[v];
+		}
+
+		centre /= static_cast<double>(winding.size());
+
+		Vector3 portalNormal = (winding[1] - winding[0]).crossProduct(winding[2] - winding[0]);
+
+		// Standing in the portal: the frustum can't be narrowed down any further
+		if (portalNormal.getLength() < 0.001 ||
+			fabs(portalNormal.getNormalised().dot(_viewer - winding[0])) < PORTAL_PLANE_EPSILON)
+		{
+			floodRecursively(otherArea, planes);
+			continue;
+		}
+
+		// Construct the planes through the viewer and each edge of the clipped portal
+		Planes portalPlanes;
+
+		for (std::size_t v = 0; v < winding.size(); ++v)
+		{
+			const Vector3& a = winding[v];
+			const Vector3& b = winding[(v + 1) % winding.size()];
+
+			Vector3 normal = (a - _viewer).crossProduct(b - _viewer);
+
+			double length = normal.getLength();
+
+			if (length < 0.001) continue; // degenerate edge
+
+			normal /= length;
+
+			Plane3 plane(normal, normal.dot(_viewer));
+
+			// Let the plane face the portal
+			if (plane.distanceToPoint(centre) < 0)
+			{
+				plane = Plane3(-normal, -plane.dist());
+			}
+
+			portalPlanes.push_back(plane);
+		}
+
+		floodRecursively(otherArea, portalPlanes);
+	}
+
+	_areaStack.pop_back();
+}
@@ -0,0 +1,184 @@
+#pragma once
+
+#include "iscenegraph.h"
+#include "imapcompiler.h"
+#include "math/Frustum.h"
+
+#include <string>
+#include <vector>
+#include <unordered_map>
+#include <sigc++/connection.h>
+#include <sigc++/trackable.h>
+#include <glibmm/thread.h>
+#include <glibmm/dispatcher.h>
+#include <boost/scoped_ptr.hpp>
+
+/**
+ * Keeps the area/portal graph of the current map for the camera views.
+ *
+ * The graph is generated by the map compiler from the structural worldspawn
+ * brushes and the visportals. It is regenerated shortly after the worldspawn
+ * brushes have been changed, moving entities or detail geometry around only
+ * invalidates the cached areas of the nodes involved. The brushes are read
+ * on the main thread, the BSP tree and the area flood are processed by a
+ * worker thread. The areas touched by a scene node are determined on demand
+ * and kept until its bounds change.
+ */
+class AreaPortalCache :
+	public scene::Graph::Observer,
+	public sigc::trackable
+{
+public:
+	// State shared with the worker thread building the graph
+	struct GraphBuild
+	{
+		Glib::Mutex mutex;
+		Glib::Cond finished;
+
+		// Prepared on the main thread, which releases it again
+		map::AreaPortalGraphTask task;
+
+		// The result, valid once running is false
+		map::AreaPortalGraphPtr graph;
+		bool running;
+
+		// Notifies the main thread, NULL while disabled
+		Glib::Dispatcher* dispatcher;
+
+		GraphBuild() :
+			running(false),
+			dispatcher(NULL)
+		{}
+	};
+	typedef boost::shared_ptr<GraphBuild> GraphBuildPtr;
+
+private:
+	map::AreaPortalGraphPtr _graph;
+
+	// The portals leading out of each area
+	typedef std::vector<std::size_t> PortalIndices;
+	std::vector<PortalIndices> _areaPortals;
+
+	// The root the graph has been generated for
+	const scene::INode* _root;
+
+	// Checksum of the worldspawn brushes the graph has been generated from
+	std::size_t _worldspawnChecksum;
+
+	// Root and checksum of the graph being built
+	const scene::INode* _buildRoot;
+	std::size_t _buildChecksum;
+
+	bool _enabled;
+	bool _rebuildPending;
+
+	sigc::connection _rebuildTimer;
+
+	GraphBuildPtr _build;
+	boost::scoped_ptr<Glib::Dispatcher> _buildDispatcher;
+
+	struct NodeAreas
+	{
+		AABB bounds;
+		std::vector<int> areas;
+	};
+	typedef std::unordered_map<const scene::INode*, NodeAreas> NodeAreaMap;
+	NodeAreaMap _nodeAreas;
+
+public:
+	AreaPortalCache();
+
+	// Starts or stops tracking the scenegraph, the graph is freed when disabled
+	void setEnabled(bool enabled);
+
+	/**
+	 * Returns the graph of the current map. This is NULL while the map has
+	 * not been processed yet, or if it doesn't have any visportals or leaks.
+	 */
+	map::AreaPortalGraphPtr getGraph();
+
+	// The indices of the portals connected to the given area
+	const std::vector<std::size_t>& getPortalsForArea(int area) const;
+
+	// The areas touched by the given node's world bounds
+	const std::vector<int>& getAreasForNode(const scene::INode& node);
+
+	// scene::Graph::Observer implementation
+	void onSceneNodeErase(const scene::INodePtr& node);
+	void onSceneNodeBoundsChanged(const scene::INodePtr& node);
+
+private:
+	void scheduleRebuild();
+	bool onRebuildTimer();
+
+	// Starts building the graph if the worldspawn brushes have changed
+	void rebuild();
+
+	// Takes the graph built by the worker thread
+	void onGraphBuilt();
+
+	// Replaces the graph, called on the main thread
+	void setGraph(const map::AreaPortalGraphPtr& graph);
+
+	std::size_t calculateWorldspawnChecksum();
+};
+
+/**
+ * Determines the areas visible from the camera by flooding through the
+ * visportals, starting in the area containing the viewer. The view frustum
+ * is narrowed to each portal on the way, scene nodes are culled if none of
+ * their areas is visible or if they are outside the portal frusta their
+ * areas are seen through.
+ */
+class PortalCuller
+{
+private:
+	AreaPortalCache& _cache;
+
+	map::AreaPortalGraphPtr _graph;
+
+	Vector3 _viewer;
+
+	// Planes facing the inside of the volume
+	typedef std::vector<Plane3> Planes;
+
+	struct AreaVisibility
+	{
+		bool visible;
+
+		// TRUE if the area is tested against the view frustum only
+		bool unbounded;
+
+		// The narrowed frusta this area is seen through
+		std::vector<Planes> frusta;
+
+		AreaVisibility() :
+			visible(false),
+			unbounded(false)
+		{}
+	};
+	std::vector<AreaVisibility> _areas;
+
+	// The areas of the current flood path
+	std::vector<int> _areaStack;
+
+	// FALSE if the viewer is outside the map or there is no graph
+	bool _active;
+
+	std::size_t _numPortalPasses;
+	std::size_t _numVisibleAreas;
+	std::size_t _numTestedNodes;
+	std::size_t _numCulledNodes;
+
+public:
+	PortalCuller(AreaPortalCache& cache, const Vector3& viewer, const Frustum& frustum);
+
+	// Returns FALSE if the given node can't be seen from the viewer
+	bool isVisible(const scene::INodePtr& node);
+
+	// Returns a human-readable summary of the areas and nodes culled
+	std::string getStats() const;
+
+private:
+	void floodRecursively(int area, const Planes& planes);
+};
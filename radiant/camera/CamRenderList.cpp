@@ -0,0 +1,299 @@
+#include "CamRenderList.h"
+
+#include "iselection.h"
+#include "itrace.h"
+#include "CamRenderer.h"
+#include "render/RenderStatistics.h"
+
+namespace
+{
+
+/**
+ * A volume containing everything, used to record the renderables of the
+ * whole scene. The matrices are the ones of the camera view.
+ */
+class UnboundedVolume :
+	public VolumeTest
+{
+	const VolumeTest& _view;
+
+public:
+	UnboundedVolume(const VolumeTest& view) :
+		_view(view)
+	{}
+
+	bool TestPoint(const Vector3& point) const
+	{
+		return true;
+	}
+
+	bool TestLine(const Segment& segment) const
+	{
+		return true;
+	}
+
+	bool TestPlane(const Plane3& plane) const
+	{
+		return true;
+	}
+
+	bool TestPlane(const Plane3& plane, const Matrix4& localToWorld) const
+	{
+		return true;
+	}
+
+	VolumeIntersectionValue TestAABB(const AABB& aabb) const
+	{
+		return VOLUME_INSIDE;
+	}
+
+	VolumeIntersectionValue TestAABB(const AABB& aabb, const Matrix4& localToWorld) const
+	{
+		return VOLUME_INSIDE;
+	}
+
+	bool fill() const
+	{
+		return _view.fill();
+	}
+
+	const Matrix4& GetViewport() const
+	{
+		return _view.GetViewport();
+	}
+
+	const Matrix4& GetProjection() const
+	{
+		return _view.GetProjection();
+	}
+
+	const Matrix4& GetModelview() const
+	{
+		return _view.GetModelview();
+	}
+};
+
+}
+
+CamRenderList::CamRenderList() :
+	_recorded(false),
+	_changed(true),
+	_recording(false)
+{
+	GlobalSceneGraph().addSceneObserver(this);
+	GlobalUndoSystem().attachTracker(*this);
+
+	_boundsChangedConn = GlobalSceneGraph().signal_boundsChanged().connect(
+		sigc::mem_fun(*this, &CamRenderList::invalidate)
+	);
+}
+
+CamRenderList::~CamRenderList()
+{
+	_boundsChangedConn.disconnect();
+
+	GlobalUndoSystem().detachTracker(*this);
+	GlobalSceneGraph().removeSceneObserver(this);
+}
+
+bool CamRenderList::beginFrame()
+{
+	// Component editing and the clipper draw view-dependent geometry, the
+	// transform preview is only valid for the current frame
+	if (GlobalSelectionSystem().Mode() == SelectionSystem::eComponent ||
+		GlobalSelectionSystem().ManipulatorMode() == SelectionSystem::eClip ||
+		GlobalSelectionSystem().getTransformPreview() != NULL)
+	{
+		invalidate();
+		return false;
+	}
+
+	if (_changed)
+	{
+		// Wait for the scene to settle before recording it again
+		_changed = false;
+		return false;
+	}
+
+	return true;
+}
+
+bool CamRenderList::isRecorded() const
+{
+	return _recorded;
+}
+
+bool CamRenderList::record(CamRenderer& renderer, const VolumeTest& view)
+{
+	trace::ScopedZone zone("render", "recordCameraRenderList");
+
+	clearItems();
+
+	UnboundedVolume volume(view);
+
+	_recording = true;
+	renderer.setRenderList(this);
+
+	// The list is used for any camera position, the level of detail is
+	// applied when submitting it
+	render::RenderableCollectionWalker::collectRenderablesInGraph(renderer, volume,
+		boost::bind(&CamRenderList::beginNode, this, _1), false);
+
+	finishNode();
+
+	renderer.setRenderList(NULL);
+	_recording = false;
+
+	if (_changed)
+	{
+		// Some nodes got updated on the way, don't keep the results
+		clearItems();
+		return false;
+	}
+
+	_recorded = true;
+
+	return true;
+}
+
+void CamRenderList::submit(CamRenderer& renderer, const VolumeTest& view,
+						   const render::RenderableCollectionWalker::NodeFilter& filter)
+{
+	render::LevelOfDetail lod(view);
+
+	for (std::vector<NodeItems>::const_iterator node = _nodes.begin(); node != _nodes.end(); ++node)
+	{
+		if (node->bounds.isValid() && view.TestAABB(node->bounds) == VOLUME_OUTSIDE)
+		{
+			continue;
+		}
+
+		// The recorded renderables are not simplified, only culled
+		if (lod.getLevel(node->bounds) == render::LevelOfDetail::CULLED &&
+			!render::RenderableCollectionWalker::isHighlighted(node->node))
+		{
+			render::RenderStatistics::Instance().increaseCulled();
+			continue;
+		}
+
+		if (filter && !filter(node->node))
+		{
+			continue;
+		}
+
+		std::vector<Item>::const_iterator end = _items.begin() + node->first + node->count;
+
+		for (std::vector<Item>::const_iterator i = _items.begin() + node->first; i != end; ++i)
+		{
+			if (i->entity != NULL)
+			{
+				i->shader->addRenderable(*i->renderable, *i->world, *i->entity, i->lights);
+			}
+			else
+			{
+				i->shader->addRenderable(*i->renderable, *i->world, i->lights);
+			}
+		}
+	}
+
+	render::RenderableCollectionWalker::collectRenderablesForNodes(renderer, view, _dynamicNodes, filter);
+	render::RenderableCollectionWalker::collectRenderSystemRenderables(renderer, view);
+}
+
+void CamRenderList::invalidate()
+{
+	_changed = true;
+
+	// Release the nodes right away, unless the list is being recorded
+	if (!_recording)
+	{
+		clearItems();
+	}
+}
+
+void CamRenderList::addItem(Shader& shader,
+							const OpenGLRenderable& renderable,
+							const Matrix4& world,
+							const IRenderEntity* entity,
+							const LightList* lights)
+{
+	_items.push_back(Item(shader, renderable, world, entity, lights));
+}
+
+void CamRenderList::onSceneGraphChange()
+{
+	invalidate();
+}
+
+void CamRenderList::onSceneNodeErase(const scene::INodePtr& node)
+{
+	invalidate();
+}
+
+void CamRenderList::clear()
+{
+	invalidate();
+}
+
+void CamRenderList::begin()
+{
+	invalidate();
+}
+
+void CamRenderList::undo()
+{
+	invalidate();
+}
+
+void CamRenderList::redo()
+{
+	invalidate();
+}
+
+void CamRenderList::clearItems()
+{
+	_items.clear();
+	_nodes.clear();
+	_dynamicNodes.clear();
+
+	_recorded = false;
+}
+
+bool CamRenderList::beginNode(const scene::INodePtr& node)
+{
+	finishNode();
+
+	// Particles are updated for the view in each frame
+	if (node->getNodeType() == scene::INode::Type::Particle)
+	{
+		_dynamicNodes.push_back(node);
+		return false;
+	}
+
+	NodeItems items;
+
+	items.node = node;
+	items.bounds = node->worldAABB();
+	items.first = _items.size();
+	items.count = 0;
+
+	_nodes.push_back(items);
+
+	return true;
+}
+
+void CamRenderList::finishNode()
+{
+	if (_nodes.empty() || _nodes.back().count > 0)
+	{
+		return;
+	}
+
+	_nodes.back().count = _items.size() - _nodes.back().first;
+
+	// Nodes without any renderables don't need to be tested later on
+	if (_nodes.back().count == 0)
+	{
+		_nodes.pop_back();
+	}
+}
@@ -0,0 +1,141 @@
+#pragma once
+
+#include "iscenegraph.h"
+#include "iundo.h"
+#include "irender.h"
+#include "math/AABB.h"
+#include "render/frontend/RenderableCollectionWalker.h"
+
+#include <vector>
+#include <sigc++/connection.h>
+#include <sigc++/trackable.h>
+
+class CamRenderer;
+
+/**
+ * Retained list of the renderables submitted by the scene for a camera view.
+ *
+ * The scene is walked once, independently of the view frustum, and the
+ * submitted renderables are stored in a flat array, grouped by the scene
+ * node they belong to. In the following frames only the node bounds are
+ * tested against the view before handing their renderables to the shaders,
+ * which saves the scenegraph traversal and the renderSolid() calls as long
+ * as the scene doesn't change.
+ *
+ * Any scene change, bounds change or undoable operation discards the list.
+ * It is recorded again after the scene has been left unchanged for a frame,
+ * such that dragging objects around doesn't record it in every frame.
+ * Particle nodes are animated and are therefore collected in every frame.
+ * The list is recorded without level of detail, nodes too small to be seen
+ * are culled when it is submitted.
+ */
+class CamRenderList :
+	public scene::Graph::Observer,
+	public IUndoTracker,
+	public sigc::trackable
+{
+private:
+	// A renderable in the state it has been submitted to the CamRenderer
+	struct Item
+	{
+		Shader* shader;
+		const OpenGLRenderable* renderable;
+		const Matrix4* world;
+		const IRenderEntity* entity;
+		const LightList* lights;
+
+		Item(Shader& shader_,
+			 const OpenGLRenderable& renderable_,
+			 const Matrix4& world_,
+			 const IRenderEntity* entity_,
+			 const LightList* lights_) :
+			shader(&shader_),
+			renderable(&renderable_),
+			world(&world_),
+			entity(entity_),
+			lights(lights_)
+		{}
+	};
+	std::vector<Item> _items;
+
+	// The range of items submitted by a single scene node
+	struct NodeItems
+	{
+		scene::INodePtr node;
+		AABB bounds;
+		std::size_t first;
+		std::size_t count;
+	};
+	std::vector<NodeItems> _nodes;
+
+	// Nodes which need to be collected in every frame
+	std::vector<scene::INodePtr> _dynamicNodes;
+
+	bool _recorded;
+
+	// TRUE if the scene changed since the last frame
+	bool _changed;
+
+	// TRUE while the scene is walked by record()
+	bool _recording;
+
+	sigc::connection _boundsChangedConn;
+
+public:
+	CamRenderList();
+	~CamRenderList();
+
+	/**
+	 * Called at the beginning of each frame, returns TRUE if the retained
+	 * list can be used for it. Otherwise the scene should be collected as
+	 * usual, this is the case after scene changes, while the selection is
+	 * displayed with a transform preview and in the editing modes drawing
+	 * view-dependent geometry (component editing, clipper).
+	 */
+	bool beginFrame();
+
+	// TRUE if the list holds the current scene
+	bool isRecorded() const;
+
+	/**
+	 * Walks the whole scene and stores the renderables submitted to the
+	 * given renderer. Returns FALSE if the scene changed during the walk,
+	 * the list is empty in this case.
+	 */
+	bool record(CamRenderer& renderer, const VolumeTest& view);
+
+	/**
+	 * Passes the renderables of the nodes intersecting the given view to
+	 * their shaders. The dynamic nodes and the renderables attached to the
+	 * RenderSystem are collected through the given renderer.
+	 */
+	void submit(CamRenderer& renderer, const VolumeTest& view,
+				const render::RenderableCollectionWalker::NodeFilter& filter);
+
+	// Discards the list, it will be recorded again once the scene settled
+	void invalidate();
+
+	// Called by the CamRenderer while recording
+	void addItem(Shader& shader,
+				 const OpenGLRenderable& renderable,
+				 const Matrix4& world,
+				 const IRenderEntity* entity,
+				 const LightList* lights);
+
+	// scene::Graph::Observer implementation
+	void onSceneGraphChange();
+	void onSceneNodeErase(const scene::INodePtr& node);
+
+	// IUndoTracker implementation
+	void clear();
+	void begin();
+	void undo();
+	void redo();
+
+private:
+	void clearItems();
+
+	// Sorts the nodes into static and dynamic ones while recording
+	bool beginNode(const scene::INodePtr& node);
+	void finishNode();
+};
@@ -1,5 +1,7 @@
 #include "CamRenderer.h"
 
+#include "CamRenderList.h"
+
 #include "debugging/debugging.h"
 
 CamRenderer::CamRenderer(RenderStateFlags globalstate,
@@ -9,7 +11,8 @@ CamRenderer::CamRenderer(RenderStateFlags globalstate,
 : m_globalstate(globalstate),
   _highlightedPrimitiveShader(primitiveShader),
   _highlightedFaceShader(faceShader),
-  m_viewer(viewer)
+  m_viewer(viewer),
+  _renderList(NULL)
 {
     assert(primitiveShader);
     assert(faceShader);
@@ -59,26 +62,46 @@ void CamRenderer::setLights(const LightList& lights)
     _stateStack.back().lights = &lights;
 }
 
+void CamRenderer::setRenderList(CamRenderList* renderList)
+{
+    _renderList = renderList;
+}
+
+void CamRenderer::submit(Shader& shader,
+                         const OpenGLRenderable& renderable,
+                         const Matrix4& world,
+                         const IRenderEntity* entity)
+{
+    const LightList* lights = _stateStack.back().lights;
+
+    if (_renderList != NULL)
+    {
+        _renderList->addItem(shader, renderable, world, entity, lights);
+    }
+    else if (entity != NULL)
+    {
+        shader.addRenderable(renderable, world, *entity, lights);
+    }
+    else
+    {
+        shader.addRenderable(renderable, world, lights);
+    }
+}
+
 void CamRenderer::addRenderable(const OpenGLRenderable& renderable,
                                 const Matrix4& world)
 {
     if(_stateStack.back().highlightPrimitives)
     {
-        _highlightedPrimitiveShader->addRenderable(
-          renderable, world, _stateStack.back().lights
-        );
+        submit(*_highlightedPrimitiveShader, renderable, world, NULL);
     }
 
     if(_stateStack.back().highlightFaces)
     {
-        _highlightedFaceShader->addRenderable(
-            renderable, world, _stateStack.back().lights
-        );
+        submit(*_highlightedFaceShader, renderable, world, NULL);
     }
 
-    _stateStack.back().shader->addRenderable(
-        renderable, world, _stateStack.back().lights
-    );
+    submit(*_stateStack.back().shader, renderable, world, NULL);
 }
 
 void CamRenderer::addRenderable(const OpenGLRenderable& renderable,
@@ -87,21 +110,15 @@ void CamRenderer::addRenderable(const OpenGLRenderable& renderable,
 {
     if (_stateStack.back().highlightPrimitives)
     {
-        _highlightedPrimitiveShader->addRenderable(
-            renderable, world, entity, _stateStack.back().lights
-        );
+        submit(*_highlightedPrimitiveShader, renderable, world, &entity);
     }
 
     if (_stateStack.back().highlightFaces)
     {
-        _highlightedFaceShader->addRenderable(
-            renderable, world, entity, _stateStack.back().lights
-        );
+        submit(*_highlightedFaceShader, renderable, world, &entity);
     }
 
-    _stateStack.back().shader->addRenderable(
-        renderable, world, entity, _stateStack.back().lights
-    );
+    submit(*_stateStack.back().shader, renderable, world, &entity);
 }
 
 void CamRenderer::render(const Matrix4& modelview, const Matrix4& projection)
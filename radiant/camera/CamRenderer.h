@@ -3,6 +3,8 @@
 #include "irenderable.h"
 #include "irender.h"
 
+class CamRenderList;
+
 /// Implementation of RenderableCollector for the 3D camera view
 class CamRenderer : 
 	public RenderableCollector
@@ -30,6 +32,15 @@ class CamRenderer :
     ShaderPtr _highlightedFaceShader;
     const Vector3& m_viewer;
 
+    // If set, renderables are stored in this list instead of the shaders
+    CamRenderList* _renderList;
+
+private:
+    void submit(Shader& shader,
+                const OpenGLRenderable& renderable,
+                const Matrix4& world,
+                const IRenderEntity* entity);
+
 public:
 
     /**
@@ -46,6 +57,13 @@ public:
 
     void render(const Matrix4& modelview, const Matrix4& projection);
 
+    /**
+     * Redirect all subsequently submitted renderables into the given list,
+     * which can pass them to the shaders in later frames. Pass NULL to
+     * submit them to the shaders directly again.
+     */
+    void setRenderList(CamRenderList* renderList);
+
     // RenderableCollector implementation
     void SetState(const ShaderPtr& shader, EStyle style);
     bool supportsFullMaterials() const;
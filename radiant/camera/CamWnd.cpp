@@ -5,6 +5,7 @@
 #include "iuimanager.h"
 #include "ieventmanager.h"
 #include "imainframe.h"
+#include "itrace.h"
 
 #include "gtkutil/GLWidgetSentry.h"
 #include <time.h>
@@ -17,12 +18,14 @@
 #include "CamRenderer.h"
 #include "CameraSettings.h"
 #include "GlobalCamera.h"
+#include "AreaPortalCulling.h"
 #include "render/RenderStatistics.h"
 #include "render/frontend/RenderableCollectionWalker.h"
 #include "registry/adaptors.h"
 #include "selection/OccludeSelector.h"
 
 #include <boost/bind.hpp>
+#include <boost/scoped_ptr.hpp>
 
 #include <gtkmm/main.h>
 #include <gtkmm/image.h>
@@ -657,8 +660,37 @@ void CamWnd::Cam_Draw()
         CamRenderer renderer(allowedRenderFlags, _primitiveHighlightShader,
                              _faceHighlightShader, m_view.getViewer());
 
-		render::RenderableCollectionWalker::collectRenderablesInScene(renderer,
-                                                                      m_view);
+        render::RenderableCollectionWalker::NodeFilter filter;
+        boost::scoped_ptr<PortalCuller> culler;
+
+        if (getCameraSettings()->portalCullingEnabled())
+        {
+            culler.reset(new PortalCuller(GlobalCamera().getAreaPortalCache(), m_view.getViewer(),
+                                          Frustum::createFromViewproj(m_view.GetViewMatrix())));
+
+            filter = boost::bind(&PortalCuller::isVisible, culler.get(), _1);
+        }
+
+        // Re-use the renderables of the previous frames if nothing changed
+        if (getCameraSettings()->retainRenderLists() && _renderList.beginFrame() &&
+            (_renderList.isRecorded() || _renderList.record(renderer, m_view)))
+        {
+            _renderList.submit(renderer, m_view, filter);
+        }
+        else
+        {
+            render::RenderableCollectionWalker::collectRenderablesInScene(renderer,
+                                                                          m_view, filter);
+        }
+
+        if (culler)
+        {
+            _portalCullingStats = culler->getStats();
+        }
+        else
+        {
+            _portalCullingStats.clear();
+        }
 
         renderer.render(m_Camera.modelview, m_Camera.projection);
     }
@@ -732,6 +764,12 @@ void CamWnd::Cam_Draw()
 
 	GlobalOpenGL().drawString(render::View::getCullStats());
 
+    if (!_portalCullingStats.empty())
+    {
+        glRasterPos3f(1.0f, static_cast<float>(m_Camera.height) - 21.0f, 0.0f);
+        GlobalOpenGL().drawString(_portalCullingStats);
+    }
+
     drawTime();
 
     // Draw the selection drag rectangle
@@ -795,6 +833,8 @@ void CamWnd::draw()
 
     m_drawing = true;
 
+    trace::ScopedZone zone("render", "CamWnd::draw");
+
     // Scoped object handling the GL context switching
     gtkutil::GLWidgetSentry sentry(*_camGLWidget);
 
@@ -941,6 +981,11 @@ void CamWnd::releaseStates() {
     _primitiveHighlightShader = ShaderPtr();
 }
 
+void CamWnd::invalidateRenderList()
+{
+    _renderList.invalidate();
+}
+
 void CamWnd::queueDraw() {
     if (m_drawing) {
         return;
@@ -15,6 +15,7 @@
 
 #include "RadiantCameraView.h"
 #include "Camera.h"
+#include "CamRenderList.h"
 
 #include <boost/shared_ptr.hpp>
 #include <boost/noncopyable.hpp>
@@ -68,6 +69,12 @@ private:
 
 	gtkutil::Timer _timer;
 
+	// The statistics of the last portal culling pass, empty if disabled
+	std::string _portalCullingStats;
+
+	// The renderables kept between frames
+	CamRenderList _renderList;
+
 	// Used in Windows only
 	sigc::connection _windowStateConn;
 
@@ -95,6 +102,9 @@ public:
 	void draw();
 	void update();
 
+	// Discards the renderables kept from the previous frames
+	void invalidateRenderList();
+
 	// The callback when the scene gets changed
 	void onSceneGraphChange();
 
@@ -18,6 +18,8 @@ CameraSettings::CameraSettings() :
 	_cameraDrawMode(RENDER_MODE_TEXTURED),
 	_cubicScale(registry::getValue<int>(RKEY_CUBIC_SCALE)),
 	_farClipEnabled(registry::getValue<bool>(RKEY_ENABLE_FARCLIP)),
+	_portalCullingEnabled(registry::getValue<bool>(RKEY_ENABLE_PORTAL_CULLING)),
+	_retainRenderLists(registry::getValue<bool>(RKEY_RETAIN_RENDER_LISTS)),
 	_solidSelectionBoxes(registry::getValue<bool>(RKEY_SOLID_SELECTION_BOXES)),
 	_toggleFreelook(registry::getValue<bool>(RKEY_TOGGLE_FREE_MOVE))
 {
@@ -35,6 +37,8 @@ CameraSettings::CameraSettings() :
 	observeKey(RKEY_INVERT_MOUSE_VERTICAL_AXIS);
 	observeKey(RKEY_DISCRETE_MOVEMENT);
 	observeKey(RKEY_ENABLE_FARCLIP);
+	observeKey(RKEY_ENABLE_PORTAL_CULLING);
+	observeKey(RKEY_RETAIN_RENDER_LISTS);
 	observeKey(RKEY_DRAWMODE);
 	observeKey(RKEY_SOLID_SELECTION_BOXES);
 	observeKey(RKEY_TOGGLE_FREE_MOVE);
@@ -62,6 +66,8 @@ void CameraSettings::constructPreferencePage()
 	page->appendCheckBox("", _("Freelook mode can be toggled"), RKEY_TOGGLE_FREE_MOVE);
 	page->appendCheckBox("", _("Discrete movement (non-freelook mode)"), RKEY_DISCRETE_MOVEMENT);
 	page->appendCheckBox("", _("Enable far-clip plane (hides distant objects)"), RKEY_ENABLE_FARCLIP);
+	page->appendCheckBox("", _("Enable portal culling (hides areas not visible through visportals)"), RKEY_ENABLE_PORTAL_CULLING);
+	page->appendCheckBox("", _("Keep render lists between frames (faster redraws of unchanged scenes)"), RKEY_RETAIN_RENDER_LISTS);
 
 	// Add the "inverse mouse vertical axis in free-look mode" preference
 	page->appendCheckBox("", _("Invert mouse vertical axis (freelook mode)"), RKEY_INVERT_MOUSE_VERTICAL_AXIS);
@@ -129,9 +135,14 @@ void CameraSettings::keyChanged()
 		_angleSpeed = registry::getValue<int>(RKEY_ROTATION_SPEED);
 		_invertMouseVerticalAxis = registry::getValue<bool>(RKEY_INVERT_MOUSE_VERTICAL_AXIS);
 		_farClipEnabled = registry::getValue<bool>(RKEY_ENABLE_FARCLIP);
+		_portalCullingEnabled = registry::getValue<bool>(RKEY_ENABLE_PORTAL_CULLING);
+		_retainRenderLists = registry::getValue<bool>(RKEY_RETAIN_RENDER_LISTS);
 		_solidSelectionBoxes = registry::getValue<bool>(RKEY_SOLID_SELECTION_BOXES);
 
 		GlobalEventManager().setToggled("ToggleCubicClip", _farClipEnabled);
+		GlobalEventManager().setToggled("TogglePortalCulling", _portalCullingEnabled);
+
+		GlobalCamera().getAreaPortalCache().setEnabled(_portalCullingEnabled);
 
 		// Determine the draw mode represented by the integer registry value
 		importDrawMode(registry::getValue<int>(RKEY_DRAWMODE));
@@ -194,6 +205,16 @@ bool CameraSettings::farClipEnabled() const
 	return _farClipEnabled;
 }
 
+bool CameraSettings::portalCullingEnabled() const
+{
+	return _portalCullingEnabled;
+}
+
+bool CameraSettings::retainRenderLists() const
+{
+	return _retainRenderLists;
+}
+
 bool CameraSettings::solidSelectionBoxes() const {
 	return _solidSelectionBoxes;
 }
@@ -246,6 +267,11 @@ void CameraSettings::toggleFarClip(bool)
 	setFarClip(!_farClipEnabled);
 }
 
+void CameraSettings::togglePortalCulling(bool)
+{
+	registry::setValue(RKEY_ENABLE_PORTAL_CULLING, !_portalCullingEnabled);
+}
+
 // ---------------------------------------------------------------------------------
 
 CameraSettings* getCameraSettings() {
@@ -22,6 +22,8 @@ namespace
 	const std::string RKEY_DISCRETE_MOVEMENT = RKEY_CAMERA_ROOT + "/discreteMovement";
 	const std::string RKEY_CUBIC_SCALE = RKEY_CAMERA_ROOT + "/cubicScale";
 	const std::string RKEY_ENABLE_FARCLIP = RKEY_CAMERA_ROOT + "/enableCubicClipping";
+	const std::string RKEY_ENABLE_PORTAL_CULLING = RKEY_CAMERA_ROOT + "/enablePortalCulling";
+	const std::string RKEY_RETAIN_RENDER_LISTS = RKEY_CAMERA_ROOT + "/retainRenderLists";
 	const std::string RKEY_DRAWMODE = RKEY_CAMERA_ROOT + "/drawMode";
 	const std::string RKEY_SOLID_SELECTION_BOXES = "user/ui/xyview/solidSelectionBoxes";
 	const std::string RKEY_TOGGLE_FREE_MOVE = RKEY_CAMERA_ROOT + "/toggleFreeMove";
@@ -51,6 +53,8 @@ class CameraSettings: public sigc::trackable
 
 	int _cubicScale;
 	bool _farClipEnabled;
+	bool _portalCullingEnabled;
+	bool _retainRenderLists;
 	bool _solidSelectionBoxes;
 	// This is TRUE if the mousebutton must be held to stay in freelook mode
 	// instead of enabling it by clicking and clicking again to disable
@@ -71,6 +75,13 @@ public:
 
 	// Returns true if cubic clipping is on
 	bool farClipEnabled() const;
+
+	// Returns true if the camera is culling the areas hidden behind visportals
+	bool portalCullingEnabled() const;
+
+	// Returns true if the camera keeps its renderables between frames
+	bool retainRenderLists() const;
+
 	bool invertMouseVerticalAxis() const;
 	bool discreteMovement() const;
 	bool solidSelectionBoxes() const;
@@ -92,6 +103,9 @@ public:
 	void toggleFarClip(bool newState);
 	void setFarClip(bool farClipEnabled);
 
+	// Enables/disables the visportal culling
+	void togglePortalCulling(bool newState);
+
 	// Adds the elements to the "camera" preference page
 	void constructPreferencePage();
 
@@ -59,6 +59,12 @@ void GlobalCameraManager::registerCommands()
 	// Set the default status of the cubic clip
 	GlobalEventManager().setToggled("ToggleCubicClip", getCameraSettings()->farClipEnabled());
 
+	GlobalEventManager().addToggle(
+        "TogglePortalCulling",
+        boost::bind(&CameraSettings::togglePortalCulling, getCameraSettings(), _1)
+    );
+	GlobalEventManager().setToggled("TogglePortalCulling", getCameraSettings()->portalCullingEnabled());
+
 	GlobalEventManager().addCommand("CubicClipZoomIn", "CubicClipZoomIn");
 	GlobalEventManager().addCommand("CubicClipZoomOut", "CubicClipZoomOut");
 
@@ -220,6 +226,8 @@ void GlobalCameraManager::update() {
 		CamWndPtr cam = i->second.lock();
 
 		if (cam != NULL) {
+			// Something outside the scene might have changed its appearance
+			cam->invalidateRenderList();
 			cam->update();
 			++i;
 		}
@@ -229,6 +237,11 @@ void GlobalCameraManager::update() {
 	}
 }
 
+AreaPortalCache& GlobalCameraManager::getAreaPortalCache()
+{
+	return _areaPortalCache;
+}
+
 // Set the global parent window
 void GlobalCameraManager::setParent(const Glib::RefPtr<Gtk::Window>& parent)
 {
@@ -486,6 +499,7 @@ const StringSet& GlobalCameraManager::getDependencies() const
 		_dependencies.insert(MODULE_EVENTMANAGER);
 		_dependencies.insert(MODULE_RENDERSYSTEM);
 		_dependencies.insert(MODULE_COMMANDSYSTEM);
+		_dependencies.insert(MODULE_SCENEGRAPH);
 	}
 
 	return _dependencies;
@@ -508,10 +522,14 @@ void GlobalCameraManager::initialiseModule(const ApplicationContext& ctx)
 	registerCommands();
 
 	CamWnd::captureStates();
+
+	_areaPortalCache.setEnabled(getCameraSettings()->portalCullingEnabled());
 }
 
 void GlobalCameraManager::shutdownModule()
 {
+	_areaPortalCache.setEnabled(false);
+
 	CamWnd::releaseStates();
 
 	_cameras.clear();
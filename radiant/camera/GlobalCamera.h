@@ -9,6 +9,7 @@
 #include "CamWnd.h"
 #include "FloatingCamWnd.h"
 #include "CameraObserver.h"
+#include "AreaPortalCulling.h"
 
 /**
  * greebo: This is the gateway class to access the currently active CamWindow
@@ -36,6 +37,9 @@ private:
 	// The window position tracker
 	gtkutil::WindowPosition _windowPosition;
 
+	// The visportal layout of the map, shared by all camera windows
+	AreaPortalCache _areaPortalCache;
+
 public:
 	// Constructor
 	GlobalCameraManager();
@@ -93,6 +97,8 @@ public:
 
 	void update();
 
+	AreaPortalCache& getAreaPortalCache();
+
 	// Add a "CameraMoved" callback to the signal member
 	void addCameraObserver(CameraObserver* observer);
 	void removeCameraObserver(CameraObserver* observer);
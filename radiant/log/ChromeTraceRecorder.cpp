@@ -0,0 +1,203 @@
+#include "ChromeTraceRecorder.h"
+
+#include "itextstream.h"
+#include <fstream>
+#include <glib.h>
+
+namespace applog
+{
+
+namespace
+{
+	// Stop recording after this many zones, roughly 100 MB
+	const std::size_t MAX_ZONES = 1 << 21;
+
+	const char* const DEFAULT_FILENAME = "darkradiant_trace.json";
+
+	// JSON string literal
+	std::string quote(const std::string& str)
+	{
+		std::string result("\"");
+
+		for (std::string::const_iterator i = str.begin(); i != str.end(); ++i)
+		{
+			switch (*i)
+			{
+			case '"':	result += "\\\""; break;
+			case '\\':	result += "\\\\"; break;
+			case '\n':	result += "\\n"; break;
+			case '\r':	result += "\\r"; break;
+			case '\t':	result += "\\t"; break;
+			default:
+				if (static_cast<unsigned char>(*i) < 0x20)
+				{
+					char buf[8];
+					g_snprintf(buf, sizeof(buf), "\\u%04x", static_cast<unsigned char>(*i));
+					result += buf;
+				}
+				else
+				{
+					result += *i;
+				}
+			}
+		}
+
+		return result + "\"";
+	}
+
+	class Lock
+	{
+		Glib::Mutex* _mutex;
+	public:
+		Lock(Glib::Mutex* mutex) :
+			_mutex(mutex)
+		{
+			if (_mutex != NULL) _mutex->lock();
+		}
+
+		~Lock()
+		{
+			if (_mutex != NULL) _mutex->unlock();
+		}
+	};
+}
+
+ChromeTraceRecorder::ChromeTraceRecorder() :
+	_droppedZones(0),
+	_origin(0)
+{}
+
+void ChromeTraceRecorder::start()
+{
+	if (!_mutex)
+	{
+		_mutex.reset(new Glib::Mutex);
+	}
+
+	Lock lock(_mutex.get());
+
+	_zones.clear();
+	_droppedZones = 0;
+	_threads.clear();
+
+	// The calling thread is the main thread
+	getThreadNumber(g_thread_self());
+
+	_origin = getTimestamp();
+	_recording = true;
+
+	rMessage() << "Trace recording started." << std::endl;
+}
+
+bool ChromeTraceRecorder::stop(const std::string& requestedFilename)
+{
+	Lock lock(_mutex.get());
+
+	if (!_recording) return false;
+
+	_recording = false;
+
+	std::string filename = !requestedFilename.empty() ? requestedFilename :
+		module::GlobalModuleRegistry().getApplicationContext().getSettingsPath() + DEFAULT_FILENAME;
+
+	std::ofstream file(filename.c_str());
+
+	if (!file.good())
+	{
+		rError() << "Could not write the trace to " << filename << std::endl;
+		return false;
+	}
+
+	file << "{\"displayTimeUnit\":\"ms\",\"traceEvents\":[\n";
+
+	// Thread names, there is always the main thread
+	for (std::size_t i = 0; i < _threads.size(); ++i)
+	{
+		file << (i > 0 ? ",\n" : "")
+			 << "{\"name\":\"thread_name\",\"ph\":\"M\",\"pid\":1,\"tid\":" << i
+			 << ",\"args\":{\"name\":\"" << (i == 0 ? "main" : "worker") << "\"}}";
+	}
+
+	for (std::vector<Zone>::const_iterator i = _zones.begin(); i != _zones.end(); ++i)
+	{
+		file << ",\n{\"name\":" << quote(i->name) << ",\"cat\":" << quote(i->category)
+			 << ",\"ph\":\"X\",\"pid\":1,\"tid\":" << i->thread
+			 << ",\"ts\":" << (i->start - _origin) << ",\"dur\":" << (i->end - i->start);
+
+		if (!i->detail.empty())
+		{
+			file << ",\"args\":{\"detail\":" << quote(i->detail) << "}";
+		}
+
+		file << "}";
+	}
+
+	file << "\n]}\n";
+
+	rMessage() << "Trace with " << _zones.size() << " zones written to "
+		<< filename << std::endl;
+
+	if (_droppedZones > 0)
+	{
+		rWarning() << _droppedZones << " zones have been dropped, "
+			<< "the recording was too long." << std::endl;
+	}
+
+	_zones.clear();
+
+	return true;
+}
+
+trace::Timestamp ChromeTraceRecorder::getTimestamp() const
+{
+	return g_get_monotonic_time();
+}
+
+void ChromeTraceRecorder::addZone(const char* category, const char* name,
+								  const std::string& detail,
+								  trace::Timestamp start, trace::Timestamp end)
+{
+	Lock lock(_mutex.get());
+
+	// The recording might have been stopped meanwhile
+	if (!_recording) return;
+
+	if (_zones.size() >= MAX_ZONES)
+	{
+		++_droppedZones;
+		return;
+	}
+
+	Zone zone;
+	zone.category = category;
+	zone.name = name;
+	zone.detail = detail;
+	zone.start = start;
+	zone.end = end;
+	zone.thread = getThreadNumber(g_thread_self());
+
+	_zones.push_back(zone);
+}
+
+std::size_t ChromeTraceRecorder::getThreadNumber(void* thread)
+{
+	std::map<void*, std::size_t>::const_iterator found = _threads.find(thread);
+
+	if (found != _threads.end())
+	{
+		return found->second;
+	}
+
+	std::size_t number = _threads.size();
+	_threads.insert(std::make_pair(thread, number));
+
+	return number;
+}
+
+ChromeTraceRecorder& ChromeTraceRecorder::Instance()
+{
+	static ChromeTraceRecorder _instance;
+	return _instance;
+}
+
+} // namespace
@@ -0,0 +1,75 @@
+#pragma once
+
+#include "itrace.h"
+
+#include <map>
+#include <vector>
+#include <boost/scoped_ptr.hpp>
+#include <glibmm/thread.h>
+
+namespace applog
+{
+
+/**
+ * The application's TraceRecorder, keeping the zones in memory until the
+ * recording is stopped, when they are written to a file in the Chrome
+ * trace-event format (JSON).
+ */
+class ChromeTraceRecorder :
+	public trace::TraceRecorder
+{
+	struct Zone
+	{
+		const char* category;
+		const char* name;
+		std::string detail;
+		trace::Timestamp start;
+		trace::Timestamp end;
+		std::size_t thread;
+	};
+	std::vector<Zone> _zones;
+
+	// Zones not recorded since the memory limit has been reached
+	std::size_t _droppedZones;
+
+	// Numbers the threads in the order they appear, the first one is the main thread
+	std::map<void*, std::size_t> _threads;
+
+	// Start of the recording
+	trace::Timestamp _origin;
+
+	// Created by the first start() call, after the thread system is initialised
+	boost::scoped_ptr<Glib::Mutex> _mutex;
+
+public:
+	ChromeTraceRecorder();
+
+	/**
+	 * Starts a new recording, discarding any zones of a previous one. This
+	 * must be called on the main thread.
+	 */
+	void start();
+
+	/**
+	 * Stops the recording and writes the zones to the given file, which
+	 * defaults to darkradiant_trace.json in the settings folder. Returns
+	 * false if nothing was written.
+	 *
+	 * The zone names are kept as pointers, so this needs to be called
+	 * before the modules are unloaded.
+	 */
+	bool stop(const std::string& filename = std::string());
+
+	// TraceRecorder implementation
+	trace::Timestamp getTimestamp() const;
+	void addZone(const char* category, const char* name, const std::string& detail,
+				 trace::Timestamp start, trace::Timestamp end);
+
+	// Contains the static singleton instance
+	static ChromeTraceRecorder& Instance();
+
+private:
+	std::size_t getThreadNumber(void* thread);
+};
+
+} // namespace
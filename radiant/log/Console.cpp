@@ -18,8 +18,11 @@ namespace ui {
 Console::Console() :
 	Gtk::VBox(false, 6),
 	_view(Gtk::manage(new gtkutil::ConsoleView)),
-	_commandEntry(Gtk::manage(new CommandEntry))
+	_commandEntry(Gtk::manage(new CommandEntry)),
+	_mainThread(Glib::Thread::self())
 {
+	_pendingOutputDispatcher.connect(sigc::mem_fun(*this, &Console::flushPendingOutput));
+
 	// Pack the scrolled textview and the entry box to the vbox
 	pack_start(*_view, true, true, 0);
 	pack_start(*_commandEntry, false, false, 0);
@@ -59,6 +62,53 @@ void Console::toggle(const cmd::ArgumentList& args)
 }
 
 void Console::writeLog(const std::string& outputStr, applog::ELogLevel level)
+{
+	if (Glib::Thread::self() != _mainThread)
+	{
+		Glib::Mutex::Lock lock(_pendingOutputMutex);
+
+		bool wasEmpty = _pendingOutput.empty();
+
+		// Consecutive output of the same level is appended in one go
+		if (!wasEmpty && _pendingOutput.back().first == level)
+		{
+			_pendingOutput.back().second += outputStr;
+		}
+		else
+		{
+			_pendingOutput.push_back(PendingOutput::value_type(level, outputStr));
+		}
+
+		if (wasEmpty)
+		{
+			_pendingOutputDispatcher.emit();
+		}
+
+		return;
+	}
+
+	// Keep the order of the output written before
+	flushPendingOutput();
+
+	appendText(outputStr, level);
+}
+
+void Console::flushPendingOutput()
+{
+	PendingOutput output;
+
+	{
+		Glib::Mutex::Lock lock(_pendingOutputMutex);
+		output.swap(_pendingOutput);
+	}
+
+	for (PendingOutput::const_iterator i = output.begin(); i != output.end(); ++i)
+	{
+		appendText(i->second, i->first);
+	}
+}
+
+void Console::appendText(const std::string& outputStr, applog::ELogLevel level)
 {
 	switch (level)
 	{
@@ -81,6 +131,9 @@ void Console::shutdown()
 {
 	applog::LogWriter::Instance().detach(this);
 
+	// No more output arrives after detaching
+	flushPendingOutput();
+
 	GlobalCommandSystem().removeCommand("clear");
 }
 
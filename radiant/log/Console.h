@@ -4,6 +4,9 @@
 #include "icommandsystem.h"
 
 #include <gtkmm/box.h>
+#include <glibmm/dispatcher.h>
+#include <glibmm/thread.h>
+#include <vector>
 #include "gtkutil/ConsoleView.h"
 
 #include "ui/common/CommandEntry.h"
@@ -32,6 +35,18 @@ private:
 	// The entry box for console commands
 	CommandEntry* _commandEntry;
 
+	// The thread the console has been created on, the only one allowed to
+	// touch the view
+	Glib::Thread* _mainThread;
+
+	// Output written by other threads, waiting to be appended on the main thread
+	typedef std::vector<std::pair<applog::ELogLevel, std::string> > PendingOutput;
+	PendingOutput _pendingOutput;
+	Glib::Mutex _pendingOutputMutex;
+
+	// Wakes up the main thread to append the pending output
+	Glib::Dispatcher _pendingOutputDispatcher;
+
 	// Private constructor, creates the Gtk structures
 	Console();
 
@@ -48,6 +63,9 @@ public:
 	 * greebo: Writes the given output string to the Console.
 	 * The log level indicates which tag is used for colouring the output.
 	 * (Note: this gets called by the LogWriter automatically).
+	 *
+	 * Output from other threads than the main thread is buffered and
+	 * appended once the main loop gets to it.
 	 */
 	void writeLog(const std::string& outputStr, applog::ELogLevel level);
 
@@ -62,6 +80,11 @@ public:
 private:
 	void shutdown();
 
+	void appendText(const std::string& outputStr, applog::ELogLevel level);
+
+	// Appends the output buffered by other threads, main thread only
+	void flushPendingOutput();
+
 	// Static shared pointer
 	static ConsolePtr& InstancePtr();
 };
@@ -18,8 +18,10 @@ class LogStream :
 	public std::ostream
 {
 public:
+	// Every character is passed to the LogWriter right away, so the
+	// stream doesn't keep any state shared by the threads writing to it
 	LogStream(ELogLevel logLevel) :
-		std::ostream(new LogStreamBuf(logLevel))
+		std::ostream(new LogStreamBuf(logLevel, 0))
 	{}
 
 	virtual ~LogStream() {
@@ -2,10 +2,31 @@
 
 namespace applog {
 
+namespace
+{
+	class Lock
+	{
+		Glib::Mutex* _mutex;
+	public:
+		Lock(Glib::Mutex* mutex) :
+			_mutex(mutex)
+		{
+			if (_mutex != NULL) _mutex->lock();
+		}
+
+		~Lock()
+		{
+			if (_mutex != NULL) _mutex->unlock();
+		}
+	};
+}
+
 void LogWriter::write(const char* p, std::size_t length, ELogLevel level) {
 	// Convert the buffer to a string
 	std::string output(p, length);
 
+	Lock lock(_mutex.get());
+
 	// Visit all the logfiles and write the string
 	for (LogDevices::iterator i = _devices.begin(); i != _devices.end(); i++) {
 		(*i)->writeLog(output, level);
@@ -13,13 +34,21 @@ void LogWriter::write(const char* p, std::size_t length, ELogLevel level) {
 }
 
 void LogWriter::attach(LogDevice* device) {
+	Lock lock(_mutex.get());
 	_devices.insert(device);
 }
 
 void LogWriter::detach(LogDevice* device) {
+	Lock lock(_mutex.get());
 	_devices.erase(device);
 }
 
+void LogWriter::initialiseLocking() {
+	if (!_mutex) {
+		_mutex.reset(new Glib::Mutex);
+	}
+}
+
 LogWriter& LogWriter::Instance() {
 	static LogWriter _writer;
 	return _writer;
@@ -2,6 +2,8 @@
 #define _LOG_WRITER_H_
 
 #include <set>
+#include <boost/scoped_ptr.hpp>
+#include <glibmm/thread.h>
 #include "LogLevels.h"
 #include "LogDevice.h"
 
@@ -17,6 +19,9 @@ class LogWriter
 	typedef std::set<LogDevice*> LogDevices;
 	LogDevices _devices;
 
+	// Serialises the writes, NULL until initialiseLocking() is called
+	boost::scoped_ptr<Glib::Mutex> _mutex;
+
 public:
 	/**
 	 * greebo: Writes the given buffer p with the given length to the
@@ -32,6 +37,12 @@ public:
 	void attach(LogDevice* device);
 	void detach(LogDevice* device);
 
+	/**
+	 * Makes write() safe to be called from several threads. This needs
+	 * to be called once, after the Glib thread system is initialised.
+	 */
+	void initialiseLocking();
+
 	// Contains the static singleton instance of this writer
 	static LogWriter& Instance();
 };
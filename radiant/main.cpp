@@ -12,6 +12,8 @@
 #include "log/LogFile.h"
 #include "log/PIDFile.h"
 #include "log/LogStream.h"
+#include "log/LogWriter.h"
+#include "log/ChromeTraceRecorder.h"
 #include "map/Map.h"
 #include "settings/GameManager.h"
 #include "ui/splash/Splash.h"
@@ -19,6 +21,7 @@
 #include "modulesystem/ModuleLoader.h"
 #include "modulesystem/ModuleRegistry.h"
 #include "Profile.h"
+#include "BatchMode.h"
 
 #ifndef POSIX
 #include "settings/LanguageManager.h"
@@ -32,6 +35,8 @@
 #endif
 
 #include <exception>
+#include <algorithm>
+#include <boost/scoped_ptr.hpp>
 
 #if defined (_DEBUG) && defined (WIN32) && defined (_MSC_VER)
 #include "crtdbg.h"
@@ -44,6 +49,43 @@ void crt_init()
 #endif
 }
 
+// Loads the DLLs from modules/ and plugins/
+static void loadModules(const ApplicationContext& ctx)
+{
+#if defined(POSIX) && defined(PKGLIBDIR)
+    // Load modules from compiled-in path (e.g. /usr/lib/darkradiant)
+    module::Loader::loadModules(PKGLIBDIR);
+#else
+    // Load modules from application-relative path
+    module::Loader::loadModules(ctx.getApplicationPath());
+#endif
+}
+
+// Processes the maps given on the command line without opening the main window
+static int runBatchMode(batch::BatchRunner& runner, const ApplicationContext& ctx,
+                        const std::string& executable)
+{
+    // The parent process just distributes the work
+    if (runner.usesWorkerProcesses())
+    {
+        return runner.runWorkerProcesses(executable);
+    }
+
+    module::RegistryReference::Instance().setRegistry(module::getRegistry());
+
+    loadModules(ctx);
+
+    runner.initialiseModules();
+
+    int result = runner.run();
+
+    applog::ChromeTraceRecorder::Instance().stop();
+
+    module::GlobalModuleRegistry().shutdownModules();
+
+    return result;
+}
+
 /**
  * Main entry point for the application.
  */
@@ -61,8 +103,16 @@ int main (int argc, char* argv[])
     // Acquire the appplication context ref (shortcut)
     const ApplicationContext& ctx = module::getRegistry().getApplicationContext();
 
+    // Map processing without user interface, see BatchMode.h
+    boost::scoped_ptr<batch::BatchRunner> batchRunner;
+
+    if (batch::BatchRunner::isRequested(ctx))
+    {
+        batchRunner.reset(new batch::BatchRunner(ctx));
+    }
+
     // The settings path is set, start logging now
-    applog::LogFile::create("darkradiant.log");
+    applog::LogFile::create(batchRunner ? batchRunner->getLogFilename() : "darkradiant.log");
 
 #ifndef POSIX
     // Initialise the language based on the settings in the user settings folder
@@ -93,6 +143,16 @@ int main (int argc, char* argv[])
 		Glib::thread_init();
 	}
 
+	// Threads may write to the log from now on
+	applog::LogWriter::Instance().initialiseLocking();
+
+	// Record the startup if requested
+	if (std::find(ctx.getCmdLineArgs().begin(), ctx.getCmdLineArgs().end(), "--trace") !=
+		ctx.getCmdLineArgs().end())
+	{
+		applog::ChromeTraceRecorder::Instance().start();
+	}
+
     Glib::add_exception_handler(&std::terminate);
 
 #ifdef HAVE_GTKSOURCEVIEW
@@ -108,6 +168,16 @@ int main (int argc, char* argv[])
     setlocale(LC_NUMERIC, "C");
     setlocale(LC_TIME, "C");
 
+    if (batchRunner)
+    {
+        int result = runBatchMode(*batchRunner, ctx, argv[0]);
+
+        applog::LogFile::close();
+        applog::shutdownStreams();
+
+        return result;
+    }
+
     // Now that GTK is ready, activate the Popup Error Handler
     module::ModuleRegistry::Instance().initErrorHandler();
 
@@ -124,13 +194,7 @@ int main (int argc, char* argv[])
         ui::Splash::Instance().setProgressAndText(_("Searching for Modules"), 0.0f);
 
         // Invoke the ModuleLoad routine to load the DLLs from modules/ and plugins/
-#if defined(POSIX) && defined(PKGLIBDIR)
-        // Load modules from compiled-in path (e.g. /usr/lib/darkradiant)
-        module::Loader::loadModules(PKGLIBDIR);
-#else
-        // Load modules from application-relative path
-        module::Loader::loadModules(ctx.getApplicationPath());
-#endif
+        loadModules(ctx);
 
         module::getRegistry().initialiseModules();
 
@@ -154,6 +218,9 @@ int main (int argc, char* argv[])
 
     GlobalMainFrame().destroy();
 
+    // Write the trace while the modules are still loaded
+    applog::ChromeTraceRecorder::Instance().stop();
+
     // Issue a shutdown() call to all the modules
     module::GlobalModuleRegistry().shutdownModules();
 
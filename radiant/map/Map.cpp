@@ -15,6 +15,8 @@
 #include "imainframe.h"
 #include "imapresource.h"
 #include "iselectionset.h"
+#include "itrace.h"
+#include "imodelcache.h"
 
 #include "registry/registry.h"
 #include "stream/textfilestream.h"
@@ -461,6 +463,11 @@ void Map::load(const std::string& filename) {
 
     {
         ScopeTimer timer("map load");
+        trace::ScopedZone zone("map", "load", filename);
+
+        // Don't wait for the static models, the placeholders are swapped
+        // as soon as the worker threads are done parsing them
+        model::ScopedBackgroundLoads backgroundLoads;
 
         m_resource = GlobalMapResourceManager().capture(_mapName);
         // greebo: Add the observer, this usually triggers a onResourceRealise() call.
@@ -520,6 +527,7 @@ bool Map::save(const MapFormatPtr& mapFormat)
     PointFile::Instance().clear();
 
     ScopeTimer timer("map save");
+    trace::ScopedZone zone("map", "save", _mapName);
 
     // Save the actual map resource
     bool success = m_resource->save(mapFormat);
@@ -557,6 +565,7 @@ void Map::createNew() {
 bool Map::import(const std::string& filename)
 {
     ui::ScreenUpdateBlocker blocker(_("Importing..."), filename);
+    trace::ScopedZone zone("map", "import", filename);
 
     bool success = false;
 
@@ -608,6 +617,8 @@ bool Map::saveDirect(const std::string& filename, const MapFormatPtr& mapFormat)
 		format = getFormatForFile(filename);
 	}
 
+    trace::ScopedZone zone("map", "saveDirect", filename);
+
     bool result = MapResource::saveFile(
         *format,
         GlobalSceneGraph().root(),
@@ -7,6 +7,7 @@
 #include "os/path.h"
 #include "os/dir.h"
 #include "log/PopupErrorHandler.h"
+#include "log/ChromeTraceRecorder.h"
 
 #include <boost/algorithm/string/predicate.hpp>
 
@@ -224,6 +225,11 @@ const ErrorHandlingFunction& ApplicationContextImpl::getErrorHandlingFunction()
 	return _errorHandler;
 }
 
+trace::TraceRecorder& ApplicationContextImpl::getTraceRecorder() const
+{
+	return applog::ChromeTraceRecorder::Instance();
+}
+
 void ApplicationContextImpl::initErrorHandler()
 {
 #ifdef _DEBUG
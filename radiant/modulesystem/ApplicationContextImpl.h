@@ -50,6 +50,8 @@ public:
 
 	virtual const ErrorHandlingFunction& getErrorHandlingFunction() const;
 
+	virtual trace::TraceRecorder& getTraceRecorder() const;
+
 private:
 	// Sets up the bitmap path and settings path
 	void initPaths();
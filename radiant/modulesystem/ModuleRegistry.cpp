@@ -4,27 +4,346 @@
 
 #include "i18n.h"
 #include "itextstream.h"
+#include "itrace.h"
 #include <stdexcept>
 #include <iostream>
+#include <algorithm>
+#include <set>
 #include "ApplicationContextImpl.h"
 #include "ModuleLoader.h"
 
 #include <boost/format.hpp>
+#include <glibmm/threadpool.h>
 
 namespace module
 {
 
+namespace
+{
+	// Command line switch to initialise all modules one after the other on the main thread
+	const char* const SERIAL_INITIALISATION_ARG = "--serial-module-init";
+
+	class Lock
+	{
+		Glib::Mutex* _mutex;
+	public:
+		Lock(Glib::Mutex* mutex) :
+			_mutex(mutex)
+		{
+			if (_mutex != NULL) _mutex->lock();
+		}
+
+		~Lock()
+		{
+			if (_mutex != NULL) _mutex->unlock();
+		}
+	};
+}
+
+/**
+ * Initialises the registered modules along their dependency graph. Modules
+ * are started as soon as all of their dependencies are initialised. The ones
+ * declaring a thread-safe initialisation are pre-initialised on the main
+ * thread and then handed to a thread pool, all others are initialised on the
+ * main thread, in the same order the serial (recursive) initialisation would
+ * use.
+ */
+class ModuleRegistry::Scheduler
+{
+	ModuleRegistry& _registry;
+
+	struct Node
+	{
+		RegisterableModulePtr module;
+
+		// Position in the serial initialisation order
+		std::size_t rank;
+
+		// Number of dependencies not initialised yet
+		std::size_t pendingDependencies;
+
+		// The modules depending on this one
+		std::vector<std::string> dependents;
+	};
+	typedef std::map<std::string, Node> Nodes;
+	Nodes _nodes;
+
+	// True if the dependency graph contains a cycle
+	bool _hasCycles;
+
+	// Modules ready to be initialised on the main thread, by rank
+	std::map<std::size_t, std::string> _readyForMainThread;
+
+	// Thread-safe modules waiting for their pre-initialisation, these are
+	// handled first to get the worker threads going
+	std::vector<std::string> _readyForThreadPool;
+
+	// Number of modules currently initialised on worker threads
+	std::size_t _running;
+
+	// Number of modules done
+	std::size_t _finished;
+
+	// The first error thrown by a module on a worker thread
+	std::string _error;
+
+	Glib::Mutex _mutex;
+	Glib::Cond _moduleFinished;
+
+	// Declared last, so it is destroyed (waiting for its threads) first
+	Glib::ThreadPool _pool;
+
+public:
+	// The given modules need to include all of their dependencies
+	Scheduler(ModuleRegistry& registry, const ModulesMap& modules) :
+		_registry(registry),
+		_hasCycles(false),
+		_running(0),
+		_finished(0)
+	{
+		for (ModulesMap::const_iterator i = modules.begin(); i != modules.end(); ++i)
+		{
+			Node& node = _nodes[i->first];
+			node.module = i->second;
+			node.rank = 0;
+			node.pendingDependencies = i->second->getDependencies().size();
+		}
+
+		for (ModulesMap::const_iterator i = modules.begin(); i != modules.end(); ++i)
+		{
+			const StringSet& dependencies = i->second->getDependencies();
+
+			for (StringSet::const_iterator d = dependencies.begin(); d != dependencies.end(); ++d)
+			{
+				Nodes::iterator found = _nodes.find(*d);
+
+				if (found == _nodes.end())
+				{
+					throw std::logic_error(
+						"ModuleRegistry: Module doesn't exist: " + *d + "\n"
+					);
+				}
+
+				found->second.dependents.push_back(i->first);
+			}
+		}
+
+		// Rank the modules in the order of the recursive initialisation
+		std::set<std::string> visited;
+		std::set<std::string> inProgress;
+		std::size_t rank = 0;
+
+		for (Nodes::const_iterator i = _nodes.begin(); i != _nodes.end(); ++i)
+		{
+			assignRank(i->first, visited, inProgress, rank);
+		}
+	}
+
+	// Cyclic dependencies can't be scheduled
+	bool hasCycles() const
+	{
+		return _hasCycles;
+	}
+
+	// Initialises all modules, returns when all of them are done
+	void run()
+	{
+		Glib::Mutex::Lock lock(_mutex);
+
+		for (Nodes::iterator i = _nodes.begin(); i != _nodes.end(); ++i)
+		{
+			if (i->second.pendingDependencies == 0)
+			{
+				scheduleModule(i->first);
+			}
+		}
+
+		while (_finished < _nodes.size())
+		{
+			if (!_readyForThreadPool.empty() && _error.empty())
+			{
+				std::string name = _readyForThreadPool.back();
+				_readyForThreadPool.pop_back();
+
+				_registry.addInitialisedModule(name, _nodes[name].module);
+
+				lock.release();
+
+				preInitialise(name);
+
+				lock.acquire();
+
+				++_running;
+				_pool.push(sigc::bind(sigc::mem_fun(*this, &Scheduler::initialiseInThread), name));
+				continue;
+			}
+
+			if (!_readyForMainThread.empty() && _error.empty())
+			{
+				std::string name = _readyForMainThread.begin()->second;
+				_readyForMainThread.erase(_readyForMainThread.begin());
+
+				_registry.addInitialisedModule(name, _nodes[name].module);
+
+				lock.release();
+
+				updateSplash(name);
+				preInitialise(name);
+				initialise(name);
+
+				lock.acquire();
+
+				finishModule(name);
+				continue;
+			}
+
+			if (_running == 0)
+			{
+				// Nothing left to wait for
+				break;
+			}
+
+			_moduleFinished.wait(_mutex);
+		}
+
+		if (!_error.empty())
+		{
+			throw std::runtime_error(_error);
+		}
+	}
+
+private:
+	void assignRank(const std::string& name, std::set<std::string>& visited,
+					std::set<std::string>& inProgress, std::size_t& rank)
+	{
+		if (visited.find(name) != visited.end()) return;
+
+		if (inProgress.find(name) != inProgress.end())
+		{
+			_hasCycles = true;
+			return;
+		}
+
+		inProgress.insert(name);
+
+		Node& node = _nodes[name];
+		const StringSet& dependencies = node.module->getDependencies();
+
+		for (StringSet::const_iterator i = dependencies.begin(); i != dependencies.end(); ++i)
+		{
+			assignRank(*i, visited, inProgress, rank);
+		}
+
+		inProgress.erase(name);
+		visited.insert(name);
+
+		node.rank = rank++;
+	}
+
+	// Queues the given module for the main thread, mutex must be held
+	void scheduleModule(const std::string& name)
+	{
+		Node& node = _nodes[name];
+
+		if (node.module->isInitialisationThreadSafe())
+		{
+			_readyForThreadPool.push_back(name);
+		}
+		else
+		{
+			_readyForMainThread[node.rank] = name;
+		}
+	}
+
+	// Marks the module as done and schedules the dependents, mutex must be held
+	void finishModule(const std::string& name)
+	{
+		++_finished;
+
+		if (!_error.empty()) return;
+
+		const std::vector<std::string>& dependents = _nodes[name].dependents;
+
+		for (std::vector<std::string>::const_iterator i = dependents.begin(); i != dependents.end(); ++i)
+		{
+			if (--_nodes[*i].pendingDependencies == 0)
+			{
+				scheduleModule(*i);
+			}
+		}
+	}
+
+	// Called on the main thread only
+	void preInitialise(const std::string& name)
+	{
+		trace::ScopedZone zone("modules", "preInitialiseModule", name);
+
+		_nodes.find(name)->second.module->preInitialiseModule(_registry._context);
+	}
+
+	void initialise(const std::string& name)
+	{
+		trace::ScopedZone zone("modules", "initialiseModule", name);
+
+		// The graph isn't changed structurally anymore, no need to lock for the lookup
+		_nodes.find(name)->second.module->initialiseModule(_registry._context);
+	}
+
+	void initialiseInThread(std::string name)
+	{
+		std::string error;
+
+		try
+		{
+			initialise(name);
+		}
+		catch (std::exception& ex)
+		{
+			error = "ModuleRegistry: Failed to initialise module " + name + ": " + ex.what();
+		}
+
+		Glib::Mutex::Lock lock(_mutex);
+
+		if (!error.empty() && _error.empty())
+		{
+			_error = error;
+		}
+
+		--_running;
+		finishModule(name);
+
+		_moduleFinished.signal();
+	}
+
+	// Called on the main thread only
+	void updateSplash(const std::string& name)
+	{
+		if (!_registry._showProgress) return;
+
+		_registry._progress = 0.1f + (static_cast<float>(_finished) / _nodes.size()) * 0.65f;
+
+		ui::Splash::Instance().setProgressAndText(
+			(boost::format(_("Initialising Module: %s")) % name).str(),
+			_registry._progress);
+	}
+};
+
 ModuleRegistry::ModuleRegistry() :
 	_modulesInitialised(false),
-	_modulesShutdown(false)
+	_modulesShutdown(false),
+	_showProgress(true)
 {
 	rMessage() << "ModuleRegistry instantiated." << std::endl;
 }
 
 void ModuleRegistry::unloadModules()
 {
-	_uninitialisedModules.clear();
-	_initialisedModules.clear();
+	{
+		Lock lock(_initialisedModulesMutex.get());
+
+		_uninitialisedModules.clear();
+		_initialisedModules.clear();
+	}
 
 	Loader::unloadModules();
 }
@@ -74,9 +393,7 @@ void ModuleRegistry::initialiseModuleRecursive(const std::string& name)
 	}
 
 	// Tag this module as "ready" by inserting it into the initialised list.
-	_initialisedModules.insert(
-		ModulesMap::value_type(name, _uninitialisedModules[name])
-	);
+	addInitialisedModule(name, _uninitialisedModules[name]);
 
 	// Create a shortcut to the module
 	RegisterableModulePtr module = _uninitialisedModules[name];
@@ -93,32 +410,120 @@ void ModuleRegistry::initialiseModuleRecursive(const std::string& name)
 		initialiseModuleRecursive(*i);
 	}
 
-	_progress = 0.1f + (static_cast<float>(_initialisedModules.size())/_uninitialisedModules.size())*0.65f;
+	if (_showProgress)
+	{
+		_progress = 0.1f + (static_cast<float>(_initialisedModules.size())/_uninitialisedModules.size())*0.65f;
 
-	ui::Splash::Instance().setProgressAndText(
-		(boost::format(_("Initialising Module: %s")) % name).str(),
-		_progress);
+		ui::Splash::Instance().setProgressAndText(
+			(boost::format(_("Initialising Module: %s")) % name).str(),
+			_progress);
+	}
 
 	// Initialise the module itself, now that the dependencies are ready
+	{
+		trace::ScopedZone zone("modules", "preInitialiseModule", name);
+		module->preInitialiseModule(_context);
+	}
+
+	trace::ScopedZone zone("modules", "initialiseModule", name);
 	module->initialiseModule(_context);
 }
 
 // Initialise all registered modules
 void ModuleRegistry::initialiseModules()
+{
+	_showProgress = true;
+
+	initialiseModuleSet(_uninitialisedModules);
+}
+
+void ModuleRegistry::initialiseModules(const StringSet& names)
+{
+	_showProgress = false;
+
+	ModulesMap modules;
+
+	for (StringSet::const_iterator i = names.begin(); i != names.end(); ++i)
+	{
+		if (_uninitialisedModules.find(*i) == _uninitialisedModules.end())
+		{
+			rWarning() << "ModuleRegistry: Module " << *i << " is not registered, "
+				<< "skipping it." << std::endl;
+			continue;
+		}
+
+		collectModules(*i, modules);
+	}
+
+	initialiseModuleSet(modules);
+}
+
+void ModuleRegistry::collectModules(const std::string& name, ModulesMap& modules) const
+{
+	ModulesMap::const_iterator found = _uninitialisedModules.find(name);
+
+	if (found == _uninitialisedModules.end())
+	{
+		throw std::logic_error(
+			"ModuleRegistry: Module doesn't exist: " + name + "\n"
+		);
+	}
+
+	// Already visited?
+	if (!modules.insert(*found).second) return;
+
+	const StringSet& dependencies = found->second->getDependencies();
+
+	for (StringSet::const_iterator i = dependencies.begin(); i != dependencies.end(); ++i)
+	{
+		collectModules(*i, modules);
+	}
+}
+
+void ModuleRegistry::initialiseModuleSet(const ModulesMap& modules)
 {
 	if (_modulesInitialised) {
 		throw std::runtime_error("ModuleRegistry::initialiseModule called twice.\n");
 	}
 
-	_progress = 0.1f;
-	ui::Splash::Instance().setProgressAndText(_("Initialising Modules"), _progress);
+	trace::ScopedZone zone("modules", "initialiseModules");
 
-	for (ModulesMap::iterator i = _uninitialisedModules.begin();
-		 i != _uninitialisedModules.end(); ++i)
+	if (_showProgress)
 	{
-		// greebo: Dive into the recursion
-		// (this will return immediately if the module is already initialised).
-		initialiseModuleRecursive(i->first);
+		_progress = 0.1f;
+		ui::Splash::Instance().setProgressAndText(_("Initialising Modules"), _progress);
+	}
+
+	// Modules may be looked up from other threads from now on
+	_initialisedModulesMutex.reset(new Glib::Mutex);
+
+	const ApplicationContext::ArgumentList& args = _context.getCmdLineArgs();
+	bool serial = std::find(args.begin(), args.end(), SERIAL_INITIALISATION_ARG) != args.end();
+
+	if (!serial)
+	{
+		Scheduler scheduler(*this, modules);
+
+		if (scheduler.hasCycles())
+		{
+			rWarning() << "ModuleRegistry: circular module dependencies found, "
+				<< "initialising modules one by one." << std::endl;
+			serial = true;
+		}
+		else
+		{
+			scheduler.run();
+		}
+	}
+
+	if (serial)
+	{
+		for (ModulesMap::const_iterator i = modules.begin(); i != modules.end(); ++i)
+		{
+			// Dive into the recursion
+			// (this will return immediately if the module is already initialised).
+			initialiseModuleRecursive(i->first);
+		}
 	}
 
 	// Make sure this isn't called again
@@ -143,7 +548,17 @@ void ModuleRegistry::shutdownModules()
 	_modulesShutdown = true;
 }
 
+void ModuleRegistry::addInitialisedModule(const std::string& name,
+										  const RegisterableModulePtr& module)
+{
+	Lock lock(_initialisedModulesMutex.get());
+
+	_initialisedModules.insert(ModulesMap::value_type(name, module));
+}
+
 bool ModuleRegistry::moduleExists(const std::string& name) const {
+	Lock lock(_initialisedModulesMutex.get());
+
 	// Try to find the initialised module, uninitialised don't count as existing
 	ModulesMap::const_iterator found = _initialisedModules.find(name);
 	return (found != _initialisedModules.end());
@@ -155,10 +570,14 @@ RegisterableModulePtr ModuleRegistry::getModule(const std::string& name) const {
 	// The return value (NULL) by default
 	RegisterableModulePtr returnValue;
 
-	// Try to find the module
-	ModulesMap::const_iterator found = _initialisedModules.find(name);
-	if (found != _initialisedModules.end()) {
-		returnValue = found->second;
+	{
+		Lock lock(_initialisedModulesMutex.get());
+
+		// Try to find the module
+		ModulesMap::const_iterator found = _initialisedModules.find(name);
+		if (found != _initialisedModules.end()) {
+			returnValue = found->second;
+		}
 	}
 
 	if (returnValue == NULL) {
@@ -5,6 +5,8 @@
 
 #include <map>
 #include <list>
+#include <boost/scoped_ptr.hpp>
+#include <glibmm/thread.h>
 #include "imodule.h"
 
 namespace module {
@@ -23,6 +25,10 @@ class ModuleRegistry :
 	// After initialisiation, modules get enlisted here.
 	ModulesMap _initialisedModules;
 
+	// Guards _initialisedModules while modules are initialised concurrently,
+	// this is NULL until initialiseModules() is called
+	boost::scoped_ptr<Glib::Mutex> _initialisedModulesMutex;
+
 	// Set to TRUE as soon as initialiseModules() is finished
 	bool _modulesInitialised;
 
@@ -35,6 +41,9 @@ class ModuleRegistry :
 	// For progress meter in the splash screen
 	float _progress;
 
+	// False if the splash screen isn't used
+	bool _showProgress;
+
 	// Private constructor
 	ModuleRegistry();
 
@@ -46,6 +55,13 @@ public:
 	// Initialise all registered modules
 	virtual void initialiseModules();
 
+	/**
+	 * Initialises the named modules and their dependencies only, leaving
+	 * all others uninitialised. The splash screen is not used. Names of
+	 * modules which are not registered are skipped with a warning.
+	 */
+	void initialiseModules(const StringSet& names);
+
 	// Shutdown all modules
 	virtual void shutdownModules();
 
@@ -81,6 +97,18 @@ private:
 	// Initialises the module (including dependencies, recursively).
 	void initialiseModuleRecursive(const std::string& name);
 
+	// Adds the named module and all of its dependencies to the given map
+	void collectModules(const std::string& name, ModulesMap& modules) const;
+
+	// Initialises the given modules, which need to include all of their dependencies
+	void initialiseModuleSet(const ModulesMap& modules);
+
+	// Adds the module to the initialised ones, thread-safe
+	void addInitialisedModule(const std::string& name, const RegisterableModulePtr& module);
+
+	// Schedules the initialisation along the dependency graph, see ModuleRegistry.cpp
+	class Scheduler;
+
 }; // class Registry
 
 } // namespace module
@@ -10,6 +10,7 @@
 
 #include "registry/registry.h"
 #include "math/Frustum.h"
+#include "render/RenderStatistics.h"
 #include "math/Ray.h"
 #include "texturelib.h"
 #include "brush/TextureProjection.h"
@@ -60,6 +61,7 @@ Patch::Patch(PatchNode& node, const Callback& evaluateTransform, const Callback&
 	m_map(0),
 	_solidRenderable(_mesh),
 	_wireframeRenderable(_mesh),
+	_coarseWireframeRenderable(_mesh),
 	_fixedWireframeRenderable(_mesh),
 	_renderableCtrlPoints(GL_POINTS, m_ctrl_vertices),
 	_renderableLattice(GL_LINES, m_lattice_indices, m_ctrl_vertices),
@@ -84,6 +86,7 @@ Patch::Patch(const Patch& other, PatchNode& node, const Callback& evaluateTransf
 	m_map(0),
 	_solidRenderable(_mesh),
 	_wireframeRenderable(_mesh),
+	_coarseWireframeRenderable(_mesh),
 	_fixedWireframeRenderable(_mesh),
 	_renderableCtrlPoints(GL_POINTS, m_ctrl_vertices),
 	_renderableLattice(GL_LINES, m_lattice_indices, m_ctrl_vertices),
@@ -101,7 +104,7 @@ Patch::Patch(const Patch& other, PatchNode& node, const Callback& evaluateTransf
 	m_subdivisions_y = other.m_subdivisions_y;
 	setDims(other.m_width, other.m_height);
 	copy_ctrl(m_ctrl.begin(), other.m_ctrl.begin(), other.m_ctrl.begin()+(m_width*m_height));
-	setShader(other.m_shader);
+	setShader(other.m_shader.getString());
 	controlPointsChanged();
 }
 
@@ -225,14 +228,19 @@ void Patch::render_solid(RenderableCollector& collector, const VolumeTest& volum
 }
 
 // Render functions for WireFrame rendering
-void Patch::render_wireframe(RenderableCollector& collector, const VolumeTest& volume, const Matrix4& localToWorld) const
+void Patch::render_wireframe(RenderableCollector& collector, const VolumeTest& volume,
+							 const Matrix4& localToWorld, bool coarse) const
 {
 	// Defer the tesselation calculation to the last minute
 	const_cast<Patch&>(*this).updateTesselation();
 
 	collector.SetState(_shader, RenderableCollector::eFullMaterials);
 
-	if (m_patchDef3) {
+	if (coarse) {
+		collector.addRenderable(_coarseWireframeRenderable, localToWorld);
+		render::RenderStatistics::Instance().increaseCoarse();
+	}
+	else if (m_patchDef3) {
 		collector.addRenderable(_fixedWireframeRenderable, localToWorld);
 	}
 	else {
@@ -280,18 +288,57 @@ void Patch::testSelect(Selector& selector, SelectionTest& test)
 	if (_mesh.vertices.empty()) return;
 
 	SelectionIntersection best;
-	IndexPointer::index_type* pIndex = &_mesh.indices.front();
 
-	for (std::size_t s=0; s<_mesh.m_numStrips; s++) {
-		test.TestQuadStrip(vertexpointer_arbitrarymeshvertex(&_mesh.vertices.front()), IndexPointer(pIndex, _mesh.m_lenStrips), best);
-		pIndex += _mesh.m_lenStrips;
-	}
+	// The test has been set up by the PatchNode, only the BVH leaves inside the volume are checked
+	getBVH().testSelect(test, vertexpointer_arbitrarymeshvertex(&_mesh.vertices.front()),
+		_node.localToWorld(), best);
 
 	if (best.valid()) {
 		selector.addIntersection(best);
 	}
 }
 
+const TriangleBVH& Patch::getBVH()
+{
+	if (!_bvh)
+	{
+		// Convert the quad strips into a triangle list, using the same
+		// triangle winding as SelectionTest::TestQuadStrip
+		IndexBuffer triangles;
+
+		if (_mesh.m_lenStrips > 2)
+		{
+			triangles.reserve(_mesh.m_numStrips * (_mesh.m_lenStrips - 2) * 3);
+		}
+
+		std::vector<RenderIndex>::const_iterator stripStartIndex = _mesh.indices.begin();
+
+		for (std::size_t strip = 0; strip < _mesh.m_numStrips; ++strip)
+		{
+			for (std::vector<RenderIndex>::const_iterator i = stripStartIndex;
+				 i + 2 < stripStartIndex + _mesh.m_lenStrips; i += 2)
+			{
+				triangles.push_back(*i);
+				triangles.push_back(*(i + 1));
+				triangles.push_back(*(i + 2));
+
+				triangles.push_back(*(i + 2));
+				triangles.push_back(*(i + 1));
+				triangles.push_back(*(i + 3));
+			}
+
+			stripStartIndex += _mesh.m_lenStrips;
+		}
+
+		_bvh.reset(new TriangleBVH(
+			vertexpointer_arbitrarymeshvertex(&_mesh.vertices.front()),
+			IndexPointer(triangles.empty() ? NULL : &triangles.front(), triangles.size())
+		));
+	}
+
+	return *_bvh;
+}
+
 // Transform this patch as defined by the transformation matrix <matrix>
 void Patch::transform(const Matrix4& matrix)
 {
@@ -377,13 +424,13 @@ void Patch::snapto(float snap)
 }
 
 const std::string& Patch::getShader() const {
-	return m_shader;
+	return m_shader.getString();
 }
 
 void Patch::setShader(const std::string& name)
 {
   	// return, if the shader is the same as the currently used
-	if (shader_equal(m_shader, name)) return;
+	if (shader_equal(m_shader.getString(), name)) return;
 
 	undoSave();
 
@@ -391,7 +438,7 @@ void Patch::setShader(const std::string& name)
 	releaseShader();
 
 	// Set the name of the shader and capture it
-	m_shader = name;
+	m_shader = string::InternedString(name);
 
 	captureShader();
 
@@ -442,7 +489,12 @@ void Patch::undoSave()
 // Save the current patch state into a new UndoMemento instance (allocated on heap) and return it to the undo observer
 IUndoMementoPtr Patch::exportState() const
 {
-	return IUndoMementoPtr(new SavedState(m_width, m_height, m_ctrl, m_shader, m_patchDef3, m_subdivisions_x, m_subdivisions_y));
+	undo::ByteBuffer data;
+	undo::ByteWriter writer(data);
+
+	SavedState::write(writer, m_width, m_height, m_ctrl, m_shader.getString(), m_patchDef3, m_subdivisions_x, m_subdivisions_y);
+
+	return _undoMementos.createMemento(data);
 }
 
 // Revert the state of this patch to the one that has been saved in the UndoMemento
@@ -450,7 +502,11 @@ void Patch::importState(const IUndoMementoPtr& state)
 {
 	undoSave();
 
-	const SavedState& other = *(std::static_pointer_cast<SavedState>(state));
+	undo::ByteBuffer data;
+	std::static_pointer_cast<undo::DeltaUndoMemento>(state)->getData(data);
+
+	undo::ByteReader reader(data);
+	const SavedState other(reader);
 
 	// begin duplicate of SavedState copy constructor, needs refactoring
 
@@ -591,6 +647,9 @@ void Patch::updateTesselation()
 
 	_tesselationChanged = false;
 
+	// The geometry is going to change, drop the selection hierarchy
+	_bvh.reset();
+
     m_ctrl_vertices.clear();
     m_lattice_indices.clear();
     
@@ -4118,47 +4177,13 @@ bool Patch::subdivionsFixed() const {
 
 bool Patch::getIntersection(const Ray& ray, Vector3& intersection)
 {
-	std::vector<RenderIndex>::const_iterator stripStartIndex = _mesh.indices.begin();
-
-	// Go over each quad strip and intersect the ray with its triangles
-	for (std::size_t strip = 0; strip < _mesh.m_numStrips; ++strip)
-	{
-		// Iterate over the indices. The +2 increment will lead up to the next quad
-		for (std::vector<RenderIndex>::const_iterator indexIter = stripStartIndex;
-			indexIter + 2 < stripStartIndex + _mesh.m_lenStrips; indexIter += 2)
-		{
-			Vector3 triangleIntersection;
-
-			// Run a selection test against the quad's triangles
-			{
-				const Vector3& p1 = _mesh.vertices[*indexIter].vertex;
-				const Vector3& p2 = _mesh.vertices[*(indexIter + 1)].vertex;
-				const Vector3& p3 = _mesh.vertices[*(indexIter + 2)].vertex;
-
-				if (ray.intersectTriangle(p1, p2, p3, triangleIntersection) == Ray::POINT)
-				{
-					intersection = triangleIntersection;
-					return true;
-				}
-			}
-
-			{
-				const Vector3& p1 = _mesh.vertices[*(indexIter + 2)].vertex;
-				const Vector3& p2 = _mesh.vertices[*(indexIter + 1)].vertex;
-				const Vector3& p3 = _mesh.vertices[*(indexIter + 3)].vertex;
-
-				if (ray.intersectTriangle(p1, p2, p3, triangleIntersection) == Ray::POINT)
-				{
-					intersection = triangleIntersection;
-					return true;
-				}
-			}
-		}
+	updateTesselation();
 
-		stripStartIndex += _mesh.m_lenStrips;
-	}
+	if (_mesh.vertices.empty()) return false;
 
-	return false;
+	// Trace the ray against the tesselation triangles, returns the nearest hit
+	return getBVH().getIntersection(ray,
+		vertexpointer_arbitrarymeshvertex(&_mesh.vertices.front()), intersection);
 }
 
 void Patch::textureChanged()
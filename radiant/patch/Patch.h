@@ -16,6 +16,9 @@
 #include "brush/TexDef.h"
 #include "brush/FacePlane.h"
 #include "brush/Face.h"
+#include "TriangleBVH.h"
+#include "DeltaUndoMemento.h"
+#include "string/InternedString.h"
 
 class PatchNode;
 class Ray;
@@ -42,7 +45,7 @@ class Patch :
 	AABB m_aabb_local; // local bbox
 
 	// greebo: The name of the shader
-	std::string m_shader;
+	string::InternedString m_shader;
 
 	ShaderPtr _shader;
 
@@ -52,6 +55,9 @@ class Patch :
 
 	IUndoStateSaver* _undoStateSaver;
 
+	// Creates the delta-encoded undo mementos of this patch
+	mutable undo::DeltaMementoChain _undoMementos;
+
   	// The pointer to the map file
 	MapFile* m_map;
 
@@ -66,6 +72,7 @@ class Patch :
 	// The OpenGL renderables for three rendering modes
 	RenderablePatchSolid _solidRenderable;
 	RenderablePatchWireframe _wireframeRenderable;
+	RenderablePatchCoarseWireframe _coarseWireframeRenderable;
 	RenderablePatchFixedWireframe _fixedWireframeRenderable;
 
 	// The shader states for the control points and the lattice
@@ -88,6 +95,10 @@ class Patch :
 	// TRUE if the patch tesselation needs an update
 	bool _tesselationChanged;
 
+	// Triangle hierarchy of the tesselation, used for selection tests and traces.
+	// Gets discarded whenever the tesselation changes and is rebuilt on demand.
+	TriangleBVHPtr _bvh;
+
 	// Callback functions when the patch gets changed
 	Callback m_evaluateTransform;
 	Callback m_boundsChanged;
@@ -98,6 +109,9 @@ class Patch :
 	// greebo: Initialises the patch member variables
 	void construct();
 
+	// Returns the triangle hierarchy of the current tesselation, building it if necessary
+	const TriangleBVH& getBVH();
+
 public:
 	bool m_patchDef3;
 	// The number of subdivisions of this patch
@@ -136,7 +150,9 @@ public:
 	// Render functions: solid mode, wireframe mode and components
 	void render_solid(RenderableCollector& collector, const VolumeTest& volume, 
 					  const Matrix4& localToWorld, const IRenderEntity& entity) const;
-	void render_wireframe(RenderableCollector& collector, const VolumeTest& volume, const Matrix4& localToWorld) const;
+	// A coarse wireframe is drawn for patches covering only a few pixels
+	void render_wireframe(RenderableCollector& collector, const VolumeTest& volume,
+						  const Matrix4& localToWorld, bool coarse) const;
 
     /// Submit renderable edge and face points
 	void submitRenderablePoints(RenderableCollector& collector,
@@ -4,6 +4,7 @@
 #include "ilayer.h"
 #include "ieventmanager.h"
 #include "ipreferencesystem.h"
+#include "istringpool.h"
 #include "itextstream.h"
 #include "i18n.h"
 
@@ -47,6 +48,7 @@ const StringSet& Doom3PatchCreator::getDependencies() const
 	if (_dependencies.empty())
 	{
 		_dependencies.insert(MODULE_PREFERENCESYSTEM);
+		_dependencies.insert(MODULE_STRINGPOOL);
 	}
 
 	return _dependencies;
@@ -165,6 +167,7 @@ const StringSet& Doom3PatchDef2Creator::getDependencies() const
 	{
 		_dependencies.insert(MODULE_RENDERSYSTEM);
 		_dependencies.insert(MODULE_PREFERENCESYSTEM);
+		_dependencies.insert(MODULE_STRINGPOOL);
 	}
 
 	return _dependencies;
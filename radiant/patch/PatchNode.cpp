@@ -5,6 +5,8 @@
 #include "iradiant.h"
 #include "icounter.h"
 #include "math/Frustum.h"
+#include "render/frontend/LevelOfDetail.h"
+#include "render/frontend/RenderableCollectionWalker.h"
 
 // Construct a PatchNode with no arguments
 PatchNode::PatchNode(bool patchDef3) :
@@ -304,8 +306,14 @@ void PatchNode::renderWireframe(RenderableCollector& collector, const VolumeTest
 
 	const_cast<Patch&>(m_patch).evaluateTransform();
 
+	// Patches which are small on the screen don't need their full tesselation,
+	// unless they or their parent entity are highlighted
+	bool coarse =
+		!render::RenderableCollectionWalker::isHighlighted(const_cast<PatchNode*>(this)->getSelf()) &&
+		render::LevelOfDetail(volume).getLevel(worldAABB()) == render::LevelOfDetail::COARSE;
+
 	// Pass the call to the patch instance, it adds the renderable
-	m_patch.render_wireframe(collector, volume, localToWorld());
+	m_patch.render_wireframe(collector, volume, localToWorld(), coarse);
 
 	// Render the selected components
 	renderComponentsSelected(collector, volume);
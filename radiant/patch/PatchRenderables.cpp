@@ -59,6 +59,61 @@ void RenderablePatchWireframe::render(const RenderInfo& info) const
     _vertexBuf.renderAllBatches(GL_LINE_STRIP);
 }
 
+void RenderablePatchCoarseWireframe::render(const RenderInfo& info) const
+{
+    // No colour changing
+    glDisableClientState(GL_COLOR_ARRAY);
+    if (info.checkFlag(RENDER_VERTEX_COLOUR))
+    {
+        glColor3f(1, 1, 1);
+    }
+
+    if (m_tess.vertices.empty()) return;
+
+    // The rows and columns of the tesselation passing through control points
+    std::vector<std::size_t> columns(1, 0);
+    for (std::size_t i = 0; i < m_tess.arrayWidth.size(); ++i)
+    {
+        columns.push_back(columns.back() + m_tess.arrayWidth[i]);
+    }
+
+    std::vector<std::size_t> rows(1, 0);
+    for (std::size_t i = 0; i < m_tess.arrayHeight.size(); ++i)
+    {
+        rows.push_back(rows.back() + m_tess.arrayHeight[i]);
+    }
+
+    const std::vector<ArbitraryMeshVertex>& patchVerts = m_tess.vertices;
+
+    std::vector<Vertex3f> lattice;
+    lattice.reserve(rows.size() * columns.size());
+
+    for (std::size_t r = 0; r < rows.size(); ++r)
+    {
+        for (std::size_t c = 0; c < columns.size(); ++c)
+        {
+            lattice.push_back(patchVerts[rows[r] * m_tess.m_nArrayWidth + columns[c]].vertex);
+        }
+    }
+
+    // Vertex buffer to receive and render vertices
+    VertexBuffer_T currentVBuf;
+
+    for (std::size_t r = 0; r < rows.size(); ++r)
+    {
+        currentVBuf.addBatch(lattice.begin() + r * columns.size(), columns.size());
+    }
+
+    for (std::size_t c = 0; c < columns.size(); ++c)
+    {
+        currentVBuf.addBatch(lattice.begin() + c, rows.size(), columns.size());
+    }
+
+    // Render all vertex batches
+    _vertexBuf.replaceData(currentVBuf);
+    _vertexBuf.renderAllBatches(GL_LINE_STRIP);
+}
+
 void RenderablePatchFixedWireframe::render(const RenderInfo& info) const
 {
     if (m_tess.vertices.empty() || m_tess.indices.empty()) return;
@@ -30,6 +30,28 @@ public:
     void render(const RenderInfo& info) const;
 };
 
+/**
+ * Helper class to render a PatchTesselation as coarse wireframe, for patches
+ * which are small on the screen. Only the curves running through the control
+ * points of the patch are drawn, sampled at the control points as well.
+ */
+class RenderablePatchCoarseWireframe : public OpenGLRenderable
+{
+    // Geometry source
+    const PatchTesselation& m_tess;
+
+    // VertexBuffer for rendering
+    typedef render::VertexBuffer<Vertex3f> VertexBuffer_T;
+    mutable VertexBuffer_T _vertexBuf;
+
+public:
+
+    RenderablePatchCoarseWireframe(const PatchTesselation& tess) : m_tess(tess)
+    { }
+
+    void render(const RenderInfo& info) const;
+};
+
 /// Helper class to render a fixed geometry PatchTesselation in wireframe mode
 class RenderablePatchFixedWireframe : public OpenGLRenderable
 {
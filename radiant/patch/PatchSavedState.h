@@ -1,13 +1,14 @@
 #pragma once
 
 #include "PatchControl.h"
+#include "DeltaUndoMemento.h"
 
-/* greebo: This is a structure that is allocated on the heap and contains all the state
- * information of a patch. This information is used by the UndoSystem to save the current
- * patch state and to revert it on request.
+/* greebo: This structure contains all the state information of a patch. This information
+ * is used by the UndoSystem to save the current patch state and to revert it on request.
+ * It is serialised into a DeltaUndoMemento, such that edits touching only a few control
+ * points don't store a full copy of the control array.
  */
-class SavedState : 
-	public IUndoMemento
+class SavedState
 {
 public:
 	// The members to store the state information
@@ -18,23 +19,39 @@ public:
 	std::size_t m_subdivisions_x;
 	std::size_t m_subdivisions_y;
 
-	// Constructor
-	SavedState(
+	// Restores the state from the given reader
+	SavedState(undo::ByteReader& reader)
+	{
+		reader.read(m_width);
+		reader.read(m_height);
+		reader.read(m_patchDef3);
+		reader.read(m_subdivisions_x);
+		reader.read(m_subdivisions_y);
+
+		m_ctrl.resize(m_width * m_height);
+		reader.readArray(m_ctrl.empty() ? NULL : &m_ctrl[0], m_ctrl.size());
+
+		m_shader = reader.readString();
+	}
+
+	// Writes the given patch state. The variable-length shader name goes
+	// last, so the control points keep their offsets as long as the patch
+	// dimensions don't change, which keeps the deltas small.
+	static void write(undo::ByteWriter& writer,
 		std::size_t width,
 		std::size_t height,
 		const PatchControlArray& ctrl,
 		const std::string& shader,
 		bool patchDef3,
 		std::size_t subdivisions_x,
-		std::size_t subdivisions_y
-	) :
-		m_width(width),
-		m_height(height),
-		m_shader(shader),
-		m_ctrl(ctrl),
-		m_patchDef3(patchDef3),
-		m_subdivisions_x(subdivisions_x),
-		m_subdivisions_y(subdivisions_y)
-    {
-    }
+		std::size_t subdivisions_y)
+	{
+		writer.write(width);
+		writer.write(height);
+		writer.write(patchDef3);
+		writer.write(subdivisions_x);
+		writer.write(subdivisions_y);
+		writer.writeArray(ctrl.empty() ? NULL : &ctrl[0], ctrl.size());
+		writer.writeString(shader);
+	}
 };
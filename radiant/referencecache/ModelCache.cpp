@@ -2,6 +2,8 @@
 
 #include "i18n.h"
 #include "ifilesystem.h"
+#include "ientity.h"
+#include "iscenegraph.h"
 #include "imodel.h"
 #include "imd5model.h"
 #include "imd5anim.h"
@@ -10,22 +12,56 @@
 #include "ieventmanager.h"
 #include "iparticles.h"
 #include "iparticlenode.h"
+#include "iradiant.h"
+#include "ithread.h"
+#include "iuimanager.h"
+#include "itrace.h"
 
 #include <iostream>
 #include <set>
 #include "os/path.h"
 #include "os/file.h"
+#include "registry/CachedKey.h"
 
 #include "modulesystem/StaticModule.h"
 #include "ui/modelselector/ModelSelector.h"
 #include "ui/mainframe/ScreenUpdateBlocker.h"
 #include "NullModelLoader.h"
 #include <boost/bind.hpp>
+#include <boost/format.hpp>
+#include <boost/algorithm/string/case_conv.hpp>
 
 namespace model {
 
 namespace {
 
+	const std::string RKEY_LOAD_MODELS_IN_BACKGROUND("user/ui/loadModelsInBackground");
+
+	// Worker thread function, parses the model and queues the result
+	void loadModelFromPath(const ModelCache::LoadQueuePtr& queue,
+						   const ModelLoaderPtr& loader,
+						   const std::string& modelPath,
+						   std::size_t generation)
+	{
+		ModelCache::LoadResult result;
+		result.modelPath = modelPath;
+		result.generation = generation;
+
+		{
+			trace::ScopedZone zone("models", "loadModelFromPath", modelPath);
+			result.model = loader->loadModelFromPath(modelPath, result.messages);
+		}
+
+		Glib::Mutex::Lock lock(queue->mutex);
+
+		queue->results.push_back(result);
+
+		if (queue->dispatcher != NULL)
+		{
+			queue->dispatcher->emit();
+		}
+	}
+
 	class ModelRefreshWalker :
 		public scene::NodeVisitor
 	{
@@ -98,7 +134,12 @@ namespace {
 } // namespace
 
 ModelCache::ModelCache() :
-	_enabled(true)
+	_enabled(true),
+	_backgroundLoads(0),
+	_generation(0),
+	_numRequested(0),
+	_numFinished(0),
+	_loadQueue(new LoadQueue)
 {}
 
 ModelLoaderPtr ModelCache::getModelLoaderForType(const std::string& type)
@@ -126,6 +167,11 @@ ModelLoaderPtr ModelCache::getModelLoaderForType(const std::string& type)
 
 scene::INodePtr ModelCache::getModelNode(const std::string& modelPath)
 {
+	if (_backgroundLoads > 0 && canLoadInBackground(modelPath))
+	{
+		return loadInBackground(modelPath);
+	}
+
 	// Check if we have a reference to a modeldef
 	IModelDefPtr modelDef = GlobalEntityClassManager().findModel(modelPath);
 
@@ -235,10 +281,176 @@ void ModelCache::clear() {
 
 	_modelMap.clear();
 
+	// Forget about the running background loads, the placeholders stay
+	++_generation;
+
+	if (!_pendingModels.empty())
+	{
+		_pendingModels.clear();
+		_numRequested = _numFinished = 0;
+
+		updateProgress();
+	}
+
 	// Allow usage of the modelnodemap again.
 	_enabled = true;
 }
 
+void ModelCache::beginBackgroundLoads()
+{
+	++_backgroundLoads;
+}
+
+void ModelCache::endBackgroundLoads()
+{
+	if (_backgroundLoads > 0)
+	{
+		--_backgroundLoads;
+	}
+}
+
+bool ModelCache::canLoadInBackground(const std::string& modelPath)
+{
+	static registry::CachedKey<bool> enabled(RKEY_LOAD_MODELS_IN_BACKGROUND);
+
+	if (!enabled.get() || !_enabled || !_loadDispatcher ||
+		_modelMap.find(modelPath) != _modelMap.end())
+	{
+		return false; // cached models are returned right away
+	}
+
+	// ModelDefs refer to animated MD5 meshes, these are loaded synchronously
+	if (path_is_absolute(modelPath.c_str()) ||
+		GlobalEntityClassManager().findModel(modelPath))
+	{
+		return false;
+	}
+
+	// The picomodel formats can be parsed by several threads at once
+	std::string type = boost::algorithm::to_lower_copy(os::getExtension(modelPath));
+
+	return type == "ase" || type == "lwo";
+}
+
+scene::INodePtr ModelCache::loadInBackground(const std::string& modelPath)
+{
+	// The placeholder is the same box a failed load falls back to
+	NullModelPtr model(new NullModel);
+	model->setModelPath(modelPath);
+	model->setFilename(modelPath);
+
+	scene::INodePtr placeholder(new NullModelNode(model));
+
+	PendingModels::iterator found = _pendingModels.find(modelPath);
+
+	if (found == _pendingModels.end())
+	{
+		// First request for this model, hand it to a worker thread
+		found = _pendingModels.insert(
+			PendingModels::value_type(modelPath, Placeholders())
+		).first;
+
+		std::string type = modelPath.substr(modelPath.rfind(".") + 1);
+
+		GlobalRadiant().getThreadManager().execute(boost::bind(
+			loadModelFromPath, _loadQueue, getModelLoaderForType(type), modelPath, _generation
+		));
+
+		++_numRequested;
+		updateProgress();
+	}
+
+	found->second.push_back(placeholder);
+
+	return placeholder;
+}
+
+void ModelCache::onModelsLoaded()
+{
+	std::vector<LoadResult> results;
+
+	{
+		Glib::Mutex::Lock lock(_loadQueue->mutex);
+		results.swap(_loadQueue->results);
+	}
+
+	std::vector<IEntityNodePtr> entities;
+
+	for (std::vector<LoadResult>::const_iterator i = results.begin(); i != results.end(); ++i)
+	{
+		writeLoadMessages(i->messages);
+
+		PendingModels::iterator found = _pendingModels.find(i->modelPath);
+
+		// Requests issued before the last clear() are void
+		if (i->generation != _generation || found == _pendingModels.end())
+		{
+			continue;
+		}
+
+		++_numFinished;
+
+		if (i->model)
+		{
+			_modelMap.insert(ModelMap::value_type(i->modelPath, i->model));
+
+			for (Placeholders::const_iterator p = found->second.begin();
+				 p != found->second.end(); ++p)
+			{
+				scene::INodePtr placeholder = p->lock();
+
+				// Placeholders might have been removed in the meantime
+				IEntityNodePtr entity = placeholder ?
+					boost::dynamic_pointer_cast<IEntityNode>(placeholder->getParent()) :
+					IEntityNodePtr();
+
+				if (entity)
+				{
+					entities.push_back(entity);
+				}
+			}
+		}
+		else
+		{
+			// The placeholders are what the NullModelLoader would return anyway
+			rError() << "ModelCache: could not load model " << i->modelPath << std::endl;
+		}
+
+		_pendingModels.erase(found);
+	}
+
+	// The entities pick up the cached models, replacing the placeholders
+	for (std::vector<IEntityNodePtr>::const_iterator i = entities.begin();
+		 i != entities.end(); ++i)
+	{
+		(*i)->refreshModel();
+	}
+
+	if (!entities.empty())
+	{
+		SceneChangeNotify();
+	}
+
+	updateProgress();
+}
+
+void ModelCache::updateProgress()
+{
+	std::string text;
+
+	if (_numFinished < _numRequested)
+	{
+		text = (boost::format(_("Models: %d / %d")) % _numFinished % _numRequested).str();
+	}
+	else
+	{
+		// All done, count from zero for the next batch
+		_numRequested = _numFinished = 0;
+	}
+
+	GlobalUIManager().getStatusBarManager().setText("ModelLoads", text);
+}
+
 void ModelCache::refreshModels(const cmd::ArgumentList& args)
 {
 	// Disable screen updates for the scope of this function
@@ -303,6 +515,7 @@ const StringSet& ModelCache::getDependencies() const {
 		_dependencies.insert(MODULE_MODELLOADER + "MD5MESH");
 		_dependencies.insert(MODULE_COMMANDSYSTEM);
 		_dependencies.insert(MODULE_SELECTIONSYSTEM);
+		_dependencies.insert(MODULE_UIMANAGER);
 	}
 
 	return _dependencies;
@@ -321,9 +534,36 @@ void ModelCache::initialiseModule(const ApplicationContext& ctx) {
 	);
 	GlobalEventManager().addCommand("RefreshModels", "RefreshModels");
 	GlobalEventManager().addCommand("RefreshSelectedModels", "RefreshSelectedModels");
+
+	// The worker threads notify the main thread through this dispatcher
+	_loadDispatcher.reset(new Glib::Dispatcher);
+	_loadDispatcher->connect(sigc::mem_fun(*this, &ModelCache::onModelsLoaded));
+
+	{
+		Glib::Mutex::Lock lock(_loadQueue->mutex);
+		_loadQueue->dispatcher = _loadDispatcher.get();
+	}
+
+	GlobalUIManager().getStatusBarManager().addTextElement(
+		"ModelLoads",
+		"",  // no icon
+		IStatusBarManager::POS_BRUSHCOUNT + 1
+	);
 }
 
 void ModelCache::shutdownModule() {
+	// Workers still running must not touch the dispatcher anymore
+	{
+		Glib::Mutex::Lock lock(_loadQueue->mutex);
+		_loadQueue->dispatcher = NULL;
+		_loadQueue->results.clear();
+	}
+
+	_loadDispatcher.reset();
+
+	// The status bar is gone already, don't report any progress
+	_pendingModels.clear();
+
 	clear();
 }
 
@@ -2,9 +2,14 @@
 
 #include <map>
 #include <string>
+#include <vector>
 #include "imodelcache.h"
 #include "icommandsystem.h"
 
+#include <boost/scoped_ptr.hpp>
+#include <glibmm/thread.h>
+#include <glibmm/dispatcher.h>
+
 namespace model {
 
 class ModelCache :
@@ -17,6 +22,54 @@ class ModelCache :
 	// Flag to disable the cache on demand (used during clear())
 	bool _enabled;
 
+public:
+	// A model parsed by a worker thread
+	struct LoadResult
+	{
+		std::string modelPath;
+		IModelPtr model;
+
+		// The value of _generation when the load was requested
+		std::size_t generation;
+
+		// Written by the loader, logged on the main thread
+		LoadMessages messages;
+	};
+
+	// State shared with the worker threads, which might outlive the cache
+	struct LoadQueue
+	{
+		Glib::Mutex mutex;
+		std::vector<LoadResult> results;
+
+		// Notifies the main thread, NULL after shutdown
+		Glib::Dispatcher* dispatcher;
+
+		LoadQueue() :
+			dispatcher(NULL)
+		{}
+	};
+	typedef boost::shared_ptr<LoadQueue> LoadQueuePtr;
+
+private:
+	// Nesting level of beginBackgroundLoads()
+	std::size_t _backgroundLoads;
+
+	// The placeholder nodes handed out for the models being loaded
+	typedef std::vector<scene::INodeWeakPtr> Placeholders;
+	typedef std::map<std::string, Placeholders> PendingModels;
+	PendingModels _pendingModels;
+
+	// Incremented by clear(), results of earlier requests are discarded
+	std::size_t _generation;
+
+	// Progress of the running background loads
+	std::size_t _numRequested;
+	std::size_t _numFinished;
+
+	LoadQueuePtr _loadQueue;
+	boost::scoped_ptr<Glib::Dispatcher> _loadDispatcher;
+
 public:
 	ModelCache();
 
@@ -33,6 +86,9 @@ public:
 	// Clears the cache
 	virtual void clear();
 
+	virtual void beginBackgroundLoads();
+	virtual void endBackgroundLoads();
+
 	// Command target: this reloads all models in the map
 	void refreshModels(const cmd::ArgumentList& args);
 	// Command target: this reloads all selected models in the map
@@ -43,6 +99,18 @@ public:
 	virtual const StringSet& getDependencies() const;
 	virtual void initialiseModule(const ApplicationContext& ctx);
 	virtual void shutdownModule();
+
+private:
+	// Returns true if the given model can be parsed by a worker thread
+	bool canLoadInBackground(const std::string& modelPath);
+
+	// Queues the given model for loading and returns a placeholder node
+	scene::INodePtr loadInBackground(const std::string& modelPath);
+
+	// Main thread callback, swaps the placeholders of the loaded models
+	void onModelsLoaded();
+
+	void updateProgress();
 };
 
 } // namespace model
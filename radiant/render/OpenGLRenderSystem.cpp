@@ -41,6 +41,7 @@ OpenGLRenderSystem::OpenGLRenderSystem() :
 	_currentShaderProgram(SHADER_PROGRAM_NONE),
 	_shadersAvailable(false),
 	_time(0),
+	_sortIndicesChanged(true),
 	m_lightsChanged(true),
 	m_traverseRenderablesMutex(false)
 {
@@ -62,12 +63,26 @@ OpenGLRenderSystem::~OpenGLRenderSystem()
 
 ShaderPtr OpenGLRenderSystem::capture(const std::string& name)
 {
+	return capture(string::InternedString(name));
+}
+
+ShaderPtr OpenGLRenderSystem::capture(const string::InternedString& name)
+{
+	// Shaders are never removed from the cache, so the last capture stays valid
+	if (_lastCapture && name == _lastCaptureName)
+	{
+		return _lastCapture;
+	}
+
 	// Usual ritual, check cache and return if found, otherwise create/
 	// insert/return.
 	ShaderMap::const_iterator i = _shaders.find(name);
 
 	if (i != _shaders.end())
 	{
+		_lastCaptureName = name;
+		_lastCapture = i->second;
+
         return i->second;
 	}
 
@@ -77,6 +92,9 @@ ShaderPtr OpenGLRenderSystem::capture(const std::string& name)
 	OpenGLShaderPtr shd(new OpenGLShader(*this));
 	_shaders[name] = shd;
 
+	_lastCaptureName = name;
+	_lastCapture = shd;
+
 	// Realise the shader if the cache is realised
 	if (_realised)
 	{
@@ -174,20 +192,26 @@ void OpenGLRenderSystem::render(RenderStateFlags globalstate,
 	glHint(GL_FOG_HINT, GL_NICEST);
     glDisable(GL_FOG);
 
-    // Iterate over the sorted mapping between OpenGLStates and their
-    // OpenGLShaderPasses (containing the renderable geometry), and render the
-    // contents of each bucket. Each pass is passed a reference to the "current"
-    // state, which it can change.
-	for (OpenGLStates::iterator i = _state_sorted.begin();
-		i != _state_sorted.end();
-		++i)
-	{
-        // Render the OpenGLShaderPass
-        if (!i->second->empty())
+    // Number the passes in the order of the sorted mapping between
+    // OpenGLStates and their OpenGLShaderPasses, the render queue sorts the
+    // submitted renderables by it.
+    if (_sortIndicesChanged)
+    {
+        std::size_t sortIndex = 0;
+
+        for (OpenGLStates::iterator i = _state_sorted.begin();
+             i != _state_sorted.end();
+             ++i)
         {
-            i->second->render(current, globalstate, viewer, _time);
+            i->second->setSortIndex(sortIndex++);
         }
-	}
+
+        _sortIndicesChanged = false;
+    }
+
+    // Render the queue contents. Each pass is passed a reference to the
+    // "current" state, which it can change.
+    _renderQueue.render(current, globalstate, viewer, _time);
 }
 
 void OpenGLRenderSystem::realise()
@@ -415,10 +439,25 @@ void OpenGLRenderSystem::propagateLightChangedFlagToAllLights()
 
 void OpenGLRenderSystem::insertSortedState(const OpenGLStates::value_type& val) {
 	_state_sorted.insert(val);
+	_sortIndicesChanged = true;
 }
 
 void OpenGLRenderSystem::eraseSortedState(const OpenGLStates::key_type& key) {
-	_state_sorted.erase(key);
+	OpenGLStates::iterator found = _state_sorted.find(key);
+
+	if (found != _state_sorted.end())
+	{
+		// Don't leave any renderables of this pass behind in the queue
+		_renderQueue.removePass(*found->second);
+		_state_sorted.erase(found);
+	}
+
+	_sortIndicesChanged = true;
+}
+
+RenderQueue& OpenGLRenderSystem::getRenderQueue()
+{
+	return _renderQueue;
 }
 
 // renderables
@@ -456,6 +495,7 @@ const StringSet& OpenGLRenderSystem::getDependencies() const
 	if (_dependencies.empty()) {
 		_dependencies.insert(MODULE_SHADERSYSTEM);
 		_dependencies.insert(MODULE_OPENGL);
+		_dependencies.insert(MODULE_STRINGPOOL);
 	}
 
 	return _dependencies;
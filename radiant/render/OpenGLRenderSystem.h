@@ -2,11 +2,13 @@
 
 #include "irender.h"
 #include <map>
+#include <unordered_map>
 #include "imodule.h"
 #include "backend/OpenGLStateManager.h"
 #include "backend/OpenGLShader.h"
 #include "LinearLightList.h"
 #include "render/backend/OpenGLStateLess.h"
+#include "string/InternedString.h"
 
 #include <boost/weak_ptr.hpp>
 
@@ -23,10 +25,17 @@ class OpenGLRenderSystem
   public ModuleObserver
 {
 private:
-	// Map of named Shader objects
-	typedef std::map<std::string, OpenGLShaderPtr> ShaderMap;
+	// Map of named Shader objects. Render shader names are case-sensitive,
+	// the pooled folded hash only serves to find the bucket.
+	typedef std::unordered_map<string::InternedString, OpenGLShaderPtr,
+		string::InternedString::HashIgnoreCase> ShaderMap;
 	ShaderMap _shaders;
 
+	// The most recently captured shader. Bulk operations like map loading
+	// capture the same name for many faces in a row.
+	string::InternedString _lastCaptureName;
+	OpenGLShaderPtr _lastCapture;
+
 	// whether this module has been realised
 	bool _realised;
 
@@ -39,6 +48,12 @@ private:
 	// Map of OpenGLState references, with access functions.
 	OpenGLStates _state_sorted;
 
+	// The renderables submitted to the passes in the current frame
+	RenderQueue _renderQueue;
+
+	// TRUE if the passes need to be numbered again before rendering
+	bool _sortIndicesChanged;
+
 	// Render time
 	std::size_t _time;
 
@@ -63,6 +78,7 @@ public:
     /* RenderSystem implementation */
 
 	ShaderPtr capture(const std::string& name);
+	ShaderPtr capture(const string::InternedString& name);
 	void render(RenderStateFlags globalstate,
 				const Matrix4& modelview,
 				const Matrix4& projection,
@@ -95,6 +111,7 @@ public:
     /* OpenGLStateManager implementation */
 	void insertSortedState(const OpenGLStates::value_type& val);
 	void eraseSortedState(const OpenGLStates::key_type& key);
+	RenderQueue& getRenderQueue();
 
 	// renderables
 	void attachRenderable(const Renderable& renderable);
@@ -2,7 +2,7 @@
 #define RENDERSTATISTICS_H_
 
 #include "timer.h"
-#include "string/string.h"
+#include "string/convert.h"
 
 namespace render {
 
@@ -11,7 +11,11 @@ class RenderStatistics {
 
 	std::size_t _countPrims;
 	std::size_t _countStates;
+	std::size_t _countSkippedStates;
 	std::size_t _countTransforms;
+	std::size_t _countPreviewed;
+	std::size_t _countCulled;
+	std::size_t _countCoarse;
 
 	Timer _timer;
 public:
@@ -19,18 +23,78 @@ public:
 		_statStr.clear();
         _statStr = "prims: " + string::to_string(_countPrims) +
 				  " | states: " + string::to_string(_countStates) +
+				  " (skipped: " + string::to_string(_countSkippedStates) + ")" +
 				  " | transforms: "	+ string::to_string(_countTransforms) +
 				  " | msec: " + string::to_string(_timer.elapsed_msec());
+
+		// Only shown while the selection is dragged with a transform preview
+		if (_countPreviewed > 0)
+		{
+			_statStr += " | previewed: " + string::to_string(_countPreviewed);
+		}
+
+		// Objects affected by the level of detail
+		if (_countCulled > 0 || _countCoarse > 0)
+		{
+			_statStr += " | lod culled: " + string::to_string(_countCulled) +
+						" coarse: " + string::to_string(_countCoarse);
+		}
+
 		return _statStr;
 	}
 
 	void resetStats() {
 		_countPrims = 0;
 		_countStates = 0;
+		_countSkippedStates = 0;
 		_countTransforms = 0;
+		_countPreviewed = 0;
+		_countCulled = 0;
+		_countCoarse = 0;
 		_timer.start();
 	}
 
+	void increasePrimitives() {
+		++_countPrims;
+	}
+
+	// A pass state has been applied to the GL
+	void increaseStates() {
+		++_countStates;
+	}
+
+	// A pass state didn't need to be applied again for the next renderables
+	void increaseSkippedStates() {
+		++_countSkippedStates;
+	}
+
+	void increaseTransforms() {
+		++_countTransforms;
+	}
+
+	// A renderable has been submitted with the pending transform of the selection
+	void increasePreviewed() {
+		++_countPreviewed;
+	}
+
+	// An object has been skipped for being too small on the screen
+	void increaseCulled() {
+		++_countCulled;
+	}
+
+	// An object has been drawn simplified for being small on the screen
+	void increaseCoarse() {
+		++_countCoarse;
+	}
+
+	std::size_t getCulled() const {
+		return _countCulled;
+	}
+
+	std::size_t getCoarse() const {
+		return _countCoarse;
+	}
+
 	static RenderStatistics& Instance() {
 		static RenderStatistics _instance;
 		return _instance;
@@ -135,7 +135,7 @@ void OpenGLShader::decrementUsed()
     }
 }
 
-void OpenGLShader::realise(const std::string& name)
+void OpenGLShader::realise(const string::InternedString& name)
 {
     // Construct the shader passes based on the name
     construct(name);
@@ -143,7 +143,7 @@ void OpenGLShader::realise(const std::string& name)
     if (_material != NULL)
 	{
 		// greebo: Check the filtersystem whether we're filtered
-		_material->setVisible(GlobalFilterSystem().isVisible(FilterRule::TYPE_TEXTURE, name));
+		_material->setVisible(GlobalFilterSystem().isVisible(FilterRule::TYPE_TEXTURE, name.getString()));
 
 		if (m_used != 0)
 		{
@@ -197,7 +197,7 @@ unsigned int OpenGLShader::getFlags() const
 // Append a default shader pass onto the back of the state list
 OpenGLState& OpenGLShader::appendDefaultPass()
 {
-    _shaderPasses.push_back(OpenGLShaderPassPtr(new OpenGLShaderPass(*this)));
+    _shaderPasses.push_back(OpenGLShaderPassPtr(new OpenGLShaderPass(*this, _glStateManager.getRenderQueue())));
     OpenGLState& state = _shaderPasses.back()->state();
     return state;
 }
@@ -547,7 +547,7 @@ void OpenGLShader::appendBlendLayer(const ShaderLayerPtr& layer)
 }
 
 // Construct a normal shader
-void OpenGLShader::constructNormalShader(const std::string& name)
+void OpenGLShader::constructNormalShader(const string::InternedString& name)
 {
     // Obtain the Material
     _material = GlobalMaterialManager().getMaterialForName(name);
@@ -568,8 +568,10 @@ void OpenGLShader::constructNormalShader(const std::string& name)
 }
 
 // Main shader construction entry point
-void OpenGLShader::construct(const std::string& name)
+void OpenGLShader::construct(const string::InternedString& internedName)
 {
+	const std::string& name = internedName.getString();
+
 	// Retrieve the highlight colour from the colourschemes (once)
 	const static Colour4 highLightColour(
         ColourSchemes().getColour("selected_brush_camera"), 0.3f
@@ -800,7 +802,7 @@ void OpenGLShader::construct(const std::string& name)
         default:
         {
             // This is not a hard-coded shader, construct from the shader system
-            constructNormalShader(name);
+            constructNormalShader(internedName);
         }
 
     } // switch (name[0])
@@ -7,6 +7,7 @@
 #include "ishaders.h"
 #include "moduleobservers.h"
 #include "string/string.h"
+#include "string/InternedString.h"
 
 #include <list>
 
@@ -39,11 +40,11 @@ class OpenGLShader
 private:
 
     // Start point for constructing shader passes from the shader name
-	void construct(const std::string& name);
+	void construct(const string::InternedString& name);
 
     // Construct shader passes from a regular shader (as opposed to a special
     // built-in shader)
-    void constructNormalShader(const std::string& name);
+    void constructNormalShader(const string::InternedString& name);
 
     // Shader pass construction helpers
     void appendBlendLayer(const ShaderLayerPtr& layer);
@@ -116,7 +117,7 @@ public:
 	/**
 	 * Realise this shader, setting the name in the process.
 	 */
-	void realise(const std::string& name);
+	void realise(const string::InternedString& name);
 
 	void unrealise();
 
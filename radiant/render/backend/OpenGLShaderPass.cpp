@@ -11,6 +11,7 @@
 #include <boost/foreach.hpp>
 
 #include "debugging/render.h"
+#include "render/RenderStatistics.h"
 
 namespace render
 {
@@ -573,7 +574,7 @@ void OpenGLShaderPass::addRenderable(const OpenGLRenderable& renderable,
                                       const Matrix4& modelview,
                                       const RendererLight* light)
 {
-    _renderablesWithoutEntity.push_back(TransformedRenderable(renderable, modelview, light, NULL));
+    _queue.add(*this, renderable, modelview, light, NULL);
 }
 
 void OpenGLShaderPass::addRenderable(const OpenGLRenderable& renderable,
@@ -581,53 +582,19 @@ void OpenGLShaderPass::addRenderable(const OpenGLRenderable& renderable,
                                       const IRenderEntity& entity,
                                       const RendererLight* light)
 {
-    RenderablesByEntity::iterator i = _renderables.find(&entity);
-
-    if (i == _renderables.end())
-    {
-        i = _renderables.insert(RenderablesByEntity::value_type(&entity, Renderables())).first;
-    }
-
-    i->second.push_back(TransformedRenderable(renderable, modelview, light, &entity));
+    _queue.add(*this, renderable, modelview, light, &entity);
 }
 
-// Render the bucket contents
-void OpenGLShaderPass::render(OpenGLState& current,
-                              unsigned int flagsMask,
-                              const Vector3& viewer,
-                              std::size_t time)
+bool OpenGLShaderPass::setUpState(OpenGLState& current,
+                                  unsigned int flagsMask,
+                                  const Vector3& viewer,
+                                  std::size_t time,
+                                  const IRenderEntity* entity)
 {
-    // Reset the texture matrix
-    glMatrixMode(GL_TEXTURE);
-    glLoadMatrixd(Matrix4::getIdentity());
-
-    glMatrixMode(GL_MODELVIEW);
-
     // Apply our state to the current state object
-    applyState(current, flagsMask, viewer, time, NULL);
+    applyState(current, flagsMask, viewer, time, entity);
 
-    if (!_renderablesWithoutEntity.empty())
-    {
-        renderAllContained(_renderablesWithoutEntity, current, viewer, time);
-    }
-
-    for (RenderablesByEntity::const_iterator i = _renderables.begin();
-         i != _renderables.end();
-         ++i)
-    {
-        // Apply our state to the current state object
-        applyState(current, flagsMask, viewer, time, i->first);
-
-        if (!stateIsActive())
-        {
-            continue;
-        }
-
-        renderAllContained(i->second, current, viewer, time);
-    }
-
-    _renderablesWithoutEntity.clear();
-    _renderables.clear();
+    return entity == NULL || stateIsActive();
 }
 
 bool OpenGLShaderPass::stateIsActive()
@@ -693,25 +660,30 @@ void OpenGLShaderPass::setUpLightingCalculation(OpenGLState& current,
 }
 
 // Flush renderables
-void OpenGLShaderPass::renderAllContained(const Renderables& renderables,
-                                          OpenGLState& current,
-                                          const Vector3& viewer,
-                                          std::size_t time)
+void OpenGLShaderPass::renderEntries(const RenderQueue::Entry* begin,
+                                     const RenderQueue::Entry* end,
+                                     OpenGLState& current,
+                                     const Vector3& viewer,
+                                     std::size_t time)
 {
     // Keep a pointer to the last transform matrix and render entity used
     const Matrix4* transform = 0;
 
     glPushMatrix();
 
-    // Iterate over each transformed renderable in the vector
-    BOOST_FOREACH (const TransformedRenderable& r, renderables)
+    RenderStatistics& stats = RenderStatistics::Instance();
+
+    // Iterate over each transformed renderable in the range
+    for (const RenderQueue::Entry* r = begin; r != end; ++r)
     {
         // If the current iteration's transform matrix was different from the
         // last, apply it and store for the next iteration
         if (transform == NULL ||
-            (transform != r.transform && !transform->isAffineEqual(*r.transform)))
+            (transform != r->transform && !transform->isAffineEqual(*r->transform)))
         {
-            transform = r.transform;
+            transform = r->transform;
+            stats.increaseTransforms();
+
             glPopMatrix();
             glPushMatrix();
             glMultMatrixd(*transform);
@@ -730,7 +702,7 @@ void OpenGLShaderPass::renderAllContained(const Renderables& renderables,
 
         // If we are using a lighting program and this renderable is lit, set
         // up the lighting calculation
-        const RendererLight* light = r.light;
+        const RendererLight* light = r->light;
         if (current.glProgram && light)
         {
             setUpLightingCalculation(current, light, viewer, *transform, time);
@@ -738,7 +710,8 @@ void OpenGLShaderPass::renderAllContained(const Renderables& renderables,
 
         // Render the renderable
         RenderInfo info(current.getRenderFlags(), viewer, current.cubeMapMode);
-        r.renderable->render(info);
+        r->renderable->render(info);
+        stats.increasePrimitives();
     }
 
     // Cleanup
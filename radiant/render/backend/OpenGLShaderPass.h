@@ -2,6 +2,7 @@
 
 #include "math/Vector3.h"
 #include "iglrender.h"
+#include "RenderQueue.h"
 
 #include <vector>
 #include <map>
@@ -20,8 +21,8 @@ class OpenGLShader;
  * @brief A single component pass of an OpenGL shader.
  *
  * Each OpenGLShader may contain multiple passes, which are rendered
- * independently. Each pass retains its own OpenGLState and a list of renderable
- * objects to be rendered in this pass.
+ * independently. Each pass retains its own OpenGLState, the renderable objects
+ * to be rendered in this pass are collected in the RenderSystem's RenderQueue.
  */
 class OpenGLShaderPass
 {
@@ -30,44 +31,11 @@ class OpenGLShaderPass
 	// The state applied to this bucket
 	OpenGLState _glState;
 
-	/*
-	 * Representation of a transformed-and-lit renderable object. Stores a
-	 * single object, with its transform matrix and illuminating light source.
-	 */
-	struct TransformedRenderable
-	{
-    	// The renderable object
-    	const OpenGLRenderable* renderable;
-
-    	// The modelview transform for this renderable
-    	const Matrix4* transform;
-
-		// The light falling on this obejct
-    	const RendererLight* light;
-
-		// The entity attached to this renderable
-		const IRenderEntity* entity;
-
-		// Constructor
-		TransformedRenderable(const OpenGLRenderable& r,
-							  const Matrix4& t,
-							  const RendererLight* l,
-							  const IRenderEntity* e)
-		: renderable(&r),
-		  transform(&t),
-		  light(l),
-		  entity(e)
-		{}
-	};
-
-	// Vector of transformed renderables using this state
-	typedef std::vector<TransformedRenderable> Renderables;
-	Renderables _renderablesWithoutEntity;
-	
-	// Renderables sorted by RenderEntity
-	typedef std::map<const IRenderEntity*, Renderables> RenderablesByEntity;
-
-	RenderablesByEntity _renderables;
+	// The queue collecting the renderables of the current frame
+	RenderQueue& _queue;
+
+	// Position of this pass in the sorted states, assigned by the RenderSystem
+	std::size_t _sortIndex;
 
 private:
 
@@ -85,12 +53,6 @@ private:
 
 	void setupTextureMatrix(GLenum textureUnit, const ShaderLayerPtr& stage);
 
-	// Render all of the given TransformedRenderables
-	void renderAllContained(const Renderables& renderables,
-							OpenGLState& current,
-						    const Vector3& viewer,
-							std::size_t time);
-
     /* Helper functions to enable/disable particular GL states */
 
     void setTexture0();
@@ -121,8 +83,10 @@ private:
 
 public:
 
-	OpenGLShaderPass(render::OpenGLShader& owner) :
-		_owner(owner)
+	OpenGLShaderPass(render::OpenGLShader& owner, RenderQueue& queue) :
+		_owner(owner),
+		_queue(queue),
+		_sortIndex(0)
 	{}
 
 	/**
@@ -155,33 +119,60 @@ public:
 		return &_glState;
 	}
 
-	/**
-	 * \brief
-     * Render the renderables attached to this shader pass.
-     *
-     * \param current
-     * The current OpenGL state variables.
-     *
-     * \param flagsMask
-     * Mask of allowed render flags.
-     *
-     * \param viewer
-     * Viewer location in world space.
-     *
-     */
-	void render(OpenGLState& current,
-				unsigned int flagsMask,
-				const Vector3& viewer,
-				std::size_t time);
+	std::size_t getSortIndex() const
+	{
+		return _sortIndex;
+	}
+
+	void setSortIndex(std::size_t sortIndex)
+	{
+		_sortIndex = sortIndex;
+	}
 
 	/**
-	 * Returns true if this shaderpass doesn't have anything to render.
+	 * Returns true if this pass has stages, whose expressions need to be
+	 * evaluated for each entity.
 	 */
-	bool empty() const
+	bool isEntityDependent() const
 	{
-		return _renderables.empty() && _renderablesWithoutEntity.empty();
+		return _glState.stage0 || _glState.stage1 || _glState.stage2 ||
+			   _glState.stage3 || _glState.stage4;
 	}
 
+	/**
+	 * \brief
+	 * Apply the state of this pass for rendering the renderables of the
+	 * given entity.
+	 *
+	 * \param current
+	 * The current OpenGL state variables.
+	 *
+	 * \param flagsMask
+	 * Mask of allowed render flags.
+	 *
+	 * \param viewer
+	 * Viewer location in world space.
+	 *
+	 * \return
+	 * false if the stages of this pass are not visible for this entity, its
+	 * renderables should be skipped in this case.
+	 */
+	bool setUpState(OpenGLState& current,
+					unsigned int flagsMask,
+					const Vector3& viewer,
+					std::size_t time,
+					const IRenderEntity* entity);
+
+	/**
+	 * Render the given queue entries, which belong to this pass and share
+	 * the state applied by setUpState() before.
+	 */
+	void renderEntries(const RenderQueue::Entry* begin,
+					   const RenderQueue::Entry* end,
+					   OpenGLState& current,
+					   const Vector3& viewer,
+					   std::size_t time);
+
 	friend std::ostream& operator<<(std::ostream& st, const OpenGLShaderPass& self);
 };
 
@@ -0,0 +1,219 @@
+#include "RenderQueue.h"
+
+#include "OpenGLShaderPass.h"
+#include "math/Matrix4.h"
+#include "render/RenderStatistics.h"
+
+#include <algorithm>
+
+namespace render
+{
+
+RenderQueue::RenderQueue() :
+	_lastEntity(NULL),
+	_lastEntityIndex(0)
+{}
+
+void RenderQueue::add(OpenGLShaderPass& pass,
+					  const OpenGLRenderable& renderable,
+					  const Matrix4& transform,
+					  const RendererLight* light,
+					  const IRenderEntity* entity)
+{
+	Entry entry;
+
+	entry.pass = &pass;
+	entry.renderable = &renderable;
+	entry.transform = &transform;
+	entry.light = light;
+	entry.entity = entity;
+	entry.entityIndex = getEntityIndex(entity);
+
+	_entries.push_back(entry);
+}
+
+boost::uint32_t RenderQueue::getEntityIndex(const IRenderEntity* entity)
+{
+	if (entity == NULL)
+	{
+		return 0;
+	}
+
+	if (entity != _lastEntity)
+	{
+		EntityIndices::const_iterator found = _entityIndices.find(entity);
+
+		if (found == _entityIndices.end())
+		{
+			boost::uint32_t index = static_cast<boost::uint32_t>(_entityIndices.size() + 1);
+			found = _entityIndices.insert(EntityIndices::value_type(entity, index)).first;
+		}
+
+		_lastEntity = entity;
+		_lastEntityIndex = found->second;
+	}
+
+	return _lastEntityIndex;
+}
+
+void RenderQueue::removePass(const OpenGLShaderPass& pass)
+{
+	std::vector<Entry>::iterator last = _entries.begin();
+
+	for (std::vector<Entry>::const_iterator i = _entries.begin(); i != _entries.end(); ++i)
+	{
+		if (i->pass != &pass)
+		{
+			*last++ = *i;
+		}
+	}
+
+	_entries.erase(last, _entries.end());
+}
+
+void RenderQueue::render(OpenGLState& current,
+						 unsigned int flagsMask,
+						 const Vector3& viewer,
+						 std::size_t time)
+{
+	if (_entries.empty())
+	{
+		return;
+	}
+
+	// Assign the keys, the entity numbers fill the lower half
+	_keys.resize(_entries.size());
+
+	for (std::size_t i = 0; i < _entries.size(); ++i)
+	{
+		_keys[i].key = (static_cast<boost::uint64_t>(_entries[i].pass->getSortIndex()) << 32) |
+					   _entries[i].entityIndex;
+		_keys[i].index = static_cast<boost::uint32_t>(i);
+	}
+
+	sortKeys();
+
+	// Bring the entries into key order, such that each group is contiguous
+	_sortedEntries.resize(_entries.size());
+
+	for (std::size_t i = 0; i < _keys.size(); ++i)
+	{
+		_sortedEntries[i] = _entries[_keys[i].index];
+	}
+
+	RenderStatistics& stats = RenderStatistics::Instance();
+
+	const Entry* entries = &_sortedEntries.front();
+	OpenGLShaderPass* currentPass = NULL;
+	bool active = true;
+
+	for (std::size_t groupStart = 0; groupStart < _keys.size(); /* in-loop */)
+	{
+		// Find the end of the group sharing the same key (pass and entity)
+		std::size_t groupEnd = groupStart + 1;
+
+		while (groupEnd < _keys.size() && _keys[groupEnd].key == _keys[groupStart].key)
+		{
+			++groupEnd;
+		}
+
+		OpenGLShaderPass& pass = *entries[groupStart].pass;
+
+		if (&pass != currentPass)
+		{
+			// Reset the texture matrix at the beginning of each pass
+			glMatrixMode(GL_TEXTURE);
+			glLoadMatrixd(Matrix4::getIdentity());
+
+			glMatrixMode(GL_MODELVIEW);
+
+			currentPass = &pass;
+
+			active = pass.setUpState(current, flagsMask, viewer, time, entries[groupStart].entity);
+			stats.increaseStates();
+		}
+		else if (pass.isEntityDependent())
+		{
+			// Same pass, but the stage expressions need to be evaluated for this entity
+			active = pass.setUpState(current, flagsMask, viewer, time, entries[groupStart].entity);
+			stats.increaseStates();
+		}
+		else
+		{
+			stats.increaseSkippedStates();
+		}
+
+		if (active)
+		{
+			pass.renderEntries(entries + groupStart, entries + groupEnd, current, viewer, time);
+		}
+
+		groupStart = groupEnd;
+	}
+
+	clear();
+}
+
+void RenderQueue::clear()
+{
+	_entries.clear();
+	_sortedEntries.clear();
+	_keys.clear();
+
+	_entityIndices.clear();
+	_lastEntity = NULL;
+	_lastEntityIndex = 0;
+}
+
+void RenderQueue::sortKeys()
+{
+	const std::size_t count = _keys.size();
+
+	_sortBuffer.resize(count);
+
+	SortItem* source = &_keys.front();
+	SortItem* target = &_sortBuffer.front();
+
+	std::size_t offsets[256];
+
+	for (unsigned int shift = 0; shift < 64; shift += 8)
+	{
+		std::fill(offsets, offsets + 256, 0);
+
+		for (std::size_t i = 0; i < count; ++i)
+		{
+			++offsets[(source[i].key >> shift) & 0xff];
+		}
+
+		// Skip this digit if all keys share it, which is the case for most
+		// of the upper bits of the pass and entity numbers
+		if (offsets[(source[0].key >> shift) & 0xff] == count)
+		{
+			continue;
+		}
+
+		std::size_t offset = 0;
+
+		for (std::size_t digit = 0; digit < 256; ++digit)
+		{
+			std::size_t digitCount = offsets[digit];
+			offsets[digit] = offset;
+			offset += digitCount;
+		}
+
+		// Stable scatter, keeps the submission order within equal keys
+		for (std::size_t i = 0; i < count; ++i)
+		{
+			target[offsets[(source[i].key >> shift) & 0xff]++] = source[i];
+		}
+
+		std::swap(source, target);
+	}
+
+	if (source != &_keys.front())
+	{
+		_keys.swap(_sortBuffer);
+	}
+}
+
+} // namespace render
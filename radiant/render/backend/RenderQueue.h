@@ -0,0 +1,106 @@
+#pragma once
+
+#include <vector>
+#include <unordered_map>
+#include <boost/cstdint.hpp>
+
+class Matrix4;
+class OpenGLRenderable;
+class OpenGLState;
+class RendererLight;
+class IRenderEntity;
+template<typename Element> class BasicVector3;
+typedef BasicVector3<double> Vector3;
+
+namespace render
+{
+
+class OpenGLShaderPass;
+
+/**
+ * \brief
+ * The renderables submitted to all shader passes of a RenderSystem during
+ * one frame.
+ *
+ * Each entry is assigned a 64 bit sort key made up of the position of its
+ * pass in the sorted OpenGL states (which already orders the passes by sort
+ * position, textures and render flags) and the order its entity has first
+ * been seen in. The keys are radix-sorted before rendering, which groups
+ * the entries by pass and entity. The pass state is only applied when the
+ * key changes, and not at all between entities if the pass doesn't have any
+ * stage expressions to evaluate.
+ */
+class RenderQueue
+{
+public:
+	// A transformed-and-lit renderable object
+	struct Entry
+	{
+		OpenGLShaderPass* pass;
+		const OpenGLRenderable* renderable;
+		const Matrix4* transform;
+		const RendererLight* light;
+		const IRenderEntity* entity;
+
+		// Entities are numbered in the order they are submitted, 0 is none
+		boost::uint32_t entityIndex;
+	};
+
+private:
+	std::vector<Entry> _entries;
+
+	// The entries in key order, filled by render()
+	std::vector<Entry> _sortedEntries;
+
+	struct SortItem
+	{
+		boost::uint64_t key;
+		boost::uint32_t index;
+	};
+	std::vector<SortItem> _keys;
+	std::vector<SortItem> _sortBuffer;
+
+	typedef std::unordered_map<const IRenderEntity*, boost::uint32_t> EntityIndices;
+	EntityIndices _entityIndices;
+
+	// Renderables of the same entity are usually submitted in a row
+	const IRenderEntity* _lastEntity;
+	boost::uint32_t _lastEntityIndex;
+
+public:
+	RenderQueue();
+
+	void add(OpenGLShaderPass& pass,
+			 const OpenGLRenderable& renderable,
+			 const Matrix4& transform,
+			 const RendererLight* light,
+			 const IRenderEntity* entity);
+
+	bool empty() const
+	{
+		return _entries.empty();
+	}
+
+	// Removes the entries of the given pass, which is about to be destroyed
+	void removePass(const OpenGLShaderPass& pass);
+
+	/**
+	 * Sorts and renders all entries, the queue is empty afterwards. The
+	 * passes need to have their sort index assigned.
+	 */
+	void render(OpenGLState& current,
+				unsigned int flagsMask,
+				const Vector3& viewer,
+				std::size_t time);
+
+	// Discards all entries
+	void clear();
+
+private:
+	boost::uint32_t getEntityIndex(const IRenderEntity* entity);
+
+	// Radix sort of the keys, 8 bits per round
+	void sortKeys();
+};
+
+} // namespace render
@@ -0,0 +1,129 @@
+#include "LevelOfDetail.h"
+
+#include "i18n.h"
+#include "ipreferencesystem.h"
+#include "ivolumetest.h"
+#include "entitylib.h"
+#include "math/AABB.h"
+#include "registry/CachedKey.h"
+
+#include <algorithm>
+#include <deque>
+#include <limits>
+
+namespace render
+{
+
+namespace
+{
+	// Draws a box in the current state, wireframe or filled
+	class BoundsProxy :
+		public OpenGLRenderable
+	{
+		AABB _bounds;
+
+	public:
+		BoundsProxy(const AABB& bounds) :
+			_bounds(bounds)
+		{}
+
+		void render(const RenderInfo& info) const
+		{
+			aabb_draw(_bounds, info.getFlags());
+		}
+	};
+
+	// A deque doesn't move its elements when growing
+	std::deque<BoundsProxy>& getProxyStorage()
+	{
+		static std::deque<BoundsProxy> _proxies;
+		return _proxies;
+	}
+}
+
+LevelOfDetail::LevelOfDetail(const VolumeTest& view, bool useLevelOfDetail) :
+	_worldToScreen(view.GetViewport().getMultipliedBy(view.GetProjection()).getMultipliedBy(view.GetModelview()))
+{
+	// The settings are queried for every collected object
+	static registry::CachedKey<bool> enabled(RKEY_LOD_ENABLED);
+	static registry::CachedKey<float> cullSize(RKEY_LOD_CULL_SIZE);
+	static registry::CachedKey<float> coarseSize(RKEY_LOD_COARSE_SIZE);
+
+	_enabled = useLevelOfDetail && enabled.get();
+	_cullSize = cullSize.get();
+	_coarseSize = coarseSize.get();
+}
+
+LevelOfDetail::Level LevelOfDetail::getLevel(const AABB& bounds) const
+{
+	// Objects without valid bounds (e.g. empty entities) are not measured
+	if (!_enabled || !bounds.isValid())
+	{
+		return FULL;
+	}
+
+	double size = getProjectedSize(bounds);
+
+	if (size < _cullSize)
+	{
+		return CULLED;
+	}
+
+	return size < _coarseSize ? COARSE : FULL;
+}
+
+double LevelOfDetail::getProjectedSize(const AABB& bounds) const
+{
+	Vector3 corners[8];
+	bounds.getCorners(corners);
+
+	double minX = std::numeric_limits<double>::max();
+	double maxX = -minX;
+	double minY = minX;
+	double maxY = -minX;
+
+	for (std::size_t i = 0; i < 8; ++i)
+	{
+		Vector4 clip = _worldToScreen.transform(Vector4(corners[i], 1));
+
+		if (clip.w() <= 0)
+		{
+			return std::numeric_limits<double>::max();
+		}
+
+		double x = clip.x() / clip.w();
+		double y = clip.y() / clip.w();
+
+		minX = std::min(minX, x);
+		maxX = std::max(maxX, x);
+		minY = std::min(minY, y);
+		maxY = std::max(maxY, y);
+	}
+
+	return std::max(maxX - minX, maxY - minY);
+}
+
+const OpenGLRenderable& LevelOfDetail::getBoundsProxy(const AABB& bounds)
+{
+	std::deque<BoundsProxy>& proxies = getProxyStorage();
+
+	proxies.push_back(BoundsProxy(bounds));
+
+	return proxies.back();
+}
+
+void LevelOfDetail::clearProxies()
+{
+	getProxyStorage().clear();
+}
+
+void LevelOfDetail::constructPreferences()
+{
+	PreferencesPagePtr page = GlobalPreferenceSystem().getPage(_("Settings/Level of Detail"));
+
+	page->appendCheckBox("", _("Simplify or skip objects covering only a few pixels"), RKEY_LOD_ENABLED);
+	page->appendSpinner(_("Skip objects smaller than (pixels)"), RKEY_LOD_CULL_SIZE, 0, 64, 1);
+	page->appendSpinner(_("Simplify objects smaller than (pixels)"), RKEY_LOD_COARSE_SIZE, 0, 256, 1);
+}
+
+} // namespace render
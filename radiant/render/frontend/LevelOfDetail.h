@@ -0,0 +1,80 @@
+#pragma once
+
+#include "irender.h"
+#include "math/Matrix4.h"
+
+class AABB;
+class VolumeTest;
+
+namespace render
+{
+
+const std::string RKEY_LOD_ROOT = "user/ui/levelOfDetail";
+const std::string RKEY_LOD_ENABLED = RKEY_LOD_ROOT + "/enabled";
+const std::string RKEY_LOD_CULL_SIZE = RKEY_LOD_ROOT + "/cullSize";
+const std::string RKEY_LOD_COARSE_SIZE = RKEY_LOD_ROOT + "/coarseSize";
+
+/**
+ * \brief
+ * Screen-space size based level of detail for the render front-end.
+ *
+ * An object is measured by the size of the screen rectangle its world bounds
+ * are projected to. Below the configurable cull size (in pixels) it is not
+ * submitted at all, below the coarse size it is drawn simplified: models are
+ * replaced by their bounding box, patches use a coarser wireframe.
+ */
+class LevelOfDetail
+{
+public:
+	enum Level
+	{
+		FULL,	// drawn as usual
+		COARSE,	// drawn simplified
+		CULLED,	// too small to be drawn
+	};
+
+private:
+	// Maps world coordinates to window coordinates
+	Matrix4 _worldToScreen;
+
+	bool _enabled;
+	double _cullSize;
+	double _coarseSize;
+
+public:
+	/**
+	 * Construct for the given view. If useLevelOfDetail is FALSE or the level
+	 * of detail is disabled in the preferences, all objects are drawn fully.
+	 */
+	LevelOfDetail(const VolumeTest& view, bool useLevelOfDetail = true);
+
+	bool isEnabled() const
+	{
+		return _enabled;
+	}
+
+	// Returns the level of detail for the given world bounds
+	Level getLevel(const AABB& bounds) const;
+
+	/**
+	 * Returns the larger side of the screen rectangle covered by the given
+	 * world bounds in pixels. Bounds crossing the eye plane are assumed to
+	 * cover the whole screen.
+	 */
+	double getProjectedSize(const AABB& bounds) const;
+
+	/**
+	 * Returns a renderable drawing the given bounds as box. The renderables
+	 * are kept until clearProxies() is called at the beginning of the next
+	 * scene collection.
+	 */
+	static const OpenGLRenderable& getBoundsProxy(const AABB& bounds);
+
+	// Releases the proxies created while collecting the previous frame
+	static void clearProxies();
+
+	// Adds the level of detail settings to the preferences
+	static void constructPreferences();
+};
+
+} // namespace render
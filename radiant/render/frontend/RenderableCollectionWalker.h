@@ -4,7 +4,15 @@
 #include "ientity.h"
 #include "ieclass.h"
 #include "iscenegraph.h"
+#include "ivolumetest.h"
+#include "iselectable.h"
+#include "math/AABB.h"
+#include "TransformPreviewCollector.h"
+#include "LevelOfDetail.h"
+#include "render/RenderStatistics.h"
+#include <vector>
 #include <boost/bind.hpp>
+#include <boost/function.hpp>
 
 namespace render
 {
@@ -17,44 +25,170 @@ namespace render
  * Also provides support for highlighting selected objects by activating the
  * RenderableCollector's "highlight" flags based on the renderable object's
  * selection state.
+ *
+ * While the SelectionSystem provides a transform preview, the selected nodes
+ * are skipped during the scenegraph walk. They are collected afterwards with
+ * the preview transform applied, since their bounds in the scenegraph are not
+ * matching their pending position.
+ *
+ * Nodes which are small on the screen are skipped or drawn simplified, see
+ * LevelOfDetail. Highlighted nodes are always drawn fully.
  */
 class RenderableCollectionWalker :
     public scene::Graph::Walker
 {
+public:
+    // Additional culling test, returns false for nodes which are not visible
+    typedef boost::function<bool (const scene::INodePtr&)> NodeFilter;
+
+private:
     // The collector which is sorting our renderables
     RenderableCollector& _collector;
 
     // The view we're using for culling
     const VolumeTest& _volume;
 
+    NodeFilter _filter;
+
+    // The pending transform of the selected nodes, NULL if there is none
+    const Matrix4* _preview;
+
+    LevelOfDetail _lod;
+
+    // Nodes skipped for being too small on the screen
+    std::size_t _numCulled;
+
 private:
 
     // Construct with RenderableCollector to receive renderables
     RenderableCollectionWalker(RenderableCollector& collector,
-                               const VolumeTest& volume)
-    : _collector(collector), _volume(volume)
+                               const VolumeTest& volume,
+                               const NodeFilter& filter = NodeFilter(),
+                               bool useLevelOfDetail = true)
+    : _collector(collector), _volume(volume), _filter(filter),
+      _preview(GlobalSelectionSystem().getTransformPreview()),
+      _lod(volume, useLevelOfDetail),
+      _numCulled(0)
     {}
 
-    void render(const Renderable& renderable) const
+    void render(const Renderable& renderable, RenderableCollector& collector) const
     {
-        if (_collector.supportsFullMaterials())
-            renderable.renderSolid(_collector, _volume);
+        if (collector.supportsFullMaterials())
+            renderable.renderSolid(collector, _volume);
         else
-            renderable.renderWireframe(_collector, _volume);
+            renderable.renderWireframe(collector, _volume);
     }
 
     RenderableCallback getRenderableCallback()
     {
-        return boost::bind(&RenderableCollectionWalker::render, this, _1);
+        return boost::bind(&RenderableCollectionWalker::render, this, _1,
+                           boost::ref(_collector));
     }
 
-public:
+    // Nodes which are displayed using the transform preview
+    static bool isPreviewed(const scene::INodePtr& node)
+    {
+        if (Node_isSelected(node))
+        {
+            return true;
+        }
 
-    // scene::Graph::Walker implementation
-    bool visit(const scene::INodePtr& node)
+        scene::INodePtr parent = node->getParent();
+
+        return parent && Node_isSelected(parent);
+    }
+
+    void collectPreviewedNode(const scene::INodePtr& node,
+                              RenderableCollector& collector)
+    {
+        if (!node->visible() ||
+            _volume.TestAABB(AABB::createFromOrientedAABBSafe(node->worldAABB(), *_preview)) == VOLUME_OUTSIDE)
+        {
+            return;
+        }
+
+        collect(node, collector);
+    }
+
+    // Submits the selected nodes and their children at their pending position
+    void collectPreviewedNodes()
     {
+        TransformPreviewCollector collector(_collector, *_preview);
+
+        GlobalSelectionSystem().foreachSelected([&] (const scene::INodePtr& node)
+        {
+            collectPreviewedNode(node, collector);
+
+            node->foreachNode([&] (const scene::INodePtr& child)
+            {
+                // Selected children are visited on their own
+                if (!Node_isSelected(child))
+                {
+                    collectPreviewedNode(child, collector);
+                }
+
+                return true;
+            });
+        });
+    }
+
+    // Returns FALSE if the node has been culled or drawn as proxy
+    bool applyLevelOfDetail(const scene::INodePtr& node)
+    {
+        if (!_lod.isEnabled() || isHighlighted(node))
+        {
+            return true;
+        }
+
+        switch (_lod.getLevel(node->worldAABB()))
+        {
+        case LevelOfDetail::CULLED:
+            RenderStatistics::Instance().increaseCulled();
+            ++_numCulled;
+            return false;
+
+        case LevelOfDetail::COARSE:
+            // Patches select their coarse wireframe themselves
+            if (node->getNodeType() == scene::INode::Type::Model)
+            {
+                collectProxy(node);
+                return false;
+            }
+            return true;
+
+        default:
+            return true;
+        }
+    }
+
+    // Submits the bounding box of the node in the colour of its entity
+    void collectProxy(const scene::INodePtr& node)
+    {
+        const IRenderEntityPtr& renderEntity = node->getRenderEntity();
+
+        if (!renderEntity)
+        {
+            collect(node, _collector);
+            return;
+        }
+
         _collector.PushState();
 
+        _collector.SetState(renderEntity->getWireShader(), RenderableCollector::eWireframeOnly);
+        _collector.SetState(renderEntity->getWireShader(), RenderableCollector::eFullMaterials);
+
+        _collector.addRenderable(LevelOfDetail::getBoundsProxy(node->worldAABB()),
+                                 Matrix4::getIdentity());
+
+        _collector.PopState();
+
+        RenderStatistics::Instance().increaseCoarse();
+    }
+
+    void collect(const scene::INodePtr& node, RenderableCollector& collector)
+    {
+        collector.PushState();
+
         // greebo: Fix for primitive nodes: as we don't traverse the scenegraph
         // nodes top-down anymore, we need to set the shader state of our
         // parent entity ourselves.  Otherwise we're in for NULL-states when
@@ -71,29 +205,60 @@ public:
 
             if (renderEntity)
             {
-                _collector.SetState(renderEntity->getWireShader(), RenderableCollector::eWireframeOnly);
+                collector.SetState(renderEntity->getWireShader(), RenderableCollector::eWireframeOnly);
             }
         }
 
         node->viewChanged();
 
-        if (node->isHighlighted() || (parent != NULL && parent->isHighlighted()))
+        if (isHighlighted(node))
         {
             if (GlobalSelectionSystem().Mode() != SelectionSystem::eComponent)
             {
-                _collector.highlightFaces(true);
+                collector.highlightFaces(true);
             }
             else
             {
-                node->renderComponents(_collector, _volume);
+                node->renderComponents(collector, _volume);
             }
 
-            _collector.highlightPrimitives(true);
+            collector.highlightPrimitives(true);
         }
 
-        render(*node);
+        render(*node, collector);
 
-        _collector.PopState();
+        collector.PopState();
+    }
+
+public:
+
+    // TRUE if the node or its parent is highlighted (selected)
+    static bool isHighlighted(const scene::INodePtr& node)
+    {
+        scene::INodePtr parent = node->getParent();
+
+        return node->isHighlighted() || (parent != NULL && parent->isHighlighted());
+    }
+
+    // scene::Graph::Walker implementation
+    bool visit(const scene::INodePtr& node)
+    {
+        if (_filter && !_filter(node))
+        {
+            return true; // culled, continue with the next node
+        }
+
+        if (_preview != NULL && isPreviewed(node))
+        {
+            return true; // collected at their pending position
+        }
+
+        if (!applyLevelOfDetail(node))
+        {
+            return true; // too small to be drawn fully
+        }
+
+        collect(node, _collector);
 
         return true;
     }
@@ -101,19 +266,80 @@ public:
     /**
      * \brief
      * Use a RenderableCollectionWalker to find all renderables in the global
-     * scenegraph.
+     * scenegraph. Scene nodes rejected by the optional filter are skipped.
+     * Returns the number of nodes culled by the level of detail.
      */
-    static void collectRenderablesInScene(RenderableCollector& collector,
-                                          const VolumeTest& volume)
+    static std::size_t collectRenderablesInScene(RenderableCollector& collector,
+                                                 const VolumeTest& volume,
+                                                 const NodeFilter& filter = NodeFilter())
     {
-        // Instantiate a new walker class
-        RenderableCollectionWalker renderHighlightWalker(collector, volume);
-
         // Submit renderables from scene graph
+        std::size_t numCulled = collectRenderablesInGraph(collector, volume, filter);
+
+        // Submit renderables directly attached to the ShaderCache
+        collectRenderSystemRenderables(collector, volume);
+
+        return numCulled;
+    }
+
+    /**
+     * \brief
+     * Submit the renderables of the scenegraph nodes in the given volume,
+     * without the ones attached to the RenderSystem. Pass FALSE for
+     * useLevelOfDetail if the renderables are not meant for the current view
+     * only. Returns the number of nodes culled by the level of detail.
+     */
+    static std::size_t collectRenderablesInGraph(RenderableCollector& collector,
+                                                 const VolumeTest& volume,
+                                                 const NodeFilter& filter = NodeFilter(),
+                                                 bool useLevelOfDetail = true)
+    {
+        RenderableCollectionWalker renderHighlightWalker(collector, volume, filter,
+                                                         useLevelOfDetail);
+
+        // The matrices and proxies of the previous frame have been drawn by now
+        TransformPreviewCollector::clearTransforms();
+        LevelOfDetail::clearProxies();
+
         GlobalSceneGraph().foreachVisibleNodeInVolume(volume,
                                                       renderHighlightWalker);
 
-        // Submit renderables directly attached to the ShaderCache
+        if (renderHighlightWalker._preview != NULL)
+        {
+            renderHighlightWalker.collectPreviewedNodes();
+        }
+
+        return renderHighlightWalker._numCulled;
+    }
+
+    /**
+     * \brief
+     * Submit the renderables of the given scene nodes only, nodes outside
+     * the volume or rejected by the filter are skipped.
+     */
+    static void collectRenderablesForNodes(RenderableCollector& collector,
+                                           const VolumeTest& volume,
+                                           const std::vector<scene::INodePtr>& nodes,
+                                           const NodeFilter& filter = NodeFilter())
+    {
+        RenderableCollectionWalker walker(collector, volume, filter);
+
+        LevelOfDetail::clearProxies();
+
+        for (std::vector<scene::INodePtr>::const_iterator i = nodes.begin();
+             i != nodes.end(); ++i)
+        {
+            if (volume.TestAABB((*i)->worldAABB()) != VOLUME_OUTSIDE)
+            {
+                walker.visit(*i);
+            }
+        }
+    }
+
+    /// Submit the renderables directly attached to the RenderSystem
+    static void collectRenderSystemRenderables(RenderableCollector& collector,
+                                               const VolumeTest& volume)
+    {
         RenderableCollectionWalker walker(collector, volume);
         GlobalRenderSystem().forEachRenderable(walker.getRenderableCallback());
     }
@@ -0,0 +1,96 @@
+#include "TransformPreviewCollector.h"
+
+#include "render/RenderStatistics.h"
+
+#include <deque>
+
+namespace render
+{
+
+namespace
+{
+	// A deque doesn't move its elements when growing
+	std::deque<Matrix4>& getTransformStorage()
+	{
+		static std::deque<Matrix4> _transforms;
+		return _transforms;
+	}
+}
+
+TransformPreviewCollector::TransformPreviewCollector(RenderableCollector& collector,
+													 const Matrix4& transform) :
+	_collector(collector),
+	_transform(transform)
+{}
+
+void TransformPreviewCollector::clearTransforms()
+{
+	getTransformStorage().clear();
+}
+
+void TransformPreviewCollector::PushState()
+{
+	_collector.PushState();
+}
+
+void TransformPreviewCollector::PopState()
+{
+	_collector.PopState();
+}
+
+void TransformPreviewCollector::SetState(const ShaderPtr& state, EStyle mode)
+{
+	_collector.SetState(state, mode);
+}
+
+void TransformPreviewCollector::addRenderable(const OpenGLRenderable& renderable,
+											  const Matrix4& world)
+{
+	_collector.addRenderable(renderable, getPreviewTransform(world));
+}
+
+void TransformPreviewCollector::addRenderable(const OpenGLRenderable& renderable,
+											  const Matrix4& world,
+											  const IRenderEntity& entity)
+{
+	_collector.addRenderable(renderable, getPreviewTransform(world), entity);
+}
+
+bool TransformPreviewCollector::supportsFullMaterials() const
+{
+	return _collector.supportsFullMaterials();
+}
+
+void TransformPreviewCollector::highlightFaces(bool enable)
+{
+	_collector.highlightFaces(enable);
+}
+
+void TransformPreviewCollector::highlightPrimitives(bool enable)
+{
+	_collector.highlightPrimitives(enable);
+}
+
+void TransformPreviewCollector::setLights(const LightList& lights)
+{
+	_collector.setLights(lights);
+}
+
+const Matrix4& TransformPreviewCollector::getPreviewTransform(const Matrix4& world)
+{
+	RenderStatistics::Instance().increasePreviewed();
+
+	// Brushes and patches are submitted in world space, share the preview matrix
+	if (world == Matrix4::getIdentity())
+	{
+		return _transform;
+	}
+
+	std::deque<Matrix4>& transforms = getTransformStorage();
+
+	transforms.push_back(_transform.getMultipliedBy(world));
+
+	return transforms.back();
+}
+
+} // namespace render
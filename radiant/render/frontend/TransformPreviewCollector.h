@@ -0,0 +1,54 @@
+#pragma once
+
+#include "irenderable.h"
+#include "math/Matrix4.h"
+
+namespace render
+{
+
+/**
+ * \brief
+ * RenderableCollector forwarding all renderables to another collector, with
+ * their local to world transform premultiplied by a preview transform.
+ *
+ * This is used to display the selection at its pending position while a
+ * manipulator is dragged, without changing the nodes themselves. The
+ * combined matrices are referenced by the backend until the renderables have
+ * been drawn, they are kept until clearTransforms() is called at the
+ * beginning of the next scene collection.
+ */
+class TransformPreviewCollector :
+	public RenderableCollector
+{
+	RenderableCollector& _collector;
+
+	const Matrix4& _transform;
+
+public:
+	TransformPreviewCollector(RenderableCollector& collector, const Matrix4& transform);
+
+	// Releases the matrices allocated while collecting the previous frame
+	static void clearTransforms();
+
+	// RenderableCollector implementation
+	void PushState();
+	void PopState();
+	void SetState(const ShaderPtr& state, EStyle mode);
+
+	void addRenderable(const OpenGLRenderable& renderable,
+					   const Matrix4& world);
+	void addRenderable(const OpenGLRenderable& renderable,
+					   const Matrix4& world,
+					   const IRenderEntity& entity);
+
+	bool supportsFullMaterials() const;
+	void highlightFaces(bool enable);
+	void highlightPrimitives(bool enable);
+	void setLights(const LightList& lights);
+
+private:
+	// Returns the preview transform concatenated with the given one
+	const Matrix4& getPreviewTransform(const Matrix4& world);
+};
+
+} // namespace render
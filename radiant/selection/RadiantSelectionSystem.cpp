@@ -6,6 +6,7 @@
 #include "igrid.h"
 #include "iradiant.h"
 #include "ieventmanager.h"
+#include "itrace.h"
 #include "editable.h"
 #include "Selectors.h"
 #include "SelectionTest.h"
@@ -18,12 +19,17 @@
 #include "selection/algorithm/General.h"
 
 #include <boost/bind.hpp>
+#include <glibmm/main.h>
 
 // Initialise the shader pointer
 ShaderPtr RadiantSelectionSystem::_state;
 
     namespace {
         const std::string RKEY_ROTATION_PIVOT = "user/ui/rotationPivotIsOrigin";
+        const std::string RKEY_TRANSFORM_PREVIEW = "user/ui/transformPreview";
+
+        // The time a drag needs to be paused until the nodes are updated
+        const unsigned int TRANSFORM_PREVIEW_DELAY_MSEC = 300;
     }
 
 // ------------ Helper Functions --------------------------------------------
@@ -68,7 +74,9 @@ RadiantSelectionSystem::RadiantSelectionSystem() :
     _rotateManipulator(*this, 8, 64),
     _scaleManipulator(*this, 0, 64),
     _pivotChanged(false),
-    _pivotMoving(false)
+    _pivotMoving(false),
+    _transformPreview(false),
+    _transformPreviewPending(false)
 {}
 
 const SelectionInfo& RadiantSelectionSystem::getSelectionInfo() {
@@ -526,6 +534,8 @@ bool RadiantSelectionSystem::SelectManipulator(const render::View& view, const V
             _deviceStart = Vector2(device_point[0], device_point[1]);
 
             _undoBegun = false;
+
+            beginTransformPreview();
         }
 
         SceneChangeNotify();
@@ -709,7 +719,10 @@ void RadiantSelectionSystem::translate(const Vector3& translation) {
         _pivot2world.translateBy(translation);
 
         // Call the according scene graph traversors and pass the translation vector
-        if (Mode() == eComponent) {
+        if (_transformPreview) {
+            setTransformPreview(Matrix4::getTranslation(_translation));
+        }
+        else if (Mode() == eComponent) {
             Scene_Translate_Component_Selected(GlobalSceneGraph(), _translation);
         }
         else {
@@ -729,7 +742,21 @@ void RadiantSelectionSystem::rotate(const Quaternion& rotation) {
         _rotation = rotation;
 
         // Perform the rotation according to the current mode
-        if (Mode() == eComponent) {
+        if (_transformPreview) {
+            // Rotate about the pivot point, like the RotateSelected walker does
+            Vector3 pivot = _pivot2world.t().getVector3();
+
+            Matrix4 transform = Matrix4::getTranslation(pivot);
+            transform.multiplyBy(Matrix4::getRotation(_rotation));
+            transform.translateBy(-pivot);
+
+            setTransformPreview(transform);
+
+            // The ultimate node is not rotated yet, add the pending rotation
+            matrix4_assign_rotation_for_pivot(_pivot2world, _selection.ultimate());
+            matrix4_assign_rotation(_pivot2world, _pendingTransform.getMultipliedBy(_pivot2world));
+        }
+        else if (Mode() == eComponent) {
             Scene_Rotate_Component_Selected(GlobalSceneGraph(), _rotation, _pivot2world.t().getVector3());
 
             matrix4_assign_rotation_for_pivot(_pivot2world, _componentSelection.ultimate());
@@ -884,6 +911,9 @@ void RadiantSelectionSystem::cancelMove() {
     // Unselect any currently selected manipulators to be sure
     _manipulator->setSelected(false);
 
+    // Nothing of the pending transform needs to be applied anymore
+    endTransformPreview();
+
     // Tell all the scene objects to revert their transformations
 	foreachSelected([] (const scene::INodePtr& node)
 	{
@@ -929,6 +959,10 @@ void RadiantSelectionSystem::freezeTransforms()
 
 // End the move, this freezes the current transforms
 void RadiantSelectionSystem::endMove() {
+    // Move the nodes to the position they have been previewed at
+    applyTransformPreview();
+    endTransformPreview();
+
     freezeTransforms();
 
     // greebo: Deselect all faces if we are in brush and drag mode
@@ -976,6 +1010,89 @@ void RadiantSelectionSystem::endMove() {
     }
 }
 
+const Matrix4* RadiantSelectionSystem::getTransformPreview() const
+{
+    return _transformPreviewPending ? &_pendingTransform : NULL;
+}
+
+void RadiantSelectionSystem::beginTransformPreview()
+{
+    // Scaling entities doesn't scale their models, a preview would differ
+    // from the result. Components are rendered by the nodes themselves.
+    _transformPreview = registry::getValue<bool>(RKEY_TRANSFORM_PREVIEW) &&
+        Mode() != eComponent &&
+        (ManipulatorMode() == eTranslate || ManipulatorMode() == eRotate);
+
+    _transformPreviewPending = false;
+
+    _previewTransform = Matrix4::getIdentity();
+    _appliedTransform = Matrix4::getIdentity();
+    _pendingTransform = Matrix4::getIdentity();
+
+    _translation = Vector3(0, 0, 0);
+    _rotation = Quaternion::Identity();
+}
+
+void RadiantSelectionSystem::setTransformPreview(const Matrix4& transform)
+{
+    _previewTransform = transform;
+
+    // The nodes might have been moved to an earlier step already
+    _pendingTransform = _previewTransform.getMultipliedBy(_appliedTransform.getFullInverse());
+    _transformPreviewPending = true;
+
+    // Restart the timer, the nodes are updated when the mouse comes to rest
+    _previewTimer.disconnect();
+    _previewTimer = Glib::signal_timeout().connect(
+        sigc::mem_fun(*this, &RadiantSelectionSystem::onTransformPreviewTimer),
+        TRANSFORM_PREVIEW_DELAY_MSEC
+    );
+}
+
+void RadiantSelectionSystem::applyTransformPreview()
+{
+    if (!_transformPreviewPending)
+    {
+        return;
+    }
+
+    trace::ScopedZone zone("selection", "applyTransformPreview");
+
+    // The transformables are holding a transform relative to the start of
+    // the drag, no matter how often they have been updated in between
+    if (ManipulatorMode() == eRotate)
+    {
+        Scene_Rotate_Selected(GlobalSceneGraph(), _rotation, _pivot2world.t().getVector3());
+    }
+    else
+    {
+        Scene_Translate_Selected(GlobalSceneGraph(), _translation);
+    }
+
+    _appliedTransform = _previewTransform;
+    _pendingTransform = Matrix4::getIdentity();
+    _transformPreviewPending = false;
+}
+
+bool RadiantSelectionSystem::onTransformPreviewTimer()
+{
+    applyTransformPreview();
+
+    // Draw the exact geometry
+    SceneChangeNotify();
+
+    return false; // disconnect
+}
+
+void RadiantSelectionSystem::endTransformPreview()
+{
+    _previewTimer.disconnect();
+
+    _transformPreview = false;
+    _transformPreviewPending = false;
+    _pendingTransform = Matrix4::getIdentity();
+}
+
 const selection::WorkZone& RadiantSelectionSystem::getWorkZone()
 {
     // Flush any pending idle callbacks, we need the workzone now
@@ -1180,6 +1297,8 @@ void RadiantSelectionSystem::shutdownModule()
     setSelectedAll(false);
     setSelectedAllComponents(false);
 
+    _previewTimer.disconnect();
+
     GlobalRenderSystem().detachRenderable(*this);
 
     destroyStatic();
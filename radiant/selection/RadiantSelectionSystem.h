@@ -17,6 +17,7 @@
 #include "ClipManipulator.h"
 #include "Selectors.h"
 #include "SelectedNodeList.h"
+#include <sigc++/connection.h>
 
 /* greebo: This can be tricky to understand (and I don't know if I do :D), but
  * I'll try:
@@ -120,6 +121,24 @@ private:
 	// The coordinates of the mouse pointer when the manipulation starts
 	Vector2 _deviceStart;
 
+	// TRUE if the current drag is displayed with a transform preview instead
+	// of updating the selected nodes in each step
+	bool _transformPreview;
+
+	// TRUE if the nodes haven't been transformed to the current position yet
+	bool _transformPreviewPending;
+
+	// The transform of the current drag step and the one which has been
+	// applied to the nodes so far, both relative to the start of the drag
+	Matrix4 _previewTransform;
+	Matrix4 _appliedTransform;
+
+	// The difference between the two above, used to render the selection
+	Matrix4 _pendingTransform;
+
+	// Applies the pending transform once the drag has been paused
+	sigc::connection _previewTimer;
+
 	bool nothingSelected() const;
 
 	void keyChanged();
@@ -208,6 +227,8 @@ public:
 	void endMove();
 	void freezeTransforms();
 
+	const Matrix4* getTransformPreview() const;
+
 	const selection::WorkZone& getWorkZone();
 
 	void renderSolid(RenderableCollector& collector, const VolumeTest& volume) const;
@@ -244,6 +265,18 @@ protected:
 private:
 	void notifyObservers(const scene::INodePtr& node, bool isComponent);
 
+	// Decides whether the drag which is about to start is using a transform preview
+	void beginTransformPreview();
+
+	// Sets the transform of the current drag step, relative to the start of the drag
+	void setTransformPreview(const Matrix4& transform);
+
+	// Moves the selected nodes to the position displayed by the preview
+	void applyTransformPreview();
+	bool onTransformPreviewTimer();
+
+	void endTransformPreview();
+
 	// Command targets used to connect to the event system
 	void toggleDefaultManipulatorMode(bool newState);
 	void toggleDragManipulatorMode(bool newState);
@@ -718,8 +718,7 @@ void snapSelectionToGrid(const cmd::ArgumentList& args)
 	}
 }
 
-class IntersectionFinder : 
-	public scene::NodeVisitor
+class IntersectionFinder
 {
 private:
 	const Ray& _ray;
@@ -740,40 +739,33 @@ public:
 		return _bestPoint;
 	}
 
-	bool pre(const scene::INodePtr& node)
+	// Invoked for each visible node whose bounds are hit by the ray
+	bool visit(const scene::INodePtr& node)
 	{
-		if (node == _self) return false;
-		if (!node->visible()) return true;
+		// Ignore the node itself and all of its children
+		for (scene::INodePtr n = node; n; n = n->getParent())
+		{
+			if (n == _self) return true;
+		}
 
-		const AABB& aabb = node->worldAABB();
 		Vector3 intersection;
 
-		if (_ray.intersectAABB(aabb, intersection))
-		{
-			rMessage() << "Ray intersects with node " << node->name() << " at " << intersection;
+		// Attempt a full trace against the object
+		ITraceablePtr traceable = boost::dynamic_pointer_cast<ITraceable>(node);
 
-			// We have an intersection, let's attempt a full trace against the object
-			ITraceablePtr traceable = boost::dynamic_pointer_cast<ITraceable>(node);
-
-			if (traceable && traceable->getIntersection(_ray, intersection))
-			{
-				rMessage() << " impacting at " << intersection;
-			}
-			else
-			{
-				// rMessage() << " (no detailed intersection)";
-				return true; // ignore this node
-			}
+		if (!traceable || !traceable->getIntersection(_ray, intersection))
+		{
+			return true; // ignore this node
+		}
 
-			float oldDistSquared = (_bestPoint - _ray.origin).getLengthSquared();
-			float newDistSquared = (intersection - _ray.origin).getLengthSquared();
+		rMessage() << "Ray intersects with node " << node->name() << " impacting at " << intersection << std::endl;
 
-			if ((oldDistSquared == 0 && newDistSquared > 0) || newDistSquared < oldDistSquared)
-			{
-				_bestPoint = intersection;
-			}
+		float oldDistSquared = (_bestPoint - _ray.origin).getLengthSquared();
+		float newDistSquared = (intersection - _ray.origin).getLengthSquared();
 
-			rMessage() << std::endl;
+		if ((oldDistSquared == 0 && newDistSquared > 0) || newDistSquared < oldDistSquared)
+		{
+			_bestPoint = intersection;
 		}
 
 		return true;
@@ -859,7 +851,12 @@ void floorNode(const scene::INodePtr& node)
 	Ray ray(objectOrigin + Vector3(0, 0, 1), Vector3(0, 0, -1));
 
 	IntersectionFinder finder(ray, node);
-	GlobalSceneGraph().root()->traverseChildren(finder);
+
+	// Only nodes whose bounds are hit by the ray are considered
+	GlobalSceneGraph().foreachVisibleNodeAlongRay(ray, [&] (const scene::INodePtr& candidate)
+	{
+		return finder.visit(candidate);
+	});
 
 	if ((finder.getIntersection() - ray.origin).getLengthSquared() > 0)
 	{
@@ -13,7 +13,9 @@
 #include "modulesystem/StaticModule.h"
 #include "selection/algorithm/General.h"
 #include "camera/GlobalCamera.h"
+#include "render/frontend/LevelOfDetail.h"
 #include <boost/bind.hpp>
+#include <boost/format.hpp>
 
 namespace
 {
@@ -184,6 +186,9 @@ void XYWndManager::constructPreferences()
 	page->appendCheckBox("", _("Show Workzone"), RKEY_SHOW_WORKZONE);
 	page->appendCheckBox("", _("Translate Manipulator always constrained to Axis"), RKEY_TRANSLATE_CONSTRAINED);
 	page->appendCheckBox("", _("Higher Selection Priority for Entities"), RKEY_HIGHER_ENTITY_PRIORITY);
+
+	// The level of detail applies to the camera view as well
+	render::LevelOfDetail::constructPreferences();
 }
 
 // Load/Reload the values from the registry
@@ -261,6 +266,37 @@ void XYWndManager::updateAllViews() {
 	}
 }
 
+void XYWndManager::setDrawTime(int id, unsigned int msec, std::size_t culled)
+{
+	DrawStatistics& stats = _drawTimes[id];
+
+	stats.msec = msec;
+	stats.culled = culled;
+
+	unsigned int totalMsec = 0;
+	std::size_t totalCulled = 0;
+
+	for (DrawTimes::const_iterator i = _drawTimes.begin(); i != _drawTimes.end(); ++i)
+	{
+		totalMsec += i->second.msec;
+		totalCulled += i->second.culled;
+	}
+
+	std::string text = (boost::format(_("Ortho: %d msec")) % totalMsec).str();
+
+	if (totalCulled > 0)
+	{
+		text += (boost::format(_(", %d culled")) % totalCulled).str();
+	}
+
+	// Don't make the status bar re-layout after each frame
+	if (text != _drawTimeText)
+	{
+		_drawTimeText = text;
+		GlobalUIManager().getStatusBarManager().setText("XYDrawTime", text);
+	}
+}
+
 void XYWndManager::zoomIn(const cmd::ArgumentList& args) {
 	if (_activeXY != NULL) {
 		_activeXY->zoomIn();
@@ -430,6 +466,8 @@ void XYWndManager::destroyXYWnd(int id)
 		_xyWnds.erase(found);
 	}
 
+	_drawTimes.erase(id);
+
 	// Also check if the activeXY is holding a strong reference of the XYWnd
 	// which prevents destruction - release the shared_ptr
 	if (_activeXY != NULL && _activeXY->getId() == id)
@@ -606,6 +644,12 @@ void XYWndManager::initialiseModule(const ApplicationContext& ctx)
 		IStatusBarManager::POS_POSITION
 	);
 
+	GlobalUIManager().getStatusBarManager().addTextElement(
+		"XYDrawTime",
+		"",  // no icon
+		IStatusBarManager::POS_POSITION + 1
+	);
+
 	XYWnd::captureStates();
 }
 
@@ -37,6 +37,19 @@ class XYWndManager : public IXWndManager
 
 	unsigned int _defaultBlockSize;
 
+	// The time the last draw() of each view took and the number of objects
+	// culled by the level of detail, by view ID
+	struct DrawStatistics
+	{
+		unsigned int msec;
+		std::size_t culled;
+	};
+	typedef std::map<int, DrawStatistics> DrawTimes;
+	DrawTimes _drawTimes;
+
+	// The draw time text currently displayed in the status bar
+	std::string _drawTimeText;
+
 	Glib::RefPtr<Gtk::Window> _globalParentWindow;
 
 private:
@@ -69,6 +82,10 @@ public:
 	// Passes a queueDraw() call to each allocated view
 	void updateAllViews();
 
+	// Called by the views after drawing, updates the frame time and culled
+	// objects displayed in the status bar (the sums over all views)
+	void setDrawTime(int id, unsigned int msec, std::size_t culled);
+
 	// Free all the allocated views from the heap
 	void destroyViews();
 
@@ -0,0 +1,46 @@
+#include "GridLayer.h"
+
+namespace ui
+{
+
+GridLayer::GridLayer() :
+	_primitive(GL_LINES),
+	_size(0)
+{}
+
+void GridLayer::begin(GLenum primitive)
+{
+	_primitive = primitive;
+	_vertices.clear();
+}
+
+void GridLayer::end()
+{
+	_size = _vertices.size();
+
+	// An empty layer is simply not drawn, the buffer keeps its old contents
+	if (_size == 0)
+	{
+		return;
+	}
+
+	render::VertexBuffer<Vertex3f> buffer;
+	buffer.addBatch(_vertices.begin(), _vertices.size());
+
+	// Re-uses the existing VBO if the new geometry fits in
+	_buffer.replaceData(buffer);
+
+	glBindBuffer(GL_ARRAY_BUFFER, 0);
+
+	_vertices.clear();
+}
+
+void GridLayer::render() const
+{
+	if (_size > 0)
+	{
+		_buffer.renderAllBatches(_primitive);
+	}
+}
+
+} // namespace ui
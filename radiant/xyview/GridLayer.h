@@ -0,0 +1,56 @@
+#pragma once
+
+#include "render/VertexBuffer.h"
+#include "render/Vertex3f.h"
+
+#include <vector>
+
+namespace ui
+{
+
+/**
+ * \brief
+ * One layer of the grid drawn behind an ortho view (the minor or major grid
+ * or the block lines), stored in a vertex buffer.
+ *
+ * The geometry is generated by adding vertices between begin() and end(),
+ * which replaces the previous contents of the buffer. The layer can then be
+ * drawn any number of times without sending the vertices again.
+ */
+class GridLayer
+{
+	render::VertexBuffer<Vertex3f> _buffer;
+
+	// Vertices added since begin()
+	std::vector<Vertex3f> _vertices;
+
+	GLenum _primitive;
+
+	// Number of vertices in the buffer
+	std::size_t _size;
+
+public:
+	GridLayer();
+
+	// Starts generating new geometry to be drawn with the given primitive type
+	void begin(GLenum primitive);
+
+	// Adds a vertex in view coordinates
+	void addVertex(double x, double y)
+	{
+		_vertices.push_back(Vertex3f(x, y, 0));
+	}
+
+	// Uploads the vertices added since begin(), requires a valid GL context
+	void end();
+
+	std::size_t size() const
+	{
+		return _size;
+	}
+
+	// Draws the layer, the GL_VERTEX_ARRAY client state needs to be enabled
+	void render() const;
+};
+
+} // namespace ui
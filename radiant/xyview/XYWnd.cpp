@@ -8,6 +8,7 @@
 #include "ientity.h"
 #include "igrid.h"
 #include "iuimanager.h"
+#include "itrace.h"
 
 #include "gtkutil/GLWidget.h"
 #include "gtkutil/GLWidgetSentry.h"
@@ -68,7 +69,9 @@ XYWnd::XYWnd(int id) :
     _zoomStarted(false),
     _chaseMouseHandler(0),
     m_window_observer(NewWindowObserver()),
-    _isActive(false)
+    _isActive(false),
+    _gridBounds(1, -1, 1, -1),
+    _blockGridBounds(1, -1, 1, -1)
 {
     m_buttonstate = 0;
 
@@ -852,6 +855,189 @@ Vector4 XYWnd::getWindowCoordinates() {
     return Vector4(xb, xe, yb, ye);
 }
 
+Vector4 XYWnd::getRegionCoordinates()
+{
+    int nDim1 = (m_viewType == YZ) ? 1 : 0;
+    int nDim2 = (m_viewType == XY) ? 1 : 2;
+
+    Vector3 regionMin;
+    Vector3 regionMax;
+    GlobalRegion().getMinMax(regionMin, regionMax);
+
+    return Vector4(regionMin[nDim1], regionMax[nDim1], regionMin[nDim2], regionMax[nDim2]);
+}
+
+Vector4 XYWnd::getGridCacheBounds(double cellSize)
+{
+    int nDim1 = (m_viewType == YZ) ? 1 : 0;
+    int nDim2 = (m_viewType == XY) ? 1 : 2;
+
+    double w = _width / 2 / m_fScale;
+    double h = _height / 2 / m_fScale;
+
+    Vector4 region = getRegionCoordinates();
+
+    return Vector4(
+        std::max(cellSize * (floor((m_vOrigin[nDim1] - w) / cellSize) - 1), region[0]),
+        std::min(cellSize * (ceil((m_vOrigin[nDim1] + w) / cellSize) + 1), region[1]),
+        std::max(cellSize * (floor((m_vOrigin[nDim2] - h) / cellSize) - 1), region[2]),
+        std::min(cellSize * (ceil((m_vOrigin[nDim2] + h) / cellSize) + 1), region[3])
+    );
+}
+
+namespace
+{
+    // Cells of the cached grid geometry are at least this many pixels wide
+    const double GRID_CACHE_CELL_PIXELS = 128;
+
+    inline bool boundsContain(const Vector4& bounds, const Vector4& area)
+    {
+        return bounds[0] <= area[0] && area[1] <= bounds[1] &&
+               bounds[2] <= area[2] && area[3] <= bounds[3];
+    }
+}
+
+void XYWnd::updateGridLayers(const GridKey& key, int mask)
+{
+    if (boundsContain(_gridBounds, getWindowCoordinates()) && key == _gridKey)
+    {
+        return; // cached geometry is still good
+    }
+
+    trace::ScopedZone zone("render", "XYWnd::updateGridLayers");
+
+    _gridKey = key;
+
+    double cellSize = key.majorStep;
+
+    while (cellSize * m_fScale < GRID_CACHE_CELL_PIXELS)
+    {
+        cellSize *= 2;
+    }
+
+    _gridBounds = getGridCacheBounds(cellSize);
+
+    // slightly bigger crosses for the major grid
+    generateGridLayer(_minorGrid, key.minorLook, key.minorStep, key.minorStep, 0.95, mask, false);
+    generateGridLayer(_majorGrid, key.majorLook, key.majorStep, key.minorStep, 1.95, mask, true);
+}
+
+void XYWnd::generateGridLayer(ui::GridLayer& layer, GridLook look, double step,
+                              double minorStep, double sizeFactor, int mask, bool major)
+{
+    // The major step is a multiple of all other steps, which keeps the lines
+    // at the same positions wherever the cached area begins
+    double xb = _gridKey.majorStep * floor(_gridBounds[0] / _gridKey.majorStep);
+    double xe = _gridKey.majorStep * ceil(_gridBounds[1] / _gridKey.majorStep);
+    double yb = _gridKey.majorStep * floor(_gridBounds[2] / _gridKey.majorStep);
+    double ye = _gridKey.majorStep * ceil(_gridBounds[3] / _gridKey.majorStep);
+
+    double density = 4;
+
+    switch (look)
+    {
+        case GRIDLOOK_DOTS:
+        case GRIDLOOK_BIGDOTS:
+        case GRIDLOOK_SQUARES:
+            layer.begin(GL_POINTS);
+            for (double x = xb ; x < xe ; x += step)
+            {
+                for (double y = yb ; y < ye ; y += step)
+                {
+                    layer.addVertex(x, y);
+                }
+            }
+            break;
+
+        case GRIDLOOK_MOREDOTLINES:
+            density = 8;
+
+        case GRIDLOOK_DOTLINES:
+            layer.begin(GL_POINTS);
+            for (double x = xb ; x < xe ; x += step)
+            {
+                for (double y = yb ; y < ye ; y += minorStep / density)
+                {
+                    layer.addVertex(x, y);
+                }
+            }
+
+            for (double y = yb ; y < ye ; y += step)
+            {
+                for (double x = xb ; x < xe ; x += minorStep / density)
+                {
+                    layer.addVertex(x, y);
+                }
+            }
+            break;
+
+        case GRIDLOOK_CROSSES:
+            layer.begin(GL_LINES);
+            for (double x = xb ; x <= xe ; x += step)
+            {
+                for (double y = yb ; y <= ye ; y += step)
+                {
+                    layer.addVertex(x - sizeFactor / m_fScale, y);
+                    layer.addVertex(x + sizeFactor / m_fScale, y);
+                    layer.addVertex(x, y - sizeFactor / m_fScale);
+                    layer.addVertex(x, y + sizeFactor / m_fScale);
+                }
+            }
+            break;
+
+        case GRIDLOOK_LINES:
+        default:
+            layer.begin(GL_LINES);
+            int i = 0;
+            for (double x = xb ; x < xe ; x += step, ++i)
+            {
+                if (major || (i & mask) != 0) // No mask check for major grid
+                {
+                    layer.addVertex(x, yb);
+                    layer.addVertex(x, ye);
+                }
+            }
+
+            i = 0;
+
+            for (double y = yb ; y < ye ; y += step, ++i)
+            {
+                if (major || (i & mask) != 0) // No mask check for major grid
+                {
+                    layer.addVertex(xb, y);
+                    layer.addVertex(xe, y);
+                }
+            }
+            break;
+    }
+
+    layer.end();
+}
+
+void XYWnd::drawGridLayer(const ui::GridLayer& layer, GridLook look)
+{
+    switch (look)
+    {
+        case GRIDLOOK_BIGDOTS:
+            glPointSize(3);
+            glEnable(GL_POINT_SMOOTH);
+            layer.render();
+            glDisable(GL_POINT_SMOOTH);
+            glPointSize(1);
+            break;
+
+        case GRIDLOOK_SQUARES:
+            glPointSize(3);
+            layer.render();
+            glPointSize(1);
+            break;
+
+        default:
+            layer.render();
+            break;
+    }
+}
+
 void XYWnd::drawGrid()
 {
     double step, minor_step, stepx, stepy;
@@ -903,157 +1089,37 @@ void XYWnd::drawGrid()
 
     if (GlobalXYWnd().showGrid())
     {
-        Vector3 colourGridBack = ColourSchemes().getColour("grid_background");
-        Vector3 colourGridMinor = ColourSchemes().getColour("grid_minor");
-        Vector3 colourGridMajor = ColourSchemes().getColour("grid_major");
+        GridKey key;
 
-        // run grid rendering twice, first run is minor grid, then major
-        // NOTE: with a bit more work, we can have variable number of grids
-        for (int gf = 0 ; gf < 2 ; ++gf)
-        {
-            double cur_step, density, sizeFactor;
-            GridLook look;
+        key.minorStep = minor_step;
+        key.majorStep = step;
+        key.scale = m_fScale;
+        key.minorLook = GlobalGrid().getMinorLook();
+        key.majorLook = GlobalGrid().getMajorLook();
+        key.region = getRegionCoordinates();
 
-            if (gf)
-            {
-                // major grid
-                if (colourGridMajor == colourGridBack)
-                {
-                    continue;
-                }
+        updateGridLayers(key, mask);
 
-                glColor3dv(colourGridMajor);
-                look = GlobalGrid().getMajorLook();
-                cur_step = step;
-                density = 4;
-                // slightly bigger crosses
-                sizeFactor = 1.95;
-            }
-            else
-            {
-                // minor grid (rendered first)
-                if (colourGridMinor == colourGridBack)
-                {
-                    continue;
-                }
-
-                glColor3dv(colourGridMinor);
-                look = GlobalGrid().getMinorLook();
-                cur_step = minor_step;
-                density = 4;
-                sizeFactor = 0.95;
-            }
-
-            switch (look)
-            {
-                case GRIDLOOK_DOTS:
-                    glBegin (GL_POINTS);
-                    for (double x = xb ; x < xe ; x += cur_step)
-                    {
-                        for (double y = yb ; y < ye ; y += cur_step)
-                        {
-                            glVertex2d (x, y);
-                        }
-                    }
-                    glEnd();
-                    break;
-
-                case GRIDLOOK_BIGDOTS:
-                    glPointSize(3);
-                    glEnable(GL_POINT_SMOOTH);
-                    glBegin (GL_POINTS);
-                    for (double x = xb ; x < xe ; x += cur_step)
-                    {
-                        for (double y = yb ; y < ye ; y += cur_step)
-                        {
-                            glVertex2d (x, y);
-                        }
-                    }
-                    glEnd();
-                    glDisable(GL_POINT_SMOOTH);
-                    glPointSize(1);
-                    break;
-
-                case GRIDLOOK_SQUARES:
-                    glPointSize(3);
-                    glBegin (GL_POINTS);
-                    for (double x = xb ; x < xe ; x += cur_step)
-                    {
-                        for (double y = yb ; y < ye ; y += cur_step)
-                        {
-                            glVertex2d (x, y);
-                        }
-                    }
-                    glEnd();
-                    glPointSize(1);
-                    break;
+        Vector3 colourGridBack = ColourSchemes().getColour("grid_background");
+        Vector3 colourGridMinor = ColourSchemes().getColour("grid_minor");
+        Vector3 colourGridMajor = ColourSchemes().getColour("grid_major");
 
-                case GRIDLOOK_MOREDOTLINES:
-                    density = 8;
-
-                case GRIDLOOK_DOTLINES:
-                    glBegin (GL_POINTS);
-                    for (double x = xb ; x < xe ; x += cur_step)
-                    {
-                        for (double y = yb ; y < ye ; y += minor_step / density)
-                        {
-                            glVertex2d (x, y);
-                        }
-                    }
-
-                    for (double y = yb ; y < ye ; y += cur_step)
-                    {
-                        for (double x = xb ; x < xe ; x += minor_step / density)
-                        {
-                            glVertex2d (x, y);
-                        }
-                    }
-                    glEnd();
-                    break;
+        glEnableClientState(GL_VERTEX_ARRAY);
 
-                case GRIDLOOK_CROSSES:
-                    glBegin (GL_LINES);
-                    for (double x = xb ; x <= xe ; x += cur_step)
-                    {
-                        for (double y = yb ; y <= ye ; y += cur_step)
-                        {
-                            glVertex2d (x - sizeFactor / m_fScale, y);
-                            glVertex2d (x + sizeFactor / m_fScale, y);
-                            glVertex2d (x, y - sizeFactor / m_fScale);
-                            glVertex2d (x, y + sizeFactor / m_fScale);
-                        }
-                    }
-                    glEnd();
-                    break;
+        // minor grid first, then the major grid on top of it
+        if (colourGridMinor != colourGridBack)
+        {
+            glColor3dv(colourGridMinor);
+            drawGridLayer(_minorGrid, key.minorLook);
+        }
 
-                case GRIDLOOK_LINES:
-                default:
-                    glBegin (GL_LINES);
-                    int i = 0;
-                    for (double x = xb ; x < xe ; x += cur_step, ++i)
-                    {
-                        if (gf == 1 || (i & mask) != 0) // greebo: No mask check for major grid
-                        {
-                            glVertex2d (x, yb);
-                            glVertex2d (x, ye);
-                        }
-                    }
-
-                    i = 0;
-
-                    for (double y = yb ; y < ye ; y += cur_step, ++i)
-                    {
-                        if (gf == 1 || (i & mask) != 0) // greebo: No mask check for major grid
-                        {
-                            glVertex2d (xb, y);
-                            glVertex2d (xe, y);
-                        }
-                    }
-
-                    glEnd();
-                    break;
-            }
+        if (colourGridMajor != colourGridBack)
+        {
+            glColor3dv(colourGridMajor);
+            drawGridLayer(_majorGrid, key.majorLook);
         }
+
+        glDisableClientState(GL_VERTEX_ARRAY);
     }
 
     int nDim1 = (m_viewType == YZ) ? 1 : 0;
@@ -1160,6 +1226,46 @@ void XYWnd::drawGrid()
     }
 }
 
+void XYWnd::updateBlockGrid(const BlockGridKey& key)
+{
+    if (boundsContain(_blockGridBounds, getWindowCoordinates()) && key == _blockGridKey)
+    {
+        return;
+    }
+
+    _blockGridKey = key;
+
+    double cellSize = key.blockSize;
+
+    while (cellSize * m_fScale < GRID_CACHE_CELL_PIXELS)
+    {
+        cellSize *= 2;
+    }
+
+    _blockGridBounds = getGridCacheBounds(cellSize);
+
+    float xb = static_cast<float>(key.blockSize * floor(_blockGridBounds[0] / key.blockSize));
+    float xe = static_cast<float>(key.blockSize * ceil(_blockGridBounds[1] / key.blockSize));
+    float yb = static_cast<float>(key.blockSize * floor(_blockGridBounds[2] / key.blockSize));
+    float ye = static_cast<float>(key.blockSize * ceil(_blockGridBounds[3] / key.blockSize));
+
+    _blockGrid.begin(GL_LINES);
+
+    for (float x = xb; x <= xe; x += key.blockSize) {
+        _blockGrid.addVertex(x, yb);
+        _blockGrid.addVertex(x, ye);
+    }
+
+    if (key.viewType == XY) {
+        for (float y = yb; y <= ye; y += key.blockSize) {
+            _blockGrid.addVertex(xb, y);
+            _blockGrid.addVertex(xe, y);
+        }
+    }
+
+    _blockGrid.end();
+}
+
 void XYWnd::drawBlockGrid() {
     if (GlobalMap().findWorldspawn() == NULL) {
         return;
@@ -1177,6 +1283,10 @@ void XYWnd::drawBlockGrid() {
         blockSize = string::convert<int>(sizeVal);
     }
 
+    if (blockSize <= 0) {
+        return;
+    }
+
     float   x, y, xb, xe, yb, ye;
     char    text[32];
 
@@ -1192,26 +1302,23 @@ void XYWnd::drawBlockGrid() {
     yb = static_cast<float>(blockSize * floor (windowCoords[2]/blockSize));
     ye = static_cast<float>(blockSize * ceil (windowCoords[3]/blockSize));
 
+    BlockGridKey key;
+
+    key.blockSize = blockSize;
+    key.viewType = m_viewType;
+    key.region = getRegionCoordinates();
+
+    updateBlockGrid(key);
+
     // draw major blocks
 
     glColor3dv(ColourSchemes().getColour("grid_block"));
     glLineWidth (2);
 
-    glBegin (GL_LINES);
-
-    for (x=xb ; x<=xe ; x+=blockSize) {
-        glVertex2f (x, yb);
-        glVertex2f (x, ye);
-    }
-
-    if (m_viewType == XY) {
-        for (y=yb ; y<=ye ; y+=blockSize) {
-            glVertex2f (xb, y);
-            glVertex2f (xe, y);
-        }
-    }
+    glEnableClientState(GL_VERTEX_ARRAY);
+    _blockGrid.render();
+    glDisableClientState(GL_VERTEX_ARRAY);
 
-    glEnd();
     glLineWidth (1);
 
     // draw coordinate text if needed
@@ -1484,6 +1591,11 @@ void XYWnd::updateModelview() {
 
 void XYWnd::draw()
 {
+    trace::ScopedZone zone("render", "XYWnd::draw");
+
+    Timer drawTimer;
+    drawTimer.start();
+
     // clear
     glViewport(0, 0, _width, _height);
     Vector3 colourGridBack = ColourSchemes().getColour("grid_background");
@@ -1533,13 +1645,16 @@ void XYWnd::draw()
         flagsMask |= RENDER_LINESTIPPLE;
     }
 
+    // The nodes culled in this view, the render statistics belong to the camera
+    std::size_t numCulled = 0;
+
     {
         // Construct the renderer and render the scene
         XYRenderer renderer(flagsMask, _selectedShader.get());
 
         // First pass (scenegraph traversal)
-        render::RenderableCollectionWalker::collectRenderablesInScene(renderer,
-                                                                      m_view);
+        numCulled = render::RenderableCollectionWalker::collectRenderablesInScene(renderer,
+                                                                                  m_view);
 
         // Second pass (GL calls)
         renderer.render(m_modelview, m_projection);
@@ -1708,6 +1823,8 @@ void XYWnd::draw()
     GlobalOpenGL().assertNoErrors();
 
     glFinish();
+
+    GlobalXYWnd().setDrawTime(_id, drawTimer.elapsed_msec(), numCulled);
 }
 
 void XYWnd::mouseToPoint(int x, int y, Vector3& point) {
@@ -3,6 +3,7 @@
 
 #include "iclipper.h"
 #include "iscenegraph.h"
+#include "igrid.h"
 
 #include "math/Vector3.h"
 #include "math/Matrix4.h"
@@ -17,6 +18,7 @@
 #include "camera/CameraObserver.h"
 #include "camera/CamWnd.h"
 #include "selection/RadiantWindowObserver.h"
+#include "GridLayer.h"
 
 	namespace {
 		const int XYWND_MINSIZE_X = 100;
@@ -103,6 +105,49 @@ protected:
 	// The handle returned from the Map valid callback signal
 	std::size_t _validCallbackHandle;
 
+	// The parameters the grid layers have been generated for
+	struct GridKey
+	{
+		double minorStep;
+		double majorStep;
+		double scale;
+		GridLook minorLook;
+		GridLook majorLook;
+		Vector4 region;
+
+		bool operator==(const GridKey& other) const
+		{
+			return minorStep == other.minorStep && majorStep == other.majorStep &&
+				   scale == other.scale && minorLook == other.minorLook &&
+				   majorLook == other.majorLook && region == other.region;
+		}
+	};
+
+	// The parameters the block grid has been generated for
+	struct BlockGridKey
+	{
+		int blockSize;
+		EViewType viewType;
+		Vector4 region;
+
+		bool operator==(const BlockGridKey& other) const
+		{
+			return blockSize == other.blockSize && viewType == other.viewType &&
+				   region == other.region;
+		}
+	};
+
+	// The cached grid geometry covers more than the visible area, such that
+	// it doesn't need to be regenerated each time the view is scrolled
+	GridKey _gridKey;
+	Vector4 _gridBounds;
+	ui::GridLayer _minorGrid;
+	ui::GridLayer _majorGrid;
+
+	BlockGridKey _blockGridKey;
+	Vector4 _blockGridBounds;
+	ui::GridLayer _blockGrid;
+
 public:
 	// Constructor, this allocates the GL widget
 	XYWnd(int uniqueId);
@@ -217,6 +262,25 @@ protected:
 
 private:
 	void onContextMenu();
+
+	// Returns the region bounds in view coordinates (xmin, xmax, ymin, ymax)
+	Vector4 getRegionCoordinates();
+
+	// Returns the area to generate the cached grid geometry for: the visible
+	// area extended by one cell on each side, snapped to the cell size and
+	// constrained to the region
+	Vector4 getGridCacheBounds(double cellSize);
+
+	// Regenerates the grid layers if the given parameters differ from the
+	// cached ones or the visible area is not covered anymore
+	void updateGridLayers(const GridKey& key, int mask);
+	void generateGridLayer(ui::GridLayer& layer, GridLook look, double step,
+						   double minorStep, double sizeFactor, int mask, bool major);
+	void updateBlockGrid(const BlockGridKey& key);
+
+	// Sets the GL point state for the given grid look and draws the layer
+	void drawGridLayer(const ui::GridLayer& layer, GridLook look);
+
 	void drawSizeInfo(int nDim1, int nDim2, const Vector3& vMinBounds, const Vector3& vMaxBounds);
 
 	// gtkmm Callbacks
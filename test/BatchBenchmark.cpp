@@ -0,0 +1,139 @@
+#include "BatchBenchmark.h"
+
+#include "Workloads.h"
+#include "BenchmarkReport.h"
+
+#include <cstdio>
+#include <cstdlib>
+#include <fstream>
+#include <iostream>
+#include <boost/filesystem.hpp>
+#include <boost/algorithm/string/split.hpp>
+#include <boost/algorithm/string/classification.hpp>
+
+Test::Registrar BatchBenchmark::_registrar(TestPtr(new BatchBenchmark));
+
+std::string BatchBenchmark::_executable;
+std::string BatchBenchmark::_modFolder;
+
+namespace
+{
+	// The jobs measured on the benchmark map, in this order
+	const char* const JOBS = "load,materials,save,dmap";
+
+	// Number of fields in a report line following the map name
+	const std::size_t NUM_JOB_FIELDS = 7;
+
+	std::string quote(const std::string& arg)
+	{
+		return "\"" + arg + "\"";
+	}
+}
+
+void BatchBenchmark::setExecutable(const std::string& executable)
+{
+	_executable = executable;
+}
+
+void BatchBenchmark::setModFolder(const std::string& folder)
+{
+	_modFolder = folder;
+}
+
+void BatchBenchmark::run()
+{
+	if (_executable.empty() || _modFolder.empty())
+	{
+		std::cout << std::endl << "  skipped, use --darkradiant <executable> --mod <folder> to run it." << std::endl;
+		return;
+	}
+
+	boost::filesystem::path modPath(_modFolder);
+
+	REQUIRE_TRUE(workload::writeWorkloads(modPath.string()),
+		"Could not write the workloads to " + modPath.string());
+
+	std::string mapFile = boost::filesystem::absolute(modPath / "maps" / "benchmark.map").string();
+	std::string reportFile = boost::filesystem::absolute(modPath / "benchmark_batch.csv").string();
+	std::string outputFolder = boost::filesystem::absolute(modPath / "benchmark_output").string();
+
+	JobTimings timings;
+
+	// Warm-up, fills the disk caches
+	REQUIRE_TRUE(runBatch(JOBS, mapFile, outputFolder, reportFile, timings), "The batch mode failed");
+
+	timings.clear();
+
+	for (std::size_t i = 0; i < BenchmarkReport::Instance().getNumSamples(); ++i)
+	{
+		REQUIRE_TRUE(runBatch(JOBS, mapFile, outputFolder, reportFile, timings), "The batch mode failed");
+	}
+
+	// Remove the report and the files written by the save and dmap jobs
+	std::remove(reportFile.c_str());
+	boost::filesystem::remove_all(outputFolder);
+	boost::filesystem::remove(boost::filesystem::path(mapFile).replace_extension(".proc"));
+
+	for (JobTimings::const_iterator i = timings.begin(); i != timings.end(); ++i)
+	{
+		std::vector<double> samples;
+
+		for (std::vector<double>::const_iterator s = i->second.begin(); s != i->second.end(); ++s)
+		{
+			samples.push_back(*s * 1000);
+		}
+
+		BenchmarkResult result(getName() + "/" + i->first, samples, 0, "");
+		BenchmarkReport::Instance().addResult(result);
+
+		std::cout << std::endl << "  " << i->first << "... " << result.median << " ms";
+	}
+
+	std::cout << std::endl;
+}
+
+bool BatchBenchmark::runBatch(const std::string& jobs, const std::string& mapFile,
+							  const std::string& outputFolder, const std::string& reportFile,
+							  JobTimings& timings)
+{
+	std::string modName = boost::filesystem::path(_modFolder).filename().string();
+
+	std::string command = quote(_executable) + " --batch " + jobs +
+		" --batch-output " + quote(outputFolder) + " --batch-report " + quote(reportFile) +
+		" fs_game=" + quote(modName) + " " + quote(mapFile);
+
+#if defined(WIN32)
+	// cmd.exe strips the outermost quotes
+	command = quote(command);
+#endif
+
+	if (std::system(command.c_str()) != 0)
+	{
+		return false;
+	}
+
+	std::ifstream report(reportFile.c_str());
+
+	std::string line;
+	std::getline(report, line); // skip the header
+
+	while (std::getline(report, line))
+	{
+		// The map name may contain commas, count the fields from the end
+		std::vector<std::string> fields;
+		boost::algorithm::split(fields, line, boost::algorithm::is_any_of(","));
+
+		if (fields.size() <= NUM_JOB_FIELDS) continue;
+
+		std::size_t job = fields.size() - NUM_JOB_FIELDS;
+
+		if (fields[job + 1] != "1")
+		{
+			return false;
+		}
+
+		timings[fields[job]].push_back(atof(fields[job + 2].c_str()));
+	}
+
+	return true;
+}
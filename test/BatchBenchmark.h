@@ -0,0 +1,45 @@
+#pragma once
+
+#include "Benchmark.h"
+
+#include <map>
+
+/**
+ * Measures DarkRadiant itself: runs the batch mode of the given executable
+ * on the generated benchmark map and records the duration of each batch
+ * job (load, materials, save and dmap), as listed in the batch report. The workloads are written to the mod
+ * folder, which needs to be located in the engine path of the game
+ * DarkRadiant has been configured for, it is passed on as fs_game.
+ *
+ * The benchmark is skipped unless both the executable and the mod folder
+ * have been set (--darkradiant and --mod on the command line).
+ */
+class BatchBenchmark :
+	public Benchmark
+{
+private:
+	static Registrar _registrar;
+
+	static std::string _executable;
+	static std::string _modFolder;
+
+	// Seconds taken by each run of a job, by job name
+	typedef std::map<std::string, std::vector<double> > JobTimings;
+
+public:
+	std::string getName()
+	{
+		return "Batch Benchmark";
+	}
+
+	static void setExecutable(const std::string& executable);
+	static void setModFolder(const std::string& folder);
+
+	void run();
+
+private:
+	// Runs the batch mode once, adds the job timings of the report. Returns false on failure.
+	bool runBatch(const std::string& jobs, const std::string& mapFile,
+				  const std::string& outputFolder, const std::string& reportFile,
+				  JobTimings& timings);
+};
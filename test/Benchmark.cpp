@@ -0,0 +1,63 @@
+#include "Benchmark.h"
+
+#include "BenchmarkReport.h"
+#include "StopWatch.h"
+
+#include <algorithm>
+#include <numeric>
+#include <cmath>
+#include <iostream>
+
+void Benchmark::measure(const std::string& caseName, const std::function<void()>& func,
+						double units, const std::string& unitName)
+{
+	std::cout << std::endl << "  " << caseName << "...";
+
+	func(); // warm-up
+
+	std::vector<double> samples;
+
+	for (std::size_t i = 0; i < BenchmarkReport::Instance().getNumSamples(); ++i)
+	{
+		StopWatch timer;
+		func();
+		samples.push_back(timer.getMilliseconds());
+	}
+
+	BenchmarkResult result(getName() + "/" + caseName, samples, units, unitName);
+	BenchmarkReport::Instance().addResult(result);
+
+	std::cout << " " << result.median << " ms";
+}
+
+BenchmarkResult::BenchmarkResult(const std::string& name_, const std::vector<double>& samples_,
+								 double units_, const std::string& unitName_) :
+	name(name_),
+	samples(samples_),
+	min(0),
+	median(0),
+	mean(0),
+	stddev(0),
+	units(units_),
+	unitName(unitName_)
+{
+	if (samples.empty()) return;
+
+	std::vector<double> sorted(samples);
+	std::sort(sorted.begin(), sorted.end());
+
+	std::size_t middle = sorted.size() / 2;
+
+	min = sorted.front();
+	median = sorted.size() % 2 == 1 ? sorted[middle] : (sorted[middle - 1] + sorted[middle]) / 2;
+	mean = std::accumulate(sorted.begin(), sorted.end(), 0.0) / sorted.size();
+
+	double variance = 0;
+
+	for (std::vector<double>::const_iterator i = sorted.begin(); i != sorted.end(); ++i)
+	{
+		variance += (*i - mean) * (*i - mean);
+	}
+
+	stddev = sorted.size() > 1 ? sqrt(variance / (sorted.size() - 1)) : 0;
+}
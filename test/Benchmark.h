@@ -0,0 +1,49 @@
+#pragma once
+
+#include "Test.h"
+
+#include <string>
+#include <vector>
+#include <functional>
+
+/**
+ * Base class of the benchmarks. A benchmark measures one or more cases by
+ * running each of them several times, the timings of all cases end up in
+ * the BenchmarkReport where they are summarised and compared against a
+ * stored baseline.
+ */
+class Benchmark :
+	public Test
+{
+protected:
+	/**
+	 * Runs the given function once to warm up the caches, then as many
+	 * times as configured in the BenchmarkReport, recording the time taken
+	 * by each run under "<benchmark name>/<caseName>". The number of work
+	 * items processed by one run (e.g. bytes or brushes) is used to print
+	 * the throughput, it may be zero.
+	 */
+	void measure(const std::string& caseName, const std::function<void()>& func,
+				 double units = 0, const std::string& unitName = "");
+};
+
+// The timings of a single benchmark case
+struct BenchmarkResult
+{
+	std::string name;
+
+	// Milliseconds taken by each run
+	std::vector<double> samples;
+
+	double min;
+	double median;
+	double mean;
+	double stddev;
+
+	// Work items processed per run
+	double units;
+	std::string unitName;
+
+	BenchmarkResult(const std::string& name_, const std::vector<double>& samples_,
+					double units_, const std::string& unitName_);
+};
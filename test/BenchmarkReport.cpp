@@ -0,0 +1,133 @@
+#include "BenchmarkReport.h"
+
+#include <algorithm>
+#include <fstream>
+#include <iomanip>
+#include <iostream>
+#include <sstream>
+
+BenchmarkReport::BenchmarkReport() :
+	_numSamples(5),
+	_tolerance(0.1)
+{}
+
+BenchmarkReport& BenchmarkReport::Instance()
+{
+	static BenchmarkReport _report;
+	return _report;
+}
+
+void BenchmarkReport::setNumSamples(std::size_t numSamples)
+{
+	_numSamples = std::max<std::size_t>(numSamples, 1);
+}
+
+void BenchmarkReport::setTolerance(double tolerance)
+{
+	_tolerance = tolerance;
+}
+
+void BenchmarkReport::addResult(const BenchmarkResult& result)
+{
+	_results.push_back(result);
+}
+
+bool BenchmarkReport::loadBaseline(const std::string& filename)
+{
+	std::ifstream file(filename.c_str());
+
+	if (!file.good()) return false;
+
+	std::string line;
+
+	while (std::getline(file, line))
+	{
+		std::size_t tab = line.rfind('\t');
+
+		if (tab == std::string::npos) continue;
+
+		std::istringstream value(line.substr(tab + 1));
+		double median = 0;
+
+		if (value >> median)
+		{
+			_baseline[line.substr(0, tab)] = median;
+		}
+	}
+
+	return true;
+}
+
+bool BenchmarkReport::saveBaseline(const std::string& filename) const
+{
+	std::ofstream file(filename.c_str());
+
+	if (!file.good()) return false;
+
+	for (std::vector<BenchmarkResult>::const_iterator i = _results.begin(); i != _results.end(); ++i)
+	{
+		file << i->name << "\t" << i->median << std::endl;
+	}
+
+	return true;
+}
+
+std::size_t BenchmarkReport::printSummary(std::ostream& stream) const
+{
+	std::size_t regressions = 0;
+
+	stream << std::endl << "Benchmark summary (" << _numSamples << " samples per case, times in ms):"
+		<< std::endl;
+
+	stream << std::left << std::setw(56) << "case" << std::right
+		<< std::setw(10) << "min" << std::setw(10) << "median"
+		<< std::setw(10) << "mean" << std::setw(10) << "stddev"
+		<< std::setw(10) << "baseline" << std::setw(9) << "change" << std::endl;
+
+	std::ios_base::fmtflags flags = stream.flags();
+	stream << std::fixed << std::setprecision(2);
+
+	for (std::vector<BenchmarkResult>::const_iterator i = _results.begin(); i != _results.end(); ++i)
+	{
+		stream << std::left << std::setw(56) << i->name << std::right
+			<< std::setw(10) << i->min << std::setw(10) << i->median
+			<< std::setw(10) << i->mean << std::setw(10) << i->stddev;
+
+		Baseline::const_iterator baseline = _baseline.find(i->name);
+
+		if (baseline != _baseline.end() && baseline->second > 0)
+		{
+			double change = i->median / baseline->second - 1;
+
+			stream << std::setw(10) << baseline->second
+				<< std::setw(8) << std::showpos << change * 100 << std::noshowpos << "%";
+
+			if (change > _tolerance)
+			{
+				stream << "  REGRESSION";
+				++regressions;
+			}
+		}
+		else
+		{
+			stream << std::setw(10) << "-" << std::setw(9) << "-";
+		}
+
+		if (i->units > 0 && i->median > 0)
+		{
+			stream << "  (" << i->units / i->median * 1000 << " " << i->unitName << "/s)";
+		}
+
+		stream << std::endl;
+	}
+
+	stream.flags(flags);
+
+	if (!_baseline.empty())
+	{
+		stream << regressions << " regression(s) beyond " << _tolerance * 100
+			<< "% of the baseline." << std::endl;
+	}
+
+	return regressions;
+}
@@ -0,0 +1,56 @@
+#pragma once
+
+#include "Benchmark.h"
+
+#include <map>
+#include <string>
+#include <vector>
+
+/**
+ * Collects the results of all benchmark cases and compares their median
+ * timings against a baseline file written by an earlier run. The baseline
+ * is a plain text file with one "<case name>\t<median ms>" line per case.
+ */
+class BenchmarkReport
+{
+private:
+	std::vector<BenchmarkResult> _results;
+
+	// Median timings by case name
+	typedef std::map<std::string, double> Baseline;
+	Baseline _baseline;
+
+	std::size_t _numSamples;
+
+	// Relative slowdown of the median considered a regression
+	double _tolerance;
+
+	BenchmarkReport();
+
+public:
+	static BenchmarkReport& Instance();
+
+	std::size_t getNumSamples() const
+	{
+		return _numSamples;
+	}
+
+	void setNumSamples(std::size_t numSamples);
+
+	// E.g. 0.1 to allow the median to be 10% slower than the baseline
+	void setTolerance(double tolerance);
+
+	void addResult(const BenchmarkResult& result);
+
+	// Reads the baseline to compare against, returns false if the file couldn't be read
+	bool loadBaseline(const std::string& filename);
+
+	// Writes the medians of this run as new baseline
+	bool saveBaseline(const std::string& filename) const;
+
+	/**
+	 * Prints the summary of all cases, including the comparison against
+	 * the baseline if one has been loaded. Returns the number of regressions.
+	 */
+	std::size_t printSummary(std::ostream& stream) const;
+};
@@ -0,0 +1,249 @@
+#include "EntityKeyValueBenchmark.h"
+
+#include "StopWatch.h"
+#include "ieclass.h"
+#include "math/AABB.h"
+#include "../plugins/entity/Doom3Entity.h"
+
+#include <iostream>
+#include <boost/algorithm/string/case_conv.hpp>
+#include <boost/algorithm/string/predicate.hpp>
+#include <boost/lexical_cast.hpp>
+#include <boost/make_shared.hpp>
+
+Test::Registrar EntityKeyValueBenchmark::_registrar(TestPtr(new EntityKeyValueBenchmark));
+
+namespace
+{
+	// AI and readable entities easily reach this number of spawnargs
+	const std::size_t NUM_KEYS = 400;
+	const std::size_t NUM_LOOKUPS = 1000000;
+	const std::size_t NUM_CHURN_ROUNDS = 20000;
+	const std::size_t NUM_CLEAR_ROUNDS = 100;
+
+	// An entity class without any attributes, the entities don't inherit anything
+	class BenchmarkEntityClass :
+		public IEntityClass
+	{
+		EntityClassAttribute _emptyAttribute;
+		sigc::signal<void> _changedSignal;
+		Vector3 _colour;
+		std::string _emptyString;
+
+	public:
+		BenchmarkEntityClass() :
+			_emptyAttribute("", "", ""),
+			_colour(0, 0, 0)
+		{}
+
+		sigc::signal<void> changedSignal() const { return _changedSignal; }
+		std::string getName() const { return "benchmark_entity"; }
+		const IEntityClass* getParent() const { return NULL; }
+		bool isLight() const { return false; }
+		bool isFixedSize() const { return true; }
+		AABB getBounds() const { return AABB(); }
+		const Vector3& getColour() const { return _colour; }
+		const std::string& getWireShader() const { return _emptyString; }
+		const std::string& getFillShader() const { return _emptyString; }
+		EntityClassAttribute& getAttribute(const std::string& name) { return _emptyAttribute; }
+		const EntityClassAttribute& getAttribute(const std::string& name) const { return _emptyAttribute; }
+
+		void forEachClassAttribute(boost::function<void(const EntityClassAttribute&)> visitor,
+								   bool editorKeys) const
+		{}
+
+		const std::string& getModelPath() const { return _emptyString; }
+		const std::string& getSkin() const { return _emptyString; }
+		bool isOfType(const std::string& className) { return className == getName(); }
+		std::string getModName() const { return "base"; }
+	};
+
+	// The lookup as performed by Doom3Entity before the key index was introduced
+	class LinearKeyFinder :
+		public Entity::Visitor
+	{
+		const std::string& _key;
+
+	public:
+		std::string value;
+		bool found;
+
+		LinearKeyFinder(const std::string& key) :
+			_key(key),
+			found(false)
+		{}
+
+		void visit(const std::string& key, const std::string& val)
+		{
+			if (!found && boost::algorithm::iequals(key, _key))
+			{
+				value = val;
+				found = true;
+			}
+		}
+	};
+
+	std::string getKey(std::size_t i)
+	{
+		return "editor_var_spawnarg_" + boost::lexical_cast<std::string>(i);
+	}
+
+	void fill(entity::Doom3Entity& entity)
+	{
+		for (std::size_t i = 0; i < NUM_KEYS; ++i)
+		{
+			entity.setKeyValue(getKey(i), "value" + boost::lexical_cast<std::string>(i));
+		}
+	}
+}
+
+void EntityKeyValueBenchmark::run()
+{
+	benchmarkLookups();
+	benchmarkSetKeyValueChurn();
+	benchmarkClear();
+}
+
+void EntityKeyValueBenchmark::benchmarkLookups()
+{
+	entity::Doom3Entity entity(boost::make_shared<BenchmarkEntityClass>());
+
+	fill(entity);
+
+	// Query every fourth key in upper case and a few keys that don't exist
+	std::vector<std::string> queries;
+
+	for (std::size_t i = 0; i < NUM_KEYS + NUM_KEYS / 8; ++i)
+	{
+		std::string key = getKey(i);
+		queries.push_back(i % 4 == 0 ? boost::algorithm::to_upper_copy(key) : key);
+	}
+
+	for (std::size_t i = 0; i < queries.size(); ++i)
+	{
+		LinearKeyFinder finder(queries[i]);
+		entity.forEachKeyValue(finder);
+
+		REQUIRE_TRUE(entity.getKeyValue(queries[i]) == finder.value,
+			"Key index and linear search disagree on " + queries[i]);
+	}
+
+	std::size_t found = 0;
+	StopWatch linearTimer;
+
+	for (std::size_t i = 0; i < NUM_LOOKUPS / 100; ++i)
+	{
+		LinearKeyFinder finder(queries[i % queries.size()]);
+		entity.forEachKeyValue(finder);
+
+		found += finder.found;
+	}
+
+	// The linear search is slow enough to run a hundredth of the lookups only
+	double linearTime = linearTimer.getMilliseconds() * 100;
+
+	found = 0;
+	StopWatch indexTimer;
+
+	for (std::size_t i = 0; i < NUM_LOOKUPS; ++i)
+	{
+		found += !entity.getKeyValue(queries[i % queries.size()]).empty();
+	}
+
+	double indexTime = indexTimer.getMilliseconds();
+
+	std::cout << std::endl << "  " << NUM_LOOKUPS << " getKeyValue calls on " << NUM_KEYS << " keys: "
+		<< "linear " << linearTime << " ms, indexed " << indexTime << " ms"
+		<< " (" << found << " hits)" << std::endl;
+}
+
+void EntityKeyValueBenchmark::benchmarkSetKeyValueChurn()
+{
+	entity::Doom3Entity entity(boost::make_shared<BenchmarkEntityClass>());
+
+	fill(entity);
+
+	StopWatch timer;
+
+	// Overwrite existing values, remove keys and add them again
+	for (std::size_t round = 0; round < NUM_CHURN_ROUNDS; ++round)
+	{
+		const std::string key = getKey((round * 7) % NUM_KEYS);
+		const std::string value = boost::lexical_cast<std::string>(round);
+
+		entity.setKeyValue(key, value);
+
+		REQUIRE_TRUE(entity.getKeyValue(key) == value, "Value not assigned: " + key);
+
+		if (round % 10 == 0)
+		{
+			entity.setKeyValue(key, "");
+
+			REQUIRE_TRUE(entity.getKeyValue(key).empty(), "Erased key still found: " + key);
+
+			entity.setKeyValue(key, "value");
+		}
+	}
+
+	std::cout << "  " << NUM_CHURN_ROUNDS << " setKeyValue rounds (10% erase/insert): "
+		<< timer.getMilliseconds() << " ms" << std::endl;
+}
+
+void EntityKeyValueBenchmark::benchmarkClear()
+{
+	double time = 0;
+
+	for (std::size_t round = 0; round < NUM_CLEAR_ROUNDS; ++round)
+	{
+		entity::Doom3Entity entity(boost::make_shared<BenchmarkEntityClass>());
+
+		fill(entity);
+
+		StopWatch timer;
+
+		// Remove every key in scrambled order, like deleting a batch of spawnargs
+		// in the entity inspector
+		for (std::size_t i = 0; i < NUM_KEYS; ++i)
+		{
+			entity.setKeyValue(getKey((i * 7) % NUM_KEYS), "");
+		}
+
+		time += timer.getMilliseconds();
+
+		if (round == 0)
+		{
+			verifyErase();
+		}
+
+		REQUIRE_TRUE(entity.getKeyValuePairs("").empty(), "Keys left after erasing all of them");
+	}
+
+	std::cout << "  " << NUM_CLEAR_ROUNDS << " times erasing all " << NUM_KEYS << " keys: "
+		<< time << " ms" << std::endl;
+}
+
+void EntityKeyValueBenchmark::verifyErase()
+{
+	entity::Doom3Entity entity(boost::make_shared<BenchmarkEntityClass>());
+
+	fill(entity);
+
+	std::vector<bool> erased(NUM_KEYS, false);
+
+	for (std::size_t i = 0; i < NUM_KEYS; ++i)
+	{
+		std::size_t index = (i * 7) % NUM_KEYS;
+
+		entity.setKeyValue(getKey(index), "");
+		erased[index] = true;
+
+		// The remaining keys must still be found at their shifted positions
+		for (std::size_t k = 0; k < NUM_KEYS; ++k)
+		{
+			std::string expected = erased[k] ? "" : "value" + boost::lexical_cast<std::string>(k);
+
+			REQUIRE_TRUE(entity.getKeyValue(getKey(k)) == expected,
+				"Wrong value after erasing " + getKey(index) + ": " + getKey(k));
+		}
+	}
+}
@@ -0,0 +1,31 @@
+#pragma once
+
+#include "Test.h"
+
+/**
+ * Measures the spawnarg lookups and modifications of a Doom3Entity with
+ * several hundred keys, comparing the hashed key index against a linear
+ * case-insensitive scan.
+ */
+class EntityKeyValueBenchmark :
+	public Test
+{
+private:
+	static Registrar _registrar;
+
+public:
+	std::string getName()
+	{
+		return "Entity Key/Value Benchmark";
+	}
+
+	void run();
+
+private:
+	void benchmarkLookups();
+	void benchmarkSetKeyValueChurn();
+	void benchmarkClear();
+
+	// Checks the lookups after each step of erasing all keys
+	void verifyErase();
+};
@@ -0,0 +1,273 @@
+#include "OctreeBenchmark.h"
+
+#include "Workloads.h"
+#include "inode.h"
+#include "math/AABB.h"
+#include "math/Frustum.h"
+#include "math/Matrix4.h"
+#include "math/Ray.h"
+#include "../plugins/scenegraph/Octree.h"
+#include "../plugins/scenegraph/OctreeNode.h"
+
+#include <iostream>
+#include <boost/enable_shared_from_this.hpp>
+
+Test::Registrar OctreeBenchmark::_registrar(TestPtr(new OctreeBenchmark));
+
+namespace
+{
+	const std::size_t NUM_BRUSHES = 100000;
+	const std::size_t NUM_QUERIES = 200;
+	const std::size_t NUM_MOVES = 20000;
+
+	// The octree only needs the world bounds of the scene nodes
+	class BoundsNode :
+		public scene::INode,
+		public boost::enable_shared_from_this<BoundsNode>
+	{
+		AABB _bounds;
+		IRenderEntityPtr _renderEntity;
+
+	public:
+		BoundsNode(const AABB& bounds) :
+			_bounds(bounds)
+		{}
+
+		void setBounds(const AABB& bounds)
+		{
+			_bounds = bounds;
+		}
+
+		const AABB& worldAABB() const { return _bounds; }
+		const AABB& localAABB() const { return _bounds; }
+		const Matrix4& localToWorld() const { static Matrix4 identity(Matrix4::getIdentity()); return identity; }
+
+		std::string name() const { return "BoundsNode"; }
+		Type getNodeType() const { return Type::Primitive; }
+		void setSceneGraph(const scene::GraphPtr&) {}
+		bool isRoot() const { return false; }
+		void setIsRoot(bool) {}
+		void enable(unsigned int) {}
+		void disable(unsigned int) {}
+		bool visible() const { return true; }
+		bool excluded() const { return false; }
+		void addChildNode(const scene::INodePtr&) {}
+		void removeChildNode(const scene::INodePtr&) {}
+		bool hasChildNodes() const { return false; }
+		void traverse(scene::NodeVisitor&) {}
+		void traverseChildren(scene::NodeVisitor&) const {}
+		bool foreachNode(const VisitorFunc&) const { return true; }
+		scene::INodePtr getSelf() { return shared_from_this(); }
+		void setParent(const scene::INodePtr&) {}
+		scene::INodePtr getParent() const { return scene::INodePtr(); }
+		void onInsertIntoScene() {}
+		void onRemoveFromScene() {}
+		bool inScene() const { return true; }
+		const IRenderEntityPtr& getRenderEntity() const { return _renderEntity; }
+		void setRenderEntity(const IRenderEntityPtr&) {}
+		void boundsChanged() {}
+		void transformChanged() {}
+
+		bool isFiltered() const { return false; }
+		void setFiltered(bool) {}
+
+		void addToLayer(int) {}
+		void moveToLayer(int) {}
+		void removeFromLayer(int) {}
+		scene::LayerList getLayers() const { return scene::LayerList(); }
+		void assignToLayers(const scene::LayerList&) {}
+
+		void setRenderSystem(const RenderSystemPtr&) {}
+		void renderSolid(RenderableCollector&, const VolumeTest&) const {}
+		void renderWireframe(RenderableCollector&, const VolumeTest&) const {}
+		bool isHighlighted() const { return false; }
+	};
+	typedef boost::shared_ptr<BoundsNode> BoundsNodePtr;
+
+	// The walk of SceneGraph::foreachNodeInVolume_r, skipping octree nodes outside the frustum
+	std::size_t countInVolume(const scene::ISPNode& node, const Frustum& frustum)
+	{
+		std::size_t count = 0;
+
+		const scene::ISPNode::MemberList& members = node.getMembers();
+
+		for (scene::ISPNode::MemberList::const_iterator m = members.begin(); m != members.end(); ++m)
+		{
+			if (frustum.testIntersection((*m)->worldAABB()) != VOLUME_OUTSIDE) ++count;
+		}
+
+		const scene::ISPNode::NodeList& children = node.getChildNodes();
+
+		for (scene::ISPNode::NodeList::const_iterator i = children.begin(); i != children.end(); ++i)
+		{
+			if (frustum.testIntersection((*i)->getBounds()) != VOLUME_OUTSIDE)
+			{
+				count += countInVolume(**i, frustum);
+			}
+		}
+
+		return count;
+	}
+
+	// The walk of SceneGraph::foreachNodeAlongRay_r
+	std::size_t countAlongRay(const scene::ISPNode& node, const Ray& ray)
+	{
+		std::size_t count = 0;
+		Vector3 intersection;
+
+		const scene::ISPNode::MemberList& members = node.getMembers();
+
+		for (scene::ISPNode::MemberList::const_iterator m = members.begin(); m != members.end(); ++m)
+		{
+			if (ray.intersectAABB((*m)->worldAABB(), intersection)) ++count;
+		}
+
+		const scene::ISPNode::NodeList& children = node.getChildNodes();
+
+		for (scene::ISPNode::NodeList::const_iterator i = children.begin(); i != children.end(); ++i)
+		{
+			if (ray.intersectAABB((*i)->getBounds(), intersection))
+			{
+				count += countAlongRay(**i, ray);
+			}
+		}
+
+		return count;
+	}
+
+	AABB getBounds(const workload::BrushPlanes& planes)
+	{
+		// The first six planes are the axial ones
+		return AABB::createFromMinMax(
+			Vector3(-planes[4].dist(), -planes[5].dist(), -planes[0].dist()),
+			Vector3(planes[2].dist(), planes[1].dist(), planes[3].dist()));
+	}
+
+	// A camera at the given position, looking into the given direction (yaw in degrees)
+	Frustum getCameraFrustum(const Vector3& eye, double yaw)
+	{
+		Matrix4 projection = Matrix4::getProjectionForFrustum(-1, 1, -0.75, 0.75, 1, 8192);
+
+		Matrix4 view = Matrix4::getRotationAboutXDegrees(-90)
+			.getMultipliedBy(Matrix4::getRotationAboutZDegrees(yaw))
+			.getMultipliedBy(Matrix4::getTranslation(-eye));
+
+		return Frustum::createFromViewproj(projection.getMultipliedBy(view));
+	}
+}
+
+void OctreeBenchmark::run()
+{
+	std::vector<workload::BrushPlanes> brushes;
+	workload::generateBrushes(NUM_BRUSHES, brushes);
+
+	std::vector<BoundsNodePtr> nodes;
+
+	for (std::size_t i = 0; i < brushes.size(); ++i)
+	{
+		nodes.push_back(BoundsNodePtr(new BoundsNode(getBounds(brushes[i]))));
+	}
+
+	measure("link", [&]()
+	{
+		scene::Octree octree;
+
+		for (std::size_t i = 0; i < nodes.size(); ++i)
+		{
+			octree.link(nodes[i]);
+		}
+	}, static_cast<double>(nodes.size()), "nodes");
+
+	scene::Octree octree;
+
+	for (std::size_t i = 0; i < nodes.size(); ++i)
+	{
+		octree.link(nodes[i]);
+	}
+
+	workload::Random random(10);
+
+	std::vector<Frustum> frusta;
+	std::vector<Ray> rays;
+
+	for (std::size_t i = 0; i < NUM_QUERIES; ++i)
+	{
+		Vector3 eye(random.nextDouble(-8192, 8192), random.nextDouble(-8192, 8192), random.nextDouble(-2048, 2048));
+
+		frusta.push_back(getCameraFrustum(eye, random.nextDouble(0, 360)));
+
+		Vector3 target(random.nextDouble(-8192, 8192), random.nextDouble(-8192, 8192), random.nextDouble(-2048, 2048));
+		rays.push_back(Ray::createForPoints(eye, target));
+	}
+
+	std::size_t visible = 0;
+
+	measure("camera frustum query", [&]()
+	{
+		visible = 0;
+
+		for (std::size_t i = 0; i < frusta.size(); ++i)
+		{
+			visible += countInVolume(*octree.getRoot(), frusta[i]);
+		}
+	}, static_cast<double>(frusta.size()), "queries");
+
+	std::size_t hits = 0;
+
+	measure("ray query", [&]()
+	{
+		hits = 0;
+
+		for (std::size_t i = 0; i < rays.size(); ++i)
+		{
+			hits += countAlongRay(*octree.getRoot(), rays[i]);
+		}
+	}, static_cast<double>(rays.size()), "queries");
+
+	// Moving nodes around: unlink, change the bounds, link again
+	measure("relink moved nodes", [&]()
+	{
+		for (std::size_t i = 0; i < NUM_MOVES; ++i)
+		{
+			const BoundsNodePtr& node = nodes[(i * 7919) % nodes.size()];
+
+			octree.unlink(node);
+
+			AABB bounds = node->worldAABB();
+			bounds.origin += Vector3(i % 2 == 0 ? 64 : -64, 0, 0);
+			node->setBounds(bounds);
+
+			octree.link(node);
+		}
+	}, static_cast<double>(NUM_MOVES), "nodes");
+
+	// Nudging nodes by a few units, only the ones leaving their octant are relinked
+	std::size_t relinked = 0;
+
+	measure("update nudged nodes", [&]()
+	{
+		relinked = 0;
+
+		for (std::size_t i = 0; i < NUM_MOVES; ++i)
+		{
+			const BoundsNodePtr& node = nodes[(i * 7919) % nodes.size()];
+
+			AABB bounds = node->worldAABB();
+			bounds.origin += Vector3(i % 2 == 0 ? 8 : -8, 0, 0);
+			node->setBounds(bounds);
+
+			if (octree.update(node))
+			{
+				++relinked;
+			}
+		}
+	}, static_cast<double>(NUM_MOVES), "nodes");
+
+	REQUIRE_TRUE(relinked < NUM_MOVES, "Nudged nodes should mostly stay in their octant");
+
+	REQUIRE_TRUE(visible > 0 && visible < NUM_BRUSHES * NUM_QUERIES, "Implausible frustum query result");
+
+	std::cout << std::endl << "  " << visible << " nodes in " << NUM_QUERIES << " frusta, "
+		<< hits << " nodes along " << NUM_QUERIES << " rays, "
+		<< (NUM_MOVES - relinked) << " of " << NUM_MOVES << " relinks avoided" << std::endl;
+}
@@ -0,0 +1,24 @@
+#pragma once
+
+#include "Benchmark.h"
+
+/**
+ * Links the bounds of a large generated map into the Octree used by the
+ * scenegraph and runs the volume and ray queries the SceneGraph performs
+ * when rendering and selecting, followed by relinking moved nodes and
+ * updating nudged ones.
+ */
+class OctreeBenchmark :
+	public Benchmark
+{
+private:
+	static Registrar _registrar;
+
+public:
+	std::string getName()
+	{
+		return "Octree Benchmark";
+	}
+
+	void run();
+};
@@ -0,0 +1,19 @@
+#pragma once
+
+#include <chrono>
+
+// Measures the wall clock time elapsed since its construction
+class StopWatch
+{
+	std::chrono::high_resolution_clock::time_point _start;
+public:
+	StopWatch() :
+		_start(std::chrono::high_resolution_clock::now())
+	{}
+
+	double getMilliseconds() const
+	{
+		return std::chrono::duration<double, std::milli>(
+			std::chrono::high_resolution_clock::now() - _start).count();
+	}
+};
@@ -20,10 +20,15 @@ public:
 		_tests.insert(TestMap::value_type(test->getName(), test));
 	}
 
-	void runAll()
+	// Runs all tests whose name contains the given filter string, returns the number of failed tests
+	std::size_t runAll(const std::string& filter = "")
 	{
+		std::size_t failed = 0;
+
 		for (TestMap::const_iterator i = _tests.begin(); i != _tests.end(); ++i)
 		{
+			if (i->first.find(filter) == std::string::npos) continue;
+
 			i->second->prepare();
 
 			try
@@ -37,10 +42,13 @@ public:
 			catch (Test::TestFailedException& ex)
 			{
 				std::cout << i->first << " failed with message: " << ex.what() << std::endl;
+				++failed;
 			}
 
 			i->second->cleanup();
 		}
+
+		return failed;
 	}
 
 	// Contains the singleton instance
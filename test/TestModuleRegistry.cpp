@@ -0,0 +1,132 @@
+#include "TestModuleRegistry.h"
+
+#include "itrace.h"
+
+#include <iostream>
+#include <stdexcept>
+
+namespace
+{
+	// Traces are not recorded in the test suite
+	class NullTraceRecorder :
+		public trace::TraceRecorder
+	{
+	public:
+		trace::Timestamp getTimestamp() const
+		{
+			return 0;
+		}
+
+		void addZone(const char* category, const char* name, const std::string& detail,
+					 trace::Timestamp start, trace::Timestamp end)
+		{}
+	};
+
+	class TestApplicationContext :
+		public ApplicationContext
+	{
+		ArgumentList _args;
+		ErrorHandlingFunction _errorHandler;
+		mutable NullTraceRecorder _traceRecorder;
+
+	public:
+		std::string getApplicationPath() const { return std::string(); }
+		std::string getRuntimeDataPath() const { return std::string(); }
+		std::string getSettingsPath() const { return std::string(); }
+		std::string getBitmapsPath() const { return std::string(); }
+
+		const ArgumentList& getCmdLineArgs() const { return _args; }
+
+		std::ostream& getOutputStream() const { return std::cout; }
+		std::ostream& getErrorStream() const { return std::cerr; }
+		std::ostream& getWarningStream() const { return std::cerr; }
+
+		void savePathsToRegistry() const {}
+
+		const ErrorHandlingFunction& getErrorHandlingFunction() const { return _errorHandler; }
+
+		trace::TraceRecorder& getTraceRecorder() const { return _traceRecorder; }
+	};
+}
+
+TestModuleRegistry::TestModuleRegistry()
+{
+	module::RegistryReference::Instance().setRegistry(*this);
+}
+
+void TestModuleRegistry::registerModule(RegisterableModulePtr module)
+{
+	_modules[module->getName()] = module;
+}
+
+void TestModuleRegistry::initialiseModules()
+{
+	for (ModuleMap::const_iterator i = _modules.begin(); i != _modules.end(); ++i)
+	{
+		initialiseModule(i->second);
+	}
+}
+
+void TestModuleRegistry::initialiseModule(const RegisterableModulePtr& module)
+{
+	if (!_initialised.insert(module->getName()).second) return;
+
+	const StringSet& dependencies = module->getDependencies();
+
+	for (StringSet::const_iterator i = dependencies.begin(); i != dependencies.end(); ++i)
+	{
+		RegisterableModulePtr dependency = getModule(*i);
+
+		if (!dependency)
+		{
+			throw std::logic_error(module->getName() + " depends on " + *i +
+				", which is not compiled into the test suite.");
+		}
+
+		initialiseModule(dependency);
+	}
+
+	module->preInitialiseModule(getApplicationContext());
+	module->initialiseModule(getApplicationContext());
+}
+
+void TestModuleRegistry::shutdownModules()
+{
+	for (ModuleMap::const_iterator i = _modules.begin(); i != _modules.end(); ++i)
+	{
+		i->second->shutdownModule();
+	}
+
+	_modules.clear();
+	_initialised.clear();
+}
+
+RegisterableModulePtr TestModuleRegistry::getModule(const std::string& name) const
+{
+	ModuleMap::const_iterator found = _modules.find(name);
+
+	return found != _modules.end() ? found->second : RegisterableModulePtr();
+}
+
+bool TestModuleRegistry::moduleExists(const std::string& name) const
+{
+	return _modules.find(name) != _modules.end();
+}
+
+const ApplicationContext& TestModuleRegistry::getApplicationContext() const
+{
+	static TestApplicationContext _context;
+	return _context;
+}
+
+TestModuleRegistry& TestModuleRegistry::Instance()
+{
+	static TestModuleRegistry _registry;
+	return _registry;
+}
+
+// The StaticModules compiled into the test suite register here
+IModuleRegistry& module::getRegistry()
+{
+	return TestModuleRegistry::Instance();
+}
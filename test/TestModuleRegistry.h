@@ -0,0 +1,41 @@
+#pragma once
+
+#include "imodule.h"
+
+#include <map>
+
+/**
+ * A minimal module registry for the test suite. The modules compiled into
+ * the test suite register themselves through their StaticModule instances,
+ * like they do in the main binary, which lets the tests exercise the real
+ * implementations behind the Global*() accessors.
+ *
+ * There is no module loading, and the modules are initialised with an
+ * application context providing empty paths.
+ */
+class TestModuleRegistry :
+	public IModuleRegistry
+{
+	typedef std::map<std::string, RegisterableModulePtr> ModuleMap;
+	ModuleMap _modules;
+
+	StringSet _initialised;
+
+	TestModuleRegistry();
+
+public:
+	void registerModule(RegisterableModulePtr module);
+
+	// Initialises all registered modules, dependencies first
+	void initialiseModules();
+	void shutdownModules();
+
+	RegisterableModulePtr getModule(const std::string& name) const;
+	bool moduleExists(const std::string& name) const;
+	const ApplicationContext& getApplicationContext() const;
+
+	static TestModuleRegistry& Instance();
+
+private:
+	void initialiseModule(const RegisterableModulePtr& module);
+};
@@ -0,0 +1,49 @@
+#include "TextureBenchmark.h"
+
+#include "Workloads.h"
+#include "ddslib.h"
+
+#include <iostream>
+#include <vector>
+
+Test::Registrar TextureBenchmark::_registrar(TestPtr(new TextureBenchmark));
+
+namespace
+{
+	const std::size_t IMAGE_SIZE = 2048;
+}
+
+void TextureBenchmark::run()
+{
+	measureDecompression("DXT1 decompression", IMAGE_SIZE, false);
+	measureDecompression("DXT5 decompression", IMAGE_SIZE, true);
+
+	std::cout << std::endl;
+}
+
+void TextureBenchmark::measureDecompression(const std::string& caseName, std::size_t size, bool dxt5)
+{
+	std::string dds = workload::generateDDS(size, size, dxt5);
+
+	const DDSHeader* header = reinterpret_cast<const DDSHeader*>(dds.data());
+	const unsigned char* data = reinterpret_cast<const unsigned char*>(dds.data()) + sizeof(DDSHeader);
+
+	int width = 0;
+	int height = 0;
+	ddsPF_t format;
+
+	REQUIRE_TRUE(DDSGetInfo(header, &width, &height, &format) == 0, "Invalid DDS header");
+	REQUIRE_TRUE(width == static_cast<int>(size) && height == static_cast<int>(size),
+		"Wrong DDS dimensions");
+	REQUIRE_TRUE(format == (dxt5 ? DDS_PF_DXT5 : DDS_PF_DXT1), "Wrong DDS pixel format");
+
+	std::vector<unsigned char> pixels(size * size * 4);
+	int result = 0;
+
+	measure(caseName, [&]()
+	{
+		result = DDSDecompress(header, data, &pixels.front());
+	}, size * size / 1e6, "Mpixels");
+
+	REQUIRE_TRUE(result == 0, caseName + " failed");
+}
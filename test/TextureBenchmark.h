@@ -0,0 +1,25 @@
+#pragma once
+
+#include "Benchmark.h"
+
+/**
+ * Decompresses generated DXT1 and DXT5 images with the DDS library used by
+ * the image loader, the most expensive step of loading DDS textures.
+ */
+class TextureBenchmark :
+	public Benchmark
+{
+private:
+	static Registrar _registrar;
+
+public:
+	std::string getName()
+	{
+		return "Texture Benchmark";
+	}
+
+	void run();
+
+private:
+	void measureDecompression(const std::string& caseName, std::size_t size, bool dxt5);
+};
@@ -0,0 +1,50 @@
+#include "TokeniserBenchmark.h"
+
+#include "Workloads.h"
+#include "parser/DefTokeniser.h"
+
+#include <iostream>
+#include <sstream>
+
+Test::Registrar TokeniserBenchmark::_registrar(TestPtr(new TokeniserBenchmark));
+
+void TokeniserBenchmark::run()
+{
+	measureTokenising("map", workload::generateMap(20000, 2000));
+	measureTokenising("materials", workload::generateMaterials(5000));
+	measureTokenising("entityDefs", workload::generateDefs(3000));
+
+	std::cout << std::endl;
+}
+
+void TokeniserBenchmark::measureTokenising(const std::string& caseName, const std::string& contents)
+{
+	std::size_t numTokens = 0;
+
+	measure(caseName + " from string", [&]()
+	{
+		parser::BasicDefTokeniser<std::string> tok(contents);
+
+		for (numTokens = 0; tok.hasMoreTokens(); ++numTokens)
+		{
+			tok.nextToken();
+		}
+	}, contents.size() / 1e6, "MB");
+
+	std::size_t numStreamTokens = 0;
+
+	// The file system hands out streams, this is what the map loader uses
+	measure(caseName + " from stream", [&]()
+	{
+		std::istringstream stream(contents);
+		parser::BasicDefTokeniser<std::istream> tok(stream);
+
+		for (numStreamTokens = 0; tok.hasMoreTokens(); ++numStreamTokens)
+		{
+			tok.nextToken();
+		}
+	}, contents.size() / 1e6, "MB");
+
+	REQUIRE_TRUE(numTokens > 0 && numTokens == numStreamTokens,
+		"String and stream tokeniser disagree on " + caseName);
+}
@@ -0,0 +1,26 @@
+#pragma once
+
+#include "Benchmark.h"
+
+/**
+ * Measures the throughput of the DefTokeniser on generated map, material
+ * and entityDef files, the tokeniser being the first stage of map loading
+ * and declaration parsing.
+ */
+class TokeniserBenchmark :
+	public Benchmark
+{
+private:
+	static Registrar _registrar;
+
+public:
+	std::string getName()
+	{
+		return "Tokeniser Benchmark";
+	}
+
+	void run();
+
+private:
+	void measureTokenising(const std::string& caseName, const std::string& contents);
+};
@@ -0,0 +1,425 @@
+#include "Workloads.h"
+
+#include <fstream>
+#include <sstream>
+#include <boost/crc.hpp>
+#include <boost/filesystem.hpp>
+
+namespace workload
+{
+
+namespace
+{
+	const double GRID = 16;
+	const double WORLD_EXTENT = 8192;
+
+	// Distance of the sealing walls to the extent of the generated content
+	const double HULL_MARGIN = 1024;
+	const double HULL_THICKNESS = 64;
+
+	const char* const MATERIAL_FOLDERS[] = { "stone/brick", "wood/boards", "metal/plates", "plaster", "tiles" };
+	const std::size_t NUM_MATERIAL_FOLDERS = sizeof(MATERIAL_FOLDERS) / sizeof(MATERIAL_FOLDERS[0]);
+
+	std::string getMaterialName(std::size_t index)
+	{
+		std::ostringstream name;
+		name << "textures/benchmark/" << MATERIAL_FOLDERS[index % NUM_MATERIAL_FOLDERS]
+			<< "/surface_" << index;
+		return name.str();
+	}
+
+	double snap(double value)
+	{
+		return static_cast<int>(value / GRID) * GRID;
+	}
+
+	BrushPlanes getBoxPlanes(const Vector3& mins, const Vector3& maxs)
+	{
+		BrushPlanes planes;
+
+		planes.push_back(Plane3(0, 0, -1, -mins.z()));
+		planes.push_back(Plane3(0, 1, 0, maxs.y()));
+		planes.push_back(Plane3(1, 0, 0, maxs.x()));
+		planes.push_back(Plane3(0, 0, 1, maxs.z()));
+		planes.push_back(Plane3(-1, 0, 0, -mins.x()));
+		planes.push_back(Plane3(0, -1, 0, -mins.y()));
+
+		return planes;
+	}
+
+	void writeBrush(std::ostream& stream, const BrushPlanes& planes, const std::string& material,
+					std::size_t primitiveNum)
+	{
+		stream << "// primitive " << primitiveNum << "\n{\nbrushDef3\n{\n";
+
+		for (BrushPlanes::const_iterator p = planes.begin(); p != planes.end(); ++p)
+		{
+			// The d value is the negated distance
+			stream << "( " << p->normal().x() << " " << p->normal().y() << " " << p->normal().z()
+				<< " " << -p->dist() << " ) ( ( 0.0078125 0 0 ) ( 0 0.0078125 0 ) ) \""
+				<< material << "\" 0 0 0\n";
+		}
+
+		stream << "}\n}\n";
+	}
+
+	void writePatch(std::ostream& stream, Random& random, const std::string& material,
+					std::size_t primitiveNum)
+	{
+		// Odd sizes between 3 and 11 control points
+		int width = 3 + 2 * random.nextInt(5);
+		int height = 3 + 2 * random.nextInt(5);
+
+		double x = snap(random.nextDouble(-WORLD_EXTENT, WORLD_EXTENT));
+		double y = snap(random.nextDouble(-WORLD_EXTENT, WORLD_EXTENT));
+		double z = snap(random.nextDouble(-WORLD_EXTENT / 4, WORLD_EXTENT / 4));
+
+		stream << "// primitive " << primitiveNum << "\n{\npatchDef2\n{\n\"" << material << "\"\n"
+			<< "( " << width << " " << height << " 0 0 0 )\n(\n";
+
+		for (int col = 0; col < width; ++col)
+		{
+			stream << "( ";
+
+			for (int row = 0; row < height; ++row)
+			{
+				stream << "( " << x + col * 32 << " " << y + row * 32 << " "
+					<< z + random.nextInt(64) << " " << col * 0.25 << " " << row * 0.25 << " ) ";
+			}
+
+			stream << ")\n";
+		}
+
+		stream << ")\n}\n}\n";
+	}
+
+	void writeUInt16(std::string& buffer, unsigned int value)
+	{
+		buffer += static_cast<char>(value & 0xff);
+		buffer += static_cast<char>((value >> 8) & 0xff);
+	}
+
+	void writeUInt32(std::string& buffer, unsigned int value)
+	{
+		writeUInt16(buffer, value & 0xffff);
+		writeUInt16(buffer, value >> 16);
+	}
+
+	bool writeFile(const boost::filesystem::path& path, const std::string& contents)
+	{
+		boost::filesystem::create_directories(path.parent_path());
+
+		std::ofstream file(path.string().c_str(), std::ios::binary);
+		file.write(contents.data(), contents.size());
+
+		return file.good();
+	}
+}
+
+void generateBrushes(std::size_t numBrushes, std::vector<BrushPlanes>& brushes)
+{
+	Random random(1);
+
+	for (std::size_t i = 0; i < numBrushes; ++i)
+	{
+		Vector3 mins(snap(random.nextDouble(-WORLD_EXTENT, WORLD_EXTENT)),
+					 snap(random.nextDouble(-WORLD_EXTENT, WORLD_EXTENT)),
+					 snap(random.nextDouble(-WORLD_EXTENT / 4, WORLD_EXTENT / 4)));
+
+		Vector3 size(GRID * (1 + random.nextInt(32)),
+					 GRID * (1 + random.nextInt(32)),
+					 GRID * (1 + random.nextInt(16)));
+
+		Vector3 maxs = mins + size;
+
+		BrushPlanes planes = getBoxPlanes(mins, maxs);
+
+		if (i % 4 == 0)
+		{
+			// Bevel one of the top edges, cutting off half of the adjacent faces
+			Vector3 normal = Vector3(size.z(), 0, size.x()).getNormalised();
+			Vector3 point(maxs.x() - size.x() * 0.5, mins.y(), maxs.z());
+
+			planes.push_back(Plane3(normal, normal.dot(point)));
+		}
+
+		brushes.push_back(planes);
+	}
+}
+
+std::string generateMap(std::size_t numBrushes, std::size_t numPatches)
+{
+	std::ostringstream stream;
+	stream.precision(6);
+
+	Random random(2);
+
+	std::vector<BrushPlanes> brushes;
+	generateBrushes(numBrushes, brushes);
+
+	stream << "Version 2\n// entity 0\n{\n\"classname\" \"worldspawn\"\n";
+
+	std::size_t primitiveNum = 0;
+
+	// Every tenth brush goes into a func_static
+	for (std::size_t i = 0; i < brushes.size(); ++i)
+	{
+		if (i % 10 != 9)
+		{
+			writeBrush(stream, brushes[i], getMaterialName(random.nextInt(200)), primitiveNum++);
+		}
+	}
+
+	for (std::size_t i = 0; i < numPatches; ++i)
+	{
+		writePatch(stream, random, getMaterialName(random.nextInt(200)), primitiveNum++);
+	}
+
+	// Six walls sealing everything in, so that dmap doesn't find a leak
+	Vector3 inner(WORLD_EXTENT + HULL_MARGIN, WORLD_EXTENT + HULL_MARGIN, WORLD_EXTENT / 4 + HULL_MARGIN);
+	Vector3 outer = inner + Vector3(HULL_THICKNESS, HULL_THICKNESS, HULL_THICKNESS);
+
+	for (std::size_t axis = 0; axis < 3; ++axis)
+	{
+		Vector3 mins = -outer;
+		Vector3 maxs = outer;
+
+		maxs[axis] = -inner[axis];
+		writeBrush(stream, getBoxPlanes(mins, maxs), getMaterialName(0), primitiveNum++);
+
+		mins[axis] = inner[axis];
+		maxs[axis] = outer[axis];
+		writeBrush(stream, getBoxPlanes(mins, maxs), getMaterialName(0), primitiveNum++);
+	}
+
+	stream << "}\n";
+
+	std::size_t entityNum = 1;
+
+	for (std::size_t i = 9; i < brushes.size(); i += 10)
+	{
+		stream << "// entity " << entityNum << "\n{\n\"classname\" \"func_static\"\n"
+			<< "\"name\" \"func_static_" << entityNum << "\"\n"
+			<< "\"model\" \"func_static_" << entityNum << "\"\n";
+
+		writeBrush(stream, brushes[i], getMaterialName(random.nextInt(200)), 0);
+
+		stream << "}\n";
+		++entityNum;
+	}
+
+	for (std::size_t i = 0; i < numBrushes / 50; ++i)
+	{
+		stream << "// entity " << entityNum << "\n{\n\"classname\" \"light\"\n"
+			<< "\"name\" \"light_" << entityNum << "\"\n"
+			<< "\"origin\" \"" << snap(random.nextDouble(-WORLD_EXTENT, WORLD_EXTENT)) << " "
+			<< snap(random.nextDouble(-WORLD_EXTENT, WORLD_EXTENT)) << " "
+			<< snap(random.nextDouble(-WORLD_EXTENT / 4, WORLD_EXTENT / 4)) << "\"\n"
+			<< "\"light_radius\" \"320 320 320\"\n"
+			<< "\"_color\" \"" << random.nextDouble(0, 1) << " " << random.nextDouble(0, 1)
+			<< " " << random.nextDouble(0, 1) << "\"\n}\n";
+		++entityNum;
+	}
+
+	return stream.str();
+}
+
+std::string generateMaterials(std::size_t numMaterials, std::size_t first)
+{
+	std::ostringstream stream;
+
+	Random random(3);
+
+	// Table names are global, keep them apart when generating several files
+	stream << "table benchmarkTable" << first << " { { 0, 0.25, 0.5, 0.75, 1, 0.75, 0.5, 0.25 } }\n\n";
+
+	for (std::size_t i = first; i < first + numMaterials; ++i)
+	{
+		std::string name = getMaterialName(i);
+
+		stream << "// Generated material " << i << "\n" << name << "\n{\n"
+			<< "\tqer_editorimage " << name << "_ed\n"
+			<< "\tdescription \"Benchmark material " << i << "\"\n";
+
+		if (i % 3 == 0) stream << "\tsurftype15\n\tnonsolid\n";
+		if (i % 5 == 0) stream << "\ttwosided\n";
+
+		stream << "\tdiffusemap " << name << "\n"
+			<< "\tbumpmap addnormals(" << name << "_local, heightmap(" << name << "_h, 4))\n"
+			<< "\tspecularmap " << name << "_s\n";
+
+		if (i % 4 == 0)
+		{
+			stream << "\t{\n\t\tblend add\n\t\tmap " << name << "_glow\n"
+				<< "\t\trgb " << random.nextDouble(0.1, 1) << " * benchmarkTable" << first << "[time * "
+				<< random.nextDouble(0.1, 2) << "]\n"
+				<< "\t\ttranslate time * 0.1, 0\n"
+				<< "\t\tscale 1, 1 + sinTable[time * 0.5] * parm3\n\t}\n";
+		}
+
+		stream << "}\n\n";
+	}
+
+	return stream.str();
+}
+
+std::string generateDefs(std::size_t numDefs, std::size_t first)
+{
+	std::ostringstream stream;
+
+	Random random(4);
+
+	for (std::size_t i = first; i < first + numDefs; ++i)
+	{
+		stream << "entityDef benchmark_entity_" << i << "\n{\n";
+
+		// Chains of up to ten levels of inheritance
+		if (i % 10 != 0)
+		{
+			stream << "\t\"inherit\"\t\t\t\"benchmark_entity_" << i - 1 << "\"\n";
+		}
+
+		stream << "\t\"editor_usage\"\t\t\"Generated entity " << i << "\"\n"
+			<< "\t\"editor_color\"\t\t\"" << random.nextDouble(0, 1) << " "
+			<< random.nextDouble(0, 1) << " " << random.nextDouble(0, 1) << "\"\n"
+			<< "\t\"editor_mins\"\t\t\"-16 -16 -16\"\n"
+			<< "\t\"editor_maxs\"\t\t\"16 16 16\"\n"
+			<< "\t\"editor_var benchmark_" << i << "\"\t\"A spawnarg documented in the editor\"\n";
+
+		for (int key = 0; key < 20; ++key)
+		{
+			stream << "\t\"key_" << i << "_" << key << "\"\t\t\"" << random.nextInt(1000) << "\"\n";
+		}
+
+		stream << "}\n\n";
+	}
+
+	return stream.str();
+}
+
+std::string generateDDS(std::size_t width, std::size_t height, bool dxt5)
+{
+	std::string buffer("DDS ");
+
+	writeUInt32(buffer, 124);			// size
+	writeUInt32(buffer, 0x00081007);	// caps, height, width, pixelformat, linearsize
+	writeUInt32(buffer, static_cast<unsigned int>(height));
+	writeUInt32(buffer, static_cast<unsigned int>(width));
+
+	std::size_t blockSize = dxt5 ? 16 : 8;
+	std::size_t dataSize = (width / 4) * (height / 4) * blockSize;
+
+	writeUInt32(buffer, static_cast<unsigned int>(dataSize));
+
+	for (int i = 0; i < 13; ++i) writeUInt32(buffer, 0); // depth, mipmaps, reserved...
+
+	// Pixel format
+	writeUInt32(buffer, 32);
+	writeUInt32(buffer, 0x4); // fourcc
+	buffer += dxt5 ? "DXT5" : "DXT1";
+
+	for (int i = 0; i < 5; ++i) writeUInt32(buffer, 0);
+
+	writeUInt32(buffer, 0x1000); // caps: texture
+
+	for (int i = 0; i < 4; ++i) writeUInt32(buffer, 0);
+
+	Random random(5);
+
+	for (std::size_t i = 0; i < dataSize; ++i)
+	{
+		buffer += static_cast<char>(random.next() & 0xff);
+	}
+
+	return buffer;
+}
+
+std::string generatePK4(const std::vector<ArchiveFile>& files)
+{
+	std::string archive;
+	std::string directory;
+
+	for (std::vector<ArchiveFile>::const_iterator i = files.begin(); i != files.end(); ++i)
+	{
+		boost::crc_32_type crc;
+		crc.process_bytes(i->contents.data(), i->contents.size());
+
+		unsigned int offset = static_cast<unsigned int>(archive.size());
+		unsigned int size = static_cast<unsigned int>(i->contents.size());
+		unsigned int nameLength = static_cast<unsigned int>(i->name.size());
+
+		// Local file header
+		writeUInt32(archive, 0x04034b50);
+		writeUInt16(archive, 10);	// version needed
+		writeUInt16(archive, 0);	// flags
+		writeUInt16(archive, 0);	// stored
+		writeUInt16(archive, 0);	// time
+		writeUInt16(archive, 0x21);	// date: 1980-01-01
+		writeUInt32(archive, crc.checksum());
+		writeUInt32(archive, size);
+		writeUInt32(archive, size);
+		writeUInt16(archive, nameLength);
+		writeUInt16(archive, 0);
+		archive += i->name;
+		archive += i->contents;
+
+		// Central directory entry
+		writeUInt32(directory, 0x02014b50);
+		writeUInt16(directory, 20);	// version made by
+		writeUInt16(directory, 10);
+		writeUInt16(directory, 0);
+		writeUInt16(directory, 0);
+		writeUInt16(directory, 0);
+		writeUInt16(directory, 0x21);
+		writeUInt32(directory, crc.checksum());
+		writeUInt32(directory, size);
+		writeUInt32(directory, size);
+		writeUInt16(directory, nameLength);
+		writeUInt16(directory, 0);	// extra
+		writeUInt16(directory, 0);	// comment
+		writeUInt16(directory, 0);	// disk
+		writeUInt16(directory, 0);	// internal attributes
+		writeUInt32(directory, 0);	// external attributes
+		writeUInt32(directory, offset);
+		directory += i->name;
+	}
+
+	unsigned int directoryOffset = static_cast<unsigned int>(archive.size());
+	archive += directory;
+
+	// End of central directory
+	writeUInt32(archive, 0x06054b50);
+	writeUInt16(archive, 0);
+	writeUInt16(archive, 0);
+	writeUInt16(archive, static_cast<unsigned int>(files.size()));
+	writeUInt16(archive, static_cast<unsigned int>(files.size()));
+	writeUInt32(archive, static_cast<unsigned int>(directory.size()));
+	writeUInt32(archive, directoryOffset);
+	writeUInt16(archive, 0);
+
+	return archive;
+}
+
+bool writeWorkloads(const std::string& folder)
+{
+	boost::filesystem::path root(folder);
+
+	std::vector<ArchiveFile> archiveFiles;
+	archiveFiles.push_back(ArchiveFile("materials/benchmark_pk4.mtr", generateMaterials(2000, 2000)));
+	archiveFiles.push_back(ArchiveFile("def/benchmark_pk4.def", generateDefs(1000, 1000)));
+
+	for (std::size_t i = 0; i < 16; ++i)
+	{
+		std::ostringstream name;
+		name << "textures/benchmark/surface_" << i << ".dds";
+
+		archiveFiles.push_back(ArchiveFile(name.str(), generateDDS(256, 256, i % 2 == 1)));
+	}
+
+	return writeFile(root / "maps" / "benchmark.map", generateMap(20000, 2000)) &&
+		writeFile(root / "materials" / "benchmark.mtr", generateMaterials(2000)) &&
+		writeFile(root / "def" / "benchmark.def", generateDefs(1000)) &&
+		writeFile(root / "benchmark.pk4", generatePK4(archiveFiles));
+}
+
+}
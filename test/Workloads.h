@@ -0,0 +1,101 @@
+#pragma once
+
+#include <string>
+#include <vector>
+#include "math/Plane3.h"
+
+/**
+ * Generators for the benchmark workloads. All of them are deterministic:
+ * the same parameters always produce the same output, independently of the
+ * platform, so timings can be compared across runs and machines.
+ */
+namespace workload
+{
+
+// Linear congruential generator, std::rand() differs between the runtimes
+class Random
+{
+	unsigned int _state;
+
+public:
+	Random(unsigned int seed) :
+		_state(seed)
+	{}
+
+	unsigned int next()
+	{
+		_state = _state * 1664525u + 1013904223u;
+		return _state >> 8;
+	}
+
+	// Returns a value in [0..max)
+	int nextInt(int max)
+	{
+		return static_cast<int>(next() % static_cast<unsigned int>(max));
+	}
+
+	// Returns a value in [min..max]
+	double nextDouble(double min, double max)
+	{
+		return min + (max - min) * (next() & 0xffff) / 65535.0;
+	}
+};
+
+// The planes of a brush, as stored in a brushDef3
+typedef std::vector<Plane3> BrushPlanes;
+
+/**
+ * Generates the planes of the given number of brushes: axis-aligned blocks
+ * snapped to the grid, every fourth brush has one of its top edges bevelled
+ * by an additional diagonal plane.
+ */
+void generateBrushes(std::size_t numBrushes, std::vector<BrushPlanes>& brushes);
+
+/**
+ * Generates a Doom 3 map (Version 2) with the given number of worldspawn
+ * brushes and patchDef2 grids, plus a few lights and func_statics. Six
+ * walls enclose all of it, so the map can be compiled without a leak.
+ */
+std::string generateMap(std::size_t numBrushes, std::size_t numPatches);
+
+/**
+ * Generates a material file with the given number of declarations using
+ * stages and expressions, numbered from the given index on.
+ */
+std::string generateMaterials(std::size_t numMaterials, std::size_t first = 0);
+
+// Generates an entityDef file with the given number of declarations and inheritance chains
+std::string generateDefs(std::size_t numDefs, std::size_t first = 0);
+
+/**
+ * Generates a DDS image (DXT1 or DXT5, without mipmaps) of the given size,
+ * which needs to be a multiple of 4.
+ */
+std::string generateDDS(std::size_t width, std::size_t height, bool dxt5);
+
+// A file to be stored in a PK4
+struct ArchiveFile
+{
+	std::string name;
+	std::string contents;
+
+	ArchiveFile(const std::string& name_, const std::string& contents_) :
+		name(name_),
+		contents(contents_)
+	{}
+};
+
+// Generates a PK4 (zip) archive holding the given files, stored without compression
+std::string generatePK4(const std::vector<ArchiveFile>& files);
+
+/**
+ * Writes the workloads to the given folder, so that they can be fed to
+ * DarkRadiant itself, e.g. using the batch mode to measure map loading,
+ * saving and compilation, or as fs_game folder:
+ *
+ * maps/benchmark.map, materials/benchmark.mtr, def/benchmark.def and
+ * benchmark.pk4, which contains another set of materials, defs and textures.
+ */
+bool writeWorkloads(const std::string& folder);
+
+}
@@ -1,18 +1,111 @@
 #include "TestManager.h"
+#include "TestModuleRegistry.h"
+#include "BenchmarkReport.h"
+#include "Workloads.h"
+#include "BatchBenchmark.h"
+
+#include <cstdlib>
 
 /**
  * Main entry point for the application.
+ *
+ * testsuite [options]
+ *
+ * --filter <text>: only runs the tests with the given text in their name
+ * --samples <n>: number of timed runs per benchmark case, defaults to 5
+ * --baseline <file>: compares the benchmark timings against the given baseline
+ * --save-baseline <file>: writes the benchmark timings as new baseline
+ * --tolerance <percent>: slowdown against the baseline considered a regression, defaults to 10
+ * --generate <folder>: writes the benchmark workloads (map, materials, defs, PK4)
+ *                      to the given folder and exits
+ * --darkradiant <executable>: the DarkRadiant executable measured by the Batch Benchmark
+ * --mod <folder>: mod folder in the engine path the Batch Benchmark writes its workloads to
+ * --no-wait: exits without waiting for the enter key
+ *
+ * Returns a non-zero exit code if a test failed or a benchmark regressed.
  */
 int main (int argc, char* argv[])
 {
+	std::string filter;
+	std::string baseline;
+	std::string newBaseline;
+	bool wait = true;
+
+	for (int i = 1; i < argc; ++i)
+	{
+		std::string arg = argv[i];
+		bool hasValue = i + 1 < argc;
+
+		if (arg == "--filter" && hasValue)
+		{
+			filter = argv[++i];
+		}
+		else if (arg == "--samples" && hasValue)
+		{
+			BenchmarkReport::Instance().setNumSamples(atoi(argv[++i]));
+		}
+		else if (arg == "--baseline" && hasValue)
+		{
+			baseline = argv[++i];
+		}
+		else if (arg == "--save-baseline" && hasValue)
+		{
+			newBaseline = argv[++i];
+		}
+		else if (arg == "--tolerance" && hasValue)
+		{
+			BenchmarkReport::Instance().setTolerance(atof(argv[++i]) / 100);
+		}
+		else if (arg == "--generate" && hasValue)
+		{
+			return workload::writeWorkloads(argv[++i]) ? EXIT_SUCCESS : EXIT_FAILURE;
+		}
+		else if (arg == "--darkradiant" && hasValue)
+		{
+			BatchBenchmark::setExecutable(argv[++i]);
+		}
+		else if (arg == "--mod" && hasValue)
+		{
+			BatchBenchmark::setModFolder(argv[++i]);
+		}
+		else if (arg == "--no-wait")
+		{
+			wait = false;
+		}
+		else
+		{
+			std::cout << "Unknown argument: " << arg << std::endl;
+			return EXIT_FAILURE;
+		}
+	}
+
+	if (!baseline.empty() && !BenchmarkReport::Instance().loadBaseline(baseline))
+	{
+		std::cout << "Could not read the baseline " << baseline << std::endl;
+	}
+
+	// Bring up the modules compiled into the test suite (like the string pool)
+	TestModuleRegistry::Instance().initialiseModules();
+
 	// Run all registered test
-	TestManager::Instance().runAll();
+	std::size_t failed = TestManager::Instance().runAll(filter);
 
-	std::cout << "Press enter to close this test." << std::endl;
+	TestModuleRegistry::Instance().shutdownModules();
 
-	std::string dummy;
-	std::cin >> dummy;
+	std::size_t regressions = BenchmarkReport::Instance().printSummary(std::cout);
 
-	return 0;
-}
+	if (!newBaseline.empty() && !BenchmarkReport::Instance().saveBaseline(newBaseline))
+	{
+		std::cout << "Could not write the baseline " << newBaseline << std::endl;
+	}
+
+	if (wait)
+	{
+		std::cout << "Press enter to close this test." << std::endl;
 
+		std::string dummy;
+		std::cin >> dummy;
+	}
+
+	return failed == 0 && regressions == 0 ? EXIT_SUCCESS : EXIT_FAILURE;
+}